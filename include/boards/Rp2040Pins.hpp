@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 #include "motion/MotorManager.hpp"
@@ -8,18 +9,43 @@
 namespace board::rp2040
 {
 
+    // Eight DRV8825 channels: one SN74HC595 for SLEEP gating and one PIO state
+    // machine per channel (PIO0 SM0-3, then PIO1 SM0-3).
+    inline constexpr std::size_t kChannelCount = 8;
+
+    static_assert(motion::kChannelCount == kChannelCount,
+                  "MOTION_CHANNEL_COUNT must match the board pin map");
+
     // STEP/DIR assignments for eight DRV8825 channels.
-    inline constexpr std::array<uint8_t, motion::MotorManager::kMotorCount> kStepPins = {
+    inline constexpr std::array<uint8_t, kChannelCount> kStepPins = {
         15, 17, 21, 22, 23, 24, 25, 26};
 
-    inline constexpr std::array<uint8_t, motion::MotorManager::kMotorCount> kDirPins = {
+    inline constexpr std::array<uint8_t, kChannelCount> kDirPins = {
         14, 18, 20, 4, 6, 27, 12, 13};
 
-    // SN74HC595 shift register control lines (data, clock, latch).
+    // SN74HC595 shift register control lines (data, clock, latch). Kept off
+    // every STEP/DIR pin: the PIO owns those once the driver starts, and SIO
+    // writes to a PIO-owned pad are dropped.
     inline constexpr motion::ShiftRegisterPins kShiftRegisterPins{
-        18, // SER
-        19, // SRCLK
-        20  // RCLK
+        9,  // SER
+        10, // SRCLK
+        11  // RCLK
     };
 
+    constexpr bool PinIsFree(uint8_t pin)
+    {
+        for (std::size_t i = 0; i < kChannelCount; ++i)
+        {
+            if (kStepPins[i] == pin || kDirPins[i] == pin)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(PinIsFree(kShiftRegisterPins.data) && PinIsFree(kShiftRegisterPins.clock) &&
+                      PinIsFree(kShiftRegisterPins.latch),
+                  "Shift register lines must not share a PIO-owned STEP/DIR pin");
+
 } // namespace board::rp2040
@@ -5,8 +5,19 @@
 #include <cstdint>
 #include <string_view>
 
+#include "geometry/Targeting.hpp"
 #include "motion/MotorManager.hpp"
 
+namespace diag
+{
+class SessionRecorder;
+}
+
+namespace storage
+{
+class CalibrationStore;
+}
+
 namespace ctrl
 {
 
@@ -14,10 +25,18 @@ class CommandProcessor
 {
 public:
   static constexpr std::size_t kMotorCount = motion::MotorManager::kMotorCount;
+  // Two-axis mirrors wired as (yaw, pitch) channel pairs.
+  static constexpr std::size_t kMirrorCount = kMotorCount / 2;
   static constexpr std::size_t kMaxCommandLength = 80;
   static constexpr std::size_t kMaxVerbLength = 8;
-  static constexpr std::size_t kMaxResponseLines = 18;
-  static constexpr std::size_t kMaxResponseLineLength = 96;
+  // Full STATUS: acknowledgement, two lines per motor, one spare.
+  static constexpr std::size_t kMaxResponseLines = 2 + (2 * kMotorCount);
+  // "#65535 ": the sequence tag echoed ahead of a tagged command's lines.
+  static constexpr std::size_t kMaxTagPrefixLength = 7;
+  static constexpr std::size_t kMaxResponseLineLength = 96 + kMaxTagPrefixLength;
+  // SUB push interval bounds; 0 unsubscribes.
+  static constexpr uint32_t kMinSubscriptionIntervalMs = 10;
+  static constexpr uint32_t kMaxSubscriptionIntervalMs = 60000;
   static constexpr int32_t kDefaultSpeedHz = motion::MotorManager::kDefaultSpeedHz;
   static constexpr int32_t kDefaultAcceleration = motion::MotorManager::kDefaultAcceleration;
 
@@ -38,7 +57,8 @@ public:
     NotReady,
     LimitViolation,
     Busy,
-    DriverFault
+    DriverFault,
+    Timeout
   };
 
   struct Response
@@ -51,17 +71,45 @@ public:
 
   void reset();
 
+  // A line may start with "#<seq> " (seq 0-65535); every line of its
+  // response, and every EVT line the command later causes, then starts with
+  // the same tag so a host can keep several commands in flight.
   void processLine(std::string_view rawLine, Response &out);
   void service(uint32_t elapsedMicros);
+  // With a SUB active and its interval elapsed, fills `out` with one DELTA
+  // line per changed channel carrying only the changed fields. Returns false
+  // (and leaves `out` empty) when there is nothing to push yet.
+  bool collectUpdates(Response &out);
+  // Drains the motion event queue into EVT:DONE/HOMED/FAULT lines, oldest
+  // first, then EVT:OVERFLOW if any were dropped since the last call.
+  // Returns false (and leaves `out` empty) when there is nothing to send.
+  bool collectEvents(Response &out);
   void configureShiftRegister(const motion::ShiftRegisterPins &pins);
 
+  // CAL writes through to the store and SHUTDOWN journals into it. Without
+  // one, calibration lasts until reset and SHUTDOWN answers ERR_NOT_READY.
+  void attachStore(storage::CalibrationStore *store) { store_ = store; }
+  // Applies stored calibration, then the clean-shutdown journal if the last
+  // power-down was clean. Returns true when positions were resumed.
+  bool restoreFromStore();
+  // REC:START captures the deck state and then every command line, stamped
+  // with service() time, until REC:STOP or the recorder fills.
+  void attachRecorder(diag::SessionRecorder *recorder) { recorder_ = recorder; }
+
   const MotorState &motorState(std::size_t index) const { return motorManager_.state(index); }
   ResponseCode lastResponse(std::size_t index) const { return lastResponseCodes_[index]; }
   motion::MotorManager &motorManager() { return motorManager_; }
+  geometry::MirrorPose &mirrorPose(std::size_t mirror) { return mirrorPoses_[mirror]; }
+  uint64_t uptimeMicros() const { return uptimeUs_; }
+
+  // Verbs in HELP order; trace CommandAccepted records carry the index.
+  // nullptr past the last one.
+  static const char *verbName(std::size_t index);
 
 private:
   static constexpr std::size_t kMaxTokens = 4;
 
+  void dispatchLine(std::string_view line, const motion::CommandTag &tag, Response &out);
   void writeResponsePrefix(Response &out, ResponseCode code);
   void appendLine(Response &out, std::string_view text);
   void appendFormatted(Response &out, const char *format, ...);
@@ -77,14 +125,52 @@ private:
   void handleWake(std::string_view payload, Response &out);
   void handleStatus(std::string_view payload, Response &out);
   void handleHome(std::string_view payload, Response &out);
+  void handleAim(std::string_view payload, Response &out);
+  void handleCal(std::string_view payload, Response &out);
+  void handleShutdown(Response &out);
+  bool invalidateJournal(const char *verb, Response &out);
+  void handleBoot(Response &out);
+  void handleSubscribe(std::string_view payload, Response &out);
+  void handleEvents(std::string_view payload, Response &out);
+  void handleSnapshot(Response &out);
+  void handleRecord(std::string_view payload, Response &out);
+  void handleTrace(std::string_view payload, Response &out);
+  void handleCache(std::string_view payload, Response &out);
 
   bool parseChannel(std::string_view token, std::size_t &channel);
+  bool parseChannelMask(std::string_view hexDigits, motion::MotorManager::ChannelMask &mask);
+  // `*`, `0x<mask>`, or channels and ranges joined by ',' or '+' (`0-3,6`).
+  // Only '+' survives inside a comma-separated payload (`MOVE:0-3+6,300`).
+  bool parseChannelSelector(std::string_view token, motion::MotorManager::ChannelMask &mask);
   ResponseCode mapFault(motion::FaultCode fault) const;
+  ResponseCode statusCode(std::size_t channel) const;
+  bool appendDelta(std::size_t channel, Response &out);
   void recordResponse(std::size_t channel, ResponseCode code);
+  void writeStatusLine(std::size_t channel, Response &out);
   void writeStatusForMotor(std::size_t channel, Response &out);
 
   motion::MotorManager motorManager_{};
   std::array<ResponseCode, kMotorCount> lastResponseCodes_{};
+  std::array<geometry::MirrorPose, kMirrorCount> mirrorPoses_{};
+  storage::CalibrationStore *store_ = nullptr;
+  diag::SessionRecorder *recorder_ = nullptr;
+
+  // What the subscriber last saw per channel, so a DELTA carries only the
+  // fields that moved.
+  struct PublishedStatus
+  {
+    int32_t position = 0;
+    int32_t targetPosition = 0;
+    MotionState phase = MotionState::Idle;
+    ResponseCode code = ResponseCode::Ok;
+    bool asleep = false;
+    bool valid = false;
+  };
+  std::array<PublishedStatus, kMotorCount> published_{};
+  // Device clock for SNAP: microseconds of service() time since reset.
+  uint64_t uptimeUs_ = 0;
+  uint32_t subscriptionIntervalUs_ = 0;
+  uint32_t subscriptionElapsedUs_ = 0;
 };
 
 } // namespace ctrl
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ctrl::snapshot
+{
+
+// SNAP frame, little-endian, fixed layout:
+//
+//   header   u8 version, u8 channelCount, u16 channelBytes, u64 timestampUs
+//   channel  i32 position, i32 target, u32 plannedDurationUs,
+//            u8 phase, u8 flags, u8 fault, u8 lastResponse      (x channelCount)
+//   trailer  u16 CRC-16/CCITT-FALSE over everything before it
+//
+// channelBytes lets a newer firmware append per-channel fields without
+// breaking older decoders, which read the first kChannelBytes of each record.
+inline constexpr uint8_t kVersion = 1;
+inline constexpr std::size_t kHeaderBytes = 12;
+inline constexpr std::size_t kChannelBytes = 16;
+inline constexpr std::size_t kTrailerBytes = 2;
+
+constexpr std::size_t FrameBytes(std::size_t channelCount)
+{
+  return kHeaderBytes + (kChannelBytes * channelCount) + kTrailerBytes;
+}
+
+// ChannelRecord::flags bits.
+inline constexpr uint8_t kFlagAsleep = 1U << 0;
+inline constexpr uint8_t kFlagHomed = 1U << 1;
+inline constexpr uint8_t kFlagLimitClipped = 1U << 2;
+
+struct Header
+{
+  uint8_t version = kVersion;
+  uint8_t channelCount = 0;
+  uint16_t channelBytes = kChannelBytes;
+  uint64_t timestampUs = 0;
+};
+
+// Numeric values mirror motion::MotionPhase, motion::FaultCode and
+// ctrl::CommandProcessor::ResponseCode.
+struct ChannelRecord
+{
+  int32_t position = 0;
+  int32_t targetPosition = 0;
+  uint32_t plannedDurationUs = 0;
+  uint8_t phase = 0;
+  uint8_t flags = 0;
+  uint8_t fault = 0;
+  uint8_t lastResponse = 0;
+};
+
+enum class DecodeStatus : uint8_t
+{
+  Ok = 0,
+  Truncated,
+  UnsupportedVersion,
+  BadChecksum
+};
+
+void EncodeHeader(const Header &header, uint8_t (&out)[kHeaderBytes]);
+void EncodeChannel(const ChannelRecord &record, uint8_t (&out)[kChannelBytes]);
+uint16_t UpdateChecksum(uint16_t crc, const uint8_t *data, std::size_t length);
+inline constexpr uint16_t kChecksumSeed = 0xFFFFU;
+
+// Host side. DecodeFrame validates the whole frame; DecodeChannel then reads
+// record `index` out of it.
+DecodeStatus DecodeFrame(const uint8_t *frame, std::size_t length, Header &header);
+ChannelRecord DecodeChannel(const uint8_t *frame, const Header &header, std::size_t index);
+// Concatenated hex payloads of the SNAP: lines into bytes; returns the byte
+// count, or 0 on an odd length, a bad digit or insufficient capacity.
+std::size_t DecodeHex(std::string_view hex, uint8_t *out, std::size_t capacity);
+
+} // namespace ctrl::snapshot
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace diag
+{
+
+// Boot milestones in the order setup() and the first loop passes reach them.
+// USB enumeration is last and independent: motion is serviced from Ready on,
+// whether or not a host ever connects.
+enum class BootPhase : uint8_t
+{
+  Reset = 0,
+  MotionReady,
+  StoreReady,
+  Ready,
+  HostConnected,
+  Count
+};
+
+inline constexpr std::size_t kBootPhaseCount = static_cast<std::size_t>(BootPhase::Count);
+
+// Records the first time a phase is reached (micros() since reset); later
+// marks of the same phase are ignored.
+void MarkBootPhase(BootPhase phase, uint32_t micros);
+bool BootPhaseReached(BootPhase phase);
+uint32_t BootPhaseMicros(BootPhase phase);
+const char *BootPhaseLabel(BootPhase phase);
+void ResetBootLog();
+
+} // namespace diag
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace diag
+{
+
+// Marks a region that must not touch the heap. The control path (command
+// parsing, motion service) runs inside one; an allocation while any scope is
+// open is counted and, on the RP2040, traps immediately.
+class NoHeapScope
+{
+public:
+  NoHeapScope();
+  ~NoHeapScope();
+
+  NoHeapScope(const NoHeapScope &) = delete;
+  NoHeapScope &operator=(const NoHeapScope &) = delete;
+};
+
+bool HeapForbidden();
+uint32_t HeapViolations();
+void ResetHeapViolations();
+
+// Called by the allocator hooks for every allocation request.
+void RecordHeapAllocation();
+
+} // namespace diag
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include "motion/MotorManager.hpp"
+
+namespace diag
+{
+
+// Static RAM ceilings for the control path. Objects assert against these at
+// compile time, so growing one is a deliberate edit here rather than a
+// silent side effect. Per-channel terms keep wide builds proportional.
+// The event queue holds two MotionEvents per channel; command slots and
+// homing plans carry a sequence tag each, and command slots keep the PIO
+// rate timing of their plan.
+// Fixed regardless of channel count: the profile cache holds eight plans.
+inline constexpr std::size_t kProfileCacheBudgetBytes = 352;
+inline constexpr std::size_t kMotorManagerBudgetBytes = 128 + (124 * motion::kChannelCount) +
+                                                        (2 * sizeof(motion::MotionEvent) * motion::kChannelCount) +
+                                                        kProfileCacheBudgetBytes;
+inline constexpr std::size_t kCommandProcessorBudgetBytes = kMotorManagerBudgetBytes + 128 + (24 * motion::kChannelCount);
+inline constexpr std::size_t kResponseBudgetBytes = 512 + (256 * motion::kChannelCount);
+// Fixed regardless of channel count: the trace ring keeps the last 128 records.
+inline constexpr std::size_t kTraceRingBudgetBytes = 1024;
+
+} // namespace diag
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace diag
+{
+
+// Deck state a replay has to start from; captured at REC:START.
+struct RecordedChannel
+{
+  int32_t position = 0;
+  int32_t zeroOffset = 0;
+  int32_t negativeLimit = 0;
+  int32_t positiveLimit = 0;
+  bool homed = false;
+};
+
+// Compact binary log of command lines with their arrival times, for native
+// replay (lib/session_replay). Layout, little-endian:
+//
+//   header   u8 version, u8 channelCount, u16 channelBytes (16)
+//   channel  i32 position, i32 zeroOffset, i32 negativeLimit, i32 positiveLimit
+//   homed    ceil(channelCount / 8) bytes, bit n = channel n
+//   line     varint deltaUs, varint length, length bytes        (repeated)
+//
+// deltaUs is service() time since the previous line (or REC:START). When the
+// buffer fills, recording stops and the log stays a valid prefix.
+class SessionRecorder
+{
+public:
+  static constexpr std::size_t kCapacity = 1024;
+  static constexpr uint8_t kVersion = 1;
+  static constexpr std::size_t kChannelBytes = 16;
+
+  // Fills in channel `index` of the prologue.
+  using ChannelSource = RecordedChannel (*)(const void *context, std::size_t index);
+
+  bool start(uint64_t nowUs, std::size_t channelCount, ChannelSource source, const void *context);
+  void stop() { active_ = false; }
+  bool recordLine(uint64_t nowUs, std::string_view line);
+
+  bool active() const { return active_; }
+  bool overflowed() const { return overflowed_; }
+  uint32_t lineCount() const { return lineCount_; }
+  std::size_t size() const { return length_; }
+  const uint8_t *data() const { return buffer_.data(); }
+
+private:
+  bool put(const void *bytes, std::size_t length);
+  bool putVarint(uint64_t value);
+
+  std::array<uint8_t, kCapacity> buffer_{};
+  std::size_t length_ = 0;
+  uint64_t lastUs_ = 0;
+  uint32_t lineCount_ = 0;
+  bool active_ = false;
+  bool overflowed_ = false;
+};
+
+} // namespace diag
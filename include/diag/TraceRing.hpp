@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace diag
+{
+
+// Hot-path events, recorded as they happen without formatting anything.
+enum class TraceKind : uint8_t
+{
+  None = 0,
+  CommandAccepted, // channel: verb index | kTraceTagged, value: tag sequence
+  SlotLatched,     // value: step count handed to the driver (saturated)
+  SlotRetired,     // value: driver's retired count, low 16 bits (word IRQ)
+  PhaseChange,     // value: MotionPhase | asleep << 8
+  SleepLatch,      // value: SLEEP register bits for channels 0-15, 1 = awake
+  Overrun,         // channel: TraceOverrun source, value: source detail
+  Count
+};
+
+// For Overrun records, carried in the channel byte.
+enum class TraceOverrun : uint8_t
+{
+  EventQueue = 0, // value: channel whose event was dropped
+  InputLine,      // value: 0; the line went out as ERR_PAYLOAD_TOO_LONG
+  LoopStall       // value: microseconds between loop passes (saturated)
+};
+
+inline constexpr uint8_t kTraceNoChannel = 0xFF;
+inline constexpr uint8_t kTraceTagged = 0x80;
+
+// Little-endian on the wire, eight bytes per record.
+struct TraceRecord
+{
+  uint32_t micros = 0;
+  TraceKind kind = TraceKind::None;
+  uint8_t channel = 0;
+  uint16_t value = 0;
+};
+
+static_assert(sizeof(TraceRecord) == 8, "TraceRecord is dumped as eight bytes");
+
+inline constexpr std::size_t kTraceCapacity = 128;
+static_assert((kTraceCapacity & (kTraceCapacity - 1U)) == 0, "kTraceCapacity must be a power of two");
+
+// Safe from the word IRQ and the main loop: a record reserves its slot with
+// one masked increment on the RP2040 (the M0+ has no exclusive loads) or an
+// atomic add elsewhere, then fills it. Timestamps are micros(), a single
+// timer register read on the target. Once full the oldest records are
+// overwritten; writers never wait.
+void Trace(TraceKind kind, uint8_t channel, uint16_t value);
+void SetTraceEnabled(bool enabled);
+bool TraceEnabled();
+
+// Sequence number of the next record; the ring holds the last
+// kTraceCapacity of the records before it.
+uint32_t TraceHead();
+uint32_t TraceMicros();
+// Copies record `sequence`; false if it has not been written yet or was
+// overwritten before (or while) it was read.
+bool ReadTrace(uint32_t sequence, TraceRecord &out);
+void EncodeTraceRecord(const TraceRecord &record, uint8_t *out);
+TraceRecord DecodeTraceRecord(const uint8_t *in);
+const char *TraceKindLabel(TraceKind kind);
+void ResetTrace();
+
+} // namespace diag
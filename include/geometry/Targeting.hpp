@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Integer-only targeting geometry shared by the firmware and host tools.
+//
+// Frame: the mirror panel lies in the z = 0 plane, the wall is the plane
+// z = distance in front of it, x runs right and y up (millimetres). Angles are
+// binary angles (BAM32): a full turn is 2^32, so int32_t covers +/- half a turn
+// and wraps naturally.
+namespace geometry
+{
+
+using BinaryAngle = int32_t;
+
+constexpr int64_t kAngleUnitsPerTurn = int64_t{1} << 32;
+constexpr int32_t kUnitQ14 = 1 << 14;
+// Keeps every squared-length sum inside uint32_t.
+constexpr int32_t kMaxCoordinateMm = 30000;
+// 200-step motor at 1/32 microstepping.
+constexpr int32_t kDefaultStepsPerTurn = 6400;
+
+struct Vector3Q14
+{
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t z = 0;
+};
+
+struct WallTarget
+{
+  int32_t xMm = 0;
+  int32_t yMm = 0;
+  int32_t distanceMm = 0;
+};
+
+// Mounting of one two-axis mirror. Zero steps on an axis means the mirror
+// normal points straight at the wall (+z). `incoming` is the unit travel
+// direction of the light arriving at the mirror (Q14).
+struct MirrorPose
+{
+  int32_t xMm = 0;
+  int32_t yMm = 0;
+  Vector3Q14 incoming{0, 0, -kUnitQ14};
+  int32_t stepsPerTurn = kDefaultStepsPerTurn;
+  int32_t yawZeroSteps = 0;
+  int32_t pitchZeroSteps = 0;
+  uint8_t yawChannel = 0;
+  uint8_t pitchChannel = 1;
+};
+
+struct StepLimits
+{
+  int32_t negative = 0;
+  int32_t positive = 0;
+};
+
+enum class TargetStatus : uint8_t
+{
+  Reachable = 0,
+  YawOutOfRange,
+  PitchOutOfRange,
+  InvalidTarget
+};
+
+struct AxisTargets
+{
+  BinaryAngle yawAngle = 0;
+  BinaryAngle pitchAngle = 0;
+  int32_t yawSteps = 0;
+  int32_t pitchSteps = 0;
+  TargetStatus status = TargetStatus::InvalidTarget;
+};
+
+// CORDIC vectoring-mode atan2; error below 1e-6 of a turn.
+BinaryAngle Atan2(int32_t y, int32_t x);
+uint32_t ISqrt(uint32_t value);
+
+int32_t StepsFromAngle(BinaryAngle angle, int32_t stepsPerTurn);
+double DegreesFromAngle(BinaryAngle angle);
+
+// Mirror yaw/pitch that reflects the pose's incoming light onto the target,
+// converted to absolute step targets and checked against the axis limits.
+AxisTargets SolveMirror(const MirrorPose &pose, const WallTarget &target, const StepLimits &limits);
+AxisTargets SolveMirror(const MirrorPose &pose,
+                        const WallTarget &target,
+                        const StepLimits &yawLimits,
+                        const StepLimits &pitchLimits);
+
+// Default 2-column grid for a panel of `mirrorIndex` two-axis mirrors wired
+// as channel pairs (yaw = 2n, pitch = 2n + 1).
+MirrorPose DefaultMirrorPose(std::size_t mirrorIndex);
+
+const char *TargetStatusLabel(TargetStatus status);
+
+} // namespace geometry
@@ -4,14 +4,26 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "motion/ProfileCache.hpp"
+
+// Channel count is a build-time property of the board; larger panels override
+// it with -DMOTION_CHANNEL_COUNT=<n> alongside a matching board pin map.
+#ifndef MOTION_CHANNEL_COUNT
+#define MOTION_CHANNEL_COUNT 8
+#endif
+
 namespace motion
 {
 
 namespace pio
 {
 struct CommandBuffer;
+struct StepperCommand;
 }
 
+inline constexpr std::size_t kChannelCount = MOTION_CHANNEL_COUNT;
+static_assert(kChannelCount > 0, "At least one motor channel is required");
+
 enum class MotionPhase : uint8_t
 {
   Idle = 0,
@@ -35,33 +47,62 @@ enum class MoveResult : uint8_t
   Fault
 };
 
-struct TimingEstimate
+// Sequence number the host put on the command that started a move or homing
+// run; the events it causes carry it back.
+struct CommandTag
+{
+  uint16_t sequence = 0;
+  bool valid = false;
+};
+
+enum class MotionEventKind : uint8_t
+{
+  Done = 0,
+  Homed,
+  Fault
+};
+
+// A state transition the host asked to be told about: a move arriving, a
+// homing run finishing, a fault.
+struct MotionEvent
 {
-  uint32_t totalSteps = 0;
-  uint32_t accelSteps = 0;
-  uint32_t cruiseSteps = 0;
-  uint32_t totalDurationUs = 0;
+  int32_t position = 0;
+  CommandTag tag{};
+  uint16_t channel = 0;
+  MotionEventKind kind = MotionEventKind::Done;
+  FaultCode fault = FaultCode::None;
 };
 
+static_assert(sizeof(MotionEvent) == 12, "MotionEvent layout changed");
+
 struct HomingRequest
 {
-  long travelRange = 0;
-  long backoff = 0;
+  int32_t travelRange = 0;
+  int32_t backoff = 0;
+  // Longest any single homing stage may drive the motor; 0 picks the
+  // manager default. A stage that would run longer stops at the deadline and
+  // faults the channel with HomingTimeout, as does a fed-back stage whose
+  // steps are still unconfirmed when the deadline passes.
+  uint32_t stageTimeoutUs = 0;
 };
 
+// Host-visible channel snapshot. Wide fields lead and byte fields trail so
+// the record carries no interior padding.
 struct MotorState
 {
-  long position = 0;
-  long targetPosition = 0;
+  int32_t position = 0;
+  int32_t targetPosition = 0;
   int32_t speedHz = 0;
   int32_t acceleration = 0;
+  uint32_t plannedDurationUs = 0;
   MotionPhase phase = MotionPhase::Idle;
-  bool asleep = true;
   FaultCode fault = FaultCode::None;
+  bool asleep = true;
   bool limitClipped = false;
-  uint32_t plannedDurationUs = 0;
 };
 
+static_assert(sizeof(MotorState) == 24, "MotorState must stay padding-free");
+
 struct ShiftRegisterPins
 {
   uint8_t data = 0;
@@ -69,76 +110,210 @@ struct ShiftRegisterPins
   uint8_t latch = 0;
 };
 
-class MotorManager
+template <std::size_t ChannelCount>
+class BasicMotorManager
 {
 public:
-  static constexpr std::size_t kMotorCount = 8;
-  static constexpr long kDefaultLimit = 1200;
-  static constexpr long kDefaultTravelRange = kDefaultLimit * 2;
-  static constexpr long kDefaultBackoff = 50;
+  static constexpr std::size_t kMotorCount = ChannelCount;
+  static constexpr int32_t kDefaultLimit = 1200;
+  static constexpr int32_t kDefaultTravelRange = kDefaultLimit * 2;
+  static constexpr int32_t kDefaultBackoff = 50;
   static constexpr int32_t kDefaultSpeedHz = 4000;
   static constexpr int32_t kDefaultAcceleration = 16000;
-
-  MotorManager();
+  static constexpr uint32_t kDefaultHomingStageTimeoutUs = 5'000'000U;
+  // Re-approach runs at cruise speed / kHomingSlowDivisor.
+  static constexpr int32_t kHomingSlowDivisor = 4;
+  // Channels allowed to home at once when a group does not say otherwise:
+  // all of them, so homing the array takes as long as its slowest channel.
+  static constexpr std::size_t kDefaultHomingConcurrency = ChannelCount;
+  // Bytes service() touches per moving channel per tick.
+  static constexpr std::size_t kHotBytesPerChannel = 16;
+  // Room for a DONE or HOMED and a FAULT from every channel between two
+  // collections.
+  static constexpr std::size_t kEventQueueCapacity = 2 * ChannelCount;
+
+  // Bit n of word n / 32 selects channel n.
+  using ChannelMask = std::array<uint32_t, (ChannelCount + 31U) / 32U>;
+
+  BasicMotorManager();
 
   void reset();
 
   MoveResult queueMove(std::size_t channel,
-                       long targetPosition,
+                       int32_t targetPosition,
                        int32_t speedHz,
                        int32_t acceleration,
                        TimingEstimate &timing);
+  // What queueMove would return for the channel's state alone: Scheduled
+  // when it would accept a move, Busy or Fault when it would refuse one.
+  // Lets a caller check every channel of a coordinated move first.
+  MoveResult moveReadiness(std::size_t channel) const;
 
+  // Stages: fast approach over the travel range, backoff, slow re-approach
+  // over twice the backoff, then centre at limit + range / 2 and zero there.
   MoveResult beginHoming(std::size_t channel, const HomingRequest &request);
+  // Homes every channel in `channels`, at most `maxConcurrent` at a time; the
+  // rest wait in HOMING and start as running channels finish. Returns Busy
+  // or Fault without touching any channel if any selected one would refuse.
+  MoveResult beginHomingGroup(const ChannelMask &channels, const HomingRequest &request, std::size_t maxConcurrent);
 
   void service(uint32_t elapsedMicros);
 
   void forceSleep(std::size_t channel);
   void forceWake(std::size_t channel);
 
+  // What queueMoveGroup did with each selected channel. `scheduled` includes
+  // the channels also in `clipped`.
+  struct GroupMoveResult
+  {
+    ChannelMask scheduled{};
+    ChannelMask clipped{};
+    ChannelMask busy{};
+    ChannelMask fault{};
+    uint32_t longestDurationUs = 0;
+  };
+
+  // Batched forms for several channels at once. Each channel is handled as
+  // the single-channel call would handle it, but the SLEEP lines they change
+  // go out in one shift-register latch at the end.
+  void queueMoveGroup(const ChannelMask &channels,
+                      int32_t targetPosition,
+                      int32_t speedHz,
+                      int32_t acceleration,
+                      GroupMoveResult &result);
+  void forceSleepGroup(const ChannelMask &channels);
+  void forceWakeGroup(const ChannelMask &channels);
+
   void injectFault(std::size_t channel, FaultCode fault);
   void clearFault(std::size_t channel);
 
   const MotorState &state(std::size_t channel) const;
 
+  int32_t positiveLimit(std::size_t channel) const { return positiveLimits_[channel]; }
+  int32_t negativeLimit(std::size_t channel) const { return negativeLimits_[channel]; }
+  int32_t zeroOffset(std::size_t channel) const { return zeroOffsets_[channel]; }
+  // Homing, or a restored clean-shutdown journal, establishes the position.
+  bool isHomed(std::size_t channel) const { return (homedMask_[channel / 32U] >> (channel % 32U)) & 1U; }
+
+  // Per-channel travel window and the offset from the homed centre to
+  // logical zero. Returns false for an inverted window or a busy channel.
+  bool setCalibration(std::size_t channel, int32_t zeroOffset, int32_t negativeLimit, int32_t positiveLimit);
+  // Adopts a journalled position without homing; the channel must be idle.
+  // `homed` false keeps the channel marked as needing a HOME (session replay).
+  bool restorePosition(std::size_t channel, int32_t position, bool homed = true);
+
+  // Channels whose MotorState may have changed since their last clearDirty().
+  // service() marks every channel it advances; callers that publish state
+  // (SUB streaming) format only these.
+  const ChannelMask &dirtyChannels() const { return dirtyMask_; }
+  void markDirty(std::size_t channel);
+  void clearDirty(std::size_t channel);
+
   static TimingEstimate ComputeTiming(uint32_t steps, int32_t speedHz, int32_t acceleration);
 
+  // Plans for (steps, speed, accel) seen recently; cleared by reset().
+  const ProfileCache &profileCache() const { return profileCache_; }
+  void clearProfileCache() { profileCache_.clear(); }
+
   void markCommandExecuted(std::size_t channel);
 
   void configureShiftRegister(const ShiftRegisterPins &pins);
 
   void exportCommandBuffer(std::size_t channel, pio::CommandBuffer &out) const;
 
+  // Hands out the newest latched slot once so the PIO driver can push it.
+  // On a fed-back channel the queued slot goes out while the active one
+  // runs, so the driver can start it the moment the first one ends.
+  bool takePendingCommand(std::size_t channel, pio::StepperCommand &out);
+
+  // Channels whose position comes from the PIO rather than from elapsed
+  // time. For these, service() leaves dispatched slots alone and
+  // reconcileExecuted() completes one slot per command the driver retired,
+  // then moves the position by the confirmed steps of the one running; a
+  // slot completes when its last step is out, however long that takes. A
+  // MOVE arriving mid-slot queues behind it in the second slot and starts
+  // from its end.
+  void setExecutionFeedback(std::size_t channel, bool enabled);
+  void reconcileExecuted(std::size_t channel, uint32_t retiredCommands, uint32_t executedSteps);
+  // forceSleep() or a fault cancelled a dispatched slot: the caller aborts
+  // the PIO commands and passes their final progress to reconcileExecuted().
+  bool cancelPending(std::size_t channel) const { return testBit(cancelMask_, channel); }
+
+  // Unsolicited events, off for every channel after reset. Transitions on
+  // enabled channels queue a MotionEvent; when the queue is full the newest
+  // is dropped and counted, so the host knows to re-read STATUS.
+  void setEventsEnabled(std::size_t channel, bool enabled);
+  const ChannelMask &eventChannels() const { return eventMask_; }
+  bool popEvent(MotionEvent &out);
+  // Events dropped since the last call.
+  uint32_t takeDroppedEvents();
+  // Stamped on every slot and homing run started until the next call, and
+  // copied into the events they produce.
+  void setCommandTag(const CommandTag &tag) { commandTag_ = tag; }
+
 private:
+  static constexpr std::size_t kMaskWords = (ChannelCount + 31U) / 32U;
+  static constexpr uint8_t kHomingStageCount = 4;
+  // HomingPlan::group of a channel homed on its own; never queued.
+  static constexpr uint16_t kUngrouped = UINT16_MAX;
+  static_assert(ChannelCount < kUngrouped, "homing group ids are 16-bit");
+
   struct CommandSlot
   {
-    bool occupied = false;
-    TimingEstimate timing{};
     uint32_t stepCount = 0;
-    uint32_t halfPeriodMicros = 0;
+    // Exact rate; the PIO timing is derived from it in ticks, not rounded
+    // through microseconds.
+    uint32_t stepRateHz = 0;
+    // PIO timing for stepRateHz, kept from the plan that filled the slot so
+    // handing it to the driver needs no second lookup.
+    StepRateTiming rate{};
+    CommandTag tag{};
+    bool occupied = false;
+    bool dispatched = false;
     bool directionHigh = true;
   };
 
-  struct ActivePlan
+  // Everything service() reads or writes per tick, one dense array per field
+  // so the tick loop streams through memory and skips idle channels via the
+  // active mask.
+  struct HotPlans
   {
+    std::array<uint32_t, ChannelCount> elapsedUs{};
+    std::array<uint32_t, ChannelCount> durationUs{};
+    std::array<int32_t, ChannelCount> startPosition{};
+    std::array<int32_t, ChannelCount> travel{};
+    std::array<uint32_t, kMaskWords> activeMask{};
+  };
+
+  // Homing bookkeeping, only consulted when a homing stage completes.
+  struct HomingPlan
+  {
+    int32_t range = 0;
+    int32_t backoff = 0;
+    int32_t limitPosition = 0;
+    uint32_t stageTimeoutUs = 0;
+    CommandTag tag{};
+    uint8_t stage = 0;
     bool active = false;
-    bool homingPhase = false;
-    uint8_t homingStep = 0;
+    bool queued = false;
     bool limitRecorded = false;
-    bool backoffRecorded = false;
-    uint32_t elapsedUs = 0;
-    long startPosition = 0;
-    long targetPosition = 0;
-    long homingRange = 0;
-    long homingBackoff = 0;
-    long homingLimitPosition = 0;
-    long homingBackoffPosition = 0;
-    TimingEstimate timing{};
+    bool timedOut = false;
+    // Index into homingGroupLimits_, or kUngrouped.
+    uint16_t group = kUngrouped;
   };
 
+  static_assert(sizeof(HotPlans) == (kHotBytesPerChannel * ChannelCount) + (sizeof(uint32_t) * kMaskWords),
+                "HotPlans must hold exactly the per-tick fields");
+  static_assert(sizeof(CommandSlot) == 24, "CommandSlot layout changed");
+  static_assert(sizeof(HomingPlan) == 28, "HomingPlan layout changed");
+
+  // Daisy-chained SN74HC595s, one register per eight channels. Bit n of
+  // register r drives the SLEEP line of channel (r * 8 + n); high means awake.
   class SleepRegister
   {
   public:
+    static constexpr std::size_t kRegisterCount = (ChannelCount + 7U) / 8U;
+
     SleepRegister() = default;
 
     void configure(const ShiftRegisterPins &pins);
@@ -148,27 +323,81 @@ private:
   private:
     bool configured_ = false;
     ShiftRegisterPins pins_{};
-    std::array<bool, MotorManager::kMotorCount> states_{};
+    std::array<uint8_t, kRegisterCount> awakeBits_{};
   };
 
   MoveResult commitMove(std::size_t channel,
-                        long clampedTarget,
+                        int32_t clampedTarget,
                         int32_t speedHz,
                         int32_t acceleration,
                         uint32_t steps,
-                        TimingEstimate &timing,
+                        const MotionProfile &profile,
                         bool clipped);
 
-  void configureHomingStage(std::size_t channel, ActivePlan &plan);
+  static pio::StepperCommand ToStepperCommand(const CommandSlot &slot);
+  // ComputeTiming and the slot's PIO rate timing, from profileCache_ when
+  // the same move was planned recently.
+  const MotionProfile &planProfile(uint32_t steps, int32_t speedHz, int32_t acceleration);
+
+  static bool testBit(const ChannelMask &mask, std::size_t channel)
+  {
+    return (mask[channel / 32U] >> (channel % 32U)) & 1U;
+  }
+  static void assignBit(ChannelMask &mask, std::size_t channel, bool value);
+
+  bool isActive(std::size_t channel) const;
+  bool slotRunning(std::size_t channel) const;
+  void cancelRunningSlot(std::size_t channel);
+  void activatePlan(std::size_t channel, int32_t startPosition, int32_t targetPosition, uint32_t durationUs);
+  void deactivatePlan(std::size_t channel);
+  void completePlan(std::size_t channel);
+
+  // What beginHoming would return for the channel, without touching it.
+  MoveResult homingReadiness(std::size_t channel, const HomingRequest &request) const;
+  // Queues the channel under `group` to start as its limit allows, or with
+  // kUngrouped leaves it for the caller to start.
+  void prepareHoming(std::size_t channel, const HomingRequest &request, uint16_t group);
+  void startHoming(std::size_t channel);
+  void finishHoming(std::size_t channel, FaultCode fault);
+  void startQueuedHoming();
+  void configureHomingStage(std::size_t channel);
+  void setPhase(std::size_t channel, MotionPhase phase, bool asleep);
   void updateAutosleep(std::size_t channel);
+  // Between these, updateAutosleep() only stages SLEEP bits; release
+  // latches them once if any changed.
+  void holdLatch() { latchHeld_ = true; }
+  void releaseLatch();
+  void pushEvent(std::size_t channel, MotionEventKind kind, const CommandTag &tag, FaultCode fault = FaultCode::None);
 
+  HotPlans hot_{};
   std::array<MotorState, kMotorCount> motors_{};
   std::array<std::array<CommandSlot, 2>, kMotorCount> commandSlots_{};
   std::array<uint8_t, kMotorCount> activeSlot_{};
-  std::array<ActivePlan, kMotorCount> plans_{};
+  std::array<HomingPlan, kMotorCount> homing_{};
   SleepRegister sleepRegister_{};
-  long positiveLimit_ = kDefaultLimit;
-  long negativeLimit_ = -kDefaultLimit;
+  std::array<int32_t, kMotorCount> positiveLimits_{};
+  std::array<int32_t, kMotorCount> negativeLimits_{};
+  std::array<int32_t, kMotorCount> zeroOffsets_{};
+  ChannelMask homedMask_{};
+  ChannelMask dirtyMask_{};
+  ChannelMask feedbackMask_{};
+  ChannelMask cancelMask_{};
+  ChannelMask eventMask_{};
+  // Faults whose event waits for an aborted PIO count.
+  ChannelMask faultEventMask_{};
+  std::array<MotionEvent, kEventQueueCapacity> events_{};
+  uint16_t eventHead_ = 0;
+  uint16_t eventCount_ = 0;
+  uint32_t droppedEvents_ = 0;
+  CommandTag commandTag_{};
+  ProfileCache profileCache_{};
+  bool latchHeld_ = false;
+  bool latchPending_ = false;
+  // Concurrency limit per homing group, indexed by HomingPlan::group. There
+  // are never more live groups than channels.
+  std::array<uint16_t, kMotorCount> homingGroupLimits_{};
 };
 
+using MotorManager = BasicMotorManager<kChannelCount>;
+
 } // namespace motion
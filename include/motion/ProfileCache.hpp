@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace motion
+{
+
+struct TimingEstimate
+{
+  uint32_t totalSteps = 0;
+  uint32_t accelSteps = 0;
+  uint32_t cruiseSteps = 0;
+  uint32_t totalDurationUs = 0;
+};
+
+static_assert(sizeof(TimingEstimate) == 16, "TimingEstimate layout changed");
+
+// step_dir timing for one step rate, as pio::StepTimingForRate derives it;
+// kept apart from pio::StepperCommand so this header stays free of the SDK.
+struct StepRateTiming
+{
+  uint32_t delayTicks = 0;
+  uint16_t clockDivider = 1;
+  uint16_t delayFraction = 0;
+};
+
+// Everything planning a move works out from (steps, speed, accel).
+struct MotionProfile
+{
+  TimingEstimate timing{};
+  StepRateTiming rate{};
+};
+
+// Cues shuttle mirrors between a handful of positions at the same speed and
+// acceleration, so the same plans come up again and again. A hit replaces
+// ComputeTiming's soft-float square root and divisions and the 64-bit
+// divisions of the rate timing with a scan of kCapacity keys. Full, the
+// least recently used entry is replaced.
+class ProfileCache
+{
+public:
+  static constexpr std::size_t kCapacity = 8;
+
+  struct Stats
+  {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+    uint32_t entries = 0;
+  };
+
+  // Counts a hit or a miss; nullptr on a miss.
+  const MotionProfile *find(uint32_t steps, int32_t speedHz, int32_t acceleration);
+  const MotionProfile &insert(uint32_t steps, int32_t speedHz, int32_t acceleration, const MotionProfile &profile);
+  void clear();
+  Stats stats() const { return stats_; }
+
+private:
+  struct Entry
+  {
+    uint32_t steps = 0;
+    int32_t speedHz = 0;
+    int32_t acceleration = 0;
+    uint32_t lastUse = 0;
+    MotionProfile profile{};
+  };
+
+  std::array<Entry, kCapacity> entries_{};
+  uint32_t useClock_ = 0;
+  Stats stats_{};
+};
+
+} // namespace motion
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "motion/StepGroupProgram.hpp"
+#include "motion/StepperPioDriver.hpp"
+
+namespace motion::pio
+{
+
+// Pins of one step_group: DIR of axis i on base + i, STEP on base + axisCount + i.
+struct StepGroupPins
+{
+  uint8_t base = 0;
+  uint8_t axisCount = 0;
+};
+
+// Alternative to StepperPioDriver for boards that wire coordinated axes to
+// consecutive pins: one state machine and one DMA channel per group of up to
+// kMaxGroupAxes axes, so a PIO block carries 16 channels and every axis in a
+// group steps on the same PIO cycle. The DMA channel streams interpolator
+// words from two ping-pong buffers; service() restarts it on the filled
+// buffer and refills the drained one, and the joined 8-word TX FIFO covers
+// the gap between the two.
+class StepGroupDriver
+{
+public:
+  static constexpr std::size_t kMaxGroups = kMaxStepDirChannels;
+  static constexpr std::size_t kBufferWords = 32;
+
+  // Claims state machines wherever they are free, PIO0 first, so it can
+  // share blocks with StepperPioDriver. Returns false if any group misses out.
+  bool begin(const StepGroupPins *groups, std::size_t groupCount);
+
+  // Starts a coordinated relative move; periodTicks is the step period of the
+  // longest axis in kStepGroupTickHz ticks. False while the group is busy.
+  bool move(std::size_t group, const int32_t *deltas, std::size_t axisCount, uint32_t periodTicks);
+  // True until the last word of the move is inside the state machine.
+  bool busy(std::size_t group) const;
+  void service();
+
+  std::size_t groupCount() const { return groupCount_; }
+
+private:
+  struct Group
+  {
+    StepInterpolator interpolator{};
+    std::array<std::array<uint32_t, kBufferWords>, 2> buffers{};
+    std::array<std::size_t, 2> lengths{};
+    uint8_t streaming = 0;
+    int8_t dmaChannel = -1;
+    uint8_t block = 0;
+    uint8_t index = 0;
+    uint8_t axisCount = 0;
+  };
+
+  void startBuffer(Group &group, uint8_t buffer);
+
+  std::array<Group, kMaxGroups> groups_{};
+  std::size_t groupCount_ = 0;
+  std::array<int8_t, kPioBlockCount> programOffsets_{-1, -1};
+};
+
+} // namespace motion::pio
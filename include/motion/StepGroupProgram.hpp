@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "motion/StepperPioProgram.hpp"
+
+namespace motion::pio
+{
+
+// step_group drives up to kMaxGroupAxes STEP/DIR pairs from one state
+// machine. The pins of a group are consecutive: DIR 0..N-1 from the base,
+// then STEP 0..N-1.
+constexpr std::size_t kMaxGroupAxes = 4;
+
+// Unlike step_dir, step_group keeps one clock: every axis of a group shares
+// the state machine, so the divider cannot follow any single axis's rate.
+constexpr uint16_t kStepGroupClockDivider = 32;
+constexpr uint32_t kStepGroupTickHz = kDefaultPioClockHz / kStepGroupClockDivider;
+
+// One step_group word per interpolator tick, least significant field first:
+//   bits 0-7    pin image with this tick's STEP bits high
+//   bits 8-15   pin image with every STEP low (DIR for the next tick)
+//   bits 16-31  dwell D
+// A word lasts D + 11 ticks at kStepGroupTickHz; STEP stays high for 8 (2 us).
+constexpr uint32_t kGroupWordOverheadTicks = 11;
+constexpr uint32_t kMaxGroupDwell = 0xFFFFU;
+// D >= 5 keeps STEP low for 2 us between ticks as well.
+constexpr uint32_t kMinGroupWordTicks = 16;
+constexpr uint32_t kMaxGroupWordTicks = kMaxGroupDwell + kGroupWordOverheadTicks;
+
+const pio_program &StepGroupProgram();
+std::string_view StepGroupProgramSource();
+uint32_t PackGroupWord(std::size_t axisCount, uint8_t stepMask, uint8_t dirMask, uint32_t ticks);
+
+// Bresenham over a group's axes. The longest axis steps on every tick and
+// the others on the ticks where their error term wraps, so all axes start
+// and finish together and each emits exactly |delta| pulses. Ticks longer
+// than one word are padded with step-free words.
+class StepInterpolator
+{
+public:
+  // periodTicks is the time between ticks of the longest axis.
+  void start(const int32_t *deltas, std::size_t axisCount, uint32_t periodTicks);
+  // Writes up to `capacity` words and returns how many it wrote.
+  std::size_t fill(uint32_t *words, std::size_t capacity);
+  bool done() const { return !directionPending_ && idleWordsPending_ == 0 && tick_ >= majorSteps_; }
+
+  uint32_t majorSteps() const { return majorSteps_; }
+
+private:
+  std::array<uint32_t, kMaxGroupAxes> counts_{};
+  std::array<uint32_t, kMaxGroupAxes> errors_{};
+  std::size_t axisCount_ = 0;
+  uint8_t dirMask_ = 0;
+  bool directionPending_ = false;
+  uint32_t majorSteps_ = 0;
+  uint32_t tick_ = 0;
+  uint32_t wordsPerTick_ = 1;
+  uint32_t firstWordTicks_ = 0;
+  uint32_t idleWordTicks_ = 0;
+  uint32_t idleWordsPending_ = 0;
+};
+
+} // namespace motion::pio
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "motion/StepperPioProgram.hpp"
+
+namespace motion::pio
+{
+
+constexpr std::size_t kPioBlockCount = 2;
+constexpr std::size_t kStateMachinesPerBlock = 4;
+constexpr std::size_t kMaxStepDirChannels = kPioBlockCount * kStateMachinesPerBlock;
+
+struct StateMachineSlot
+{
+  uint8_t block = 0;
+  uint8_t index = 0;
+};
+
+// Channels fill PIO0 first and spill into PIO1, so channel n always lands on
+// the same state machine regardless of how many channels a board enables.
+constexpr StateMachineSlot StateMachineForChannel(std::size_t channel)
+{
+  return StateMachineSlot{static_cast<uint8_t>(channel / kStateMachinesPerBlock),
+                          static_cast<uint8_t>(channel % kStateMachinesPerBlock)};
+}
+
+// Words a channel can have between its TX FIFO and an unread completion
+// token: four queued, one running, four tokens in the RX FIFO.
+constexpr std::size_t kInFlightWordCapacity = 16;
+
+// What a channel's state machine has done since the last takeProgress():
+// commands whose last step is confirmed, and confirmed steps of the one now
+// running.
+struct StepProgress
+{
+  uint32_t retired = 0;
+  uint32_t executed = 0;
+};
+
+// Owns the step_dir program instances and one state machine per channel.
+// Channels beyond kMaxStepDirChannels have no state machine of their own.
+//
+// Each channel holds a running command and one queued behind it. The word
+// completion IRQ retires the running command, promotes the queued one and
+// tops the TX FIFO up from the handler, so back-to-back commands leave no
+// gap between their steps whatever the main loop is doing. Main-thread calls
+// mask interrupts while they touch channel state.
+class StepperPioDriver
+{
+public:
+  bool begin(const uint8_t *stepPins, const uint8_t *dirPins, std::size_t channelCount);
+
+  // True while the channel can take another command behind the running one.
+  bool ready(std::size_t channel) const;
+  // Starts the command, or queues it behind the running one. Counts above
+  // one word's worth, and commands whose delay fraction is diffused, go out
+  // as several words as the FIFO drains; a queued command's words follow the
+  // running command's into the FIFO. A command at a new clock divider waits
+  // until the state machine has finished the previous one.
+  bool submit(std::size_t channel, const StepperCommand &command);
+  // Collects completion tokens, then tops up every TX FIFO. The IRQ does the
+  // same per word; this catches divider changes the handler had to defer.
+  void service();
+
+  // Confirmed steps of the running command, and steps not yet confirmed of
+  // it and of the queued one.
+  uint32_t executedSteps(std::size_t channel) const;
+  uint32_t remainingSteps(std::size_t channel) const;
+  // Hands over and clears the retired count along with the running
+  // command's confirmed steps.
+  StepProgress takeProgress(std::size_t channel);
+  // Stops the channel mid-command and drops the queued one. The progress
+  // includes the exact steps of the interrupted word.
+  StepProgress abort(std::size_t channel);
+
+  // Body of the PIO0/PIO1 IRQ0 handlers: clears each raised word flag and
+  // drains and refills that channel.
+  void handleIrq(uint8_t block);
+
+  std::size_t channelCount() const { return channelCount_; }
+
+private:
+  struct InFlightWords
+  {
+    std::array<uint16_t, kInFlightWordCapacity> steps{};
+    uint8_t head = 0;
+    uint8_t size = 0;
+  };
+
+  struct ChannelState
+  {
+    // Steps not yet in the FIFO, of the running command or, once its last
+    // word is in, of the queued one.
+    StepperCommand unfed{};
+    // Queued command before its first word goes in.
+    StepperCommand next{};
+    uint32_t currentSteps = 0;
+    uint32_t executed = 0;
+    uint32_t nextSteps = 0;
+    uint32_t retired = 0;
+    // Diffused delay error in 1/65536 ticks per step, carried between words.
+    int64_t delayError = 0;
+    // Step counts of words pushed but not yet confirmed, oldest first.
+    InFlightWords inFlight{};
+    uint16_t divider = 1;
+    // Commands held: none, running, or running plus queued.
+    uint8_t commands = 0;
+    bool nextFed = false;
+  };
+
+  void drain(std::size_t channel);
+  void feed(std::size_t channel);
+  void retireFinished(std::size_t channel);
+  bool parked(std::size_t channel) const;
+  uint32_t interruptedWordSteps(std::size_t channel);
+
+  std::size_t channelCount_ = 0;
+  std::array<uint8_t, kPioBlockCount> programOffsets_{};
+  std::array<ChannelState, kMaxStepDirChannels> channels_{};
+};
+
+} // namespace motion::pio
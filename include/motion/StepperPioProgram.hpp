@@ -19,16 +19,25 @@
 namespace motion::pio
 {
 
+// One command for step_dir: a run of steps at one rate. The state machine
+// runs at sysclk / clockDivider; delayTicks is the delay mantissa M and
+// delayFraction the ideal mantissa's fractional part in 1/65536, which the
+// driver diffuses across words by alternating M and M + 1.
 struct StepperCommand
 {
   uint32_t stepCount = 0;
   uint32_t delayTicks = 0;
+  uint16_t clockDivider = 1;
+  uint16_t delayFraction = 0;
   bool directionHigh = true;
 };
 
+// words[i] is the first packed FIFO word of slots[i]; slots longer than
+// kMaxStepsPerWord continue in further words (see PackCommandWord).
 struct CommandBuffer
 {
   std::array<StepperCommand, 2> slots{};
+  std::array<uint32_t, 2> words{};
   std::array<bool, 2> occupied{};
 };
 
@@ -45,8 +54,46 @@ struct pio_program
 
 constexpr uint32_t kDefaultPioClockHz = 125'000'000U;
 
+// Packed step_dir word, least significant field first (the OSR shifts right):
+//   bit 0       DIR level
+//   bits 1-15   step count - 1
+//   bits 16-31  delay mantissa M, left in the OSR for the delay reloads
+// Steps come every 2M + 7 state machine ticks.
+constexpr uint32_t kCommandCountShift = 1;
+constexpr uint32_t kCommandDelayShift = 16;
+constexpr uint32_t kMaxStepsPerWord = 1U << (kCommandDelayShift - kCommandCountShift);
+constexpr uint32_t kMaxDelayMantissa = 0xFFFFU;
+constexpr uint32_t kStepOverheadTicks = 7;
+// STEP stays high for M + 3 ticks; DRV8825 needs 1.9 us, so 250 cycles.
+constexpr uint32_t kMinStepHighCycles = 250;
+// Below this many ticks per step, rounding M alone would cost more than
+// 0.01%, so the fraction is diffused over words of kDiffusionRunSteps.
+constexpr uint32_t kDiffusionThresholdTicks = 10'000;
+constexpr uint32_t kDiffusionRunSteps = 64;
+// Each finished word pushes this to the RX FIFO (X after its last jmp x--),
+// so confirmed step counts lag emitted ones by at most one word. Words are
+// cut to kReadbackWindowCycles to bound that lag.
+constexpr uint32_t kWordDoneToken = 0xFFFFFFFFU;
+constexpr uint32_t kReadbackWindowCycles = kDefaultPioClockHz / 1000U;
+// Program counters, relative to the load offset, that tell how far the
+// running word got when X is read back.
+constexpr uint8_t kStepDirPullPc = 0;
+constexpr uint8_t kStepDirStepPc = 3;
+constexpr uint8_t kStepDirDonePc = 10;
+constexpr uint8_t kStepDirIrqPc = 12;
+
 const pio_program &StepDirProgram();
 std::string_view StepDirProgramSource();
-uint32_t DelayTicksFromMicros(uint32_t halfPeriodMicros, uint32_t clockHz = kDefaultPioClockHz);
+// Picks the smallest integer clock divider whose M still fits 16 bits, so
+// slow rates keep a fine tick instead of a coarse loop, then splits the
+// ideal tick count into M and its fraction. Integer dividers only: the
+// fractional divider would add a cycle of jitter to every edge. Rates above
+// what kMinStepHighCycles allows are clamped to that limit.
+StepperCommand StepTimingForRate(uint32_t stepRateHz, uint32_t clockHz = kDefaultPioClockHz);
+// System clock cycles per step for a mantissa at a divider.
+uint64_t StepPeriodCycles(uint32_t delayTicks, uint16_t clockDivider);
+// Packs the first min(stepCount, kMaxStepsPerWord) steps of a command into
+// one FIFO word with mantissa delayTicks. stepCount must be non-zero.
+uint32_t PackCommandWord(const StepperCommand &command);
 
 } // namespace motion::pio
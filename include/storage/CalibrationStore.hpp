@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "motion/MotorManager.hpp"
+#include "storage/FlashLog.hpp"
+
+namespace storage
+{
+
+struct ChannelCalibration
+{
+  int32_t zeroOffset = 0;
+  int32_t negativeLimit = -motion::MotorManager::kDefaultLimit;
+  int32_t positiveLimit = motion::MotorManager::kDefaultLimit;
+};
+
+// Calibration and the clean-shutdown position journal on top of FlashLog.
+//
+// begin() replays the log and then appends a boot marker, which consumes any
+// clean-shutdown snapshot: if power drops before the next recordShutdown(),
+// the following boot sees a dirty journal and the deck must re-home. Motion
+// after recordShutdown() does the same through invalidateShutdown().
+class CalibrationStore
+{
+public:
+  static constexpr std::size_t kChannelCount = motion::kChannelCount;
+  using ChannelMask = motion::MotorManager::ChannelMask;
+
+  struct Journal
+  {
+    bool clean = false;
+    uint32_t bootCount = 0;
+    ChannelMask homed{};
+    std::array<int32_t, kChannelCount> positions{};
+  };
+
+  explicit CalibrationStore(FlashDevice &device);
+
+  bool begin();
+  bool ready() const { return ready_; }
+
+  bool hasCalibration(std::size_t channel) const { return (calibrated_[channel / 32U] >> (channel % 32U)) & 1U; }
+  const ChannelCalibration &calibration(std::size_t channel) const { return calibration_[channel]; }
+  bool saveCalibration(std::size_t channel, const ChannelCalibration &calibration);
+
+  // Call with every channel idle; positions of channels outside `homed` are
+  // not trusted on restore.
+  bool recordShutdown(const std::array<int32_t, kChannelCount> &positions, const ChannelMask &homed);
+  // Call before anything moves: the journalled positions stop being true,
+  // so the first call after recordShutdown() appends a boot marker. Later
+  // calls write nothing. False when the marker could not be written; the
+  // journal then still reads clean and nothing may move.
+  bool invalidateShutdown();
+  bool shutdownClean() const { return current_.clean; }
+
+  // Journal as found at begin(), before this boot's marker.
+  const Journal &lastShutdown() const { return restored_; }
+  uint32_t bootCount() const { return current_.bootCount; }
+  const FlashLog &log() const { return log_; }
+
+private:
+  enum RecordType : uint8_t
+  {
+    kCalibrationRecord = 1,
+    kShutdownRecord = 2,
+    kBootRecord = 3
+  };
+
+  struct CalibrationPayload
+  {
+    uint8_t channel;
+    uint8_t reserved[3];
+    ChannelCalibration calibration;
+  };
+
+  static void Visit(void *context, uint8_t type, const uint8_t *payload, std::size_t length);
+  static void Compact(void *context, FlashLog &log);
+
+  bool writeCalibration(FlashLog &log, std::size_t channel);
+  bool writeShutdown(FlashLog &log);
+  bool writeBoot(FlashLog &log);
+
+  FlashLog log_;
+  std::array<ChannelCalibration, kChannelCount> calibration_{};
+  ChannelMask calibrated_{};
+  Journal restored_{};
+  Journal current_{};
+  // Record encoding lives here, not on the command-path stack.
+  std::array<uint8_t, sizeof(uint32_t) + sizeof(ChannelMask) + (sizeof(int32_t) * kChannelCount)> scratch_{};
+  bool ready_ = false;
+};
+
+} // namespace storage
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storage
+{
+
+// NOR flash as the log sees it: erase sets a whole sector to 0xFF, program
+// can only clear bits. Offsets are relative to the start of the log region.
+class FlashDevice
+{
+public:
+  virtual ~FlashDevice() = default;
+
+  virtual std::size_t sectorSize() const = 0;
+  virtual std::size_t sectorCount() const = 0;
+  virtual void read(std::size_t offset, void *out, std::size_t length) const = 0;
+  virtual bool program(std::size_t offset, const void *data, std::size_t length) = 0;
+  virtual bool erase(std::size_t sector) = 0;
+};
+
+// Append-only record log spread round-robin over every sector of the device,
+// so erases are spread evenly. The newest sector (highest sequence number) is
+// authoritative. When it fills, the next sector is erased, the owner's live
+// state is re-appended through the compactor, and only then is the new
+// sector's header written. Power loss at any point leaves either the old or
+// the new sector complete.
+class FlashLog
+{
+public:
+  static constexpr std::size_t kMaxPayloadBytes = 384;
+  static constexpr uint8_t kErasedType = 0xFF;
+
+  // Re-appends the owner's live records into a freshly rotated sector.
+  using Compactor = void (*)(void *context, FlashLog &log);
+  using Visitor = void (*)(void *context, uint8_t type, const uint8_t *payload, std::size_t length);
+
+  struct Stats
+  {
+    uint32_t appends = 0;
+    uint32_t rotations = 0;
+    uint32_t bytesProgrammed = 0;
+  };
+
+  explicit FlashLog(FlashDevice &device);
+
+  void setCompactor(Compactor compactor, void *context);
+
+  // Finds the newest sector and the append point; formats an empty device.
+  bool mount();
+  // Replays every valid record of the newest sector in write order.
+  void replay(Visitor visitor, void *context) const;
+  bool append(uint8_t type, const void *payload, std::size_t length);
+
+  uint32_t sequence() const { return sequence_; }
+  std::size_t activeSector() const { return activeSector_; }
+  std::size_t freeBytes() const;
+  const Stats &stats() const { return stats_; }
+
+private:
+  struct SectorHeader
+  {
+    uint32_t magic;
+    uint32_t sequence;
+  };
+
+  struct RecordHeader
+  {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t length;
+    uint32_t crc;
+  };
+
+  static_assert(sizeof(SectorHeader) == 8, "SectorHeader layout changed");
+  static_assert(sizeof(RecordHeader) == 8, "RecordHeader layout changed");
+
+  static constexpr uint32_t kSectorMagic = 0x474F4C43U; // "CLOG"
+
+  static std::size_t RecordSpan(std::size_t payloadLength);
+  static uint32_t Checksum(uint8_t type, const uint8_t *payload, std::size_t length);
+
+  bool readHeader(std::size_t sector, SectorHeader &header) const;
+  // Scans the active sector; sets head_ and returns false on a torn record.
+  bool scan();
+  bool writeRecord(uint8_t type, const void *payload, std::size_t length);
+  bool rotate();
+
+  FlashDevice &device_;
+  Compactor compactor_ = nullptr;
+  void *compactorContext_ = nullptr;
+  std::size_t activeSector_ = 0;
+  std::size_t head_ = 0;
+  uint32_t sequence_ = 0;
+  bool mounted_ = false;
+  bool rotating_ = false;
+  bool writeFailed_ = false;
+  Stats stats_{};
+};
+
+} // namespace storage
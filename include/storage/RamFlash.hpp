@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "storage/FlashLog.hpp"
+
+namespace storage
+{
+
+// RAM stand-in with NOR semantics (program ANDs bits in, erase restores
+// 0xFF) for native tests and the simulator. Counts wear and program traffic
+// and can cut power after a given number of programmed bytes.
+template <std::size_t SectorSize, std::size_t SectorCount>
+class RamFlash : public FlashDevice
+{
+public:
+  static constexpr std::size_t kUnlimited = static_cast<std::size_t>(-1);
+
+  RamFlash() { bytes_.fill(0xFF); }
+
+  std::size_t sectorSize() const override { return SectorSize; }
+  std::size_t sectorCount() const override { return SectorCount; }
+
+  void read(std::size_t offset, void *out, std::size_t length) const override
+  {
+    std::memcpy(out, bytes_.data() + offset, length);
+  }
+
+  bool program(std::size_t offset, const void *data, std::size_t length) override
+  {
+    if (offset + length > bytes_.size())
+    {
+      return false;
+    }
+    const auto *source = static_cast<const uint8_t *>(data);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+      if (powerBudget_ == 0)
+      {
+        return false;
+      }
+      if (powerBudget_ != kUnlimited)
+      {
+        --powerBudget_;
+      }
+      bytes_[offset + i] &= source[i];
+    }
+    ++programCalls;
+    bytesProgrammed += length;
+    return true;
+  }
+
+  bool erase(std::size_t sector) override
+  {
+    if (sector >= SectorCount || powerBudget_ == 0)
+    {
+      return false;
+    }
+    std::memset(bytes_.data() + (sector * SectorSize), 0xFF, SectorSize);
+    ++eraseCounts[sector];
+    return true;
+  }
+
+  // Stops programming after `bytes` more bytes, as if power were pulled.
+  void cutPowerAfter(std::size_t bytes) { powerBudget_ = bytes; }
+  void restorePower() { powerBudget_ = kUnlimited; }
+
+  std::array<uint32_t, SectorCount> eraseCounts{};
+  uint32_t programCalls = 0;
+  std::size_t bytesProgrammed = 0;
+
+private:
+  std::array<uint8_t, SectorSize * SectorCount> bytes_{};
+  std::size_t powerBudget_ = kUnlimited;
+};
+
+} // namespace storage
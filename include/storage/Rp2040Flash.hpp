@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "storage/FlashLog.hpp"
+
+namespace storage
+{
+
+// Log region at the top of the RP2040's QSPI flash, below the sector the
+// Arduino core reserves for EEPROM emulation. Off target it reports no
+// sectors, so FlashLog::mount() fails and the firmware runs without a store.
+class Rp2040Flash : public FlashDevice
+{
+public:
+  static constexpr std::size_t kSectorSize = 4096;
+  static constexpr std::size_t kSectorCount = 4;
+
+  std::size_t sectorSize() const override { return kSectorSize; }
+  std::size_t sectorCount() const override;
+  void read(std::size_t offset, void *out, std::size_t length) const override;
+  bool program(std::size_t offset, const void *data, std::size_t length) override;
+  bool erase(std::size_t sector) override;
+};
+
+} // namespace storage
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "geometry/Targeting.hpp"
+#include "motion/MotorManager.hpp"
+
+// Host-side show compiler. A timeline of wall targets, mirror angles or raw
+// step targets is planned offline with MotorManager::ComputeTiming and
+// emitted as a delta-encoded per-channel step program.
+//
+// Timeline text, one cue per line ('#' starts a comment):
+//   at <ms> aim <mirror> <x_mm> <y_mm> <distance_mm>
+//   at <ms> angle <mirror> <yaw_deg> <pitch_deg>
+//   at <ms> move <channel> <steps>
+// Cues sharing a timestamp form one group whose moves finish together.
+namespace cue
+{
+
+enum class CueKind : uint8_t
+{
+  Aim = 0,
+  Angle,
+  Move
+};
+
+struct Cue
+{
+  uint32_t atMs = 0;
+  CueKind kind = CueKind::Move;
+  uint16_t index = 0; // mirror for Aim/Angle, channel for Move
+  int32_t a = 0;      // x_mm | yaw millidegrees | steps
+  int32_t b = 0;      // y_mm | pitch millidegrees
+  int32_t c = 0;      // distance_mm
+  uint32_t line = 0;
+};
+
+enum class DiagnosticCode : uint8_t
+{
+  ParseError = 0,
+  InvalidIndex,
+  Unreachable,
+  ChannelBusy,
+  OverPowerBudget,
+  DurationExceeded
+};
+
+struct Diagnostic
+{
+  DiagnosticCode code = DiagnosticCode::ParseError;
+  uint32_t line = 0;
+  uint32_t atMs = 0;
+  std::string detail;
+};
+
+struct CompileOptions
+{
+  int32_t speedHz = motion::MotorManager::kDefaultSpeedHz;
+  int32_t acceleration = motion::MotorManager::kDefaultAcceleration;
+  geometry::StepLimits limits{-motion::MotorManager::kDefaultLimit, motion::MotorManager::kDefaultLimit};
+  // Power cap: most channels allowed to be stepping at the same instant.
+  std::size_t maxMovingChannels = motion::kChannelCount;
+  // Longest move a single cue group may take; 0 disables the check.
+  uint32_t maxCueDurationMs = 0;
+};
+
+// One planned move, replayable as MOVE:<channel>,<target>,<speedHz>,<accel>.
+struct ChannelStep
+{
+  uint32_t startMs = 0;
+  int32_t target = 0;
+  int32_t speedHz = 0;
+  uint32_t durationUs = 0;
+};
+
+struct CompiledShow
+{
+  int32_t acceleration = 0;
+  std::vector<std::vector<ChannelStep>> channels;
+  std::vector<Diagnostic> diagnostics;
+  uint32_t endMs = 0;
+
+  bool ok() const { return diagnostics.empty(); }
+  std::size_t moveCount() const;
+};
+
+bool ParseTimeline(std::string_view text, std::vector<Cue> &cues, std::vector<Diagnostic> &diagnostics);
+
+class CueCompiler
+{
+public:
+  static constexpr std::size_t kChannelCount = motion::kChannelCount;
+  static constexpr std::size_t kMirrorCount = kChannelCount / 2;
+
+  explicit CueCompiler(const CompileOptions &options = CompileOptions{});
+
+  geometry::MirrorPose &mirrorPose(std::size_t mirror) { return poses_[mirror]; }
+
+  CompiledShow compile(std::vector<Cue> cues) const;
+
+  // Lowest speed (<= maxSpeedHz) that still covers `steps` within
+  // `durationUs` under ComputeTiming's trapezoid; used to stretch shorter
+  // moves so a cue group lands together.
+  static int32_t SpeedForDuration(uint32_t steps, uint32_t durationUs, int32_t maxSpeedHz, int32_t acceleration);
+
+private:
+  CompileOptions options_;
+  std::vector<geometry::MirrorPose> poses_;
+};
+
+// Program layout (little endian, LEB128 varints, zigzag for signed fields):
+//   "CUE" version:u8 channels:u8 accel:varint
+//   per channel: moveCount:varint, then per move
+//     dt_ms:varint (from the previous move's start) dtarget:zigzag speedHz:varint
+constexpr uint8_t kProgramVersion = 1;
+
+std::vector<uint8_t> EncodeProgram(const CompiledShow &show);
+bool DecodeProgram(const uint8_t *data, std::size_t length, CompiledShow &show);
+// Streaming form: "<ms> MOVE:<ch>,<target>,<speed>,<accel>" in time order.
+std::string FormatMoveScript(const CompiledShow &show);
+
+const char *DiagnosticLabel(DiagnosticCode code);
+
+} // namespace cue
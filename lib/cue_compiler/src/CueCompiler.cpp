@@ -0,0 +1,365 @@
+#include "cue/CueCompiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace cue
+{
+
+namespace
+{
+
+using Planner = motion::MotorManager;
+
+constexpr int64_t kMilliDegreesPerTurn = 360000;
+
+std::string_view Trim(std::string_view value)
+{
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t' || value.front() == '\r'))
+  {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r'))
+  {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+std::string_view NextWord(std::string_view &rest)
+{
+  rest = Trim(rest);
+  std::size_t end = rest.find_first_of(" \t");
+  std::string_view word = rest.substr(0, end);
+  rest = (end == std::string_view::npos) ? std::string_view{} : rest.substr(end);
+  return word;
+}
+
+bool ParseLong(std::string_view word, long &value)
+{
+  if (word.empty() || word.size() > 15)
+  {
+    return false;
+  }
+  char buffer[16];
+  word.copy(buffer, word.size());
+  buffer[word.size()] = '\0';
+  char *end = nullptr;
+  value = std::strtol(buffer, &end, 10);
+  return *end == '\0';
+}
+
+// Decimal degrees to integer millidegrees.
+bool ParseMilliDegrees(std::string_view word, int32_t &value)
+{
+  if (word.empty() || word.size() > 15)
+  {
+    return false;
+  }
+  char buffer[16];
+  word.copy(buffer, word.size());
+  buffer[word.size()] = '\0';
+  char *end = nullptr;
+  const double degrees = std::strtod(buffer, &end);
+  if (*end != '\0' || std::fabs(degrees) > 360.0)
+  {
+    return false;
+  }
+  value = static_cast<int32_t>(std::lround(degrees * 1000.0));
+  return true;
+}
+
+void Report(std::vector<Diagnostic> &diagnostics, DiagnosticCode code, const Cue &cue, const char *format, long a = 0, long b = 0)
+{
+  char detail[96];
+  std::snprintf(detail, sizeof(detail), format, a, b);
+  diagnostics.push_back(Diagnostic{code, cue.line, cue.atMs, detail});
+}
+
+int32_t StepsFromMilliDegrees(int32_t milliDegrees, int32_t stepsPerTurn)
+{
+  const int64_t scaled = static_cast<int64_t>(milliDegrees) * stepsPerTurn;
+  const int64_t half = kMilliDegreesPerTurn / 2;
+  return static_cast<int32_t>((scaled >= 0 ? scaled + half : scaled - half) / kMilliDegreesPerTurn);
+}
+
+struct ResolvedMove
+{
+  std::size_t channel = 0;
+  int32_t target = 0;
+  uint32_t steps = 0;
+};
+
+} // namespace
+
+std::size_t CompiledShow::moveCount() const
+{
+  std::size_t total = 0;
+  for (const auto &channel : channels)
+  {
+    total += channel.size();
+  }
+  return total;
+}
+
+bool ParseTimeline(std::string_view text, std::vector<Cue> &cues, std::vector<Diagnostic> &diagnostics)
+{
+  const std::size_t errorsBefore = diagnostics.size();
+  uint32_t lineNumber = 0;
+  while (!text.empty())
+  {
+    ++lineNumber;
+    const std::size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    text = (newline == std::string_view::npos) ? std::string_view{} : text.substr(newline + 1);
+
+    const std::size_t comment = line.find('#');
+    line = Trim(line.substr(0, comment));
+    if (line.empty())
+    {
+      continue;
+    }
+
+    Cue cue{};
+    cue.line = lineNumber;
+    std::string_view rest = line;
+    long atMs = 0;
+    long index = 0;
+    const std::string_view at = NextWord(rest);
+    const bool timed = (at == "at") && ParseLong(NextWord(rest), atMs) && atMs >= 0;
+    const std::string_view kind = NextWord(rest);
+    bool ok = timed && ParseLong(NextWord(rest), index) && index >= 0 && index <= 0xFFFF;
+    cue.atMs = static_cast<uint32_t>(atMs);
+    cue.index = static_cast<uint16_t>(index);
+
+    long values[3] = {};
+    if (ok && kind == "aim")
+    {
+      cue.kind = CueKind::Aim;
+      for (long &value : values)
+      {
+        ok = ok && ParseLong(NextWord(rest), value) && std::labs(value) <= geometry::kMaxCoordinateMm;
+      }
+      cue.a = static_cast<int32_t>(values[0]);
+      cue.b = static_cast<int32_t>(values[1]);
+      cue.c = static_cast<int32_t>(values[2]);
+    }
+    else if (ok && kind == "angle")
+    {
+      cue.kind = CueKind::Angle;
+      ok = ParseMilliDegrees(NextWord(rest), cue.a) && ParseMilliDegrees(NextWord(rest), cue.b);
+    }
+    else if (ok && kind == "move")
+    {
+      cue.kind = CueKind::Move;
+      ok = ParseLong(NextWord(rest), values[0]) && std::labs(values[0]) <= 0x7FFFFFFFL;
+      cue.a = static_cast<int32_t>(values[0]);
+    }
+    else
+    {
+      ok = false;
+    }
+
+    if (!ok || !Trim(rest).empty())
+    {
+      Report(diagnostics, DiagnosticCode::ParseError, cue, "expected 'at <ms> aim|angle|move <index> ...'");
+      continue;
+    }
+    cues.push_back(cue);
+  }
+  return diagnostics.size() == errorsBefore;
+}
+
+CueCompiler::CueCompiler(const CompileOptions &options) : options_(options), poses_(kMirrorCount)
+{
+  for (std::size_t mirror = 0; mirror < kMirrorCount; ++mirror)
+  {
+    poses_[mirror] = geometry::DefaultMirrorPose(mirror);
+  }
+}
+
+int32_t CueCompiler::SpeedForDuration(uint32_t steps, uint32_t durationUs, int32_t maxSpeedHz, int32_t acceleration)
+{
+  if (steps == 0 || Planner::ComputeTiming(steps, maxSpeedHz, acceleration).totalDurationUs >= durationUs)
+  {
+    return maxSpeedHz;
+  }
+
+  // Trapezoid time T = v/a + s/v  =>  v^2 - Tav + sa = 0; the smaller root
+  // keeps the ramp inside the move.
+  const double seconds = static_cast<double>(durationUs) / 1e6;
+  const double a = static_cast<double>(acceleration);
+  const double discriminant = (seconds * seconds * a * a) - (4.0 * static_cast<double>(steps) * a);
+  if (discriminant < 0.0)
+  {
+    return maxSpeedHz;
+  }
+  int32_t speed = static_cast<int32_t>(std::ceil(((seconds * a) - std::sqrt(discriminant)) / 2.0));
+  speed = std::max<int32_t>(1, std::min(speed, maxSpeedHz));
+  while (speed < maxSpeedHz && Planner::ComputeTiming(steps, speed, acceleration).totalDurationUs > durationUs)
+  {
+    ++speed;
+  }
+  return speed;
+}
+
+CompiledShow CueCompiler::compile(std::vector<Cue> cues) const
+{
+  CompiledShow show{};
+  show.acceleration = options_.acceleration;
+  show.channels.resize(kChannelCount);
+
+  std::stable_sort(cues.begin(), cues.end(), [](const Cue &lhs, const Cue &rhs) { return lhs.atMs < rhs.atMs; });
+
+  std::vector<int32_t> position(kChannelCount, 0);
+  std::vector<uint64_t> busyUntilUs(kChannelCount, 0);
+  std::vector<ResolvedMove> group;
+  uint64_t showEndUs = 0;
+
+  for (std::size_t first = 0; first < cues.size();)
+  {
+    const uint32_t atMs = cues[first].atMs;
+    const uint64_t startUs = static_cast<uint64_t>(atMs) * 1000U;
+    std::size_t last = first;
+    group.clear();
+
+    for (; last < cues.size() && cues[last].atMs == atMs; ++last)
+    {
+      const Cue &cue = cues[last];
+      ResolvedMove moves[2];
+      std::size_t moveCount = 0;
+
+      if (cue.kind == CueKind::Move)
+      {
+        if (cue.index >= kChannelCount)
+        {
+          Report(show.diagnostics, DiagnosticCode::InvalidIndex, cue, "channel %ld does not exist", cue.index);
+          continue;
+        }
+        if (cue.a < options_.limits.negative || cue.a > options_.limits.positive)
+        {
+          Report(show.diagnostics, DiagnosticCode::Unreachable, cue, "channel %ld target %ld is past the limit", cue.index, cue.a);
+          continue;
+        }
+        moves[moveCount++] = ResolvedMove{cue.index, cue.a, 0};
+      }
+      else
+      {
+        if (cue.index >= kMirrorCount)
+        {
+          Report(show.diagnostics, DiagnosticCode::InvalidIndex, cue, "mirror %ld does not exist", cue.index);
+          continue;
+        }
+        const geometry::MirrorPose &pose = poses_[cue.index];
+        geometry::AxisTargets axes{};
+        if (cue.kind == CueKind::Aim)
+        {
+          axes = geometry::SolveMirror(pose, geometry::WallTarget{cue.a, cue.b, cue.c}, options_.limits);
+        }
+        else
+        {
+          axes.yawSteps = pose.yawZeroSteps + StepsFromMilliDegrees(cue.a, pose.stepsPerTurn);
+          axes.pitchSteps = pose.pitchZeroSteps + StepsFromMilliDegrees(cue.b, pose.stepsPerTurn);
+          const bool yawOk = axes.yawSteps >= options_.limits.negative && axes.yawSteps <= options_.limits.positive;
+          const bool pitchOk = axes.pitchSteps >= options_.limits.negative && axes.pitchSteps <= options_.limits.positive;
+          axes.status = !yawOk     ? geometry::TargetStatus::YawOutOfRange
+                        : !pitchOk ? geometry::TargetStatus::PitchOutOfRange
+                                   : geometry::TargetStatus::Reachable;
+        }
+        if (axes.status != geometry::TargetStatus::Reachable)
+        {
+          char format[64];
+          std::snprintf(format, sizeof(format), "mirror %%ld %s (yaw %%ld)", geometry::TargetStatusLabel(axes.status));
+          Report(show.diagnostics, DiagnosticCode::Unreachable, cue, format, cue.index, axes.yawSteps);
+          continue;
+        }
+        moves[moveCount++] = ResolvedMove{pose.yawChannel, axes.yawSteps, 0};
+        moves[moveCount++] = ResolvedMove{pose.pitchChannel, axes.pitchSteps, 0};
+      }
+
+      for (std::size_t i = 0; i < moveCount; ++i)
+      {
+        auto existing = std::find_if(group.begin(), group.end(),
+                                     [&](const ResolvedMove &move) { return move.channel == moves[i].channel; });
+        if (existing != group.end())
+        {
+          existing->target = moves[i].target; // later cue in the group wins
+        }
+        else
+        {
+          group.push_back(moves[i]);
+        }
+      }
+    }
+
+    // Coordinated timing: every move in the group lands with the slowest.
+    uint32_t groupDurationUs = 0;
+    for (auto &move : group)
+    {
+      move.steps = static_cast<uint32_t>(std::llabs(static_cast<long long>(move.target) - position[move.channel]));
+      groupDurationUs = std::max(groupDurationUs,
+                                 Planner::ComputeTiming(move.steps, options_.speedHz, options_.acceleration).totalDurationUs);
+    }
+    if (options_.maxCueDurationMs != 0 && groupDurationUs > options_.maxCueDurationMs * 1000U)
+    {
+      Report(show.diagnostics, DiagnosticCode::DurationExceeded, cues[first], "group needs %ld ms, budget %ld ms",
+             static_cast<long>((groupDurationUs + 999U) / 1000U), static_cast<long>(options_.maxCueDurationMs));
+    }
+
+    for (const auto &move : group)
+    {
+      if (move.steps == 0)
+      {
+        continue;
+      }
+      if (busyUntilUs[move.channel] > startUs)
+      {
+        Report(show.diagnostics, DiagnosticCode::ChannelBusy, cues[first], "channel %ld still moving until %ld ms",
+               static_cast<long>(move.channel), static_cast<long>(busyUntilUs[move.channel] / 1000U));
+      }
+      const int32_t speed = SpeedForDuration(move.steps, groupDurationUs, options_.speedHz, options_.acceleration);
+      const motion::TimingEstimate timing = Planner::ComputeTiming(move.steps, speed, options_.acceleration);
+      show.channels[move.channel].push_back(ChannelStep{atMs, move.target, speed, timing.totalDurationUs});
+      position[move.channel] = move.target;
+      busyUntilUs[move.channel] = startUs + timing.totalDurationUs;
+      showEndUs = std::max(showEndUs, busyUntilUs[move.channel]);
+    }
+
+    const std::size_t moving = static_cast<std::size_t>(
+        std::count_if(busyUntilUs.begin(), busyUntilUs.end(), [&](uint64_t until) { return until > startUs; }));
+    if (moving > options_.maxMovingChannels)
+    {
+      Report(show.diagnostics, DiagnosticCode::OverPowerBudget, cues[first], "%ld channels moving, cap is %ld",
+             static_cast<long>(moving), static_cast<long>(options_.maxMovingChannels));
+    }
+
+    first = last;
+  }
+
+  show.endMs = static_cast<uint32_t>((showEndUs + 999U) / 1000U);
+  return show;
+}
+
+const char *DiagnosticLabel(DiagnosticCode code)
+{
+  switch (code)
+  {
+  case DiagnosticCode::ParseError:
+    return "PARSE";
+  case DiagnosticCode::InvalidIndex:
+    return "INVALID_INDEX";
+  case DiagnosticCode::Unreachable:
+    return "UNREACHABLE";
+  case DiagnosticCode::ChannelBusy:
+    return "CHANNEL_BUSY";
+  case DiagnosticCode::OverPowerBudget:
+    return "POWER_CAP";
+  case DiagnosticCode::DurationExceeded:
+    return "DURATION";
+  }
+  return "UNKNOWN";
+}
+
+} // namespace cue
@@ -0,0 +1,199 @@
+#include "cue/CueCompiler.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace cue
+{
+
+namespace
+{
+
+constexpr uint8_t kMagic[] = {'C', 'U', 'E'};
+
+void PutVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+  while (value >= 0x80U)
+  {
+    out.push_back(static_cast<uint8_t>(value | 0x80U));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ZigZag(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1U);
+}
+
+class Reader
+{
+public:
+  Reader(const uint8_t *data, std::size_t length) : data_(data), length_(length) {}
+
+  bool byte(uint8_t &value)
+  {
+    if (offset_ >= length_)
+    {
+      return false;
+    }
+    value = data_[offset_++];
+    return true;
+  }
+
+  bool varint(uint64_t &value)
+  {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+      uint8_t next = 0;
+      if (!byte(next))
+      {
+        return false;
+      }
+      value |= static_cast<uint64_t>(next & 0x7FU) << shift;
+      if ((next & 0x80U) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool done() const { return offset_ == length_; }
+
+private:
+  const uint8_t *data_;
+  std::size_t length_;
+  std::size_t offset_ = 0;
+};
+
+} // namespace
+
+std::vector<uint8_t> EncodeProgram(const CompiledShow &show)
+{
+  std::vector<uint8_t> out(std::begin(kMagic), std::end(kMagic));
+  out.push_back(kProgramVersion);
+  out.push_back(static_cast<uint8_t>(show.channels.size()));
+  PutVarint(out, static_cast<uint64_t>(show.acceleration));
+
+  for (const auto &steps : show.channels)
+  {
+    PutVarint(out, steps.size());
+    uint32_t previousMs = 0;
+    int32_t previousTarget = 0;
+    for (const auto &step : steps)
+    {
+      PutVarint(out, step.startMs - previousMs);
+      PutVarint(out, ZigZag(static_cast<int64_t>(step.target) - previousTarget));
+      PutVarint(out, static_cast<uint64_t>(step.speedHz));
+      previousMs = step.startMs;
+      previousTarget = step.target;
+    }
+  }
+  return out;
+}
+
+bool DecodeProgram(const uint8_t *data, std::size_t length, CompiledShow &show)
+{
+  Reader reader(data, length);
+  for (uint8_t expected : kMagic)
+  {
+    uint8_t actual = 0;
+    if (!reader.byte(actual) || actual != expected)
+    {
+      return false;
+    }
+  }
+  uint8_t version = 0;
+  uint8_t channelCount = 0;
+  uint64_t acceleration = 0;
+  if (!reader.byte(version) || version != kProgramVersion || !reader.byte(channelCount) || !reader.varint(acceleration) ||
+      acceleration == 0 || acceleration > 0x7FFFFFFFU)
+  {
+    return false;
+  }
+
+  show = CompiledShow{};
+  show.acceleration = static_cast<int32_t>(acceleration);
+  show.channels.resize(channelCount);
+  uint64_t endUs = 0;
+  for (auto &steps : show.channels)
+  {
+    uint64_t count = 0;
+    if (!reader.varint(count) || count > length)
+    {
+      return false;
+    }
+    steps.resize(static_cast<std::size_t>(count));
+    uint64_t atMs = 0;
+    int64_t target = 0;
+    for (auto &step : steps)
+    {
+      uint64_t deltaMs = 0;
+      uint64_t deltaTarget = 0;
+      uint64_t speed = 0;
+      if (!reader.varint(deltaMs) || !reader.varint(deltaTarget) || !reader.varint(speed) || speed == 0 ||
+          speed > 0x7FFFFFFFU)
+      {
+        return false;
+      }
+      atMs += deltaMs;
+      target += UnZigZag(deltaTarget);
+      if (atMs > 0xFFFFFFFFU || target < INT32_MIN || target > INT32_MAX)
+      {
+        return false;
+      }
+      const int32_t previous = (&step == steps.data()) ? 0 : (&step - 1)->target;
+      const uint32_t travel = static_cast<uint32_t>(std::llabs(target - previous));
+      step.startMs = static_cast<uint32_t>(atMs);
+      step.target = static_cast<int32_t>(target);
+      step.speedHz = static_cast<int32_t>(speed);
+      step.durationUs = motion::MotorManager::ComputeTiming(travel, step.speedHz, show.acceleration).totalDurationUs;
+      endUs = std::max<uint64_t>(endUs, (atMs * 1000U) + step.durationUs);
+    }
+  }
+  show.endMs = static_cast<uint32_t>((endUs + 999U) / 1000U);
+  return reader.done();
+}
+
+std::string FormatMoveScript(const CompiledShow &show)
+{
+  struct Entry
+  {
+    uint32_t atMs;
+    std::size_t channel;
+    const ChannelStep *step;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(show.moveCount());
+  for (std::size_t channel = 0; channel < show.channels.size(); ++channel)
+  {
+    for (const auto &step : show.channels[channel])
+    {
+      entries.push_back(Entry{step.startMs, channel, &step});
+    }
+  }
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs)
+                   { return (lhs.atMs != rhs.atMs) ? lhs.atMs < rhs.atMs : lhs.channel < rhs.channel; });
+
+  std::string script;
+  char line[80];
+  for (const auto &entry : entries)
+  {
+    std::snprintf(line, sizeof(line), "%lu MOVE:%zu,%ld,%ld,%ld\n", static_cast<unsigned long>(entry.atMs), entry.channel,
+                  static_cast<long>(entry.step->target), static_cast<long>(entry.step->speedHz),
+                  static_cast<long>(show.acceleration));
+    script += line;
+  }
+  return script;
+}
+
+} // namespace cue
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "host/Protocol.hpp"
+
+namespace host
+{
+
+// One deck on a serial port (or pty), driven without blocking. Commands are
+// tagged "#<seq>" and kept up to `window` in flight; replies and events are
+// matched back by tag, so callers never wait for one command before sending
+// the next.
+//
+// The deck prints a command's whole response before reading the next line,
+// so a reply ends at the first line that is not part of it. The last reply
+// before the port goes quiet ends after `settleUs` without input.
+class DeckClient
+{
+public:
+  using ReplyHandler = std::function<void(const Reply &)>;
+  using EventHandler = std::function<void(const Event &)>;
+  // Untagged lines that are not events: the boot banner, DELTA pushes,
+  // errors for lines the deck could not frame.
+  using LineHandler = std::function<void(std::string_view)>;
+
+  struct Options
+  {
+    std::size_t window = 16;
+    uint32_t settleUs = 2000;
+  };
+
+  DeckClient() = default;
+  explicit DeckClient(const Options &options) : options_(options) {}
+  ~DeckClient();
+  DeckClient(const DeckClient &) = delete;
+  DeckClient &operator=(const DeckClient &) = delete;
+
+  // Opens a tty or pty path raw, 8N1, non-blocking.
+  bool open(const std::string &path);
+  // Takes ownership of an open descriptor and makes it non-blocking.
+  void adopt(int fd, std::string name);
+  void close();
+  bool isOpen() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+  const std::string &name() const { return name_; }
+
+  void setEventHandler(EventHandler handler) { onEvent_ = std::move(handler); }
+  void setLineHandler(LineHandler handler) { onLine_ = std::move(handler); }
+
+  // Queues a command and returns its tag. Commands past the window wait
+  // locally until an earlier reply completes.
+  uint16_t submit(std::string_view command, ReplyHandler onReply = {});
+
+  // One non-blocking pass: writes what the port accepts, reads what is
+  // there, completes replies. Returns false once the port is gone.
+  bool pump();
+  // poll(2) interest and the longest wait before pump() has work to do.
+  short pollEvents() const;
+  int pollTimeoutMs() const;
+  // Waits on this deck alone, then pumps.
+  bool poll(int timeoutMs);
+  // Pumps until every submitted command has its reply or the time runs out.
+  bool drain(int timeoutMs);
+  // Blocking round trip for scripts; `code` stays empty on a timeout.
+  Reply call(std::string_view command, int timeoutMs);
+
+  // Submitted but not yet completed, including those not yet sent.
+  std::size_t pending() const { return waiting_.size() + inFlight_.size(); }
+  uint64_t completed() const { return completed_; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request
+  {
+    uint16_t sequence = 0;
+    std::string command;
+    ReplyHandler onReply;
+  };
+
+  void release();
+  void handleLine(std::string_view line);
+  void finishReply();
+  void completeFront(Reply &reply);
+
+  Options options_{};
+  int fd_ = -1;
+  std::string name_;
+  uint16_t nextSequence_ = 1;
+  std::deque<Request> waiting_;
+  std::deque<Request> inFlight_;
+  std::string outbound_;
+  std::string inbound_;
+  Reply current_{};
+  bool collecting_ = false;
+  Clock::time_point lastInput_{};
+  uint64_t completed_ = 0;
+  EventHandler onEvent_;
+  LineHandler onLine_;
+};
+
+// Fans commands out to several decks and services them from one poll(2).
+class DeckGroup
+{
+public:
+  using ReplyHandler = std::function<void(std::size_t deck, const Reply &)>;
+
+  void add(DeckClient &deck) { decks_.push_back(&deck); }
+  std::size_t size() const { return decks_.size(); }
+  DeckClient &deck(std::size_t index) { return *decks_[index]; }
+
+  // Queues `command` on every deck.
+  void broadcast(std::string_view command, const ReplyHandler &onReply = {});
+  // Returns false if any deck's port is gone.
+  bool poll(int timeoutMs);
+  bool drain(int timeoutMs);
+  std::size_t pending() const;
+
+private:
+  std::vector<DeckClient *> decks_;
+};
+
+} // namespace host
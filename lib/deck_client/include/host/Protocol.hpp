@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace host
+{
+
+// Host-side parsing of the deck's serial lines (docs/firmware/README.md).
+// Parsers take the body after any "#<seq> " tag and return false on lines
+// of another shape, leaving the output untouched.
+
+struct TaggedLine
+{
+  bool tagged = false;
+  uint16_t sequence = 0;
+  std::string_view body;
+};
+
+TaggedLine SplitTag(std::string_view line);
+
+// Everything the deck sent back for one command, in order. `code` is the
+// CTRL: label ("OK", "ERR_BUSY", ...); empty when the deck sent nothing.
+struct Reply
+{
+  uint16_t sequence = 0;
+  std::string command;
+  std::string code;
+  std::vector<std::string> lines;
+
+  bool ok() const { return code == "OK"; }
+};
+
+enum class EventKind : uint8_t
+{
+  Done = 0,
+  Homed,
+  Fault,
+  Overflow
+};
+
+struct Event
+{
+  EventKind kind = EventKind::Done;
+  bool tagged = false;
+  uint16_t sequence = 0;
+  uint32_t channel = 0;
+  int32_t position = 0;
+  std::string error;    // FAULT only
+  uint32_t dropped = 0; // OVERFLOW only
+};
+
+// "EVT:DONE CH=2 POS=400" and friends. EVT:MASK= is a reply, not an event.
+bool ParseEvent(std::string_view body, Event &event);
+
+struct ChannelStatus
+{
+  uint32_t channel = 0;
+  int32_t position = 0;
+  int32_t target = 0;
+  std::string state;
+  bool asleep = false;
+  std::string error;
+};
+
+// "STATUS:CH=<c> POS=<p> TARGET=<t> STATE=<s> SLEEP=<0|1> ERR=<code>"
+bool ParseStatus(std::string_view body, ChannelStatus &status);
+
+// Looks up KEY=value among the space-separated fields after the verb.
+bool FindField(std::string_view body, std::string_view key, std::string_view &value);
+
+} // namespace host
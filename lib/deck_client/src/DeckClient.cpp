@@ -0,0 +1,375 @@
+#include "host/DeckClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "control/CommandProcessor.hpp"
+
+namespace host
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+int RemainingMs(Clock::time_point deadline)
+{
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+  return left > 0 ? static_cast<int>(left) : 0;
+}
+
+bool PollAll(const std::vector<DeckClient *> &decks, int timeoutMs)
+{
+  std::vector<pollfd> fds;
+  fds.reserve(decks.size());
+  for (DeckClient *deck : decks)
+  {
+    fds.push_back(pollfd{deck->fd(), deck->pollEvents(), 0});
+    const int settle = deck->pollTimeoutMs();
+    if (settle >= 0 && (timeoutMs < 0 || settle < timeoutMs))
+    {
+      timeoutMs = settle;
+    }
+  }
+  if (::poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR)
+  {
+    return false;
+  }
+  bool alive = true;
+  for (DeckClient *deck : decks)
+  {
+    alive = deck->pump() && alive;
+  }
+  return alive;
+}
+
+} // namespace
+
+DeckClient::~DeckClient()
+{
+  close();
+}
+
+bool DeckClient::open(const std::string &path)
+{
+  const int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0)
+  {
+    return false;
+  }
+  termios tty{};
+  if (tcgetattr(fd, &tty) == 0)
+  {
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    // VMIN=1 so an empty non-blocking read is EAGAIN, never a 0 that looks
+    // like end of file.
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    // USB CDC ignores the rate; a real UART gets the deck's 115200.
+    cfsetispeed(&tty, B115200);
+    cfsetospeed(&tty, B115200);
+    tcsetattr(fd, TCSANOW, &tty);
+  }
+  adopt(fd, path);
+  return true;
+}
+
+void DeckClient::adopt(int fd, std::string name)
+{
+  close();
+  fd_ = fd;
+  name_ = std::move(name);
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+}
+
+void DeckClient::close()
+{
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  waiting_.clear();
+  inFlight_.clear();
+  outbound_.clear();
+  inbound_.clear();
+  collecting_ = false;
+}
+
+uint16_t DeckClient::submit(std::string_view command, ReplyHandler onReply)
+{
+  const uint16_t sequence = nextSequence_++;
+  // "#<seq> " counts towards the deck's line limit. A line it would reject
+  // untagged fails here instead, where the reply can still be matched.
+  const std::size_t tagged = 2 + std::to_string(sequence).size() + command.size();
+  if (tagged > ctrl::CommandProcessor::kMaxCommandLength || command.find('\n') != std::string_view::npos)
+  {
+    Reply reply{};
+    reply.sequence = sequence;
+    reply.command = std::string(command);
+    reply.code = "ERR_PAYLOAD_TOO_LONG";
+    ++completed_;
+    if (onReply)
+    {
+      onReply(reply);
+    }
+    return sequence;
+  }
+  Request request{};
+  request.sequence = sequence;
+  request.command = std::string(command);
+  request.onReply = std::move(onReply);
+  waiting_.push_back(std::move(request));
+  release();
+  return sequence;
+}
+
+void DeckClient::release()
+{
+  const std::size_t window = std::max<std::size_t>(1, options_.window);
+  while (!waiting_.empty() && inFlight_.size() < window)
+  {
+    Request &request = waiting_.front();
+    outbound_ += '#';
+    outbound_ += std::to_string(request.sequence);
+    outbound_ += ' ';
+    outbound_ += request.command;
+    outbound_ += '\n';
+    inFlight_.push_back(std::move(request));
+    waiting_.pop_front();
+  }
+}
+
+bool DeckClient::pump()
+{
+  if (fd_ < 0)
+  {
+    return false;
+  }
+  while (!outbound_.empty())
+  {
+    const ssize_t written = ::write(fd_, outbound_.data(), outbound_.size());
+    if (written < 0)
+    {
+      if (errno == EAGAIN || errno == EINTR)
+      {
+        break;
+      }
+      return false;
+    }
+    outbound_.erase(0, static_cast<std::size_t>(written));
+  }
+
+  char buffer[1024];
+  for (;;)
+  {
+    const ssize_t received = ::read(fd_, buffer, sizeof(buffer));
+    if (received > 0)
+    {
+      lastInput_ = Clock::now();
+      inbound_.append(buffer, static_cast<std::size_t>(received));
+      continue;
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+      break;
+    }
+    // EOF, or EIO once the other end of a pty has gone.
+    return false;
+  }
+
+  std::size_t start = 0;
+  for (std::size_t newline = inbound_.find('\n'); newline != std::string::npos;
+       newline = inbound_.find('\n', start))
+  {
+    std::string_view line(inbound_.data() + start, newline - start);
+    if (!line.empty() && line.back() == '\r')
+    {
+      line.remove_suffix(1);
+    }
+    if (!line.empty())
+    {
+      handleLine(line);
+    }
+    start = newline + 1;
+  }
+  inbound_.erase(0, start);
+
+  if (collecting_ && inbound_.empty() &&
+      Clock::now() - lastInput_ >= std::chrono::microseconds(options_.settleUs))
+  {
+    finishReply();
+  }
+  return true;
+}
+
+void DeckClient::handleLine(std::string_view line)
+{
+  const TaggedLine tagged = SplitTag(line);
+  Event event{};
+  if (ParseEvent(tagged.body, event))
+  {
+    finishReply();
+    event.tagged = tagged.tagged;
+    event.sequence = tagged.sequence;
+    if (onEvent_)
+    {
+      onEvent_(event);
+    }
+    return;
+  }
+  if (tagged.tagged && collecting_ && tagged.sequence == current_.sequence &&
+      tagged.body.substr(0, 5) != "CTRL:")
+  {
+    current_.lines.emplace_back(tagged.body);
+    return;
+  }
+  finishReply();
+  const auto owner = std::find_if(inFlight_.begin(), inFlight_.end(),
+                                  [&](const Request &request) { return request.sequence == tagged.sequence; });
+  if (!tagged.tagged || tagged.body.substr(0, 5) != "CTRL:" || owner == inFlight_.end())
+  {
+    if (onLine_)
+    {
+      onLine_(line);
+    }
+    return;
+  }
+
+  // Commands the deck ignored outright (unframed chatter) end with no reply.
+  while (inFlight_.front().sequence != tagged.sequence)
+  {
+    Reply empty{};
+    completeFront(empty);
+  }
+  current_ = Reply{};
+  current_.sequence = tagged.sequence;
+  current_.code = std::string(tagged.body.substr(5));
+  collecting_ = true;
+}
+
+void DeckClient::finishReply()
+{
+  if (!collecting_)
+  {
+    return;
+  }
+  collecting_ = false;
+  completeFront(current_);
+}
+
+void DeckClient::completeFront(Reply &reply)
+{
+  Request request = std::move(inFlight_.front());
+  inFlight_.pop_front();
+  reply.sequence = request.sequence;
+  reply.command = std::move(request.command);
+  ++completed_;
+  release();
+  if (request.onReply)
+  {
+    request.onReply(reply);
+  }
+}
+
+short DeckClient::pollEvents() const
+{
+  return static_cast<short>(POLLIN | (outbound_.empty() ? 0 : POLLOUT));
+}
+
+int DeckClient::pollTimeoutMs() const
+{
+  if (!collecting_)
+  {
+    return -1;
+  }
+  const auto due = lastInput_ + std::chrono::microseconds(options_.settleUs);
+  const auto left = std::chrono::duration_cast<std::chrono::microseconds>(due - Clock::now()).count();
+  return left > 0 ? static_cast<int>((left + 999) / 1000) : 0;
+}
+
+bool DeckClient::poll(int timeoutMs)
+{
+  return PollAll({this}, timeoutMs);
+}
+
+bool DeckClient::drain(int timeoutMs)
+{
+  const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+  while (pending() != 0)
+  {
+    if (Clock::now() >= deadline || !poll(RemainingMs(deadline)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+Reply DeckClient::call(std::string_view command, int timeoutMs)
+{
+  Reply result{};
+  bool done = false;
+  result.sequence = submit(command,
+                           [&](const Reply &reply)
+                           {
+                             result = reply;
+                             done = true;
+                           });
+  const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+  while (!done && Clock::now() < deadline && poll(RemainingMs(deadline)))
+  {
+  }
+  return result;
+}
+
+void DeckGroup::broadcast(std::string_view command, const ReplyHandler &onReply)
+{
+  for (std::size_t index = 0; index < decks_.size(); ++index)
+  {
+    if (onReply)
+    {
+      decks_[index]->submit(command, [index, onReply](const Reply &reply) { onReply(index, reply); });
+    }
+    else
+    {
+      decks_[index]->submit(command);
+    }
+  }
+}
+
+bool DeckGroup::poll(int timeoutMs)
+{
+  return PollAll(decks_, timeoutMs);
+}
+
+bool DeckGroup::drain(int timeoutMs)
+{
+  const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+  while (pending() != 0)
+  {
+    if (Clock::now() >= deadline || !poll(RemainingMs(deadline)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::size_t DeckGroup::pending() const
+{
+  std::size_t total = 0;
+  for (const DeckClient *deck : decks_)
+  {
+    total += deck->pending();
+  }
+  return total;
+}
+
+} // namespace host
@@ -0,0 +1,159 @@
+#include "host/Protocol.hpp"
+
+#include <cstdlib>
+#include <limits>
+
+namespace host
+{
+
+namespace
+{
+
+bool ParseLong(std::string_view text, long &value)
+{
+  if (text.empty() || text.size() > 20)
+  {
+    return false;
+  }
+  char buffer[24];
+  text.copy(buffer, text.size());
+  buffer[text.size()] = '\0';
+  char *end = nullptr;
+  value = std::strtol(buffer, &end, 10);
+  return end == buffer + text.size();
+}
+
+bool FieldInt(std::string_view body, std::string_view key, long &value)
+{
+  std::string_view text;
+  return FindField(body, key, text) && ParseLong(text, value);
+}
+
+} // namespace
+
+TaggedLine SplitTag(std::string_view line)
+{
+  TaggedLine result{};
+  result.body = line;
+  if (line.empty() || line.front() != '#')
+  {
+    return result;
+  }
+  const std::size_t space = line.find(' ');
+  long sequence = 0;
+  if (space == std::string_view::npos || !ParseLong(line.substr(1, space - 1), sequence) || sequence < 0 ||
+      sequence > std::numeric_limits<uint16_t>::max())
+  {
+    return result;
+  }
+  result.tagged = true;
+  result.sequence = static_cast<uint16_t>(sequence);
+  result.body = line.substr(space + 1);
+  return result;
+}
+
+bool FindField(std::string_view body, std::string_view key, std::string_view &value)
+{
+  const std::size_t colon = body.find(':');
+  std::string_view rest = (colon == std::string_view::npos) ? body : body.substr(colon + 1);
+  while (!rest.empty())
+  {
+    const std::size_t space = rest.find(' ');
+    const std::string_view field = rest.substr(0, space);
+    if (field.size() > key.size() && field.substr(0, key.size()) == key && field[key.size()] == '=')
+    {
+      value = field.substr(key.size() + 1);
+      return true;
+    }
+    rest = (space == std::string_view::npos) ? std::string_view{} : rest.substr(space + 1);
+  }
+  return false;
+}
+
+bool ParseEvent(std::string_view body, Event &event)
+{
+  constexpr std::string_view kPrefix = "EVT:";
+  if (body.substr(0, kPrefix.size()) != kPrefix)
+  {
+    return false;
+  }
+  const std::string_view rest = body.substr(kPrefix.size());
+  const std::string_view kind = rest.substr(0, rest.find(' '));
+  Event parsed{};
+  long channel = 0;
+  long position = 0;
+  if (kind == "OVERFLOW")
+  {
+    long dropped = 0;
+    if (!FieldInt(body, "DROPPED", dropped) || dropped < 0)
+    {
+      return false;
+    }
+    parsed.kind = EventKind::Overflow;
+    parsed.dropped = static_cast<uint32_t>(dropped);
+    event = parsed;
+    return true;
+  }
+  if (kind == "DONE")
+  {
+    parsed.kind = EventKind::Done;
+  }
+  else if (kind == "HOMED")
+  {
+    parsed.kind = EventKind::Homed;
+  }
+  else if (kind == "FAULT")
+  {
+    std::string_view error;
+    if (!FindField(body, "ERR", error))
+    {
+      return false;
+    }
+    parsed.kind = EventKind::Fault;
+    parsed.error = std::string(error);
+  }
+  else
+  {
+    return false;
+  }
+  if (!FieldInt(body, "CH", channel) || channel < 0 || !FieldInt(body, "POS", position))
+  {
+    return false;
+  }
+  parsed.channel = static_cast<uint32_t>(channel);
+  parsed.position = static_cast<int32_t>(position);
+  event = parsed;
+  return true;
+}
+
+bool ParseStatus(std::string_view body, ChannelStatus &status)
+{
+  constexpr std::string_view kPrefix = "STATUS:CH=";
+  if (body.substr(0, kPrefix.size()) != kPrefix)
+  {
+    return false;
+  }
+  ChannelStatus parsed{};
+  long channel = 0;
+  long position = 0;
+  long target = 0;
+  long asleep = 0;
+  std::string_view state;
+  std::string_view error;
+  if (!FieldInt(body, "CH", channel) || channel < 0 || !FieldInt(body, "POS", position) ||
+      !FieldInt(body, "TARGET", target) || !FindField(body, "STATE", state) || !FieldInt(body, "SLEEP", asleep) ||
+      !FindField(body, "ERR", error))
+  {
+    return false;
+  }
+  parsed.channel = static_cast<uint32_t>(channel);
+  parsed.position = static_cast<int32_t>(position);
+  parsed.target = static_cast<int32_t>(target);
+  parsed.state = std::string(state);
+  parsed.asleep = (asleep != 0);
+  parsed.error = std::string(error);
+  status = parsed;
+  return true;
+}
+
+} // namespace host
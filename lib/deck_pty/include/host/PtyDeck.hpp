@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "control/CommandProcessor.hpp"
+#include "storage/CalibrationStore.hpp"
+#include "storage/RamFlash.hpp"
+
+namespace host
+{
+
+struct PtyDeckOptions
+{
+  // Deck microseconds per wall-clock microsecond; 10 runs moves and homing
+  // ten times faster than the hardware would.
+  double clockScale = 1.0;
+  // Longest wait for input between service() passes.
+  uint32_t loopPeriodUs = 500;
+};
+
+// The deck's command loop (src/main.cpp) on the master side of a pty, for
+// host tools without a board. Clients open path() like a USB serial port.
+// There is no step driver: motion follows the MotorManager's own clock.
+// Flash is RAM, so CAL and SHUTDOWN work but last only for the process.
+//
+// The slave end stays open so the banner is buffered for the first client
+// and the pty keeps its raw settings between clients.
+class PtyDeck
+{
+public:
+  explicit PtyDeck(const PtyDeckOptions &options = {});
+  ~PtyDeck();
+  PtyDeck(const PtyDeck &) = delete;
+  PtyDeck &operator=(const PtyDeck &) = delete;
+
+  // Creates the pty, resets the deck and queues the boot banner.
+  bool open();
+  const std::string &path() const { return path_; }
+
+  // Serves until stop(). stop() only sets a flag, so it is safe from a
+  // signal handler or another thread.
+  void run();
+  void stop() { stopping_ = true; }
+  // run() on a background thread; the destructor stops and joins it.
+  void start();
+
+  uint64_t virtualMicros() const { return processor_.uptimeMicros(); }
+
+private:
+  static constexpr std::size_t kFlashSectorSize = 4096;
+  static constexpr std::size_t kFlashSectorCount = 4;
+
+  void serviceClock();
+  void readInput();
+  void flushCommand();
+  void emit(const ctrl::CommandProcessor::Response &response);
+  void emitLine(const char *text);
+
+  PtyDeckOptions options_{};
+  int master_ = -1;
+  int slave_ = -1;
+  std::string path_;
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+
+  ctrl::CommandProcessor processor_;
+  ctrl::CommandProcessor::Response response_{};
+  storage::RamFlash<kFlashSectorSize, kFlashSectorCount> flash_;
+  storage::CalibrationStore store_{flash_};
+  char buffer_[ctrl::CommandProcessor::kMaxCommandLength + 1] = {};
+  std::size_t bufferLength_ = 0;
+  bool bufferOverflow_ = false;
+  int64_t lastWallUs_ = 0;
+  double pendingUs_ = 0.0;
+};
+
+} // namespace host
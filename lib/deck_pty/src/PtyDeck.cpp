@@ -0,0 +1,196 @@
+#include "host/PtyDeck.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string_view>
+#include <termios.h>
+#include <unistd.h>
+
+#include "diag/TraceRing.hpp"
+
+namespace host
+{
+
+namespace
+{
+
+int64_t WallMicros()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+PtyDeck::PtyDeck(const PtyDeckOptions &options) : options_(options) {}
+
+PtyDeck::~PtyDeck()
+{
+  stop();
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+  if (slave_ >= 0)
+  {
+    ::close(slave_);
+  }
+  if (master_ >= 0)
+  {
+    ::close(master_);
+  }
+}
+
+bool PtyDeck::open()
+{
+  master_ = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_ < 0 || grantpt(master_) != 0 || unlockpt(master_) != 0)
+  {
+    return false;
+  }
+  path_ = ptsname(master_);
+  slave_ = ::open(path_.c_str(), O_RDWR | O_NOCTTY);
+  if (slave_ < 0)
+  {
+    return false;
+  }
+  // Raw before anything is written: a cooked slave would echo the banner
+  // back to the deck as a command.
+  termios tty{};
+  tcgetattr(slave_, &tty);
+  cfmakeraw(&tty);
+  tcsetattr(slave_, TCSANOW, &tty);
+  fcntl(master_, F_SETFL, fcntl(master_, F_GETFL) | O_NONBLOCK);
+
+  // setup(): motion first, then the store; nothing journalled yet, so the
+  // deck asks for homing as a fresh board would.
+  processor_.reset();
+  processor_.attachStore(&store_);
+  const bool resumed = store_.begin() && processor_.restoreFromStore();
+  emitLine(resumed ? "BOOT:RESUMED" : "BOOT:HOMING_REQUIRED");
+  emitLine("CTRL:READY");
+  lastWallUs_ = WallMicros();
+  return true;
+}
+
+void PtyDeck::start()
+{
+  thread_ = std::thread([this]() { run(); });
+}
+
+void PtyDeck::run()
+{
+  while (!stopping_)
+  {
+    pollfd input{master_, POLLIN, 0};
+    ::poll(&input, 1, static_cast<int>((options_.loopPeriodUs + 999U) / 1000U));
+
+    // Same order as loop(): time, pushes, then input.
+    serviceClock();
+    if (processor_.collectUpdates(response_))
+    {
+      emit(response_);
+    }
+    if (processor_.collectEvents(response_))
+    {
+      emit(response_);
+    }
+    readInput();
+  }
+}
+
+void PtyDeck::serviceClock()
+{
+  const int64_t now = WallMicros();
+  pendingUs_ += static_cast<double>(now - lastWallUs_) * options_.clockScale;
+  lastWallUs_ = now;
+  // service() takes 32-bit steps; a long stall is fed in pieces.
+  while (pendingUs_ >= 1.0)
+  {
+    const double step = pendingUs_ < 1e9 ? pendingUs_ : 1e9;
+    const uint32_t whole = static_cast<uint32_t>(step);
+    processor_.service(whole);
+    pendingUs_ -= whole;
+  }
+}
+
+void PtyDeck::readInput()
+{
+  char chunk[256];
+  for (ssize_t received = ::read(master_, chunk, sizeof(chunk)); received > 0;
+       received = ::read(master_, chunk, sizeof(chunk)))
+  {
+    for (ssize_t i = 0; i < received; ++i)
+    {
+      const char incoming = chunk[i];
+      if (incoming == '\r')
+      {
+        continue;
+      }
+      if (incoming == '\n')
+      {
+        flushCommand();
+        continue;
+      }
+      if (bufferLength_ >= ctrl::CommandProcessor::kMaxCommandLength)
+      {
+        bufferOverflow_ = true;
+        continue;
+      }
+      buffer_[bufferLength_++] = incoming;
+    }
+  }
+}
+
+void PtyDeck::flushCommand()
+{
+  if (bufferOverflow_)
+  {
+    bufferOverflow_ = false;
+    bufferLength_ = 0;
+    diag::Trace(diag::TraceKind::Overrun, static_cast<uint8_t>(diag::TraceOverrun::InputLine), 0);
+    emitLine("CTRL:ERR_PAYLOAD_TOO_LONG");
+    return;
+  }
+  processor_.processLine(std::string_view(buffer_, bufferLength_), response_);
+  emit(response_);
+  bufferLength_ = 0;
+}
+
+void PtyDeck::emit(const ctrl::CommandProcessor::Response &response)
+{
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    emitLine(response.lines[i].data());
+  }
+}
+
+void PtyDeck::emitLine(const char *text)
+{
+  // Serial.println() framing. The master refuses bytes only while the slave
+  // side's input queue is full. Like the USB port with nobody reading, the
+  // rest of the line is dropped if no client drains it within kWriteStallMs.
+  constexpr int kWriteStallMs = 250;
+  std::string line(text);
+  line += "\r\n";
+  for (std::size_t sent = 0; sent < line.size() && !stopping_;)
+  {
+    const ssize_t written = ::write(master_, line.data() + sent, line.size() - sent);
+    if (written > 0)
+    {
+      sent += static_cast<std::size_t>(written);
+      continue;
+    }
+    pollfd output{master_, POLLOUT, 0};
+    if ((written < 0 && errno != EAGAIN && errno != EINTR) || ::poll(&output, 1, kWriteStallMs) == 0)
+    {
+      return;
+    }
+  }
+}
+
+} // namespace host
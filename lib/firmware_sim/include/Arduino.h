@@ -0,0 +1,33 @@
+#pragma once
+
+// Arduino core stand-in for the simulator build (-DDECK_SIMULATION). Only the
+// calls the firmware makes are provided; each one acts on sim::board().
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sim/Board.hpp"
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+
+unsigned long millis();
+unsigned long micros();
+// Busy waits advance the virtual clock, so PIO keeps running through them.
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+extern sim::SerialPort &Serial;
+
+void setup();
+void loop();
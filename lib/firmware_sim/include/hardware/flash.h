@@ -0,0 +1,17 @@
+#pragma once
+
+// Pico SDK hardware/flash.h stand-in over sim::FlashChip. XIP_BASE points at
+// the chip image, so XIP reads in the firmware see what was programmed.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sim/Board.hpp"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#define XIP_BASE (reinterpret_cast<uintptr_t>(::sim::board().flash().data()))
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
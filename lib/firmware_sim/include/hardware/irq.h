@@ -0,0 +1,13 @@
+#pragma once
+
+// Pico SDK hardware/irq.h stand-in backed by sim::InterruptController.
+
+#include <cstdint>
+
+typedef unsigned int uint;
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
@@ -0,0 +1,112 @@
+#pragma once
+
+// Pico SDK hardware/pio.h stand-in backed by the sim::PioBlock interpreter.
+
+#include <cstdint>
+
+#include "sim/Pio.hpp"
+
+typedef unsigned int uint;
+
+struct pio_program
+{
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+};
+typedef struct pio_program pio_program_t;
+
+typedef sim::PioBlock *PIO;
+typedef sim::PioSmConfig pio_sm_config;
+
+PIO sim_pio_instance(uint index);
+#define pio0 (sim_pio_instance(0))
+#define pio1 (sim_pio_instance(1))
+
+enum pio_fifo_join
+{
+  PIO_FIFO_JOIN_NONE = 0,
+  PIO_FIFO_JOIN_TX = 1,
+  PIO_FIFO_JOIN_RX = 2
+};
+
+enum pio_mov_status_type
+{
+  STATUS_TX_LESSTHAN = 0,
+  STATUS_RX_LESSTHAN = 1
+};
+
+enum pio_interrupt_source
+{
+  pis_sm0_rx_fifo_not_empty = 0,
+  pis_sm1_rx_fifo_not_empty,
+  pis_sm2_rx_fifo_not_empty,
+  pis_sm3_rx_fifo_not_empty,
+  pis_sm0_tx_fifo_not_full,
+  pis_sm1_tx_fifo_not_full,
+  pis_sm2_tx_fifo_not_full,
+  pis_sm3_tx_fifo_not_full,
+  pis_interrupt0,
+  pis_interrupt1,
+  pis_interrupt2,
+  pis_interrupt3
+};
+
+#define PIO0_IRQ_0 7
+#define PIO0_IRQ_1 8
+#define PIO1_IRQ_0 9
+#define PIO1_IRQ_1 10
+
+bool pio_can_add_program(PIO pio, const pio_program *program);
+uint pio_add_program(PIO pio, const pio_program *program);
+void pio_remove_program(PIO pio, const pio_program *program, uint offset);
+uint pio_get_index(PIO pio);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+void pio_gpio_init(PIO pio, uint pin);
+
+void pio_sm_claim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+pio_sm_config pio_get_default_sm_config();
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base);
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+void sm_config_set_mov_status(pio_sm_config *c, enum pio_mov_status_type status_sel, uint status_n);
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clkdiv_restart(PIO pio, uint sm);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr);
+uint8_t pio_sm_get_pc(PIO pio, uint sm);
+
+void pio_sm_clear_fifos(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
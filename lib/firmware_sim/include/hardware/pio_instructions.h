@@ -0,0 +1,74 @@
+#pragma once
+
+// Pico SDK hardware/pio_instructions.h stand-in: the same encoders, so the
+// firmware's hand-built programs assemble to the words silicon would run.
+
+#include <cstdint>
+
+enum pio_src_dest
+{
+  pio_pins = 0u,
+  pio_x = 1u,
+  pio_y = 2u,
+  pio_null = 3u | 0x20u | 0x80u,
+  pio_pindirs = 4u | 0x08u | 0x40u | 0x80u,
+  pio_exec_mov = 4u | 0x08u | 0x10u | 0x20u | 0x80u,
+  pio_status = 5u | 0x08u | 0x10u | 0x20u | 0x80u,
+  pio_pc = 5u | 0x08u | 0x20u | 0x40u,
+  pio_isr = 6u | 0x20u,
+  pio_osr = 7u | 0x10u | 0x20u,
+  pio_exec_out = 7u | 0x08u | 0x20u | 0x40u | 0x80u
+};
+
+namespace sim::detail
+{
+
+enum : unsigned
+{
+  kInstrJmp = 0x0000u,
+  kInstrWait = 0x2000u,
+  kInstrIn = 0x4000u,
+  kInstrOut = 0x6000u,
+  kInstrPush = 0x8000u,
+  kInstrPull = 0x8080u,
+  kInstrMov = 0xA000u,
+  kInstrIrq = 0xC000u,
+  kInstrSet = 0xE000u
+};
+
+inline uint32_t EncodeInstruction(unsigned instr, unsigned arg1, unsigned arg2)
+{
+  return instr | (arg1 << 5u) | (arg2 & 0x1Fu);
+}
+
+} // namespace sim::detail
+
+inline uint32_t pio_encode_delay(unsigned cycles) { return cycles << 8u; }
+inline uint32_t pio_encode_sideset(unsigned sideset_bit_count, unsigned value) { return value << (13u - sideset_bit_count); }
+inline uint32_t pio_encode_sideset_opt(unsigned sideset_bit_count, unsigned value) { return 0x1000u | (value << (12u - sideset_bit_count)); }
+
+inline uint32_t pio_encode_jmp(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 0, addr); }
+inline uint32_t pio_encode_jmp_not_x(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 1, addr); }
+inline uint32_t pio_encode_jmp_x_dec(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 2, addr); }
+inline uint32_t pio_encode_jmp_not_y(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 3, addr); }
+inline uint32_t pio_encode_jmp_y_dec(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 4, addr); }
+inline uint32_t pio_encode_jmp_x_ne_y(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 5, addr); }
+inline uint32_t pio_encode_jmp_pin(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 6, addr); }
+inline uint32_t pio_encode_jmp_not_osre(unsigned addr) { return sim::detail::EncodeInstruction(sim::detail::kInstrJmp, 7, addr); }
+
+inline uint32_t pio_encode_wait_gpio(bool polarity, unsigned gpio) { return sim::detail::EncodeInstruction(sim::detail::kInstrWait, polarity ? 4u : 0u, gpio); }
+inline uint32_t pio_encode_wait_pin(bool polarity, unsigned pin) { return sim::detail::EncodeInstruction(sim::detail::kInstrWait, polarity ? 5u : 1u, pin); }
+inline uint32_t pio_encode_wait_irq(bool polarity, bool relative, unsigned irq) { return sim::detail::EncodeInstruction(sim::detail::kInstrWait, polarity ? 6u : 2u, (relative ? 0x10u : 0u) | irq); }
+
+inline uint32_t pio_encode_in(enum pio_src_dest src, unsigned count) { return sim::detail::EncodeInstruction(sim::detail::kInstrIn, src & 7u, count); }
+inline uint32_t pio_encode_out(enum pio_src_dest dest, unsigned count) { return sim::detail::EncodeInstruction(sim::detail::kInstrOut, dest & 7u, count); }
+inline uint32_t pio_encode_push(bool if_full, bool block) { return sim::detail::EncodeInstruction(sim::detail::kInstrPush, (if_full ? 2u : 0u) | (block ? 1u : 0u), 0); }
+inline uint32_t pio_encode_pull(bool if_empty, bool block) { return sim::detail::EncodeInstruction(sim::detail::kInstrPull, (if_empty ? 2u : 0u) | (block ? 1u : 0u), 0); }
+inline uint32_t pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src) { return sim::detail::EncodeInstruction(sim::detail::kInstrMov, dest & 7u, src & 7u); }
+inline uint32_t pio_encode_mov_not(enum pio_src_dest dest, enum pio_src_dest src) { return sim::detail::EncodeInstruction(sim::detail::kInstrMov, dest & 7u, (1u << 3u) | (src & 7u)); }
+inline uint32_t pio_encode_mov_reverse(enum pio_src_dest dest, enum pio_src_dest src) { return sim::detail::EncodeInstruction(sim::detail::kInstrMov, dest & 7u, (2u << 3u) | (src & 7u)); }
+inline uint32_t pio_encode_irq_set(bool relative, unsigned irq) { return sim::detail::EncodeInstruction(sim::detail::kInstrIrq, 0, (relative ? 0x10u : 0u) | irq); }
+inline uint32_t pio_encode_irq_wait(bool relative, unsigned irq) { return sim::detail::EncodeInstruction(sim::detail::kInstrIrq, 1, (relative ? 0x10u : 0u) | irq); }
+inline uint32_t pio_encode_irq_clear(bool relative, unsigned irq) { return sim::detail::EncodeInstruction(sim::detail::kInstrIrq, 2, (relative ? 0x10u : 0u) | irq); }
+inline uint32_t pio_encode_set(enum pio_src_dest dest, unsigned value) { return sim::detail::EncodeInstruction(sim::detail::kInstrSet, dest & 7u, value); }
+inline uint32_t pio_encode_nop() { return pio_encode_mov(pio_y, pio_y); }
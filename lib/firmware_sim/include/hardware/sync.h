@@ -0,0 +1,9 @@
+#pragma once
+
+// Pico SDK hardware/sync.h stand-in backed by sim::InterruptController:
+// while masked, PIO interrupts are held pending and run on restore.
+
+#include <cstdint>
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
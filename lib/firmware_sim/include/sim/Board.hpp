@@ -0,0 +1,289 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sim/Dma.hpp"
+#include "sim/Pio.hpp"
+
+namespace sim
+{
+
+inline constexpr uint32_t kSystemClockHz = 125'000'000U;
+inline constexpr uint32_t kCyclesPerMicro = kSystemClockHz / 1'000'000U;
+
+constexpr uint64_t MicrosToCycles(uint64_t micros) { return micros * kCyclesPerMicro; }
+
+enum class PinFunction : uint8_t
+{
+  Sio = 0,
+  Pio0,
+  Pio1
+};
+
+enum class TraceSignal : uint8_t
+{
+  Gpio = 0,
+  // SN74HC595 output, indexed by chain bit (register * 8 + Q).
+  ShiftOutput
+};
+
+struct TraceEvent
+{
+  uint64_t cycle = 0;
+  TraceSignal signal = TraceSignal::Gpio;
+  uint8_t index = 0;
+  bool level = false;
+};
+
+using TraceSink = void (*)(void *context, const TraceEvent &event);
+
+// Pads and their function select. A pad only follows writes from the block
+// that owns it, as on silicon; writes from anything else are dropped and the
+// pin is flagged in conflictMask() so a shared assignment is visible.
+class Gpio
+{
+public:
+  static constexpr std::size_t kPinCount = 30;
+
+  void reset();
+
+  void setFunction(uint8_t pin, PinFunction function);
+  PinFunction function(uint8_t pin) const { return functions_[pin % kPinCount]; }
+
+  void drive(uint8_t pin, bool level, uint64_t cycle, PinFunction source);
+  bool level(uint8_t pin) const { return (levels_ >> (pin % kPinCount)) & 1U; }
+  uint32_t levels() const { return levels_; }
+  uint32_t conflictMask() const { return conflicts_; }
+
+  // Edges since the last call, sorted by cycle. State machines run one after
+  // another, so their edges arrive out of order until sorted here.
+  const std::vector<TraceEvent> &takeEdges();
+
+private:
+  std::array<PinFunction, kPinCount> functions_{};
+  uint32_t levels_ = 0;
+  uint32_t conflicts_ = 0;
+  std::vector<TraceEvent> pending_{};
+  std::vector<TraceEvent> taken_{};
+};
+
+// A daisy chain of SN74HC595s watching three pads: SRCLK rising shifts SER in
+// at QA of register 0 and QH of each register feeds the next; RCLK rising
+// copies the chain to the outputs.
+class ShiftRegisterChain
+{
+public:
+  static constexpr std::size_t kMaxRegisters = 8;
+
+  void attach(uint8_t data, uint8_t clock, uint8_t latch, std::size_t registers);
+  void powerOn();
+  bool attached() const { return registers_ > 0; }
+  uint8_t dataPin() const { return data_; }
+  std::size_t outputCount() const { return registers_ * 8U; }
+
+  // Returns true when the outputs changed.
+  bool onEdge(const TraceEvent &edge, bool dataLevel);
+  bool output(std::size_t bit) const { return outputs_[bit]; }
+  uint64_t latches() const { return latches_; }
+
+private:
+  uint8_t data_ = 0;
+  uint8_t clock_ = 0;
+  uint8_t latch_ = 0;
+  std::size_t registers_ = 0;
+  std::array<bool, kMaxRegisters * 8U> chain_{};
+  std::array<bool, kMaxRegisters * 8U> outputs_{};
+  uint64_t latches_ = 0;
+};
+
+// STEP/DIR pair as a DRV8825 sees it: DIR is sampled on each STEP rising edge.
+struct AxisStats
+{
+  uint8_t stepPin = 0;
+  uint8_t dirPin = 0;
+  bool watched = false;
+  uint64_t pulses = 0;
+  int64_t position = 0;
+  uint64_t reversals = 0;
+  bool lastDirection = true;
+  uint64_t firstPulseCycle = 0;
+  uint64_t lastPulseCycle = 0;
+  // Widest gap between consecutive rising edges.
+  uint64_t longestPeriodCycles = 0;
+};
+
+struct SleepStats
+{
+  uint64_t wakes = 0;
+  uint64_t awakeCycles = 0;
+  uint64_t lastChangeCycle = 0;
+  bool awake = false;
+};
+
+struct OutputLine
+{
+  uint64_t micros = 0;
+  std::string text;
+};
+
+// USB CDC stand-in. The host side queues input and collects whole lines.
+// The port comes up closed after reset, as USB enumerates after setup().
+class SerialPort
+{
+public:
+  void reset();
+
+  void begin(unsigned long baud) { baud_ = baud; }
+  explicit operator bool() const { return connected_; }
+  int available() const { return static_cast<int>(input_.size()); }
+  int read();
+  int peek() const;
+  std::size_t write(uint8_t byte);
+  std::size_t write(const uint8_t *data, std::size_t length);
+  std::size_t print(const char *text);
+  std::size_t println(const char *text);
+  std::size_t println() { return write(static_cast<uint8_t>('\r')) + write(static_cast<uint8_t>('\n')); }
+  int availableForWrite() const { return connected_ ? 64 : 0; }
+  void flush() {}
+
+  void setConnected(bool connected) { connected_ = connected; }
+  void hostWrite(std::string_view text);
+  std::deque<OutputLine> &lines() { return lines_; }
+  uint64_t bytesWritten() const { return bytesWritten_; }
+
+private:
+  bool connected_ = false;
+  unsigned long baud_ = 0;
+  std::deque<char> input_{};
+  std::string partial_{};
+  std::deque<OutputLine> lines_{};
+  uint64_t bytesWritten_ = 0;
+};
+
+// NOR flash behind the XIP window: erase sets bytes to 0xFF, programming can
+// only clear bits. Contents survive Board::reset(), like a power cycle.
+class FlashChip
+{
+public:
+  static constexpr std::size_t kSizeBytes = 2U * 1024U * 1024U;
+  static constexpr std::size_t kSectorSize = 4096;
+
+  FlashChip();
+
+  void erase(std::size_t offset, std::size_t length);
+  void program(std::size_t offset, const uint8_t *data, std::size_t length);
+  uint8_t *data() { return image_.data(); }
+  const uint8_t *data() const { return image_.data(); }
+  uint64_t erases() const { return erases_; }
+
+private:
+  std::vector<uint8_t> image_;
+  uint64_t erases_ = 0;
+};
+
+using IrqHandler = void (*)();
+
+// NVIC stand-in. A handler runs synchronously at the virtual cycle its
+// interrupt was raised, between two state-machine instructions, so a PIO
+// IRQ can refill a FIFO before the machine reaches its next pull. While
+// save_and_disable_interrupts() holds the mask, interrupts wait as pending
+// and run from restore_interrupts(). Handlers do not nest.
+class InterruptController
+{
+public:
+  static constexpr std::size_t kIrqCount = 32;
+  static constexpr uint8_t kPio0Irq0 = 7;
+  static constexpr uint8_t kPio1Irq0 = 9;
+
+  void reset();
+
+  void setHandler(uint8_t irq, IrqHandler handler);
+  void setEnabled(uint8_t irq, bool enabled);
+  bool enabled(uint8_t irq) const { return (enabled_ >> (irq % kIrqCount)) & 1U; }
+  void raise(uint8_t irq);
+
+  // Returns the previous mask state for restore().
+  uint32_t mask();
+  void restore(uint32_t state);
+
+  uint64_t delivered(uint8_t irq) const { return delivered_[irq % kIrqCount]; }
+
+private:
+  void deliver();
+
+  std::array<IrqHandler, kIrqCount> handlers_{};
+  std::array<uint64_t, kIrqCount> delivered_{};
+  uint32_t enabled_ = 0;
+  uint32_t pending_ = 0;
+  bool masked_ = false;
+  bool inHandler_ = false;
+};
+
+// The virtual RP2040 and what is wired to it. One instance backs the
+// Arduino and SDK shims; the clock only moves when advance() is called.
+class Board
+{
+public:
+  static constexpr std::size_t kMaxAxes = 32;
+
+  Board();
+
+  // Power-on reset: clock, pads, PIO, DMA, interrupts and serial. Flash and
+  // watches persist.
+  void reset();
+
+  uint64_t cycles() const { return cycles_; }
+  uint64_t micros() const { return cycles_ / kCyclesPerMicro; }
+  void advance(uint64_t cycles);
+
+  void writePin(uint8_t pin, bool level);
+  bool readPin(uint8_t pin) const { return gpio_.level(pin); }
+
+  Gpio &gpio() { return gpio_; }
+  PioBlock &pio(std::size_t block) { return pio_[block % kPioBlockCount]; }
+  DmaController &dma() { return dma_; }
+  InterruptController &interrupts() { return interrupts_; }
+  SerialPort &serial() { return serial_; }
+  FlashChip &flash() { return flash_; }
+
+  void attachShiftRegisters(uint8_t data, uint8_t clock, uint8_t latch, std::size_t registers);
+  const ShiftRegisterChain &shiftRegisters() const { return shiftRegisters_; }
+  // Boards wire QH..QA of register r to lines r*8 .. r*8+7, which is what
+  // LSB-first shifting produces. The mapping is its own inverse.
+  static std::size_t ChainBitForLine(std::size_t line) { return (line / 8U) * 8U + (7U - (line % 8U)); }
+  const SleepStats &sleepLine(std::size_t line);
+
+  void watchAxis(std::size_t axis, uint8_t stepPin, uint8_t dirPin);
+  const AxisStats &axis(std::size_t axis) const { return axes_[axis % kMaxAxes]; }
+
+  void setTraceSink(TraceSink sink, void *context);
+
+private:
+  static void RaisePioIrq(void *context, uint8_t block, uint64_t cycle);
+  void dispatchEdges();
+  void emit(const TraceEvent &event);
+
+  uint64_t cycles_ = 0;
+  Gpio gpio_{};
+  std::array<PioBlock, kPioBlockCount> pio_{PioBlock(0), PioBlock(1)};
+  DmaController dma_{};
+  InterruptController interrupts_{};
+  SerialPort serial_{};
+  FlashChip flash_{};
+  ShiftRegisterChain shiftRegisters_{};
+  std::array<SleepStats, ShiftRegisterChain::kMaxRegisters * 8U> sleepLines_{};
+  std::array<AxisStats, kMaxAxes> axes_{};
+  uint32_t tracedLevels_ = 0;
+  TraceSink sink_ = nullptr;
+  void *sinkContext_ = nullptr;
+};
+
+Board &board();
+
+} // namespace sim
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "sim/Pio.hpp"
+
+namespace sim
+{
+
+inline constexpr std::size_t kDmaChannelCount = 12;
+// DREQ numbers below this pace a PIO FIFO: block * 8 + sm for TX, + 4 for RX.
+inline constexpr uint8_t kDreqPioLimit = 16;
+inline constexpr uint8_t kDreqForce = 0x3f;
+
+// The sim's view of dma_channel_config, unpacked.
+struct DmaChannelConfig
+{
+  bool readIncrement = true;
+  bool writeIncrement = false;
+  // 0, 1, 2 for 8, 16, 32-bit transfers, as DMA_SIZE_*.
+  uint8_t dataSize = 2;
+  uint8_t dreq = kDreqForce;
+};
+
+struct DmaChannel
+{
+  DmaChannelConfig config{};
+  bool claimed = false;
+  const uint32_t *read = nullptr;
+  // TRANS_COUNT as last written; copied into `remaining` on each trigger.
+  uint32_t reloadCount = 0;
+  uint32_t remaining = 0;
+  uint64_t transfers = 0;
+};
+
+// DMA channels streaming 32-bit words into PIO TX FIFOs on their DREQ. A
+// channel binds itself as the state machine's TxFeeder, so words move at
+// the exact cycle a slot frees up. Other destinations and transfer sizes are
+// out of scope: the firmware only feeds state machines.
+class DmaController
+{
+public:
+  void reset(PioBlock *blocks, std::size_t blockCount);
+
+  int claimUnused();
+  void claim(std::size_t channel);
+  void unclaim(std::size_t channel);
+
+  DmaChannel &channel(std::size_t channel) { return channels_[channel % kDmaChannelCount]; }
+  void trigger(std::size_t channel);
+  void abort(std::size_t channel);
+  bool busy(std::size_t channel) const { return channels_[channel % kDmaChannelCount].remaining != 0; }
+
+private:
+  struct Binding
+  {
+    DmaController *owner = nullptr;
+    uint8_t index = 0;
+  };
+
+  static void Feed(void *context);
+  void feed(std::size_t channel);
+  PioStateMachine *target(const DmaChannel &channel);
+
+  PioBlock *blocks_ = nullptr;
+  std::size_t blockCount_ = 0;
+  std::array<DmaChannel, kDmaChannelCount> channels_{};
+  std::array<Binding, kDmaChannelCount> bindings_{};
+};
+
+} // namespace sim
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sim
+{
+
+class Gpio;
+
+inline constexpr std::size_t kPioBlockCount = 2;
+inline constexpr std::size_t kPioStateMachineCount = 4;
+inline constexpr std::size_t kPioInstructionCount = 32;
+inline constexpr std::size_t kPioFifoDepth = 4;
+
+// The sim's view of pio_sm_config: the fields the SDK packs into CLKDIV,
+// EXECCTRL, SHIFTCTRL and PINCTRL, kept unpacked.
+struct PioSmConfig
+{
+  uint8_t wrapTarget = 0;
+  uint8_t wrapTop = kPioInstructionCount - 1;
+  uint8_t setBase = 0;
+  uint8_t setCount = 5;
+  uint8_t outBase = 0;
+  uint8_t outCount = 32;
+  uint8_t inBase = 0;
+  uint8_t jmpPin = 0;
+  uint8_t sidesetBase = 0;
+  // Bits taken from the delay field, including the enable bit when optional.
+  uint8_t sidesetBits = 0;
+  bool sidesetOptional = false;
+  bool sidesetPindirs = false;
+  bool outShiftRight = true;
+  bool autopull = false;
+  uint8_t pullThreshold = 32;
+  bool inShiftRight = true;
+  bool autopush = false;
+  uint8_t pushThreshold = 32;
+  // 0 selects the full 65536 divide, as on silicon.
+  uint16_t clkdivInt = 1;
+  uint8_t clkdivFrac = 0;
+  // 0 none, 1 TX takes the RX storage, 2 RX takes the TX storage.
+  uint8_t fifoJoin = 0;
+  uint8_t statusLevel = 0;
+  bool statusOnRx = false;
+};
+
+class PioFifo
+{
+public:
+  static constexpr std::size_t kMaxDepth = kPioFifoDepth * 2;
+
+  void reset(std::size_t depth);
+  bool push(uint32_t word);
+  bool pop(uint32_t &word);
+  std::size_t level() const { return count_; }
+  std::size_t depth() const { return depth_; }
+  bool empty() const { return count_ == 0; }
+  bool full() const { return count_ >= depth_; }
+
+private:
+  std::array<uint32_t, kMaxDepth> words_{};
+  std::size_t head_ = 0;
+  std::size_t count_ = 0;
+  std::size_t depth_ = kPioFifoDepth;
+};
+
+// A paced writer on a TX FIFO (a DMA channel on its DREQ). Called whenever
+// the state machine frees a slot, so the FIFO refills at the instant it
+// drains without the DMA needing a clock of its own.
+using TxFeeder = void (*)(void *context);
+
+// The block's IRQ0 output, raised when an `irq` instruction sets a flag that
+// is enabled as an IRQ0 source (or a source is enabled with its flag set).
+using IrqLine = void (*)(void *context, uint8_t block, uint64_t cycle);
+
+struct PioStateMachine
+{
+  PioSmConfig config{};
+  bool enabled = false;
+  uint8_t pc = 0;
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t isr = 0;
+  uint32_t osr = 0;
+  uint8_t isrCount = 0;
+  // 32 means empty, matching the hardware shift counter after reset.
+  uint8_t osrCount = 32;
+  bool execPending = false;
+  uint16_t execInstruction = 0;
+  bool irqWaiting = false;
+  PioFifo tx{};
+  PioFifo rx{};
+  // System-clock time of the next state-machine cycle, in 1/256 cycles so
+  // fractional dividers accumulate exactly.
+  uint64_t clock256 = 0;
+  uint64_t instructions = 0;
+  uint64_t stallCycles = 0;
+  bool txOverflow = false;
+  bool rxUnderflow = false;
+  TxFeeder txFeeder = nullptr;
+  void *txFeederContext = nullptr;
+};
+
+// One PIO block: 32 words of instruction memory, four state machines and the
+// shared IRQ flags. State machines are interpreted instruction by instruction;
+// stalls and `jmp x--`/`jmp y--` self-loops are skipped in one step, so an
+// idle or delaying machine costs nothing per simulated cycle.
+class PioBlock
+{
+public:
+  explicit PioBlock(uint8_t index = 0) : index_(index) {}
+
+  void reset(Gpio *gpio);
+
+  uint8_t index() const { return index_; }
+
+  // Stand-ins for the TXF registers so `&pio->txf[sm]` compiles as a DMA
+  // write address; transfers are routed by DREQ, never through these.
+  std::array<uint32_t, kPioStateMachineCount> txf{};
+
+  bool canAddProgram(const uint16_t *instructions, uint8_t length, int8_t origin) const;
+  // Loads and relocates JMP targets; returns the offset or -1 without space.
+  int addProgram(const uint16_t *instructions, uint8_t length, int8_t origin);
+  void removeProgram(uint8_t offset, uint8_t length);
+  uint16_t instruction(uint8_t address) const { return memory_[address % kPioInstructionCount]; }
+
+  PioStateMachine &stateMachine(std::size_t sm) { return machines_[sm % kPioStateMachineCount]; }
+  const PioStateMachine &stateMachine(std::size_t sm) const { return machines_[sm % kPioStateMachineCount]; }
+
+  void claim(std::size_t sm) { claimedMask_ = static_cast<uint8_t>(claimedMask_ | (1U << sm)); }
+  void unclaim(std::size_t sm) { claimedMask_ = static_cast<uint8_t>(claimedMask_ & ~(1U << sm)); }
+  bool claimed(std::size_t sm) const { return (claimedMask_ >> sm) & 1U; }
+
+  void init(std::size_t sm, uint8_t initialPc, const PioSmConfig &config, uint64_t nowCycles);
+  void setEnabled(std::size_t sm, bool enabled, uint64_t nowCycles);
+  void restart(std::size_t sm);
+  void clearFifos(std::size_t sm);
+  // Runs `instruction` on the state machine at `nowCycles`, as SMx_INSTR does.
+  void exec(std::size_t sm, uint16_t instruction, uint64_t nowCycles);
+
+  // Advances every enabled state machine up to `untilCycles`.
+  void run(uint64_t untilCycles);
+
+  uint8_t irqFlags() const { return irqFlags_; }
+  void setIrqFlag(uint8_t flag) { irqFlags_ = static_cast<uint8_t>(irqFlags_ | (1U << flag)); }
+  void clearIrqFlags(uint8_t mask) { irqFlags_ = static_cast<uint8_t>(irqFlags_ & ~mask); }
+
+  uint32_t irq0Sources() const { return irq0Sources_; }
+  void setIrq0Source(uint8_t source, bool enabled, uint64_t nowCycles);
+  void setIrqLine(IrqLine line, void *context)
+  {
+    irqLine_ = line;
+    irqLineContext_ = context;
+  }
+
+private:
+  struct Outcome
+  {
+    bool stalled = false;
+    bool jumped = false;
+    uint64_t extraCycles = 0;
+  };
+
+  void runStateMachine(std::size_t sm, uint64_t untilCycles);
+  static bool PopTx(PioStateMachine &machine, uint32_t &word);
+  Outcome execute(std::size_t sm, uint16_t instruction, uint64_t cycle, uint64_t budget256, bool forced);
+  void applySideSet(PioStateMachine &machine, uint16_t instruction, uint64_t cycle);
+  uint8_t delayCycles(const PioStateMachine &machine, uint16_t instruction) const;
+  void advancePc(PioStateMachine &machine) const;
+  void writePins(uint8_t base, uint8_t count, uint32_t value, uint64_t cycle);
+  uint32_t readPins(uint8_t base) const;
+  uint8_t irqIndex(std::size_t sm, uint8_t field) const;
+  void signalIrq0(uint64_t cycle);
+
+  uint8_t index_ = 0;
+  Gpio *gpio_ = nullptr;
+  std::array<uint16_t, kPioInstructionCount> memory_{};
+  uint32_t usedMask_ = 0;
+  std::array<PioStateMachine, kPioStateMachineCount> machines_{};
+  uint8_t claimedMask_ = 0;
+  uint8_t irqFlags_ = 0;
+  uint32_t irq0Sources_ = 0;
+  IrqLine irqLine_ = nullptr;
+  void *irqLineContext_ = nullptr;
+};
+
+} // namespace sim
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "sim/Board.hpp"
+
+namespace sim
+{
+
+struct SimulationOptions
+{
+  // Virtual time between loop() calls. The real loop spins far faster; a
+  // coarser period trades service granularity for simulation speed.
+  uint32_t loopPeriodUs = 100;
+};
+
+// Drives the firmware's own setup()/loop() against sim::board(). Entry
+// points are passed in because they live in the firmware image, not here.
+class Simulation
+{
+public:
+  using EntryPoint = void (*)();
+
+  Simulation(EntryPoint setup, EntryPoint loop, const SimulationOptions &options = {});
+
+  // Power-on reset, setup(), then the host opens the port. Flash persists,
+  // so a second boot() sees what the first one journalled.
+  void boot();
+  void run(uint64_t micros);
+  // Runs until a device line starting with `prefix` arrives after the call;
+  // returns false at the timeout.
+  bool runUntilLine(std::string_view prefix, uint64_t timeoutMicros);
+  void send(std::string_view line);
+
+  uint64_t loops() const { return loops_; }
+  uint64_t micros() const { return board().micros(); }
+
+private:
+  void step();
+
+  EntryPoint setup_;
+  EntryPoint loop_;
+  SimulationOptions options_;
+  uint64_t loops_ = 0;
+};
+
+} // namespace sim
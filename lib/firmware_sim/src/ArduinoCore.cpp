@@ -0,0 +1,53 @@
+#include <Arduino.h>
+
+sim::SerialPort &Serial = sim::board().serial();
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  sim::board().writePin(pin, value != LOW);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return sim::board().readPin(pin) ? HIGH : LOW;
+}
+
+// Bit-banged like the Arduino core, so the shift-register model sees every
+// SRCLK edge rather than a byte-level shortcut.
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value)
+{
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    const uint8_t bit = (bitOrder == LSBFIRST) ? (value >> i) : (value >> (7 - i));
+    digitalWrite(dataPin, bit & 1U);
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+unsigned long millis()
+{
+  return static_cast<unsigned long>(sim::board().micros() / 1000U);
+}
+
+unsigned long micros()
+{
+  // 32-bit like the target, so wraparound handling gets exercised.
+  return static_cast<unsigned long>(static_cast<uint32_t>(sim::board().micros()));
+}
+
+void delay(unsigned long ms)
+{
+  sim::board().advance(sim::MicrosToCycles(static_cast<uint64_t>(ms) * 1000U));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  sim::board().advance(sim::MicrosToCycles(us));
+}
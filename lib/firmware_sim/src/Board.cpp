@@ -0,0 +1,417 @@
+#include "sim/Board.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sim
+{
+
+void Gpio::reset()
+{
+  functions_.fill(PinFunction::Sio);
+  levels_ = 0;
+  conflicts_ = 0;
+  pending_.clear();
+  taken_.clear();
+}
+
+void Gpio::setFunction(uint8_t pin, PinFunction function)
+{
+  if (pin < kPinCount)
+  {
+    functions_[pin] = function;
+  }
+}
+
+void Gpio::drive(uint8_t pin, bool level, uint64_t cycle, PinFunction source)
+{
+  if (pin >= kPinCount)
+  {
+    return;
+  }
+  if (functions_[pin] != source)
+  {
+    conflicts_ |= 1u << pin;
+    return;
+  }
+  if (this->level(pin) == level)
+  {
+    return;
+  }
+  levels_ ^= 1u << pin;
+  pending_.push_back(TraceEvent{cycle, TraceSignal::Gpio, pin, level});
+}
+
+const std::vector<TraceEvent> &Gpio::takeEdges()
+{
+  taken_.swap(pending_);
+  pending_.clear();
+  std::stable_sort(taken_.begin(), taken_.end(), [](const TraceEvent &a, const TraceEvent &b) { return a.cycle < b.cycle; });
+  return taken_;
+}
+
+void ShiftRegisterChain::attach(uint8_t data, uint8_t clock, uint8_t latch, std::size_t registers)
+{
+  data_ = data;
+  clock_ = clock;
+  latch_ = latch;
+  registers_ = std::min(registers, kMaxRegisters);
+  powerOn();
+}
+
+void ShiftRegisterChain::powerOn()
+{
+  chain_.fill(false);
+  outputs_.fill(false);
+  latches_ = 0;
+}
+
+bool ShiftRegisterChain::onEdge(const TraceEvent &edge, bool dataLevel)
+{
+  if (registers_ == 0 || edge.signal != TraceSignal::Gpio || !edge.level)
+  {
+    return false;
+  }
+  const std::size_t bits = registers_ * 8U;
+  if (edge.index == clock_)
+  {
+    for (std::size_t bit = bits - 1; bit > 0; --bit)
+    {
+      chain_[bit] = chain_[bit - 1];
+    }
+    chain_[0] = dataLevel;
+    return false;
+  }
+  if (edge.index == latch_)
+  {
+    ++latches_;
+    const bool changed = !std::equal(chain_.begin(), chain_.begin() + bits, outputs_.begin());
+    std::copy(chain_.begin(), chain_.begin() + bits, outputs_.begin());
+    return changed;
+  }
+  return false;
+}
+
+void SerialPort::reset()
+{
+  connected_ = false;
+  baud_ = 0;
+  input_.clear();
+  partial_.clear();
+  lines_.clear();
+  bytesWritten_ = 0;
+}
+
+int SerialPort::read()
+{
+  if (input_.empty())
+  {
+    return -1;
+  }
+  const char c = input_.front();
+  input_.pop_front();
+  return static_cast<unsigned char>(c);
+}
+
+int SerialPort::peek() const
+{
+  return input_.empty() ? -1 : static_cast<unsigned char>(input_.front());
+}
+
+std::size_t SerialPort::write(uint8_t byte)
+{
+  if (!connected_)
+  {
+    return 0;
+  }
+  ++bytesWritten_;
+  if (byte == '\n')
+  {
+    lines_.push_back(OutputLine{board().micros(), partial_});
+    partial_.clear();
+  }
+  else if (byte != '\r')
+  {
+    partial_.push_back(static_cast<char>(byte));
+  }
+  return 1;
+}
+
+std::size_t SerialPort::write(const uint8_t *data, std::size_t length)
+{
+  std::size_t written = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    written += write(data[i]);
+  }
+  return written;
+}
+
+std::size_t SerialPort::print(const char *text)
+{
+  return write(reinterpret_cast<const uint8_t *>(text), std::strlen(text));
+}
+
+std::size_t SerialPort::println(const char *text)
+{
+  const std::size_t written = print(text);
+  return written + println();
+}
+
+void SerialPort::hostWrite(std::string_view text)
+{
+  input_.insert(input_.end(), text.begin(), text.end());
+}
+
+FlashChip::FlashChip() : image_(kSizeBytes, 0xFF) {}
+
+void FlashChip::erase(std::size_t offset, std::size_t length)
+{
+  if (offset >= kSizeBytes)
+  {
+    return;
+  }
+  length = std::min(length, kSizeBytes - offset);
+  std::fill_n(image_.begin() + static_cast<std::ptrdiff_t>(offset), length, 0xFF);
+  erases_ += (length + kSectorSize - 1) / kSectorSize;
+}
+
+void FlashChip::program(std::size_t offset, const uint8_t *data, std::size_t length)
+{
+  for (std::size_t i = 0; i < length && offset + i < kSizeBytes; ++i)
+  {
+    image_[offset + i] &= data[i];
+  }
+}
+
+void InterruptController::reset()
+{
+  handlers_.fill(nullptr);
+  delivered_.fill(0);
+  enabled_ = 0;
+  pending_ = 0;
+  masked_ = false;
+  inHandler_ = false;
+}
+
+void InterruptController::setHandler(uint8_t irq, IrqHandler handler)
+{
+  handlers_[irq % kIrqCount] = handler;
+}
+
+void InterruptController::setEnabled(uint8_t irq, bool enabled)
+{
+  const uint32_t bit = 1u << (irq % kIrqCount);
+  enabled_ = enabled ? (enabled_ | bit) : (enabled_ & ~bit);
+  deliver();
+}
+
+void InterruptController::raise(uint8_t irq)
+{
+  pending_ |= 1u << (irq % kIrqCount);
+  deliver();
+}
+
+uint32_t InterruptController::mask()
+{
+  const uint32_t previous = masked_ ? 1U : 0U;
+  masked_ = true;
+  return previous;
+}
+
+void InterruptController::restore(uint32_t state)
+{
+  masked_ = state != 0;
+  deliver();
+}
+
+void InterruptController::deliver()
+{
+  if (masked_ || inHandler_)
+  {
+    return;
+  }
+  // Lowest number first, as equal-priority NVIC lines resolve.
+  while ((pending_ & enabled_) != 0U)
+  {
+    const uint8_t irq = static_cast<uint8_t>(__builtin_ctz(pending_ & enabled_));
+    pending_ &= ~(1u << irq);
+    if (handlers_[irq] == nullptr)
+    {
+      continue;
+    }
+    inHandler_ = true;
+    handlers_[irq]();
+    inHandler_ = false;
+    ++delivered_[irq];
+  }
+}
+
+Board::Board()
+{
+  reset();
+}
+
+void Board::reset()
+{
+  cycles_ = 0;
+  gpio_.reset();
+  interrupts_.reset();
+  for (PioBlock &block : pio_)
+  {
+    block.reset(&gpio_);
+    block.setIrqLine(&Board::RaisePioIrq, this);
+  }
+  dma_.reset(pio_.data(), pio_.size());
+  serial_.reset();
+  for (AxisStats &stats : axes_)
+  {
+    const AxisStats wiring = stats;
+    stats = AxisStats{};
+    stats.stepPin = wiring.stepPin;
+    stats.dirPin = wiring.dirPin;
+    stats.watched = wiring.watched;
+  }
+  shiftRegisters_.powerOn();
+  sleepLines_.fill(SleepStats{});
+  tracedLevels_ = 0;
+}
+
+void Board::advance(uint64_t cycles)
+{
+  const uint64_t target = cycles_ + cycles;
+  for (PioBlock &block : pio_)
+  {
+    block.run(target);
+  }
+  cycles_ = target;
+  dispatchEdges();
+}
+
+// The handler sees the clock at the raising instruction, not at the start of
+// the slice being run.
+void Board::RaisePioIrq(void *context, uint8_t block, uint64_t cycle)
+{
+  Board &self = *static_cast<Board *>(context);
+  const uint64_t sliceStart = self.cycles_;
+  self.cycles_ = std::max(sliceStart, cycle);
+  self.interrupts_.raise(block == 0 ? InterruptController::kPio0Irq0 : InterruptController::kPio1Irq0);
+  self.cycles_ = sliceStart;
+}
+
+void Board::writePin(uint8_t pin, bool level)
+{
+  dispatchEdges();
+  gpio_.drive(pin, level, cycles_, PinFunction::Sio);
+  dispatchEdges();
+}
+
+void Board::attachShiftRegisters(uint8_t data, uint8_t clock, uint8_t latch, std::size_t registers)
+{
+  shiftRegisters_.attach(data, clock, latch, registers);
+  sleepLines_.fill(SleepStats{});
+}
+
+const SleepStats &Board::sleepLine(std::size_t line)
+{
+  SleepStats &stats = sleepLines_[ChainBitForLine(line) % sleepLines_.size()];
+  if (stats.awake)
+  {
+    stats.awakeCycles += cycles_ - stats.lastChangeCycle;
+    stats.lastChangeCycle = cycles_;
+  }
+  return stats;
+}
+
+void Board::watchAxis(std::size_t axis, uint8_t stepPin, uint8_t dirPin)
+{
+  AxisStats &stats = axes_[axis % kMaxAxes];
+  stats = AxisStats{};
+  stats.stepPin = stepPin;
+  stats.dirPin = dirPin;
+  stats.watched = true;
+}
+
+void Board::setTraceSink(TraceSink sink, void *context)
+{
+  sink_ = sink;
+  sinkContext_ = context;
+}
+
+void Board::dispatchEdges()
+{
+  const std::vector<TraceEvent> &edges = gpio_.takeEdges();
+  for (const TraceEvent &edge : edges)
+  {
+    // Pads as of this edge; gpio_ already holds the end-of-slice levels.
+    tracedLevels_ = edge.level ? (tracedLevels_ | (1u << edge.index)) : (tracedLevels_ & ~(1u << edge.index));
+    emit(edge);
+    if (edge.level)
+    {
+      for (AxisStats &stats : axes_)
+      {
+        if (!stats.watched || stats.stepPin != edge.index)
+        {
+          continue;
+        }
+        const bool direction = (tracedLevels_ >> stats.dirPin) & 1U;
+        if (stats.pulses == 0)
+        {
+          stats.firstPulseCycle = edge.cycle;
+        }
+        else
+        {
+          stats.longestPeriodCycles = std::max(stats.longestPeriodCycles, edge.cycle - stats.lastPulseCycle);
+          if (direction != stats.lastDirection)
+          {
+            ++stats.reversals;
+          }
+        }
+        ++stats.pulses;
+        stats.position += direction ? 1 : -1;
+        stats.lastDirection = direction;
+        stats.lastPulseCycle = edge.cycle;
+      }
+    }
+
+    if (shiftRegisters_.onEdge(edge, (tracedLevels_ >> shiftRegisters_.dataPin()) & 1U))
+    {
+      for (std::size_t bit = 0; bit < shiftRegisters_.outputCount(); ++bit)
+      {
+        const bool high = shiftRegisters_.output(bit);
+        SleepStats &line = sleepLines_[bit];
+        if (high == line.awake)
+        {
+          continue;
+        }
+        if (line.awake)
+        {
+          line.awakeCycles += edge.cycle - line.lastChangeCycle;
+        }
+        else
+        {
+          ++line.wakes;
+        }
+        line.awake = high;
+        line.lastChangeCycle = edge.cycle;
+        emit(TraceEvent{edge.cycle, TraceSignal::ShiftOutput, static_cast<uint8_t>(bit), high});
+      }
+    }
+  }
+}
+
+void Board::emit(const TraceEvent &event)
+{
+  if (sink_ != nullptr)
+  {
+    sink_(sinkContext_, event);
+  }
+}
+
+Board &board()
+{
+  static Board instance;
+  return instance;
+}
+
+} // namespace sim
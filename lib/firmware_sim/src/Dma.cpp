@@ -0,0 +1,110 @@
+#include "sim/Dma.hpp"
+
+namespace sim
+{
+
+void DmaController::reset(PioBlock *blocks, std::size_t blockCount)
+{
+  blocks_ = blocks;
+  blockCount_ = blockCount;
+  channels_.fill(DmaChannel{});
+  for (std::size_t i = 0; i < kDmaChannelCount; ++i)
+  {
+    bindings_[i] = Binding{this, static_cast<uint8_t>(i)};
+  }
+}
+
+int DmaController::claimUnused()
+{
+  for (std::size_t i = 0; i < kDmaChannelCount; ++i)
+  {
+    if (!channels_[i].claimed)
+    {
+      channels_[i].claimed = true;
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void DmaController::claim(std::size_t channel)
+{
+  channels_[channel % kDmaChannelCount].claimed = true;
+}
+
+void DmaController::unclaim(std::size_t channel)
+{
+  abort(channel);
+  channels_[channel % kDmaChannelCount].claimed = false;
+}
+
+void DmaController::trigger(std::size_t channel)
+{
+  DmaChannel &state = channels_[channel % kDmaChannelCount];
+  state.remaining = state.reloadCount;
+  PioStateMachine *machine = target(state);
+  if (machine == nullptr)
+  {
+    return;
+  }
+  machine->txFeeder = &DmaController::Feed;
+  machine->txFeederContext = &bindings_[channel % kDmaChannelCount];
+  feed(channel % kDmaChannelCount);
+}
+
+void DmaController::abort(std::size_t channel)
+{
+  DmaChannel &state = channels_[channel % kDmaChannelCount];
+  state.remaining = 0;
+  PioStateMachine *machine = target(state);
+  if (machine != nullptr && machine->txFeederContext == &bindings_[channel % kDmaChannelCount])
+  {
+    machine->txFeeder = nullptr;
+    machine->txFeederContext = nullptr;
+  }
+}
+
+void DmaController::Feed(void *context)
+{
+  const Binding *binding = static_cast<const Binding *>(context);
+  binding->owner->feed(binding->index);
+}
+
+void DmaController::feed(std::size_t channel)
+{
+  DmaChannel &state = channels_[channel];
+  PioStateMachine *machine = target(state);
+  if (machine == nullptr)
+  {
+    return;
+  }
+  while (state.remaining != 0 && !machine->tx.full())
+  {
+    machine->tx.push(*state.read);
+    if (state.config.readIncrement)
+    {
+      ++state.read;
+    }
+    --state.remaining;
+    ++state.transfers;
+  }
+  if (state.remaining == 0)
+  {
+    machine->txFeeder = nullptr;
+    machine->txFeederContext = nullptr;
+  }
+}
+
+PioStateMachine *DmaController::target(const DmaChannel &channel)
+{
+  const uint8_t dreq = channel.config.dreq;
+  const std::size_t block = dreq / 8U;
+  const std::size_t slot = dreq % 8U;
+  if (dreq >= kDreqPioLimit || block >= blockCount_ || slot >= kPioStateMachineCount || channel.read == nullptr)
+  {
+    return nullptr;
+  }
+  return &blocks_[block].stateMachine(slot);
+}
+
+} // namespace sim
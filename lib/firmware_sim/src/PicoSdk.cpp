@@ -0,0 +1,451 @@
+#include <hardware/dma.h>
+#include <hardware/flash.h>
+#include <hardware/irq.h>
+#include <hardware/pio.h>
+#include <hardware/sync.h>
+
+namespace
+{
+
+uint64_t Now()
+{
+  return sim::board().cycles();
+}
+
+uint8_t ClampPins(uint count)
+{
+  return static_cast<uint8_t>(count > 32 ? 32 : count);
+}
+
+} // namespace
+
+PIO sim_pio_instance(uint index)
+{
+  return &sim::board().pio(index);
+}
+
+bool pio_can_add_program(PIO pio, const pio_program *program)
+{
+  return pio->canAddProgram(program->instructions, program->length, program->origin);
+}
+
+uint pio_add_program(PIO pio, const pio_program *program)
+{
+  const int offset = pio->addProgram(program->instructions, program->length, program->origin);
+  // The SDK panics here; a negative offset would only corrupt later calls.
+  return offset < 0 ? 0u : static_cast<uint>(offset);
+}
+
+void pio_remove_program(PIO pio, const pio_program *program, uint offset)
+{
+  pio->removeProgram(static_cast<uint8_t>(offset), program->length);
+}
+
+uint pio_get_index(PIO pio)
+{
+  return pio->index();
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+  return (pio->index() * 8u) + (is_tx ? sm : sm + 4u);
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+  sim::board().gpio().setFunction(static_cast<uint8_t>(pin), pio->index() == 0 ? sim::PinFunction::Pio0 : sim::PinFunction::Pio1);
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+  pio->claim(sm);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+  (void)required;
+  for (uint sm = 0; sm < sim::kPioStateMachineCount; ++sm)
+  {
+    if (!pio->claimed(sm))
+    {
+      pio->claim(sm);
+      return static_cast<int>(sm);
+    }
+  }
+  return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm)
+{
+  pio->unclaim(sm);
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm)
+{
+  return pio->claimed(sm);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+  (void)pio;
+  (void)sm;
+  (void)pin_base;
+  (void)pin_count;
+  (void)is_out;
+  return 0;
+}
+
+pio_sm_config pio_get_default_sm_config()
+{
+  return sim::PioSmConfig{};
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+  c->wrapTarget = static_cast<uint8_t>(wrap_target);
+  c->wrapTop = static_cast<uint8_t>(wrap);
+}
+
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count)
+{
+  c->setBase = static_cast<uint8_t>(set_base);
+  c->setCount = ClampPins(set_count);
+}
+
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count)
+{
+  c->outBase = static_cast<uint8_t>(out_base);
+  c->outCount = ClampPins(out_count);
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+  c->inBase = static_cast<uint8_t>(in_base);
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base)
+{
+  c->sidesetBase = static_cast<uint8_t>(sideset_base);
+}
+
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs)
+{
+  c->sidesetBits = static_cast<uint8_t>(bit_count);
+  c->sidesetOptional = optional;
+  c->sidesetPindirs = pindirs;
+}
+
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin)
+{
+  c->jmpPin = static_cast<uint8_t>(pin);
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+  c->outShiftRight = shift_right;
+  c->autopull = autopull;
+  c->pullThreshold = static_cast<uint8_t>(pull_threshold == 0 ? 32 : pull_threshold);
+}
+
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+  c->inShiftRight = shift_right;
+  c->autopush = autopush;
+  c->pushThreshold = static_cast<uint8_t>(push_threshold == 0 ? 32 : push_threshold);
+}
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+  c->clkdivInt = div_int;
+  c->clkdivFrac = div_frac;
+}
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+  const uint16_t integer = static_cast<uint16_t>(div);
+  const uint8_t fraction = integer == 0 ? 0 : static_cast<uint8_t>((div - static_cast<float>(integer)) * 256.0f);
+  sm_config_set_clkdiv_int_frac(c, integer, fraction);
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join)
+{
+  c->fifoJoin = static_cast<uint8_t>(join);
+}
+
+void sm_config_set_mov_status(pio_sm_config *c, enum pio_mov_status_type status_sel, uint status_n)
+{
+  c->statusOnRx = status_sel == STATUS_RX_LESSTHAN;
+  c->statusLevel = static_cast<uint8_t>(status_n);
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+  pio->init(sm, static_cast<uint8_t>(initial_pc), config != nullptr ? *config : sim::PioSmConfig{}, Now());
+  return 0;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+  pio->setEnabled(sm, enabled, Now());
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+  pio->restart(sm);
+}
+
+void pio_sm_clkdiv_restart(PIO pio, uint sm)
+{
+  (void)pio;
+  (void)sm;
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac)
+{
+  sm_config_set_clkdiv_int_frac(&pio->stateMachine(sm).config, div_int, div_frac);
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div)
+{
+  sm_config_set_clkdiv(&pio->stateMachine(sm).config, div);
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+  pio->exec(sm, static_cast<uint16_t>(instr), Now());
+}
+
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr)
+{
+  pio_sm_exec(pio, sm, instr);
+  while (pio->stateMachine(sm).execPending)
+  {
+    sim::board().advance(1);
+  }
+}
+
+uint8_t pio_sm_get_pc(PIO pio, uint sm)
+{
+  return pio->stateMachine(sm).pc;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+  pio->clearFifos(sm);
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+  return static_cast<uint>(pio->stateMachine(sm).tx.level());
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+  return static_cast<uint>(pio->stateMachine(sm).rx.level());
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+  return pio->stateMachine(sm).tx.full();
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm)
+{
+  return pio->stateMachine(sm).tx.empty();
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+  return pio->stateMachine(sm).rx.empty();
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm)
+{
+  return pio->stateMachine(sm).rx.full();
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+  sim::PioStateMachine &machine = pio->stateMachine(sm);
+  if (!machine.tx.push(data))
+  {
+    machine.txOverflow = true;
+  }
+}
+
+// Blocking calls spin in virtual time, so the state machine drains meanwhile.
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+  while (pio->stateMachine(sm).tx.full())
+  {
+    sim::board().advance(sim::kCyclesPerMicro);
+  }
+  pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+  sim::PioStateMachine &machine = pio->stateMachine(sm);
+  uint32_t word = 0;
+  if (!machine.rx.pop(word))
+  {
+    machine.rxUnderflow = true;
+  }
+  return word;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+  while (pio->stateMachine(sm).rx.empty())
+  {
+    sim::board().advance(sim::kCyclesPerMicro);
+  }
+  return pio_sm_get(pio, sm);
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled)
+{
+  pio->setIrq0Source(static_cast<uint8_t>(source), enabled, Now());
+}
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num)
+{
+  return (pio->irqFlags() >> pio_interrupt_num) & 1U;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num)
+{
+  pio->clearIrqFlags(static_cast<uint8_t>(1U << pio_interrupt_num));
+}
+
+int dma_claim_unused_channel(bool required)
+{
+  (void)required;
+  return sim::board().dma().claimUnused();
+}
+
+void dma_channel_claim(uint channel)
+{
+  sim::board().dma().claim(channel);
+}
+
+void dma_channel_unclaim(uint channel)
+{
+  sim::board().dma().unclaim(channel);
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+  (void)channel;
+  return dma_channel_config{};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+  c->dataSize = static_cast<uint8_t>(size);
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+  c->readIncrement = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+  c->writeIncrement = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+  c->dreq = static_cast<uint8_t>(dreq);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+  (void)write_addr;
+  sim::DmaChannel &state = sim::board().dma().channel(channel);
+  state.config = *config;
+  dma_channel_set_read_addr(channel, read_addr, false);
+  dma_channel_set_trans_count(channel, transfer_count, trigger);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+  sim::board().dma().channel(channel).read = static_cast<const uint32_t *>(const_cast<const void *>(read_addr));
+  if (trigger)
+  {
+    dma_channel_start(channel);
+  }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+  sim::board().dma().channel(channel).reloadCount = trans_count;
+  if (trigger)
+  {
+    dma_channel_start(channel);
+  }
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+  dma_channel_set_read_addr(channel, read_addr, false);
+  dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+void dma_channel_start(uint channel)
+{
+  sim::board().dma().trigger(channel);
+}
+
+void dma_channel_abort(uint channel)
+{
+  sim::board().dma().abort(channel);
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+  return sim::board().dma().busy(channel);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+  sim::board().flash().erase(flash_offs, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+  sim::board().flash().program(flash_offs, data, count);
+}
+
+uint32_t save_and_disable_interrupts()
+{
+  return sim::board().interrupts().mask();
+}
+
+void restore_interrupts(uint32_t status)
+{
+  sim::board().interrupts().restore(status);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+  sim::board().interrupts().setHandler(static_cast<uint8_t>(num), handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+  (void)handler;
+  sim::board().interrupts().setHandler(static_cast<uint8_t>(num), nullptr);
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+  sim::board().interrupts().setEnabled(static_cast<uint8_t>(num), enabled);
+}
+
+bool irq_is_enabled(uint num)
+{
+  return sim::board().interrupts().enabled(static_cast<uint8_t>(num));
+}
@@ -0,0 +1,729 @@
+#include "sim/Pio.hpp"
+
+#include <algorithm>
+
+#include "sim/Board.hpp"
+
+namespace sim
+{
+
+namespace
+{
+
+enum Opcode : uint8_t
+{
+  kJmp = 0,
+  kWait,
+  kIn,
+  kOut,
+  kPushPull,
+  kMov,
+  kIrq,
+  kSet
+};
+
+constexpr uint32_t Mask(uint8_t bits)
+{
+  return bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+}
+
+uint32_t BitReverse(uint32_t value)
+{
+  uint32_t result = 0;
+  for (int bit = 0; bit < 32; ++bit)
+  {
+    result = (result << 1) | (value & 1u);
+    value >>= 1;
+  }
+  return result;
+}
+
+uint32_t ClockDivider256(const PioSmConfig &config)
+{
+  const uint32_t integer = config.clkdivInt == 0 ? 65536u : config.clkdivInt;
+  return (integer << 8) + config.clkdivFrac;
+}
+
+PinFunction FunctionForBlock(uint8_t block)
+{
+  return block == 0 ? PinFunction::Pio0 : PinFunction::Pio1;
+}
+
+} // namespace
+
+void PioFifo::reset(std::size_t depth)
+{
+  head_ = 0;
+  count_ = 0;
+  depth_ = std::min(depth, kMaxDepth);
+}
+
+bool PioFifo::push(uint32_t word)
+{
+  if (full())
+  {
+    return false;
+  }
+  words_[(head_ + count_) % kMaxDepth] = word;
+  ++count_;
+  return true;
+}
+
+bool PioFifo::pop(uint32_t &word)
+{
+  if (empty())
+  {
+    return false;
+  }
+  word = words_[head_];
+  head_ = (head_ + 1) % kMaxDepth;
+  --count_;
+  return true;
+}
+
+bool PioBlock::PopTx(PioStateMachine &machine, uint32_t &word)
+{
+  if (machine.txFeeder != nullptr && machine.tx.empty())
+  {
+    machine.txFeeder(machine.txFeederContext);
+  }
+  if (!machine.tx.pop(word))
+  {
+    return false;
+  }
+  if (machine.txFeeder != nullptr)
+  {
+    machine.txFeeder(machine.txFeederContext);
+  }
+  return true;
+}
+
+void PioBlock::reset(Gpio *gpio)
+{
+  gpio_ = gpio;
+  memory_.fill(0);
+  usedMask_ = 0;
+  machines_.fill(PioStateMachine{});
+  claimedMask_ = 0;
+  irqFlags_ = 0;
+  irq0Sources_ = 0;
+}
+
+bool PioBlock::canAddProgram(const uint16_t *instructions, uint8_t length, int8_t origin) const
+{
+  if (instructions == nullptr || length == 0 || length > kPioInstructionCount)
+  {
+    return false;
+  }
+  const uint32_t programMask = Mask(length);
+  if (origin >= 0)
+  {
+    return origin + length <= static_cast<int>(kPioInstructionCount) && (usedMask_ & (programMask << origin)) == 0;
+  }
+  for (int offset = static_cast<int>(kPioInstructionCount) - length; offset >= 0; --offset)
+  {
+    if ((usedMask_ & (programMask << offset)) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int PioBlock::addProgram(const uint16_t *instructions, uint8_t length, int8_t origin)
+{
+  if (!canAddProgram(instructions, length, origin))
+  {
+    return -1;
+  }
+  const uint32_t programMask = Mask(length);
+  int offset = origin;
+  if (offset < 0)
+  {
+    // Highest free offset first, like the SDK allocator.
+    for (offset = static_cast<int>(kPioInstructionCount) - length; offset > 0; --offset)
+    {
+      if ((usedMask_ & (programMask << offset)) == 0)
+      {
+        break;
+      }
+    }
+  }
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    uint16_t instruction = instructions[i];
+    if ((instruction >> 13) == kJmp)
+    {
+      instruction = static_cast<uint16_t>(instruction + offset);
+    }
+    memory_[offset + i] = instruction;
+  }
+  usedMask_ |= programMask << offset;
+  return offset;
+}
+
+void PioBlock::removeProgram(uint8_t offset, uint8_t length)
+{
+  usedMask_ &= ~(Mask(length) << offset);
+}
+
+void PioBlock::init(std::size_t sm, uint8_t initialPc, const PioSmConfig &config, uint64_t nowCycles)
+{
+  PioStateMachine &machine = stateMachine(sm);
+  machine = PioStateMachine{};
+  machine.config = config;
+  machine.pc = initialPc;
+  clearFifos(sm);
+  machine.clock256 = nowCycles << 8;
+}
+
+void PioBlock::setEnabled(std::size_t sm, bool enabled, uint64_t nowCycles)
+{
+  PioStateMachine &machine = stateMachine(sm);
+  if (enabled && !machine.enabled)
+  {
+    machine.clock256 = std::max(machine.clock256, nowCycles << 8);
+  }
+  machine.enabled = enabled;
+}
+
+void PioBlock::restart(std::size_t sm)
+{
+  PioStateMachine &machine = stateMachine(sm);
+  machine.isr = 0;
+  machine.isrCount = 0;
+  machine.osrCount = 32;
+  machine.execPending = false;
+  machine.irqWaiting = false;
+}
+
+void PioBlock::clearFifos(std::size_t sm)
+{
+  PioStateMachine &machine = stateMachine(sm);
+  const uint8_t join = machine.config.fifoJoin;
+  machine.tx.reset(join == 1 ? kPioFifoDepth * 2 : (join == 2 ? 0 : kPioFifoDepth));
+  machine.rx.reset(join == 2 ? kPioFifoDepth * 2 : (join == 1 ? 0 : kPioFifoDepth));
+}
+
+void PioBlock::exec(std::size_t sm, uint16_t instruction, uint64_t nowCycles)
+{
+  PioStateMachine &machine = stateMachine(sm);
+  const Outcome outcome = execute(sm % kPioStateMachineCount, instruction, nowCycles, 0, true);
+  if (outcome.stalled)
+  {
+    // A stalled forced instruction latches and retries on the next cycle.
+    machine.execPending = true;
+    machine.execInstruction = instruction;
+  }
+}
+
+void PioBlock::setIrq0Source(uint8_t source, bool enabled, uint64_t nowCycles)
+{
+  if (enabled)
+  {
+    irq0Sources_ |= 1u << source;
+  }
+  else
+  {
+    irq0Sources_ &= ~(1u << source);
+  }
+  signalIrq0(nowCycles);
+}
+
+// Only the four flag sources are modelled; FIFO-level sources never assert.
+void PioBlock::signalIrq0(uint64_t cycle)
+{
+  constexpr uint8_t kFirstFlagSource = 8;
+  if (irqLine_ != nullptr && (irqFlags_ & (irq0Sources_ >> kFirstFlagSource) & 0xFu) != 0U)
+  {
+    irqLine_(irqLineContext_, index_, cycle);
+  }
+}
+
+void PioBlock::run(uint64_t untilCycles)
+{
+  for (std::size_t sm = 0; sm < kPioStateMachineCount; ++sm)
+  {
+    runStateMachine(sm, untilCycles);
+  }
+}
+
+void PioBlock::runStateMachine(std::size_t sm, uint64_t untilCycles)
+{
+  PioStateMachine &machine = machines_[sm];
+  const uint64_t until256 = untilCycles << 8;
+  const uint64_t divider = ClockDivider256(machine.config);
+  while (machine.enabled && machine.clock256 < until256)
+  {
+    const bool forced = machine.execPending;
+    const uint16_t instruction = forced ? machine.execInstruction : memory_[machine.pc];
+    machine.execPending = false;
+    const uint64_t cycle = machine.clock256 >> 8;
+    applySideSet(machine, instruction, cycle);
+
+    const Outcome outcome = execute(sm, instruction, cycle, until256 - machine.clock256, forced);
+    if (outcome.stalled)
+    {
+      if (forced)
+      {
+        machine.execPending = true;
+      }
+      // Nothing a stalled machine waits on changes before the CPU runs
+      // again, so skip straight to the end of the slice.
+      const uint64_t idle = ((until256 - machine.clock256) + divider - 1) / divider;
+      machine.clock256 += idle * divider;
+      machine.stallCycles += idle;
+      break;
+    }
+    ++machine.instructions;
+    const uint64_t cycles = static_cast<uint64_t>(1U + delayCycles(machine, instruction)) + outcome.extraCycles;
+    machine.clock256 += cycles * divider;
+  }
+  if (!machine.enabled)
+  {
+    machine.clock256 = std::max(machine.clock256, until256);
+  }
+}
+
+uint8_t PioBlock::delayCycles(const PioStateMachine &machine, uint16_t instruction) const
+{
+  const uint8_t delayBits = static_cast<uint8_t>(5U - machine.config.sidesetBits);
+  return static_cast<uint8_t>((instruction >> 8) & Mask(delayBits));
+}
+
+void PioBlock::applySideSet(PioStateMachine &machine, uint16_t instruction, uint64_t cycle)
+{
+  const PioSmConfig &config = machine.config;
+  if (config.sidesetBits == 0)
+  {
+    return;
+  }
+  const uint8_t field = static_cast<uint8_t>((instruction >> 8) & 0x1Fu);
+  const uint8_t delayBits = static_cast<uint8_t>(5U - config.sidesetBits);
+  uint8_t valueBits = config.sidesetBits;
+  if (config.sidesetOptional)
+  {
+    if ((field & 0x10u) == 0)
+    {
+      return;
+    }
+    --valueBits;
+  }
+  const uint32_t value = (field >> delayBits) & Mask(valueBits);
+  if (!config.sidesetPindirs)
+  {
+    writePins(config.sidesetBase, valueBits, value, cycle);
+  }
+}
+
+void PioBlock::advancePc(PioStateMachine &machine) const
+{
+  if (machine.pc == machine.config.wrapTop)
+  {
+    machine.pc = machine.config.wrapTarget;
+  }
+  else
+  {
+    machine.pc = static_cast<uint8_t>((machine.pc + 1U) % kPioInstructionCount);
+  }
+}
+
+void PioBlock::writePins(uint8_t base, uint8_t count, uint32_t value, uint64_t cycle)
+{
+  if (gpio_ == nullptr)
+  {
+    return;
+  }
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const uint8_t pin = static_cast<uint8_t>((base + i) % 32U);
+    if (pin < Gpio::kPinCount)
+    {
+      gpio_->drive(pin, ((value >> i) & 1U) != 0, cycle, FunctionForBlock(index_));
+    }
+  }
+}
+
+uint32_t PioBlock::readPins(uint8_t base) const
+{
+  if (gpio_ == nullptr)
+  {
+    return 0;
+  }
+  const uint32_t levels = gpio_->levels();
+  return base == 0 ? levels : ((levels >> base) | (levels << (32U - base)));
+}
+
+uint8_t PioBlock::irqIndex(std::size_t sm, uint8_t field) const
+{
+  if ((field & 0x10u) == 0)
+  {
+    return static_cast<uint8_t>(field & 0x7u);
+  }
+  return static_cast<uint8_t>((field & 0x4u) | ((field + sm) & 0x3u));
+}
+
+PioBlock::Outcome PioBlock::execute(std::size_t sm, uint16_t instruction, uint64_t cycle, uint64_t budget256, bool forced)
+{
+  PioStateMachine &machine = machines_[sm];
+  const PioSmConfig &config = machine.config;
+  const uint8_t opcode = static_cast<uint8_t>(instruction >> 13);
+  const uint8_t arg1 = static_cast<uint8_t>((instruction >> 5) & 0x7u);
+  const uint8_t arg2 = static_cast<uint8_t>(instruction & 0x1Fu);
+  Outcome outcome{};
+
+  switch (opcode)
+  {
+  case kJmp:
+  {
+    bool taken = false;
+    switch (arg1)
+    {
+    case 0:
+      taken = true;
+      break;
+    case 1:
+      taken = machine.x == 0;
+      break;
+    case 2:
+    case 4:
+    {
+      uint32_t &reg = (arg1 == 2) ? machine.x : machine.y;
+      const uint64_t period256 = (1ULL + delayCycles(machine, instruction)) * ClockDivider256(config);
+      if (!forced && arg2 == machine.pc && budget256 > period256 && reg > 0)
+      {
+        // Counted self-loop: retire as many iterations as fit the slice.
+        const uint64_t fit = budget256 / period256;
+        const uint64_t iterations = std::min<uint64_t>(fit - 1U, reg);
+        reg -= static_cast<uint32_t>(iterations);
+        machine.instructions += iterations;
+        outcome.extraCycles = iterations * (1ULL + delayCycles(machine, instruction));
+      }
+      taken = reg != 0;
+      --reg;
+      break;
+    }
+    case 3:
+      taken = machine.y == 0;
+      break;
+    case 5:
+      taken = machine.x != machine.y;
+      break;
+    case 6:
+      taken = gpio_ != nullptr && gpio_->level(config.jmpPin);
+      break;
+    case 7:
+      taken = machine.osrCount < config.pullThreshold;
+      break;
+    default:
+      break;
+    }
+    if (taken)
+    {
+      machine.pc = arg2;
+      outcome.jumped = true;
+    }
+    break;
+  }
+  case kWait:
+  {
+    const bool polarity = (arg1 & 0x4u) != 0;
+    const uint8_t source = arg1 & 0x3u;
+    bool level = false;
+    if (source == 0)
+    {
+      level = gpio_ != nullptr && gpio_->level(arg2);
+    }
+    else if (source == 1)
+    {
+      level = ((readPins(config.inBase) >> arg2) & 1U) != 0;
+    }
+    else if (source == 2)
+    {
+      const uint8_t flag = irqIndex(sm, arg2);
+      level = (irqFlags_ >> flag) & 1U;
+      if (level && polarity)
+      {
+        clearIrqFlags(static_cast<uint8_t>(1U << flag));
+      }
+    }
+    outcome.stalled = level != polarity;
+    break;
+  }
+  case kIn:
+  {
+    if (config.autopush && machine.isrCount >= config.pushThreshold)
+    {
+      if (!machine.rx.push(machine.isr))
+      {
+        outcome.stalled = true;
+        break;
+      }
+      machine.isr = 0;
+      machine.isrCount = 0;
+    }
+    const uint8_t count = arg2 == 0 ? 32 : arg2;
+    uint32_t data = 0;
+    switch (arg1)
+    {
+    case 0:
+      data = readPins(config.inBase);
+      break;
+    case 1:
+      data = machine.x;
+      break;
+    case 2:
+      data = machine.y;
+      break;
+    case 6:
+      data = machine.isr;
+      break;
+    case 7:
+      data = machine.osr;
+      break;
+    default:
+      break;
+    }
+    data &= Mask(count);
+    if (count == 32)
+    {
+      machine.isr = data;
+    }
+    else if (config.inShiftRight)
+    {
+      machine.isr = (machine.isr >> count) | (data << (32U - count));
+    }
+    else
+    {
+      machine.isr = (machine.isr << count) | data;
+    }
+    machine.isrCount = static_cast<uint8_t>(std::min<uint32_t>(32U, machine.isrCount + count));
+    if (config.autopush && machine.isrCount >= config.pushThreshold && machine.rx.push(machine.isr))
+    {
+      machine.isr = 0;
+      machine.isrCount = 0;
+    }
+    break;
+  }
+  case kOut:
+  {
+    if (config.autopull && machine.osrCount >= config.pullThreshold)
+    {
+      if (!PopTx(machine, machine.osr))
+      {
+        outcome.stalled = true;
+        break;
+      }
+      machine.osrCount = 0;
+    }
+    const uint8_t count = arg2 == 0 ? 32 : arg2;
+    uint32_t data = 0;
+    if (count == 32)
+    {
+      data = machine.osr;
+      machine.osr = 0;
+    }
+    else if (config.outShiftRight)
+    {
+      data = machine.osr & Mask(count);
+      machine.osr >>= count;
+    }
+    else
+    {
+      data = machine.osr >> (32U - count);
+      machine.osr <<= count;
+    }
+    machine.osrCount = static_cast<uint8_t>(std::min<uint32_t>(32U, machine.osrCount + count));
+    switch (arg1)
+    {
+    case 0:
+      writePins(config.outBase, std::min(count, config.outCount), data, cycle);
+      break;
+    case 1:
+      machine.x = data;
+      break;
+    case 2:
+      machine.y = data;
+      break;
+    case 5:
+      machine.pc = static_cast<uint8_t>(data % kPioInstructionCount);
+      outcome.jumped = true;
+      break;
+    case 6:
+      machine.isr = data;
+      machine.isrCount = count;
+      break;
+    case 7:
+      machine.execPending = true;
+      machine.execInstruction = static_cast<uint16_t>(data);
+      break;
+    default:
+      break;
+    }
+    break;
+  }
+  case kPushPull:
+  {
+    const bool pull = (instruction & 0x80u) != 0;
+    const bool conditional = (instruction & 0x40u) != 0;
+    const bool block = (instruction & 0x20u) != 0;
+    if (pull)
+    {
+      if (conditional && machine.osrCount < config.pullThreshold)
+      {
+        break;
+      }
+      if (!PopTx(machine, machine.osr))
+      {
+        if (block)
+        {
+          outcome.stalled = true;
+          break;
+        }
+        machine.osr = machine.x;
+      }
+      machine.osrCount = 0;
+    }
+    else
+    {
+      if (conditional && machine.isrCount < config.pushThreshold)
+      {
+        break;
+      }
+      if (machine.rx.full() && block)
+      {
+        outcome.stalled = true;
+        break;
+      }
+      machine.rx.push(machine.isr);
+      machine.isr = 0;
+      machine.isrCount = 0;
+    }
+    break;
+  }
+  case kMov:
+  {
+    const uint8_t op = static_cast<uint8_t>((instruction >> 3) & 0x3u);
+    uint32_t data = 0;
+    switch (instruction & 0x7u)
+    {
+    case 0:
+      data = readPins(config.inBase);
+      break;
+    case 1:
+      data = machine.x;
+      break;
+    case 2:
+      data = machine.y;
+      break;
+    case 5:
+    {
+      const std::size_t level = config.statusOnRx ? machine.rx.level() : machine.tx.level();
+      data = level < config.statusLevel ? 0xFFFFFFFFu : 0u;
+      break;
+    }
+    case 6:
+      data = machine.isr;
+      break;
+    case 7:
+      data = machine.osr;
+      break;
+    default:
+      break;
+    }
+    if (op == 1)
+    {
+      data = ~data;
+    }
+    else if (op == 2)
+    {
+      data = BitReverse(data);
+    }
+    switch (arg1)
+    {
+    case 0:
+      writePins(config.outBase, config.outCount, data, cycle);
+      break;
+    case 1:
+      machine.x = data;
+      break;
+    case 2:
+      machine.y = data;
+      break;
+    case 4:
+      machine.execPending = true;
+      machine.execInstruction = static_cast<uint16_t>(data);
+      break;
+    case 5:
+      machine.pc = static_cast<uint8_t>(data % kPioInstructionCount);
+      outcome.jumped = true;
+      break;
+    case 6:
+      machine.isr = data;
+      machine.isrCount = 0;
+      break;
+    case 7:
+      machine.osr = data;
+      machine.osrCount = 0;
+      break;
+    default:
+      break;
+    }
+    break;
+  }
+  case kIrq:
+  {
+    const bool clear = (instruction & 0x40u) != 0;
+    const bool wait = (instruction & 0x20u) != 0;
+    const uint8_t flag = irqIndex(sm, arg2);
+    if (clear)
+    {
+      clearIrqFlags(static_cast<uint8_t>(1U << flag));
+      break;
+    }
+    if (!machine.irqWaiting)
+    {
+      setIrqFlag(flag);
+      machine.irqWaiting = wait;
+      signalIrq0(cycle);
+    }
+    if (machine.irqWaiting)
+    {
+      if ((irqFlags_ >> flag) & 1U)
+      {
+        outcome.stalled = true;
+        break;
+      }
+      machine.irqWaiting = false;
+    }
+    break;
+  }
+  case kSet:
+    switch (arg1)
+    {
+    case 0:
+      writePins(config.setBase, config.setCount, arg2, cycle);
+      break;
+    case 1:
+      machine.x = arg2;
+      break;
+    case 2:
+      machine.y = arg2;
+      break;
+    default:
+      break;
+    }
+    break;
+  default:
+    break;
+  }
+
+  // Forced instructions (SMx_INSTR, EXEC) leave the PC alone unless they jump.
+  if (!outcome.stalled && !outcome.jumped && !forced)
+  {
+    advancePc(machine);
+  }
+  return outcome;
+}
+
+} // namespace sim
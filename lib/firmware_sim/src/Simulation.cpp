@@ -0,0 +1,70 @@
+#include "sim/Simulation.hpp"
+
+#include <string>
+
+namespace sim
+{
+
+Simulation::Simulation(EntryPoint setup, EntryPoint loop, const SimulationOptions &options)
+    : setup_(setup), loop_(loop), options_(options)
+{
+  if (options_.loopPeriodUs == 0)
+  {
+    options_.loopPeriodUs = 1;
+  }
+}
+
+void Simulation::boot()
+{
+  board().reset();
+  loops_ = 0;
+  setup_();
+  // One pass with the port closed, then the host opens it: the firmware sees
+  // a connect edge on every boot, including a re-boot of the same image.
+  step();
+  board().serial().setConnected(true);
+}
+
+void Simulation::step()
+{
+  board().advance(MicrosToCycles(options_.loopPeriodUs));
+  loop_();
+  ++loops_;
+}
+
+void Simulation::run(uint64_t micros)
+{
+  const uint64_t end = board().micros() + micros;
+  while (board().micros() < end)
+  {
+    step();
+  }
+}
+
+bool Simulation::runUntilLine(std::string_view prefix, uint64_t timeoutMicros)
+{
+  std::deque<OutputLine> &lines = board().serial().lines();
+  std::size_t seen = lines.size();
+  const uint64_t end = board().micros() + timeoutMicros;
+  while (board().micros() < end)
+  {
+    step();
+    for (; seen < lines.size(); ++seen)
+    {
+      if (std::string_view(lines[seen].text).substr(0, prefix.size()) == prefix)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void Simulation::send(std::string_view line)
+{
+  SerialPort &serial = board().serial();
+  serial.hostWrite(line);
+  serial.hostWrite("\n");
+}
+
+} // namespace sim
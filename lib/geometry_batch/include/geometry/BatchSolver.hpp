@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "geometry/Targeting.hpp"
+#include "motion/MotorManager.hpp"
+
+// Host-only batch targeting for multi-panel walls. Mirrors are stored as
+// structure-of-arrays so the solver can run four mirrors per SIMD lane group
+// (GCC/Clang vector extensions: SSE on x86, NEON on ARM hosts). Results use the
+// same step convention as geometry::SolveMirror and can be scattered into
+// per-deck channel targets for MotorManager::queueMove.
+namespace geometry
+{
+
+struct MirrorBatch
+{
+  std::vector<float> xMm;
+  std::vector<float> yMm;
+  std::vector<float> incomingX;
+  std::vector<float> incomingY;
+  std::vector<float> incomingZ;
+  std::vector<float> stepsPerTurn;
+  std::vector<int32_t> yawZeroSteps;
+  std::vector<int32_t> pitchZeroSteps;
+  std::vector<uint16_t> deck;
+  std::vector<uint8_t> yawChannel;
+  std::vector<uint8_t> pitchChannel;
+
+  std::size_t size() const { return xMm.size(); }
+  void resize(std::size_t count);
+  void assign(std::size_t index, uint16_t deckIndex, const MirrorPose &pose);
+};
+
+// One wall point per mirror for the frame being solved.
+struct TargetBatch
+{
+  std::vector<float> xMm;
+  std::vector<float> yMm;
+  std::vector<float> distanceMm;
+
+  std::size_t size() const { return xMm.size(); }
+  void resize(std::size_t count);
+};
+
+struct BatchTargets
+{
+  std::vector<int32_t> yawSteps;
+  std::vector<int32_t> pitchSteps;
+  std::vector<TargetStatus> status;
+
+  void resize(std::size_t count);
+};
+
+// Step targets for one deck, ready for queueMove; only channels whose bit is
+// set in `assigned` received a reachable target this frame.
+struct DeckFrame
+{
+  std::array<int32_t, motion::kChannelCount> target{};
+  std::array<uint32_t, (motion::kChannelCount + 31) / 32> assigned{};
+
+  bool hasTarget(std::size_t channel) const { return (assigned[channel / 32] >> (channel % 32)) & 1U; }
+};
+
+// Fixed worker pool for parallel-for over index ranges. Workers and the
+// calling thread pull `grain`-sized tasks until the range is exhausted.
+class ThreadPool
+{
+public:
+  explicit ThreadPool(std::size_t workers);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  std::size_t concurrency() const { return workers_.size() + 1; }
+  // Splits [0, count) into `grain`-aligned ranges and blocks until all ran.
+  void parallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)> &body);
+
+private:
+  void workerLoop();
+  void runTasks();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t, std::size_t)> *body_ = nullptr;
+  std::size_t count_ = 0;
+  std::size_t grain_ = 1;
+  std::atomic<std::size_t> nextTask_{0};
+  std::size_t pending_ = 0;
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+};
+
+class BatchSolver
+{
+public:
+  // Mirrors per task handed to a worker; a multiple of the SIMD width.
+  static constexpr std::size_t kPanelGrain = 256;
+
+  // `threads` == 0 picks std::thread::hardware_concurrency().
+  explicit BatchSolver(std::size_t threads = 0);
+
+  std::size_t threads() const { return pool_.concurrency(); }
+
+  void solve(const MirrorBatch &mirrors, const TargetBatch &targets, const StepLimits &limits, BatchTargets &out);
+  // Single-threaded SIMD kernel over [begin, end); exposed for benchmarks.
+  static void SolveRange(const MirrorBatch &mirrors,
+                         const TargetBatch &targets,
+                         const StepLimits &limits,
+                         BatchTargets &out,
+                         std::size_t begin,
+                         std::size_t end);
+
+private:
+  ThreadPool pool_;
+};
+
+// Scatters reachable results into per-deck channel targets. `decks` is
+// resized to the highest deck index + 1.
+void ScatterToDecks(const MirrorBatch &mirrors, const BatchTargets &results, std::vector<DeckFrame> &decks);
+
+} // namespace geometry
@@ -0,0 +1,330 @@
+#include "geometry/BatchSolver.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace geometry
+{
+
+namespace
+{
+
+using Float4 = float __attribute__((vector_size(16)));
+using Int4 = int32_t __attribute__((vector_size(16)));
+
+constexpr std::size_t kLanes = 4;
+constexpr float kPi = 3.14159265358979f;
+constexpr float kHalfPi = 1.57079632679490f;
+constexpr float kTwoPi = 6.28318530717959f;
+constexpr float kMaxCoordinate = static_cast<float>(kMaxCoordinateMm);
+
+Float4 Splat(float value)
+{
+  return Float4{value, value, value, value};
+}
+
+Float4 Load(const std::vector<float> &source, std::size_t index, std::size_t lanes, float fill)
+{
+  Float4 result = Splat(fill);
+  std::memcpy(&result, source.data() + index, lanes * sizeof(float));
+  return result;
+}
+
+Int4 Load(const std::vector<int32_t> &source, std::size_t index, std::size_t lanes)
+{
+  Int4 result{0, 0, 0, 0};
+  std::memcpy(&result, source.data() + index, lanes * sizeof(int32_t));
+  return result;
+}
+
+Float4 Select(Int4 mask, Float4 whenTrue, Float4 whenFalse)
+{
+  return reinterpret_cast<Float4>((mask & reinterpret_cast<Int4>(whenTrue)) | (~mask & reinterpret_cast<Int4>(whenFalse)));
+}
+
+Float4 Abs(Float4 value)
+{
+  return reinterpret_cast<Float4>(reinterpret_cast<Int4>(value) & Int4{0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF});
+}
+
+// Bit-trick seed plus three Newton steps: full float precision, no divide.
+Float4 InverseSqrt(Float4 value)
+{
+  Float4 estimate = reinterpret_cast<Float4>(Int4{0x5F3759DF, 0x5F3759DF, 0x5F3759DF, 0x5F3759DF} -
+                                             (reinterpret_cast<Int4>(value) >> 1));
+  const Float4 half = value * 0.5f;
+  for (int i = 0; i < 3; ++i)
+  {
+    estimate = estimate * (1.5f - (half * estimate * estimate));
+  }
+  return estimate;
+}
+
+// Octant-reduced odd polynomial (A&S 4.4.49 family), |error| < 1e-5 rad.
+Float4 Atan2(Float4 y, Float4 x)
+{
+  const Float4 ax = Abs(x);
+  const Float4 ay = Abs(y);
+  const Int4 steep = ay > ax;
+  const Float4 high = Select(steep, ay, ax);
+  const Float4 low = Select(steep, ax, ay);
+  const Float4 t = low / Select(high > 0.0f, high, Splat(1.0f));
+  const Float4 s = t * t;
+  Float4 poly = Splat(-0.0117212f);
+  poly = (poly * s) + 0.05265332f;
+  poly = (poly * s) - 0.11643287f;
+  poly = (poly * s) + 0.19354346f;
+  poly = (poly * s) - 0.33262347f;
+  poly = (poly * s) + 0.99997726f;
+  Float4 angle = poly * t;
+  angle = Select(steep, kHalfPi - angle, angle);
+  angle = Select(x < 0.0f, kPi - angle, angle);
+  return Select(y < 0.0f, -angle, angle);
+}
+
+Int4 RoundToSteps(Float4 angle, Float4 stepsPerRadian)
+{
+  const Float4 scaled = angle * stepsPerRadian;
+  return __builtin_convertvector(scaled + Select(scaled < 0.0f, Splat(-0.5f), Splat(0.5f)), Int4);
+}
+
+Int4 OutOfRange(Float4 value)
+{
+  return (value > kMaxCoordinate) | (value < -kMaxCoordinate);
+}
+
+} // namespace
+
+void MirrorBatch::resize(std::size_t count)
+{
+  xMm.resize(count);
+  yMm.resize(count);
+  incomingX.resize(count);
+  incomingY.resize(count);
+  incomingZ.resize(count, -1.0f);
+  stepsPerTurn.resize(count, static_cast<float>(kDefaultStepsPerTurn));
+  yawZeroSteps.resize(count);
+  pitchZeroSteps.resize(count);
+  deck.resize(count);
+  yawChannel.resize(count);
+  pitchChannel.resize(count);
+}
+
+void MirrorBatch::assign(std::size_t index, uint16_t deckIndex, const MirrorPose &pose)
+{
+  xMm[index] = static_cast<float>(pose.xMm);
+  yMm[index] = static_cast<float>(pose.yMm);
+  incomingX[index] = static_cast<float>(pose.incoming.x) / kUnitQ14;
+  incomingY[index] = static_cast<float>(pose.incoming.y) / kUnitQ14;
+  incomingZ[index] = static_cast<float>(pose.incoming.z) / kUnitQ14;
+  stepsPerTurn[index] = static_cast<float>(pose.stepsPerTurn);
+  yawZeroSteps[index] = pose.yawZeroSteps;
+  pitchZeroSteps[index] = pose.pitchZeroSteps;
+  deck[index] = deckIndex;
+  yawChannel[index] = pose.yawChannel;
+  pitchChannel[index] = pose.pitchChannel;
+}
+
+void TargetBatch::resize(std::size_t count)
+{
+  xMm.resize(count);
+  yMm.resize(count);
+  distanceMm.resize(count);
+}
+
+void BatchTargets::resize(std::size_t count)
+{
+  yawSteps.resize(count);
+  pitchSteps.resize(count);
+  status.resize(count, TargetStatus::InvalidTarget);
+}
+
+ThreadPool::ThreadPool(std::size_t workers)
+{
+  workers_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i)
+  {
+    workers_.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)> &body)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  grain = std::max<std::size_t>(grain, 1);
+  if (workers_.empty() || count <= grain)
+  {
+    body(0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_ = &body;
+    count_ = count;
+    grain_ = grain;
+    nextTask_.store(0, std::memory_order_relaxed);
+    pending_ = workers_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+  runTasks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this]() { return pending_ == 0; });
+  body_ = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+  uint64_t seen = 0;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+      if (stopping_)
+      {
+        return;
+      }
+      seen = generation_;
+    }
+    runTasks();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0)
+    {
+      done_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::runTasks()
+{
+  const std::size_t taskCount = (count_ + grain_ - 1) / grain_;
+  for (;;)
+  {
+    const std::size_t task = nextTask_.fetch_add(1, std::memory_order_relaxed);
+    if (task >= taskCount)
+    {
+      return;
+    }
+    const std::size_t begin = task * grain_;
+    (*body_)(begin, std::min(begin + grain_, count_));
+  }
+}
+
+BatchSolver::BatchSolver(std::size_t threads)
+    : pool_((threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads) - 1)
+{
+}
+
+void BatchSolver::solve(const MirrorBatch &mirrors, const TargetBatch &targets, const StepLimits &limits, BatchTargets &out)
+{
+  const std::size_t count = std::min(mirrors.size(), targets.size());
+  out.resize(count);
+  pool_.parallelFor(count, kPanelGrain, [&](std::size_t begin, std::size_t end)
+                    { SolveRange(mirrors, targets, limits, out, begin, end); });
+}
+
+void BatchSolver::SolveRange(const MirrorBatch &mirrors,
+                             const TargetBatch &targets,
+                             const StepLimits &limits,
+                             BatchTargets &out,
+                             std::size_t begin,
+                             std::size_t end)
+{
+  const Int4 negativeLimit = Int4{0, 0, 0, 0} + limits.negative;
+  const Int4 positiveLimit = Int4{0, 0, 0, 0} + limits.positive;
+
+  for (std::size_t index = begin; index < end; index += kLanes)
+  {
+    const std::size_t lanes = std::min(kLanes, end - index);
+    const Float4 targetX = Load(targets.xMm, index, lanes, 0.0f);
+    const Float4 targetY = Load(targets.yMm, index, lanes, 0.0f);
+    const Float4 distance = Load(targets.distanceMm, index, lanes, 1.0f);
+    const Float4 mirrorX = Load(mirrors.xMm, index, lanes, 0.0f);
+    const Float4 mirrorY = Load(mirrors.yMm, index, lanes, 0.0f);
+
+    const Float4 outX = targetX - mirrorX;
+    const Float4 outY = targetY - mirrorY;
+    const Float4 inverseLength = InverseSqrt((outX * outX) + (outY * outY) + (distance * distance));
+
+    const Float4 normalX = (outX * inverseLength) - Load(mirrors.incomingX, index, lanes, 0.0f);
+    const Float4 normalY = (outY * inverseLength) - Load(mirrors.incomingY, index, lanes, 0.0f);
+    const Float4 normalZ = (distance * inverseLength) - Load(mirrors.incomingZ, index, lanes, -1.0f);
+    const Float4 horizontalSquared = (normalX * normalX) + (normalZ * normalZ);
+    const Float4 horizontal = horizontalSquared * InverseSqrt(Select(horizontalSquared > 0.0f, horizontalSquared, Splat(1.0f)));
+
+    const Float4 stepsPerRadian = Load(mirrors.stepsPerTurn, index, lanes, 1.0f) / kTwoPi;
+    const Int4 yaw = RoundToSteps(Atan2(normalX, normalZ), stepsPerRadian) + Load(mirrors.yawZeroSteps, index, lanes);
+    const Int4 pitch = RoundToSteps(Atan2(normalY, horizontal), stepsPerRadian) + Load(mirrors.pitchZeroSteps, index, lanes);
+
+    const Int4 invalid = (distance <= 0.0f) | OutOfRange(distance) | OutOfRange(targetX) | OutOfRange(targetY) |
+                         OutOfRange(mirrorX) | OutOfRange(mirrorY) |
+                         OutOfRange(outX) | OutOfRange(outY) | (normalZ <= 0.0f);
+    const Int4 yawOut = (yaw < negativeLimit) | (yaw > positiveLimit);
+    const Int4 pitchOut = (pitch < negativeLimit) | (pitch > positiveLimit);
+
+    for (std::size_t lane = 0; lane < lanes; ++lane)
+    {
+      const std::size_t slot = index + lane;
+      out.yawSteps[slot] = yaw[lane];
+      out.pitchSteps[slot] = pitch[lane];
+      out.status[slot] = invalid[lane]   ? TargetStatus::InvalidTarget
+                         : yawOut[lane]  ? TargetStatus::YawOutOfRange
+                         : pitchOut[lane] ? TargetStatus::PitchOutOfRange
+                                          : TargetStatus::Reachable;
+    }
+  }
+}
+
+void ScatterToDecks(const MirrorBatch &mirrors, const BatchTargets &results, std::vector<DeckFrame> &decks)
+{
+  const std::size_t count = std::min(mirrors.size(), results.status.size());
+  std::size_t deckCount = 0;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    deckCount = std::max<std::size_t>(deckCount, mirrors.deck[i] + 1U);
+  }
+  decks.assign(deckCount, DeckFrame{});
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (results.status[i] != TargetStatus::Reachable)
+    {
+      continue;
+    }
+    DeckFrame &frame = decks[mirrors.deck[i]];
+    const std::size_t channels[] = {mirrors.yawChannel[i], mirrors.pitchChannel[i]};
+    const int32_t steps[] = {results.yawSteps[i], results.pitchSteps[i]};
+    for (std::size_t axis = 0; axis < 2; ++axis)
+    {
+      if (channels[axis] >= motion::kChannelCount)
+      {
+        continue;
+      }
+      frame.target[channels[axis]] = steps[axis];
+      frame.assigned[channels[axis] / 32] |= 1U << (channels[axis] % 32);
+    }
+  }
+}
+
+} // namespace geometry
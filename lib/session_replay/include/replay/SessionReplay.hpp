@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "diag/SessionRecorder.hpp"
+
+namespace replay
+{
+
+struct SessionLine
+{
+  uint64_t atUs = 0; // service() time since REC:START
+  std::string text;
+};
+
+struct Session
+{
+  std::vector<diag::RecordedChannel> channels;
+  std::vector<SessionLine> lines;
+};
+
+enum class ParseStatus : uint8_t
+{
+  Ok = 0,
+  Truncated,
+  UnsupportedVersion
+};
+
+ParseStatus ParseSession(const uint8_t *data, std::size_t length, Session &out);
+const char *ParseStatusLabel(ParseStatus status);
+
+// Collects the bytes from a captured serial transcript: every REC:DATA= line
+// in order, other lines ignored. Raw binary logs can be passed straight to
+// ParseSession instead.
+std::vector<uint8_t> ReadDump(std::istream &in);
+
+struct ReplayOptions
+{
+  // Virtual service() period. The deck's loop ticks irregularly, so homing
+  // stage boundaries can differ from the hardware by up to one tick.
+  uint32_t tickUs = 1000;
+  // Extra virtual time after the last line so trailing motion can finish.
+  uint64_t settleUs = 5'000'000;
+  bool traceMotion = true;
+};
+
+// Deterministic record of a replay, one event per line:
+//   "<us> > <command>"                       input line
+//   "<us> < <response>"                      response, DELTA or EVT push
+//   "<us> M CH=<c> STATE=<s> POS=<p> TARGET=<t> SLEEP=<0|1>"   motion edge
+struct Transcript
+{
+  std::vector<std::string> lines;
+  uint64_t virtualUs = 0;
+  uint64_t serviceCalls = 0;
+};
+
+Transcript Replay(const Session &session, const ReplayOptions &options);
+
+struct TranscriptDiff
+{
+  bool equal = true;
+  std::size_t line = 0; // first differing line, 0-based
+  std::string expected;
+  std::string actual;
+};
+
+TranscriptDiff Diff(const std::vector<std::string> &expected, const std::vector<std::string> &actual);
+
+} // namespace replay
@@ -0,0 +1,323 @@
+#include "replay/SessionReplay.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "control/CommandProcessor.hpp"
+
+namespace replay
+{
+
+namespace
+{
+
+class Reader
+{
+public:
+  Reader(const uint8_t *data, std::size_t length) : data_(data), length_(length) {}
+
+  bool byte(uint8_t &out)
+  {
+    if (offset_ >= length_)
+    {
+      return false;
+    }
+    out = data_[offset_++];
+    return true;
+  }
+
+  bool i32(int32_t &out)
+  {
+    if (length_ - offset_ < 4)
+    {
+      return false;
+    }
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      value |= static_cast<uint32_t>(data_[offset_ + i]) << (8U * i);
+    }
+    offset_ += 4;
+    out = static_cast<int32_t>(value);
+    return true;
+  }
+
+  bool varint(uint64_t &out)
+  {
+    out = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+      uint8_t b = 0;
+      if (!byte(b))
+      {
+        return false;
+      }
+      out |= static_cast<uint64_t>(b & 0x7FU) << shift;
+      if ((b & 0x80U) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool text(std::size_t length, std::string &out)
+  {
+    if (length_ - offset_ < length)
+    {
+      return false;
+    }
+    out.assign(reinterpret_cast<const char *>(data_ + offset_), length);
+    offset_ += length;
+    return true;
+  }
+
+  bool skip(std::size_t length)
+  {
+    if (length_ - offset_ < length)
+    {
+      return false;
+    }
+    offset_ += length;
+    return true;
+  }
+
+  bool done() const { return offset_ == length_; }
+
+private:
+  const uint8_t *data_;
+  std::size_t length_;
+  std::size_t offset_ = 0;
+};
+
+const char *PhaseLabel(motion::MotionPhase phase)
+{
+  switch (phase)
+  {
+  case motion::MotionPhase::Idle:
+    return "IDLE";
+  case motion::MotionPhase::Moving:
+    return "MOVING";
+  case motion::MotionPhase::Homing:
+    return "HOMING";
+  }
+  return "UNKNOWN";
+}
+
+std::string Stamp(uint64_t atUs, char kind, const char *text)
+{
+  char prefix[32];
+  std::snprintf(prefix, sizeof(prefix), "%llu %c ", static_cast<unsigned long long>(atUs), kind);
+  return std::string(prefix) + text;
+}
+
+void AppendResponse(uint64_t atUs, const ctrl::CommandProcessor::Response &response, Transcript &out)
+{
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    out.lines.push_back(Stamp(atUs, '<', response.lines[i].data()));
+  }
+}
+
+} // namespace
+
+ParseStatus ParseSession(const uint8_t *data, std::size_t length, Session &out)
+{
+  out = Session{};
+  Reader reader(data, length);
+  uint8_t version = 0;
+  uint8_t channelCount = 0;
+  uint8_t channelBytes = 0;
+  uint8_t reserved = 0;
+  if (!reader.byte(version) || !reader.byte(channelCount) || !reader.byte(channelBytes) || !reader.byte(reserved))
+  {
+    return ParseStatus::Truncated;
+  }
+  if (version != diag::SessionRecorder::kVersion || channelBytes < diag::SessionRecorder::kChannelBytes)
+  {
+    return ParseStatus::UnsupportedVersion;
+  }
+
+  out.channels.resize(channelCount);
+  for (auto &channel : out.channels)
+  {
+    if (!reader.i32(channel.position) || !reader.i32(channel.zeroOffset) || !reader.i32(channel.negativeLimit) ||
+        !reader.i32(channel.positiveLimit) || !reader.skip(channelBytes - diag::SessionRecorder::kChannelBytes))
+    {
+      return ParseStatus::Truncated;
+    }
+  }
+  for (std::size_t base = 0; base < channelCount; base += 8)
+  {
+    uint8_t homed = 0;
+    if (!reader.byte(homed))
+    {
+      return ParseStatus::Truncated;
+    }
+    for (std::size_t bit = 0; bit < 8 && base + bit < channelCount; ++bit)
+    {
+      out.channels[base + bit].homed = ((homed >> bit) & 1U) != 0U;
+    }
+  }
+
+  uint64_t atUs = 0;
+  while (!reader.done())
+  {
+    uint64_t delta = 0;
+    uint64_t textLength = 0;
+    SessionLine line{};
+    if (!reader.varint(delta) || !reader.varint(textLength) || !reader.text(textLength, line.text))
+    {
+      return ParseStatus::Truncated;
+    }
+    atUs += delta;
+    line.atUs = atUs;
+    out.lines.push_back(std::move(line));
+  }
+  return ParseStatus::Ok;
+}
+
+const char *ParseStatusLabel(ParseStatus status)
+{
+  switch (status)
+  {
+  case ParseStatus::Ok:
+    return "ok";
+  case ParseStatus::Truncated:
+    return "truncated";
+  case ParseStatus::UnsupportedVersion:
+    return "unsupported version";
+  }
+  return "unknown";
+}
+
+std::vector<uint8_t> ReadDump(std::istream &in)
+{
+  static const std::string kPrefix = "REC:DATA=";
+  std::vector<uint8_t> bytes;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    const std::size_t at = line.find(kPrefix);
+    if (at == std::string::npos)
+    {
+      continue;
+    }
+    for (std::size_t i = at + kPrefix.size(); i + 1 < line.size(); i += 2)
+    {
+      unsigned value = 0;
+      if (std::sscanf(line.c_str() + i, "%2x", &value) != 1)
+      {
+        break;
+      }
+      bytes.push_back(static_cast<uint8_t>(value));
+    }
+  }
+  return bytes;
+}
+
+Transcript Replay(const Session &session, const ReplayOptions &options)
+{
+  Transcript transcript{};
+  // Heap-allocated: Response alone is a few KB.
+  auto processor = std::make_unique<ctrl::CommandProcessor>();
+  auto response = std::make_unique<ctrl::CommandProcessor::Response>();
+  auto &manager = processor->motorManager();
+
+  const std::size_t channels = std::min(session.channels.size(), ctrl::CommandProcessor::kMotorCount);
+  for (std::size_t channel = 0; channel < channels; ++channel)
+  {
+    const diag::RecordedChannel &state = session.channels[channel];
+    manager.setCalibration(channel, state.zeroOffset, state.negativeLimit, state.positiveLimit);
+    manager.restorePosition(channel, state.position, state.homed);
+  }
+
+  std::vector<motion::MotorState> last(ctrl::CommandProcessor::kMotorCount);
+  for (std::size_t channel = 0; channel < last.size(); ++channel)
+  {
+    last[channel] = manager.state(channel);
+  }
+
+  const auto traceEdges = [&](uint64_t atUs) {
+    if (!options.traceMotion)
+    {
+      return;
+    }
+    for (std::size_t channel = 0; channel < last.size(); ++channel)
+    {
+      const motion::MotorState &state = manager.state(channel);
+      if (state.phase == last[channel].phase && state.targetPosition == last[channel].targetPosition &&
+          state.asleep == last[channel].asleep)
+      {
+        continue;
+      }
+      char text[96];
+      std::snprintf(text, sizeof(text), "CH=%u STATE=%s POS=%ld TARGET=%ld SLEEP=%u",
+                    static_cast<unsigned>(channel), PhaseLabel(state.phase), static_cast<long>(state.position),
+                    static_cast<long>(state.targetPosition), state.asleep ? 1U : 0U);
+      transcript.lines.push_back(Stamp(atUs, 'M', text));
+      last[channel] = state;
+    }
+  };
+
+  uint64_t clock = 0;
+  const uint32_t tick = std::max<uint32_t>(1U, options.tickUs);
+  const auto advanceTo = [&](uint64_t targetUs) {
+    while (clock < targetUs)
+    {
+      const uint32_t step = static_cast<uint32_t>(std::min<uint64_t>(tick, targetUs - clock));
+      processor->service(step);
+      clock += step;
+      ++transcript.serviceCalls;
+      traceEdges(clock);
+      if (processor->collectUpdates(*response))
+      {
+        AppendResponse(clock, *response, transcript);
+      }
+      if (processor->collectEvents(*response))
+      {
+        AppendResponse(clock, *response, transcript);
+      }
+    }
+  };
+
+  for (const SessionLine &line : session.lines)
+  {
+    advanceTo(line.atUs);
+    transcript.lines.push_back(Stamp(clock, '>', line.text.c_str()));
+    processor->processLine(line.text, *response);
+    AppendResponse(clock, *response, transcript);
+    traceEdges(clock);
+  }
+  advanceTo(clock + options.settleUs);
+  transcript.virtualUs = clock;
+  return transcript;
+}
+
+TranscriptDiff Diff(const std::vector<std::string> &expected, const std::vector<std::string> &actual)
+{
+  TranscriptDiff diff{};
+  const std::size_t common = std::min(expected.size(), actual.size());
+  for (std::size_t i = 0; i < common; ++i)
+  {
+    if (expected[i] != actual[i])
+    {
+      diff.equal = false;
+      diff.line = i;
+      diff.expected = expected[i];
+      diff.actual = actual[i];
+      return diff;
+    }
+  }
+  if (expected.size() != actual.size())
+  {
+    diff.equal = false;
+    diff.line = common;
+    diff.expected = common < expected.size() ? expected[common] : "<end>";
+    diff.actual = common < actual.size() ? actual[common] : "<end>";
+  }
+  return diff;
+}
+
+} // namespace replay
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "diag/TraceRing.hpp"
+
+namespace trace
+{
+
+// Records keyed by their ring sequence number, so overlapping pages from
+// repeated TRACE:DUMP polls collapse into one run.
+struct Capture
+{
+  std::map<uint32_t, diag::TraceRecord> records;
+  // LOST= totals from the dump headers: overwritten before they were asked for.
+  uint64_t lost = 0;
+};
+
+// Collects every TRACE:DUMP page (header plus its TRACE:DATA lines) from a
+// serial transcript into `capture`; sequence tags and other lines are
+// skipped. Returns the number of records read.
+std::size_t ReadDump(std::istream &in, Capture &capture);
+// One header line and the data lines after it, as TRACE:DUMP returns them.
+std::size_t AddPage(const std::vector<std::string> &lines, Capture &capture);
+
+// One line per record, times relative to the first record:
+//   "<us> +<delta_us> <KIND> <fields>"
+// e.g. "      1250 +     40 LATCH   CH=0 STEPS=400". Timestamps are the deck's
+// 32-bit micros() and are unwrapped record to record. A hole in the
+// sequence numbers becomes a "-- <n> records missing --" line.
+std::vector<std::string> Timeline(const Capture &capture);
+std::string DescribeRecord(const diag::TraceRecord &record);
+
+} // namespace trace
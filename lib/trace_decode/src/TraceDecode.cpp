@@ -0,0 +1,215 @@
+#include "trace/TraceDecode.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "control/CommandProcessor.hpp"
+
+namespace trace
+{
+
+namespace
+{
+
+const std::string kHeaderPrefix = "TRACE:DUMP ";
+const std::string kDataPrefix = "TRACE:DATA=";
+
+// Drops a leading "#<seq> " echoed for tagged commands.
+std::string Untagged(const std::string &line)
+{
+  if (line.empty() || line.front() != '#')
+  {
+    return line;
+  }
+  const std::size_t space = line.find(' ');
+  return space == std::string::npos ? std::string() : line.substr(space + 1);
+}
+
+unsigned long Field(const std::string &line, const char *key)
+{
+  const std::size_t at = line.find(key);
+  return at == std::string::npos ? 0UL : std::strtoul(line.c_str() + at + std::strlen(key), nullptr, 10);
+}
+
+const char *PhaseLabel(uint8_t phase)
+{
+  switch (static_cast<motion::MotionPhase>(phase))
+  {
+  case motion::MotionPhase::Idle:
+    return "IDLE";
+  case motion::MotionPhase::Moving:
+    return "MOVING";
+  case motion::MotionPhase::Homing:
+    return "HOMING";
+  }
+  return "UNKNOWN";
+}
+
+class PageReader
+{
+public:
+  explicit PageReader(Capture &capture) : capture_(capture) {}
+
+  void line(const std::string &raw)
+  {
+    const std::string text = Untagged(raw);
+    if (text.compare(0, kHeaderPrefix.size(), kHeaderPrefix) == 0)
+    {
+      next_ = static_cast<uint32_t>(Field(text, "FROM="));
+      remaining_ = Field(text, "COUNT=");
+      capture_.lost += Field(text, "LOST=");
+      return;
+    }
+    if (text.compare(0, kDataPrefix.size(), kDataPrefix) != 0)
+    {
+      return;
+    }
+    uint8_t bytes[sizeof(diag::TraceRecord)];
+    std::size_t filled = 0;
+    for (std::size_t i = kDataPrefix.size(); i + 1 < text.size() && remaining_ != 0; i += 2)
+    {
+      unsigned value = 0;
+      if (std::sscanf(text.c_str() + i, "%2x", &value) != 1)
+      {
+        break;
+      }
+      bytes[filled++] = static_cast<uint8_t>(value);
+      if (filled == sizeof(bytes))
+      {
+        capture_.records[next_++] = diag::DecodeTraceRecord(bytes);
+        --remaining_;
+        ++read_;
+        filled = 0;
+      }
+    }
+  }
+
+  std::size_t read() const { return read_; }
+
+private:
+  Capture &capture_;
+  uint32_t next_ = 0;
+  unsigned long remaining_ = 0;
+  std::size_t read_ = 0;
+};
+
+} // namespace
+
+std::size_t ReadDump(std::istream &in, Capture &capture)
+{
+  PageReader reader(capture);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+    {
+      line.pop_back();
+    }
+    reader.line(line);
+  }
+  return reader.read();
+}
+
+std::size_t AddPage(const std::vector<std::string> &lines, Capture &capture)
+{
+  PageReader reader(capture);
+  for (const std::string &line : lines)
+  {
+    reader.line(line);
+  }
+  return reader.read();
+}
+
+std::string DescribeRecord(const diag::TraceRecord &record)
+{
+  char text[96];
+  switch (record.kind)
+  {
+  case diag::TraceKind::CommandAccepted:
+  {
+    const std::size_t verb = record.channel & static_cast<uint8_t>(~diag::kTraceTagged);
+    const char *name = ctrl::CommandProcessor::verbName(verb);
+    int length = name != nullptr ? std::snprintf(text, sizeof(text), "%s", name)
+                                 : std::snprintf(text, sizeof(text), "VERB=%zu", verb);
+    if ((record.channel & diag::kTraceTagged) != 0)
+    {
+      std::snprintf(text + length, sizeof(text) - static_cast<std::size_t>(length), " #%u",
+                    static_cast<unsigned>(record.value));
+    }
+    break;
+  }
+  case diag::TraceKind::SlotLatched:
+    std::snprintf(text, sizeof(text), "CH=%u STEPS=%u", static_cast<unsigned>(record.channel),
+                  static_cast<unsigned>(record.value));
+    break;
+  case diag::TraceKind::SlotRetired:
+    std::snprintf(text, sizeof(text), "CH=%u RETIRED=%u", static_cast<unsigned>(record.channel),
+                  static_cast<unsigned>(record.value));
+    break;
+  case diag::TraceKind::PhaseChange:
+    std::snprintf(text, sizeof(text), "CH=%u %s %s", static_cast<unsigned>(record.channel),
+                  PhaseLabel(static_cast<uint8_t>(record.value)),
+                  (record.value & 0x100U) != 0 ? "ASLEEP" : "AWAKE");
+    break;
+  case diag::TraceKind::SleepLatch:
+    std::snprintf(text, sizeof(text), "AWAKE=0x%04X", static_cast<unsigned>(record.value));
+    break;
+  case diag::TraceKind::Overrun:
+    switch (static_cast<diag::TraceOverrun>(record.channel))
+    {
+    case diag::TraceOverrun::EventQueue:
+      std::snprintf(text, sizeof(text), "EVENT_QUEUE CH=%u", static_cast<unsigned>(record.value));
+      break;
+    case diag::TraceOverrun::InputLine:
+      std::snprintf(text, sizeof(text), "INPUT_LINE");
+      break;
+    case diag::TraceOverrun::LoopStall:
+      std::snprintf(text, sizeof(text), "LOOP_STALL US=%u", static_cast<unsigned>(record.value));
+      break;
+    default:
+      std::snprintf(text, sizeof(text), "SOURCE=%u VALUE=%u", static_cast<unsigned>(record.channel),
+                    static_cast<unsigned>(record.value));
+      break;
+    }
+    break;
+  case diag::TraceKind::None:
+  case diag::TraceKind::Count:
+  default:
+    std::snprintf(text, sizeof(text), "KIND=%u CH=%u VALUE=%u", static_cast<unsigned>(record.kind),
+                  static_cast<unsigned>(record.channel), static_cast<unsigned>(record.value));
+    break;
+  }
+  return text;
+}
+
+std::vector<std::string> Timeline(const Capture &capture)
+{
+  std::vector<std::string> lines;
+  uint64_t elapsedUs = 0;
+  uint32_t previousMicros = 0;
+  uint32_t expected = 0;
+  bool first = true;
+  char text[160];
+  for (const auto &[sequence, record] : capture.records)
+  {
+    // micros() wraps every ~71 minutes; unsigned differences survive that.
+    const uint32_t deltaUs = first ? 0U : record.micros - previousMicros;
+    if (!first && sequence != expected)
+    {
+      std::snprintf(text, sizeof(text), "-- %lu records missing --", static_cast<unsigned long>(sequence - expected));
+      lines.emplace_back(text);
+    }
+    elapsedUs += deltaUs;
+    std::snprintf(text, sizeof(text), "%10llu +%7lu %-7s %s", static_cast<unsigned long long>(elapsedUs),
+                  static_cast<unsigned long>(deltaUs), diag::TraceKindLabel(record.kind),
+                  DescribeRecord(record).c_str());
+    lines.emplace_back(text);
+    previousMicros = record.micros;
+    expected = sequence + 1U;
+    first = false;
+  }
+  return lines;
+}
+
+} // namespace trace
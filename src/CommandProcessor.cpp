@@ -1,10 +1,19 @@
 #include "control/CommandProcessor.hpp"
 
+#include "control/Snapshot.hpp"
+
+#include "diag/BootLog.hpp"
+#include "diag/MemoryBudget.hpp"
+#include "diag/SessionRecorder.hpp"
+#include "diag/TraceRing.hpp"
+#include "storage/CalibrationStore.hpp"
+
 #include <algorithm>
 #include <array>
 #include <cctype>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <string_view>
 
@@ -73,10 +82,191 @@ namespace
       return "ERR_BUSY";
     case CommandProcessor::ResponseCode::DriverFault:
       return "ERR_DRIVER_FAULT";
+    case CommandProcessor::ResponseCode::Timeout:
+      return "ERR_TIMEOUT";
     }
     return "ERR_UNKNOWN";
   }
 
+  bool AnyChannel(const motion::MotorManager::ChannelMask &mask)
+  {
+    for (const uint32_t word : mask)
+    {
+      if (word != 0U)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool HasChannel(const motion::MotorManager::ChannelMask &mask, std::size_t channel)
+  {
+    return ((mask[channel / 32U] >> (channel % 32U)) & 1U) != 0U;
+  }
+
+  // Flash writes run with interrupts off, for tens of milliseconds when a
+  // sector rotates; a moving channel would miss its PIO refills meanwhile.
+  bool FindMovingChannel(const motion::MotorManager &manager, std::size_t &channel)
+  {
+    for (channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+    {
+      if (manager.state(channel).phase != motion::MotionPhase::Idle)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Hex, most significant word first, as HOME accepts it.
+  void FormatChannelMask(const motion::MotorManager::ChannelMask &mask, char *text, std::size_t capacity)
+  {
+    std::size_t written = 0;
+    for (std::size_t word = mask.size(); word-- > 0;)
+    {
+      written += static_cast<std::size_t>(std::snprintf(text + written, capacity - written,
+                                                        (written == 0) ? "%lx" : "%08lx",
+                                                        static_cast<unsigned long>(mask[word])));
+    }
+  }
+
+  // Streams frame bytes as hex into consecutive "SNAP:" lines, keeping the
+  // running checksum, so no frame-sized buffer is needed.
+  class SnapshotWriter
+  {
+  public:
+    static constexpr std::size_t kBytesPerLine = 40;
+
+    explicit SnapshotWriter(CommandProcessor::Response &out) : out_(out) {}
+
+    void put(const uint8_t *data, std::size_t length)
+    {
+      crc_ = ctrl::snapshot::UpdateChecksum(crc_, data, length);
+      emit(data, length);
+    }
+
+    void finish()
+    {
+      const uint8_t trailer[ctrl::snapshot::kTrailerBytes] = {static_cast<uint8_t>(crc_),
+                                                              static_cast<uint8_t>(crc_ >> 8)};
+      emit(trailer, sizeof(trailer));
+    }
+
+  private:
+    void emit(const uint8_t *data, std::size_t length)
+    {
+      static constexpr char kDigits[] = "0123456789ABCDEF";
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        if (column_ == 0)
+        {
+          if (out_.count >= CommandProcessor::kMaxResponseLines)
+          {
+            return;
+          }
+          std::snprintf(out_.lines[out_.count].data(), CommandProcessor::kMaxResponseLineLength, "SNAP:");
+          cursor_ = 5;
+          ++out_.count;
+        }
+        char *line = out_.lines[out_.count - 1].data();
+        line[cursor_++] = kDigits[data[i] >> 4];
+        line[cursor_++] = kDigits[data[i] & 0x0FU];
+        line[cursor_] = '\0';
+        column_ = (column_ + 1U) % kBytesPerLine;
+      }
+    }
+
+    CommandProcessor::Response &out_;
+    std::size_t column_ = 0;
+    std::size_t cursor_ = 0;
+    uint16_t crc_ = ctrl::snapshot::kChecksumSeed;
+  };
+
+  static_assert(5 + (2 * SnapshotWriter::kBytesPerLine) < CommandProcessor::kMaxResponseLineLength,
+                "SNAP line overflows a response line");
+  static_assert(1 + ((ctrl::snapshot::FrameBytes(CommandProcessor::kMotorCount) + SnapshotWriter::kBytesPerLine - 1) /
+                     SnapshotWriter::kBytesPerLine) <=
+                    CommandProcessor::kMaxResponseLines,
+                "SNAP frame does not fit in one response");
+  static_assert(CommandProcessor::kMotorCount <= 255, "SNAP header holds an 8-bit channel count");
+  static_assert(motion::MotorManager::kEventQueueCapacity + 1U <= CommandProcessor::kMaxResponseLines,
+                "A full event queue plus EVT:OVERFLOW must fit one response");
+
+  // Parses a leading "#<seq>" and strips it from `line`. The tag must be
+  // followed by whitespace or end the line.
+  bool TakeSequenceTag(std::string_view &line, motion::CommandTag &tag)
+  {
+    std::size_t digits = 1;
+    unsigned long value = 0;
+    while (digits < line.size() && std::isdigit(static_cast<unsigned char>(line[digits])) != 0)
+    {
+      value = (value * 10U) + static_cast<unsigned long>(line[digits] - '0');
+      if (value > std::numeric_limits<uint16_t>::max())
+      {
+        return false;
+      }
+      ++digits;
+    }
+    if (digits == 1 || (digits < line.size() && kWhitespace.find(line[digits]) == std::string_view::npos))
+    {
+      return false;
+    }
+    tag.sequence = static_cast<uint16_t>(value);
+    tag.valid = true;
+    line = Trim(line.substr(digits));
+    return true;
+  }
+
+  // Shifts a response line right to make room for "#<seq> ". A line already
+  // at full width loses its tail rather than the tag.
+  void PrefixSequenceTag(char *line, uint16_t sequence)
+  {
+    char prefix[CommandProcessor::kMaxTagPrefixLength + 1];
+    const std::size_t prefixLength =
+        static_cast<std::size_t>(std::snprintf(prefix, sizeof(prefix), "#%u ", static_cast<unsigned>(sequence)));
+    const std::size_t bodyLength =
+        std::min(std::strlen(line), CommandProcessor::kMaxResponseLineLength - 1 - prefixLength);
+    std::memmove(line + prefixLength, line, bodyLength);
+    std::memcpy(line, prefix, prefixLength);
+    line[prefixLength + bodyLength] = '\0';
+  }
+
+  bool EqualsIgnoreCase(std::string_view value, std::string_view upper)
+  {
+    if (value.size() != upper.size())
+    {
+      return false;
+    }
+    for (std::size_t i = 0; i < value.size(); ++i)
+    {
+      if (std::toupper(static_cast<unsigned char>(value[i])) != upper[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The recorder leaves out its own control commands.
+  bool IsRecorderCommand(std::string_view line)
+  {
+    const std::size_t colon = line.find(':');
+    return EqualsIgnoreCase(Trim(colon == std::string_view::npos ? line : line.substr(0, colon)), "REC");
+  }
+
+  diag::RecordedChannel RecordedChannelState(const void *context, std::size_t channel)
+  {
+    const auto &manager = *static_cast<const motion::MotorManager *>(context);
+    diag::RecordedChannel state{};
+    state.position = manager.state(channel).position;
+    state.zeroOffset = manager.zeroOffset(channel);
+    state.negativeLimit = manager.negativeLimit(channel);
+    state.positiveLimit = manager.positiveLimit(channel);
+    state.homed = manager.isHomed(channel);
+    return state;
+  }
+
   struct CommandHelp
   {
     const char *verb;
@@ -86,17 +276,46 @@ namespace
 
   constexpr CommandHelp kCommandHelp[] = {
       {"HELP", "HELP", "List supported verbs and payload formats."},
-      {"MOVE", "MOVE:<channel>,<position>[,<speed>[,<accel>]]", "Queue an absolute move with optional speed/accel overrides."},
-      {"HOME", "HOME:<channel>[,<travel>[,<backoff>]]", "Initiate the homing routine with optional travel/backoff overrides."},
-      {"STATUS", "STATUS[:<channel>]", "Report state, position, and last error for one or all motors."},
-      {"SLEEP", "SLEEP:<channel>", "Force a motor channel into low-power sleep."},
-      {"WAKE", "WAKE:<channel>", "Wake a motor channel before additional commands."}};
+      {"MOVE", "MOVE:<chs>,<position>[,<speed>[,<accel>]]", "Absolute move; <chs>: n, n-m, n+m, *, 0xmask"},
+      {"HOME", "HOME:<chs>[,<travel>[,<backoff>[,<parallel>]]]", "Home channels; several run in parallel."},
+      {"STATUS", "STATUS[:<chs>]", "Report state, position, and last error for some or all motors."},
+      {"SLEEP", "SLEEP:<chs>", "Force motor channels into low-power sleep in one latch."},
+      {"WAKE", "WAKE:<chs>", "Wake motor channels in one latch before additional commands."},
+      {"AIM", "AIM:<mirror>,<x_mm>,<y_mm>,<distance_mm>", "Point a mirror's yaw/pitch pair at a wall coordinate."},
+      {"CAL", "CAL:<channel>[,<zero>,<min>,<max>]", "Show or set and persist a channel's zero offset and travel window."},
+      {"SHUTDOWN", "SHUTDOWN", "Journal idle positions so the next boot can skip homing."},
+      {"BOOT", "BOOT", "Report microseconds from reset to each boot phase."},
+      {"SNAP", "SNAP", "Binary snapshot of every channel as hex SNAP: lines (see control/Snapshot.hpp)."},
+      {"REC", "REC[:START|STOP|DUMP[,<offset>]]", "Record command lines for native replay and page the log out as hex."},
+      {"SUB", "SUB[:<interval_ms>]", "Push DELTA lines for changed channels at most once per interval; 0 stops."},
+      {"EVT", "EVT[:<chs>,<0|1>]", "Turn unsolicited EVT:DONE/HOMED/FAULT lines on or off per channel."},
+      {"TRACE", "TRACE[:ON|OFF|CLEAR|DUMP[,<seq>]]", "Hot-path event trace; DUMP pages binary records out as hex."},
+      {"CACHE", "CACHE[:CLEAR]", "Profile cache hits, misses, evictions; CLEAR empties it."}};
+
+  constexpr std::size_t kVerbCount = sizeof(kCommandHelp) / sizeof(kCommandHelp[0]);
+
+  uint8_t VerbIndex(std::string_view verb)
+  {
+    for (std::size_t index = 0; index < kVerbCount; ++index)
+    {
+      if (verb == kCommandHelp[index].verb)
+      {
+        return static_cast<uint8_t>(index);
+      }
+    }
+    return static_cast<uint8_t>(diag::kTraceNoChannel & ~diag::kTraceTagged);
+  }
 
 } // namespace
 
 namespace ctrl
 {
 
+  static_assert(sizeof(CommandProcessor) <= diag::kCommandProcessorBudgetBytes,
+                "CommandProcessor outgrew its RAM budget (include/diag/MemoryBudget.hpp)");
+  static_assert(sizeof(CommandProcessor::Response) <= diag::kResponseBudgetBytes,
+                "Response outgrew its RAM budget (include/diag/MemoryBudget.hpp)");
+
   CommandProcessor::CommandProcessor()
   {
     reset();
@@ -106,6 +325,14 @@ void CommandProcessor::reset()
 {
   motorManager_.reset();
   lastResponseCodes_.fill(ResponseCode::Ok);
+  published_.fill(PublishedStatus{});
+  uptimeUs_ = 0;
+  subscriptionIntervalUs_ = 0;
+  subscriptionElapsedUs_ = 0;
+  for (std::size_t mirror = 0; mirror < kMirrorCount; ++mirror)
+  {
+    mirrorPoses_[mirror] = geometry::DefaultMirrorPose(mirror);
+  }
 }
 
   void CommandProcessor::processLine(std::string_view rawLine, Response &out)
@@ -113,15 +340,49 @@ void CommandProcessor::reset()
     out.count = 0;
 
     std::string_view line = Trim(rawLine);
-    if (line.empty())
+    if (line.size() > kMaxCommandLength)
     {
-      writeResponsePrefix(out, ResponseCode::EmptyCommand);
+      writeResponsePrefix(out, ResponseCode::PayloadTooLong);
       return;
     }
 
-    if (line.size() > kMaxCommandLength)
+    const std::string_view received = line;
+    motion::CommandTag tag{};
+    if (!line.empty() && line.front() == '#' && !TakeSequenceTag(line, tag))
     {
-      writeResponsePrefix(out, ResponseCode::PayloadTooLong);
+      // A malformed tag cannot be echoed, so the error goes out bare.
+      writeResponsePrefix(out, ResponseCode::ParseError);
+      return;
+    }
+
+    // Recorded with its tag, so a replay echoes the tags the host saw.
+    if (recorder_ != nullptr && !line.empty() && !IsRecorderCommand(line))
+    {
+      recorder_->recordLine(uptimeUs_, received);
+    }
+
+    motorManager_.setCommandTag(tag);
+    dispatchLine(line, tag, out);
+    motorManager_.setCommandTag(motion::CommandTag{});
+    if (tag.valid)
+    {
+      for (std::size_t index = 0; index < out.count; ++index)
+      {
+        PrefixSequenceTag(out.lines[index].data(), tag.sequence);
+      }
+    }
+  }
+
+  const char *CommandProcessor::verbName(std::size_t index)
+  {
+    return index < kVerbCount ? kCommandHelp[index].verb : nullptr;
+  }
+
+  void CommandProcessor::dispatchLine(std::string_view line, const motion::CommandTag &tag, Response &out)
+  {
+    if (line.empty())
+    {
+      writeResponsePrefix(out, ResponseCode::EmptyCommand);
       return;
     }
 
@@ -156,6 +417,9 @@ void CommandProcessor::reset()
       verbBuffer[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(verbView[i])));
     }
     verbBuffer[verbLength] = '\0';
+    diag::Trace(diag::TraceKind::CommandAccepted,
+                static_cast<uint8_t>(VerbIndex(verbBuffer) | (tag.valid ? diag::kTraceTagged : 0U)),
+                tag.valid ? tag.sequence : 0U);
 
     if (std::string_view(verbBuffer) == "HELP")
     {
@@ -193,12 +457,144 @@ void CommandProcessor::reset()
       return;
     }
 
+    if (std::string_view(verbBuffer) == "AIM")
+    {
+      handleAim(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "CAL")
+    {
+      handleCal(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "SHUTDOWN")
+    {
+      handleShutdown(out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "BOOT")
+    {
+      handleBoot(out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "SNAP")
+    {
+      handleSnapshot(out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "REC")
+    {
+      handleRecord(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "SUB")
+    {
+      handleSubscribe(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "EVT")
+    {
+      handleEvents(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "TRACE")
+    {
+      handleTrace(payload, out);
+      return;
+    }
+
+    if (std::string_view(verbBuffer) == "CACHE")
+    {
+      handleCache(payload, out);
+      return;
+    }
+
     writeResponsePrefix(out, ResponseCode::UnknownVerb);
   }
 
 void CommandProcessor::service(uint32_t elapsedMicros)
 {
   motorManager_.service(elapsedMicros);
+  uptimeUs_ += elapsedMicros;
+  if (subscriptionIntervalUs_ != 0)
+  {
+    const uint32_t headroom = std::numeric_limits<uint32_t>::max() - subscriptionElapsedUs_;
+    subscriptionElapsedUs_ += std::min(elapsedMicros, headroom);
+  }
+}
+
+bool CommandProcessor::collectUpdates(Response &out)
+{
+  out.count = 0;
+  if (subscriptionIntervalUs_ == 0 || subscriptionElapsedUs_ < subscriptionIntervalUs_)
+  {
+    return false;
+  }
+
+  const motion::MotorManager::ChannelMask &dirty = motorManager_.dirtyChannels();
+  for (std::size_t word = 0; word < dirty.size() && out.count < kMaxResponseLines; ++word)
+  {
+    uint32_t pending = dirty[word];
+    while (pending != 0U && out.count < kMaxResponseLines)
+    {
+      const std::size_t channel = (word * 32U) + static_cast<std::size_t>(__builtin_ctz(pending));
+      pending &= pending - 1U;
+      // Channels that do not fit stay dirty for the next push.
+      appendDelta(channel, out);
+      motorManager_.clearDirty(channel);
+    }
+  }
+
+  if (out.count == 0)
+  {
+    // Keep the interval "open" so the next change goes out immediately.
+    return false;
+  }
+  subscriptionElapsedUs_ = 0;
+  return true;
+}
+
+bool CommandProcessor::collectEvents(Response &out)
+{
+  out.count = 0;
+  motion::MotionEvent event{};
+  while (out.count < kMaxResponseLines && motorManager_.popEvent(event))
+  {
+    switch (event.kind)
+    {
+    case motion::MotionEventKind::Done:
+      appendFormatted(out, "EVT:DONE CH=%u POS=%ld", static_cast<unsigned>(event.channel),
+                      static_cast<long>(event.position));
+      break;
+    case motion::MotionEventKind::Homed:
+      appendFormatted(out, "EVT:HOMED CH=%u POS=%ld", static_cast<unsigned>(event.channel),
+                      static_cast<long>(event.position));
+      break;
+    case motion::MotionEventKind::Fault:
+      appendFormatted(out, "EVT:FAULT CH=%u POS=%ld ERR=%s", static_cast<unsigned>(event.channel),
+                      static_cast<long>(event.position), ResponseCodeLabel(mapFault(event.fault)));
+      break;
+    }
+    if (event.tag.valid)
+    {
+      PrefixSequenceTag(out.lines[out.count - 1].data(), event.tag.sequence);
+    }
+  }
+  // Dropped events were newer than everything queued, so the marker follows.
+  const uint32_t dropped = motorManager_.takeDroppedEvents();
+  if (dropped != 0U)
+  {
+    appendFormatted(out, "EVT:OVERFLOW DROPPED=%lu", static_cast<unsigned long>(dropped));
+  }
+  return out.count != 0;
 }
 
 void CommandProcessor::configureShiftRegister(const motion::ShiftRegisterPins &pins)
@@ -206,6 +602,37 @@ void CommandProcessor::configureShiftRegister(const motion::ShiftRegisterPins &p
   motorManager_.configureShiftRegister(pins);
 }
 
+bool CommandProcessor::restoreFromStore()
+{
+  if (store_ == nullptr || !store_->ready())
+  {
+    return false;
+  }
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (store_->hasCalibration(channel))
+    {
+      const storage::ChannelCalibration &calibration = store_->calibration(channel);
+      motorManager_.setCalibration(channel, calibration.zeroOffset, calibration.negativeLimit, calibration.positiveLimit);
+    }
+  }
+
+  const storage::CalibrationStore::Journal &journal = store_->lastShutdown();
+  if (!journal.clean)
+  {
+    return false;
+  }
+  bool resumed = false;
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if ((journal.homed[channel / 32U] >> (channel % 32U)) & 1U)
+    {
+      resumed = motorManager_.restorePosition(channel, journal.positions[channel]) || resumed;
+    }
+  }
+  return resumed;
+}
+
 void CommandProcessor::writeResponsePrefix(Response &out, ResponseCode code)
 {
   if (out.count >= kMaxResponseLines)
@@ -372,15 +799,19 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
       return;
     }
 
+    // A plain channel number keeps the per-channel response; any other
+    // selector moves every channel it names to the same position.
     std::size_t channel = 0;
-    if (!parseChannel(tokens[0], channel))
+    motion::MotorManager::ChannelMask mask{};
+    const bool group = !parseChannel(tokens[0], channel);
+    if (group && !parseChannelSelector(tokens[0], mask))
     {
       writeResponsePrefix(out, ResponseCode::InvalidChannel);
       return;
     }
 
-    long position = 0;
-    if (!parseInt(tokens[1], position))
+    int32_t position = 0;
+    if (!parseInt32(tokens[1], position))
     {
       writeResponsePrefix(out, ResponseCode::InvalidArgument);
       return;
@@ -407,6 +838,65 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
       }
     }
 
+    if (group)
+    {
+      motion::MotorManager::GroupMoveResult result{};
+      if (!invalidateJournal("MOVE", out))
+      {
+        return;
+      }
+      motorManager_.queueMoveGroup(mask, position, speed, accel, result);
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        if (HasChannel(result.clipped, i))
+        {
+          recordResponse(i, ResponseCode::LimitViolation);
+        }
+        else if (HasChannel(result.scheduled, i))
+        {
+          recordResponse(i, ResponseCode::Ok);
+        }
+        else if (HasChannel(result.busy, i))
+        {
+          recordResponse(i, ResponseCode::Busy);
+        }
+        else if (HasChannel(result.fault, i))
+        {
+          recordResponse(i, ResponseCode::DriverFault);
+        }
+      }
+
+      // One summary line, plus a line each for clipped and refused channels.
+      const bool busy = AnyChannel(result.busy);
+      const bool fault = AnyChannel(result.fault);
+      writeResponsePrefix(out, AnyChannel(result.scheduled) ? ResponseCode::Ok
+                               : busy                       ? ResponseCode::Busy
+                                                            : ResponseCode::DriverFault);
+      char maskText[(sizeof(mask) * 2U) + 1U];
+      FormatChannelMask(result.scheduled, maskText, sizeof(maskText));
+      appendFormatted(out, "MOVE:MASK=0x%s TARGET=%ld SPEED=%ld ACC=%ld PLAN_US=%lu", maskText,
+                      static_cast<long>(position), static_cast<long>(speed), static_cast<long>(accel),
+                      static_cast<unsigned long>(result.longestDurationUs));
+      if (AnyChannel(result.clipped))
+      {
+        FormatChannelMask(result.clipped, maskText, sizeof(maskText));
+        appendFormatted(out, "MOVE:LIMIT_CLIPPED=0x%s", maskText);
+      }
+      if (busy || fault)
+      {
+        char faultText[(sizeof(mask) * 2U) + 1U];
+        FormatChannelMask(result.busy, maskText, sizeof(maskText));
+        FormatChannelMask(result.fault, faultText, sizeof(faultText));
+        appendFormatted(out, "MOVE:BUSY=0x%s DRIVER_FAULT=0x%s", maskText, faultText);
+      }
+      return;
+    }
+
+    if (!invalidateJournal("MOVE", out))
+    {
+      recordResponse(channel, ResponseCode::DriverFault);
+      return;
+    }
     motion::TimingEstimate timing{};
     motion::MoveResult result = motorManager_.queueMove(channel, position, speed, accel, timing);
 
@@ -432,8 +922,8 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
 
     appendFormatted(out, "MOVE:CH=%u POS=%ld TARGET=%ld STATE=%s",
                     static_cast<unsigned>(channel),
-                    state.position,
-                    state.targetPosition,
+                    static_cast<long>(state.position),
+                    static_cast<long>(state.targetPosition),
                     MotionStateLabel(state.phase));
     appendFormatted(out, "MOVE:SPEED=%ld ACC=%ld PLAN_US=%lu STEPS=%lu",
                     static_cast<long>(state.speedHz),
@@ -456,9 +946,26 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     }
 
     std::size_t channel = 0;
+    motion::MotorManager::ChannelMask mask{};
     if (!parseChannel(payload, channel))
     {
-      writeResponsePrefix(out, ResponseCode::InvalidChannel);
+      if (!parseChannelSelector(payload, mask))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidChannel);
+        return;
+      }
+      motorManager_.forceSleepGroup(mask);
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        if (HasChannel(mask, i))
+        {
+          recordResponse(i, ResponseCode::Ok);
+        }
+      }
+      char maskText[(sizeof(mask) * 2U) + 1U];
+      FormatChannelMask(mask, maskText, sizeof(maskText));
+      writeResponsePrefix(out, ResponseCode::Ok);
+      appendFormatted(out, "SLEEP:MASK=0x%s STATE=SLEEP", maskText);
       return;
     }
 
@@ -478,12 +985,39 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     }
 
     std::size_t channel = 0;
+    motion::MotorManager::ChannelMask mask{};
     if (!parseChannel(payload, channel))
     {
-      writeResponsePrefix(out, ResponseCode::InvalidChannel);
+      if (!parseChannelSelector(payload, mask))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidChannel);
+        return;
+      }
+      if (!invalidateJournal("WAKE", out))
+      {
+        return;
+      }
+      motorManager_.forceWakeGroup(mask);
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        if (HasChannel(mask, i))
+        {
+          motorManager_.clearFault(i);
+          recordResponse(i, ResponseCode::Ok);
+        }
+      }
+      char maskText[(sizeof(mask) * 2U) + 1U];
+      FormatChannelMask(mask, maskText, sizeof(maskText));
+      writeResponsePrefix(out, ResponseCode::Ok);
+      appendFormatted(out, "WAKE:MASK=0x%s STATE=AWAKE", maskText);
       return;
     }
 
+    if (!invalidateJournal("WAKE", out))
+    {
+      recordResponse(channel, ResponseCode::DriverFault);
+      return;
+    }
     motorManager_.forceWake(channel);
     motorManager_.clearFault(channel);
     recordResponse(channel, ResponseCode::Ok);
@@ -504,23 +1038,57 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
       return;
     }
 
-    std::array<std::string_view, kMaxTokens> tokens{};
-    std::size_t tokenCount = 0;
-    if (!tokenize(payload, tokens, tokenCount) || tokenCount == 0 || tokenCount > 1)
+    std::size_t channel = 0;
+    if (parseChannel(Trim(payload), channel))
     {
-      writeResponsePrefix(out, ResponseCode::ParseError);
+      writeResponsePrefix(out, ResponseCode::Ok);
+      writeStatusForMotor(channel, out);
       return;
     }
 
-    std::size_t channel = 0;
-    if (!parseChannel(tokens[0], channel))
+    // Several channels: which of them are moving, homing, asleep or in
+    // error as masks, then one STATUS:CH line each without the PROFILE lines.
+    motion::MotorManager::ChannelMask mask{};
+    if (!parseChannelSelector(payload, mask))
     {
       writeResponsePrefix(out, ResponseCode::InvalidChannel);
       return;
     }
-
+    motion::MotorManager::ChannelMask moving{};
+    motion::MotorManager::ChannelMask homing{};
+    motion::MotorManager::ChannelMask asleep{};
+    motion::MotorManager::ChannelMask failing{};
+    for (std::size_t i = 0; i < kMotorCount; ++i)
+    {
+      if (!HasChannel(mask, i))
+      {
+        continue;
+      }
+      const auto &state = motorManager_.state(i);
+      const uint32_t bit = 1UL << (i % 32U);
+      moving[i / 32U] |= (state.phase == motion::MotionPhase::Moving) ? bit : 0U;
+      homing[i / 32U] |= (state.phase == motion::MotionPhase::Homing) ? bit : 0U;
+      asleep[i / 32U] |= state.asleep ? bit : 0U;
+      failing[i / 32U] |= (statusCode(i) != ResponseCode::Ok) ? bit : 0U;
+    }
+    char movingText[(sizeof(mask) * 2U) + 1U];
+    char homingText[(sizeof(mask) * 2U) + 1U];
+    char asleepText[(sizeof(mask) * 2U) + 1U];
+    char failingText[(sizeof(mask) * 2U) + 1U];
+    FormatChannelMask(moving, movingText, sizeof(movingText));
+    FormatChannelMask(homing, homingText, sizeof(homingText));
+    FormatChannelMask(asleep, asleepText, sizeof(asleepText));
+    FormatChannelMask(failing, failingText, sizeof(failingText));
     writeResponsePrefix(out, ResponseCode::Ok);
-    writeStatusForMotor(channel, out);
+    appendFormatted(out, "STATUS:MOVING=0x%s HOMING=0x%s SLEEP=0x%s ERR=0x%s", movingText, homingText, asleepText,
+                    failingText);
+    for (std::size_t i = 0; i < kMotorCount; ++i)
+    {
+      if (HasChannel(mask, i))
+      {
+        writeStatusLine(i, out);
+      }
+    }
   }
 
   void CommandProcessor::handleHome(std::string_view payload, Response &out)
@@ -533,14 +1101,17 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
 
     std::array<std::string_view, kMaxTokens> tokens{};
     std::size_t tokenCount = 0;
-    if (!tokenize(payload, tokens, tokenCount) || tokenCount < 1 || tokenCount > 3)
+    if (!tokenize(payload, tokens, tokenCount) || tokenCount < 1 || tokenCount > 4)
     {
       writeResponsePrefix(out, ResponseCode::ParseError);
       return;
     }
 
+    // Any selector other than a plain channel homes its channels concurrently.
+    motion::MotorManager::ChannelMask mask{};
     std::size_t channel = 0;
-    if (!parseChannel(tokens[0], channel))
+    const bool group = !parseChannel(tokens[0], channel);
+    if (group && !parseChannelSelector(tokens[0], mask))
     {
       writeResponsePrefix(out, ResponseCode::InvalidChannel);
       return;
@@ -553,31 +1124,54 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     if (tokenCount >= 2 && !tokens[1].empty())
     {
       long travel = request.travelRange;
-      if (!parseOptionalLong(tokens[1], travel) || travel <= 0)
+      if (!parseOptionalLong(tokens[1], travel) || travel <= 0 || travel > std::numeric_limits<int32_t>::max())
       {
         writeResponsePrefix(out, ResponseCode::InvalidArgument);
         return;
       }
-      request.travelRange = travel;
+      request.travelRange = static_cast<int32_t>(travel);
     }
 
-    if (tokenCount == 3 && !tokens[2].empty())
+    if (tokenCount >= 3 && !tokens[2].empty())
     {
       long backoff = request.backoff;
-      if (!parseOptionalLong(tokens[2], backoff) || backoff < 0)
+      if (!parseOptionalLong(tokens[2], backoff) || backoff < 0 || backoff > std::numeric_limits<int32_t>::max())
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      request.backoff = static_cast<int32_t>(backoff);
+    }
+
+    long concurrency = static_cast<long>(motion::MotorManager::kDefaultHomingConcurrency);
+    if (tokenCount == 4 && !tokens[3].empty())
+    {
+      if (!group || !parseOptionalLong(tokens[3], concurrency) || concurrency <= 0 ||
+          concurrency > static_cast<long>(kMotorCount))
       {
         writeResponsePrefix(out, ResponseCode::InvalidArgument);
         return;
       }
-      request.backoff = backoff;
     }
 
-    motion::MoveResult result = motorManager_.beginHoming(channel, request);
+    if (!invalidateJournal("HOME", out))
+    {
+      if (!group)
+      {
+        recordResponse(channel, ResponseCode::DriverFault);
+      }
+      return;
+    }
+    motion::MoveResult result = group ? motorManager_.beginHomingGroup(mask, request, static_cast<std::size_t>(concurrency))
+                                      : motorManager_.beginHoming(channel, request);
     if (result == motion::MoveResult::Busy)
     {
       writeResponsePrefix(out, ResponseCode::Busy);
       appendLine(out, "HOME:ERR=BUSY");
-      recordResponse(channel, ResponseCode::Busy);
+      if (!group)
+      {
+        recordResponse(channel, ResponseCode::Busy);
+      }
       return;
     }
 
@@ -585,16 +1179,661 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     {
       writeResponsePrefix(out, ResponseCode::DriverFault);
       appendLine(out, "HOME:ERR=DRIVER_FAULT");
-      recordResponse(channel, ResponseCode::DriverFault);
+      if (!group)
+      {
+        recordResponse(channel, ResponseCode::DriverFault);
+      }
       return;
     }
 
-    recordResponse(channel, ResponseCode::Ok);
     writeResponsePrefix(out, ResponseCode::Ok);
+    if (group)
+    {
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        if ((mask[i / 32U] >> (i % 32U)) & 1U)
+        {
+          recordResponse(i, ResponseCode::Ok);
+        }
+      }
+      char maskText[(sizeof(mask) * 2U) + 1U];
+      FormatChannelMask(mask, maskText, sizeof(maskText));
+      appendFormatted(out, "HOME:MASK=0x%s RANGE=%ld BACKOFF=%ld CONCURRENCY=%ld",
+                      maskText,
+                      static_cast<long>(request.travelRange),
+                      static_cast<long>(request.backoff),
+                      concurrency);
+      return;
+    }
+
+    recordResponse(channel, ResponseCode::Ok);
     appendFormatted(out, "HOME:CH=%u RANGE=%ld BACKOFF=%ld",
                     static_cast<unsigned>(channel),
-                    request.travelRange,
-                    request.backoff);
+                    static_cast<long>(request.travelRange),
+                    static_cast<long>(request.backoff));
+  }
+
+  void CommandProcessor::handleAim(std::string_view payload, Response &out)
+  {
+    if (payload.empty())
+    {
+      writeResponsePrefix(out, ResponseCode::MissingPayload);
+      return;
+    }
+
+    std::array<std::string_view, kMaxTokens> tokens{};
+    std::size_t tokenCount = 0;
+    if (!tokenize(payload, tokens, tokenCount) || tokenCount != 4)
+    {
+      writeResponsePrefix(out, ResponseCode::ParseError);
+      return;
+    }
+
+    long mirror = 0;
+    if (!parseInt(tokens[0], mirror) || mirror < 0 || mirror >= static_cast<long>(kMirrorCount))
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidChannel);
+      return;
+    }
+
+    geometry::WallTarget target{};
+    if (!parseInt32(tokens[1], target.xMm) || !parseInt32(tokens[2], target.yMm) ||
+        !parseInt32(tokens[3], target.distanceMm))
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidArgument);
+      return;
+    }
+
+    const geometry::MirrorPose &pose = mirrorPoses_[static_cast<std::size_t>(mirror)];
+    const geometry::StepLimits yawLimits{motorManager_.negativeLimit(pose.yawChannel),
+                                         motorManager_.positiveLimit(pose.yawChannel)};
+    const geometry::StepLimits pitchLimits{motorManager_.negativeLimit(pose.pitchChannel),
+                                           motorManager_.positiveLimit(pose.pitchChannel)};
+    const geometry::AxisTargets axes = geometry::SolveMirror(pose, target, yawLimits, pitchLimits);
+    if (axes.status == geometry::TargetStatus::InvalidTarget)
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidArgument);
+      return;
+    }
+    if (axes.status != geometry::TargetStatus::Reachable)
+    {
+      // Reject the whole pair rather than clipping one axis off target.
+      writeResponsePrefix(out, ResponseCode::LimitViolation);
+      appendFormatted(out, "AIM:UNREACHABLE MIRROR=%ld REASON=%s YAW=%ld PITCH=%ld",
+                      mirror,
+                      geometry::TargetStatusLabel(axes.status),
+                      static_cast<long>(axes.yawSteps),
+                      static_cast<long>(axes.pitchSteps));
+      recordResponse(pose.yawChannel, ResponseCode::LimitViolation);
+      recordResponse(pose.pitchChannel, ResponseCode::LimitViolation);
+      return;
+    }
+
+    // Both axes or neither: a refusal on either leaves the other untouched.
+    const motion::MoveResult yawReadiness = motorManager_.moveReadiness(pose.yawChannel);
+    const motion::MoveResult pitchReadiness = motorManager_.moveReadiness(pose.pitchChannel);
+    if (yawReadiness == motion::MoveResult::Fault || pitchReadiness == motion::MoveResult::Fault)
+    {
+      writeResponsePrefix(out, ResponseCode::DriverFault);
+      appendLine(out, "AIM:ERR=DRIVER_FAULT");
+      recordResponse(pose.yawChannel, ResponseCode::DriverFault);
+      recordResponse(pose.pitchChannel, ResponseCode::DriverFault);
+      return;
+    }
+    if (yawReadiness == motion::MoveResult::Busy || pitchReadiness == motion::MoveResult::Busy)
+    {
+      writeResponsePrefix(out, ResponseCode::Busy);
+      appendLine(out, "AIM:ERR=BUSY");
+      recordResponse(pose.yawChannel, ResponseCode::Busy);
+      recordResponse(pose.pitchChannel, ResponseCode::Busy);
+      return;
+    }
+
+    if (!invalidateJournal("AIM", out))
+    {
+      recordResponse(pose.yawChannel, ResponseCode::DriverFault);
+      recordResponse(pose.pitchChannel, ResponseCode::DriverFault);
+      return;
+    }
+    motion::TimingEstimate yawTiming{};
+    motion::TimingEstimate pitchTiming{};
+    motorManager_.queueMove(pose.yawChannel, axes.yawSteps, kDefaultSpeedHz, kDefaultAcceleration, yawTiming);
+    motorManager_.queueMove(pose.pitchChannel, axes.pitchSteps, kDefaultSpeedHz, kDefaultAcceleration, pitchTiming);
+
+    recordResponse(pose.yawChannel, ResponseCode::Ok);
+    recordResponse(pose.pitchChannel, ResponseCode::Ok);
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "AIM:MIRROR=%ld YAW_CH=%u YAW=%ld PITCH_CH=%u PITCH=%ld PLAN_US=%lu",
+                    mirror,
+                    static_cast<unsigned>(pose.yawChannel),
+                    static_cast<long>(axes.yawSteps),
+                    static_cast<unsigned>(pose.pitchChannel),
+                    static_cast<long>(axes.pitchSteps),
+                    static_cast<unsigned long>(std::max(yawTiming.totalDurationUs, pitchTiming.totalDurationUs)));
+  }
+
+  void CommandProcessor::handleCal(std::string_view payload, Response &out)
+  {
+    if (payload.empty())
+    {
+      writeResponsePrefix(out, ResponseCode::MissingPayload);
+      return;
+    }
+
+    std::array<std::string_view, kMaxTokens> tokens{};
+    std::size_t tokenCount = 0;
+    if (!tokenize(payload, tokens, tokenCount) || (tokenCount != 1 && tokenCount != 4))
+    {
+      writeResponsePrefix(out, ResponseCode::ParseError);
+      return;
+    }
+
+    std::size_t channel = 0;
+    if (!parseChannel(tokens[0], channel))
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidChannel);
+      return;
+    }
+
+    bool saved = store_ != nullptr && store_->hasCalibration(channel);
+    if (tokenCount == 4)
+    {
+      storage::ChannelCalibration calibration{};
+      if (!parseInt32(tokens[1], calibration.zeroOffset) || !parseInt32(tokens[2], calibration.negativeLimit) ||
+          !parseInt32(tokens[3], calibration.positiveLimit) || calibration.negativeLimit > calibration.positiveLimit)
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      std::size_t moving = 0;
+      if (FindMovingChannel(motorManager_, moving))
+      {
+        writeResponsePrefix(out, ResponseCode::Busy);
+        appendFormatted(out, "CAL:ERR=BUSY CH=%u", static_cast<unsigned>(moving));
+        recordResponse(channel, ResponseCode::Busy);
+        return;
+      }
+      // setCalibration re-expresses the position against the new zero; a
+      // journal written under the old one would restore it off by the shift.
+      if (!invalidateJournal("CAL", out))
+      {
+        recordResponse(channel, ResponseCode::DriverFault);
+        return;
+      }
+      if (!motorManager_.setCalibration(channel, calibration.zeroOffset, calibration.negativeLimit,
+                                        calibration.positiveLimit))
+      {
+        writeResponsePrefix(out, ResponseCode::Busy);
+        appendLine(out, "CAL:ERR=BUSY");
+        recordResponse(channel, ResponseCode::Busy);
+        return;
+      }
+      // Applied either way; SAVED=0 tells the host it will not survive reset.
+      saved = store_ != nullptr && store_->saveCalibration(channel, calibration);
+      recordResponse(channel, ResponseCode::Ok);
+    }
+
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "CAL:CH=%u ZERO=%ld MIN=%ld MAX=%ld HOMED=%u SAVED=%u",
+                    static_cast<unsigned>(channel),
+                    static_cast<long>(motorManager_.zeroOffset(channel)),
+                    static_cast<long>(motorManager_.negativeLimit(channel)),
+                    static_cast<long>(motorManager_.positiveLimit(channel)),
+                    motorManager_.isHomed(channel) ? 1U : 0U,
+                    saved ? 1U : 0U);
+  }
+
+  void CommandProcessor::handleShutdown(Response &out)
+  {
+    if (store_ == nullptr || !store_->ready())
+    {
+      writeResponsePrefix(out, ResponseCode::NotReady);
+      return;
+    }
+
+    // Only positions at rest are worth journalling.
+    std::size_t moving = 0;
+    if (FindMovingChannel(motorManager_, moving))
+    {
+      writeResponsePrefix(out, ResponseCode::Busy);
+      appendFormatted(out, "SHUTDOWN:ERR=BUSY CH=%u", static_cast<unsigned>(moving));
+      return;
+    }
+    std::array<int32_t, kMotorCount> positions{};
+    motion::MotorManager::ChannelMask homed{};
+    for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+    {
+      const MotorState &state = motorManager_.state(channel);
+      positions[channel] = state.position;
+      if (motorManager_.isHomed(channel))
+      {
+        homed[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
+      }
+    }
+
+    if (!store_->recordShutdown(positions, homed))
+    {
+      writeResponsePrefix(out, ResponseCode::DriverFault);
+      appendLine(out, "SHUTDOWN:ERR=FLASH");
+      return;
+    }
+
+    char maskText[(sizeof(homed) * 2U) + 1U];
+    FormatChannelMask(homed, maskText, sizeof(maskText));
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "SHUTDOWN:HOMED=0x%s BOOT=%lu", maskText, static_cast<unsigned long>(store_->bootCount()));
+  }
+
+  // Motion makes a clean-shutdown journal stale; the store drops it before
+  // anything moves. If it cannot, the command is refused: moving with the
+  // journal still clean would resume the next boot from wrong positions.
+  bool CommandProcessor::invalidateJournal(const char *verb, Response &out)
+  {
+    if (store_ == nullptr || store_->invalidateShutdown())
+    {
+      return true;
+    }
+    writeResponsePrefix(out, ResponseCode::DriverFault);
+    appendFormatted(out, "%s:ERR=FLASH", verb);
+    return false;
+  }
+
+  void CommandProcessor::handleBoot(Response &out)
+  {
+    writeResponsePrefix(out, ResponseCode::Ok);
+    if (out.count >= kMaxResponseLines)
+    {
+      return;
+    }
+    // One line, `-` for phases not reached yet: BOOT:RESET=0 MOTION=850 ... HOST=-
+    auto &line = out.lines[out.count];
+    std::size_t written = static_cast<std::size_t>(std::snprintf(line.data(), kMaxResponseLineLength, "BOOT:"));
+    for (std::size_t index = 0; index < diag::kBootPhaseCount && written < kMaxResponseLineLength; ++index)
+    {
+      const auto phase = static_cast<diag::BootPhase>(index);
+      const char *separator = (index == 0) ? "" : " ";
+      const int length = diag::BootPhaseReached(phase)
+                             ? std::snprintf(line.data() + written, kMaxResponseLineLength - written, "%s%s=%lu",
+                                             separator, diag::BootPhaseLabel(phase),
+                                             static_cast<unsigned long>(diag::BootPhaseMicros(phase)))
+                             : std::snprintf(line.data() + written, kMaxResponseLineLength - written, "%s%s=-",
+                                             separator, diag::BootPhaseLabel(phase));
+      written += static_cast<std::size_t>(length);
+    }
+    ++out.count;
+  }
+
+  void CommandProcessor::handleSnapshot(Response &out)
+  {
+    writeResponsePrefix(out, ResponseCode::Ok);
+    SnapshotWriter writer(out);
+
+    snapshot::Header header{};
+    header.channelCount = static_cast<uint8_t>(kMotorCount);
+    header.timestampUs = uptimeUs_;
+    uint8_t headerBytes[snapshot::kHeaderBytes];
+    snapshot::EncodeHeader(header, headerBytes);
+    writer.put(headerBytes, sizeof(headerBytes));
+
+    for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+    {
+      const MotorState &state = motorManager_.state(channel);
+      snapshot::ChannelRecord record{};
+      record.position = state.position;
+      record.targetPosition = state.targetPosition;
+      record.plannedDurationUs = state.plannedDurationUs;
+      record.phase = static_cast<uint8_t>(state.phase);
+      record.flags = static_cast<uint8_t>((state.asleep ? snapshot::kFlagAsleep : 0U) |
+                                          (motorManager_.isHomed(channel) ? snapshot::kFlagHomed : 0U) |
+                                          (state.limitClipped ? snapshot::kFlagLimitClipped : 0U));
+      record.fault = static_cast<uint8_t>(state.fault);
+      record.lastResponse = static_cast<uint8_t>(statusCode(channel));
+      uint8_t recordBytes[snapshot::kChannelBytes];
+      snapshot::EncodeChannel(record, recordBytes);
+      writer.put(recordBytes, sizeof(recordBytes));
+    }
+    writer.finish();
+  }
+
+  void CommandProcessor::handleRecord(std::string_view payload, Response &out)
+  {
+    if (recorder_ == nullptr)
+    {
+      writeResponsePrefix(out, ResponseCode::NotReady);
+      return;
+    }
+
+    std::array<std::string_view, kMaxTokens> tokens{};
+    std::size_t tokenCount = 0;
+    if (!payload.empty() && (!tokenize(payload, tokens, tokenCount) || tokenCount > 2))
+    {
+      writeResponsePrefix(out, ResponseCode::ParseError);
+      return;
+    }
+
+    if (tokenCount == 0)
+    {
+      // Status only.
+    }
+    else if (EqualsIgnoreCase(tokens[0], "START") && tokenCount == 1)
+    {
+      // A replay starts from rest; anything in flight would be lost.
+      for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+      {
+        if (motorManager_.state(channel).phase != MotionState::Idle)
+        {
+          writeResponsePrefix(out, ResponseCode::Busy);
+          appendFormatted(out, "REC:ERR=BUSY CH=%u", static_cast<unsigned>(channel));
+          return;
+        }
+      }
+      if (!recorder_->start(uptimeUs_, kMotorCount, &RecordedChannelState, &motorManager_))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        appendLine(out, "REC:ERR=CAPACITY");
+        return;
+      }
+    }
+    else if (EqualsIgnoreCase(tokens[0], "STOP") && tokenCount == 1)
+    {
+      recorder_->stop();
+    }
+    else if (EqualsIgnoreCase(tokens[0], "DUMP"))
+    {
+      long offset = 0;
+      if (tokenCount == 2 && (!parseInt(tokens[1], offset) || offset < 0 ||
+                              static_cast<std::size_t>(offset) > recorder_->size()))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      // Header line plus as many 40-byte data lines as the response holds;
+      // the host re-issues DUMP at OFFSET + BYTES until it reaches TOTAL.
+      constexpr std::size_t kBytesPerLine = 40;
+      const std::size_t start = static_cast<std::size_t>(offset);
+      const std::size_t pageBytes =
+          std::min((kMaxResponseLines - 2U) * kBytesPerLine, recorder_->size() - start);
+      writeResponsePrefix(out, ResponseCode::Ok);
+      appendFormatted(out, "REC:DUMP OFFSET=%lu BYTES=%lu TOTAL=%lu",
+                      static_cast<unsigned long>(start),
+                      static_cast<unsigned long>(pageBytes),
+                      static_cast<unsigned long>(recorder_->size()));
+      static constexpr char kDigits[] = "0123456789ABCDEF";
+      for (std::size_t lineStart = 0; lineStart < pageBytes; lineStart += kBytesPerLine)
+      {
+        auto &line = out.lines[out.count];
+        std::size_t cursor = static_cast<std::size_t>(std::snprintf(line.data(), kMaxResponseLineLength, "REC:DATA="));
+        for (std::size_t i = lineStart; i < std::min(pageBytes, lineStart + kBytesPerLine); ++i)
+        {
+          const uint8_t byte = recorder_->data()[start + i];
+          line[cursor++] = kDigits[byte >> 4];
+          line[cursor++] = kDigits[byte & 0x0FU];
+        }
+        line[cursor] = '\0';
+        ++out.count;
+      }
+      return;
+    }
+    else
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidArgument);
+      return;
+    }
+
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "REC:STATE=%s BYTES=%lu LINES=%lu OVERFLOW=%u",
+                    recorder_->active() ? "ON" : "OFF",
+                    static_cast<unsigned long>(recorder_->size()),
+                    static_cast<unsigned long>(recorder_->lineCount()),
+                    recorder_->overflowed() ? 1U : 0U);
+  }
+
+  void CommandProcessor::handleTrace(std::string_view payload, Response &out)
+  {
+    std::array<std::string_view, kMaxTokens> tokens{};
+    std::size_t tokenCount = 0;
+    if (!payload.empty() && (!tokenize(payload, tokens, tokenCount) || tokenCount > 2))
+    {
+      writeResponsePrefix(out, ResponseCode::ParseError);
+      return;
+    }
+
+    const uint32_t head = diag::TraceHead();
+    const uint32_t held = std::min<uint32_t>(head, diag::kTraceCapacity);
+    if (tokenCount == 0)
+    {
+      // Status only.
+    }
+    else if (EqualsIgnoreCase(tokens[0], "ON") && tokenCount == 1)
+    {
+      diag::SetTraceEnabled(true);
+    }
+    else if (EqualsIgnoreCase(tokens[0], "OFF") && tokenCount == 1)
+    {
+      diag::SetTraceEnabled(false);
+    }
+    else if (EqualsIgnoreCase(tokens[0], "CLEAR") && tokenCount == 1)
+    {
+      diag::ResetTrace();
+    }
+    else if (EqualsIgnoreCase(tokens[0], "DUMP"))
+    {
+      // Sequence numbers run on across pages and dumps, so a host polling
+      // DUMP at the previous NEXT streams the ring; LOST counts records
+      // overwritten before it asked.
+      uint32_t requested = head - held;
+      if (tokenCount == 2)
+      {
+        long sequence = 0;
+        if (!parseInt(tokens[1], sequence) || sequence < 0 || static_cast<unsigned long>(sequence) > head)
+        {
+          writeResponsePrefix(out, ResponseCode::InvalidArgument);
+          return;
+        }
+        requested = static_cast<uint32_t>(sequence);
+      }
+      uint32_t from = std::max(requested, head - held);
+
+      // Header, then five records per data line straight from the ring. The
+      // header is written last, once the page's extent is known.
+      constexpr std::size_t kRecordsPerLine = 5;
+      constexpr std::size_t kPageRecords = (kMaxResponseLines - 2U) * kRecordsPerLine;
+      static_assert(11 + (2 * kRecordsPerLine * sizeof(diag::TraceRecord)) < kMaxResponseLineLength,
+                    "TRACE:DATA line overflows a response line");
+      static constexpr char kDigits[] = "0123456789ABCDEF";
+      writeResponsePrefix(out, ResponseCode::Ok);
+      const std::size_t headerLine = out.count++;
+      std::size_t count = 0;
+      std::size_t cursor = 0;
+      for (uint32_t sequence = from; sequence != head && count < kPageRecords; ++sequence)
+      {
+        diag::TraceRecord record{};
+        if (!diag::ReadTrace(sequence, record))
+        {
+          // Overwritten mid-dump by a writer lapping the ring: only ever the
+          // oldest records, so the page starts later.
+          if (count != 0)
+          {
+            break;
+          }
+          from = sequence + 1U;
+          continue;
+        }
+        if (count % kRecordsPerLine == 0)
+        {
+          cursor = static_cast<std::size_t>(
+              std::snprintf(out.lines[out.count++].data(), kMaxResponseLineLength, "TRACE:DATA="));
+        }
+        auto &line = out.lines[out.count - 1U];
+        uint8_t bytes[sizeof(diag::TraceRecord)];
+        diag::EncodeTraceRecord(record, bytes);
+        for (const uint8_t byte : bytes)
+        {
+          line[cursor++] = kDigits[byte >> 4];
+          line[cursor++] = kDigits[byte & 0x0FU];
+        }
+        line[cursor] = '\0';
+        ++count;
+      }
+      std::snprintf(out.lines[headerLine].data(), kMaxResponseLineLength,
+                    "TRACE:DUMP FROM=%lu COUNT=%lu NEXT=%lu HEAD=%lu LOST=%lu NOW=%lu",
+                    static_cast<unsigned long>(from), static_cast<unsigned long>(count),
+                    static_cast<unsigned long>(from + count), static_cast<unsigned long>(diag::TraceHead()),
+                    static_cast<unsigned long>(from - requested), static_cast<unsigned long>(diag::TraceMicros()));
+      return;
+    }
+    else
+    {
+      writeResponsePrefix(out, ResponseCode::InvalidArgument);
+      return;
+    }
+
+    writeResponsePrefix(out, ResponseCode::Ok);
+    const uint32_t current = diag::TraceHead();
+    appendFormatted(out, "TRACE:STATE=%s HEAD=%lu HELD=%lu NOW=%lu", diag::TraceEnabled() ? "ON" : "OFF",
+                    static_cast<unsigned long>(current),
+                    static_cast<unsigned long>(std::min<uint32_t>(current, diag::kTraceCapacity)),
+                    static_cast<unsigned long>(diag::TraceMicros()));
+  }
+
+  void CommandProcessor::handleCache(std::string_view payload, Response &out)
+  {
+    if (!payload.empty())
+    {
+      if (!EqualsIgnoreCase(payload, "CLEAR"))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      motorManager_.clearProfileCache();
+    }
+
+    const motion::ProfileCache::Stats stats = motorManager_.profileCache().stats();
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "CACHE:ENTRIES=%lu/%lu HITS=%lu MISSES=%lu EVICTIONS=%lu",
+                    static_cast<unsigned long>(stats.entries),
+                    static_cast<unsigned long>(motion::ProfileCache::kCapacity),
+                    static_cast<unsigned long>(stats.hits), static_cast<unsigned long>(stats.misses),
+                    static_cast<unsigned long>(stats.evictions));
+  }
+
+  void CommandProcessor::handleSubscribe(std::string_view payload, Response &out)
+  {
+    if (!payload.empty())
+    {
+      long intervalMs = 0;
+      if (!parseInt(payload, intervalMs))
+      {
+        writeResponsePrefix(out, ResponseCode::ParseError);
+        return;
+      }
+      if (intervalMs != 0 && (intervalMs < static_cast<long>(kMinSubscriptionIntervalMs) ||
+                              intervalMs > static_cast<long>(kMaxSubscriptionIntervalMs)))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      subscriptionIntervalUs_ = static_cast<uint32_t>(intervalMs) * 1000U;
+      // A new subscriber starts from a full snapshot, due on the next poll.
+      subscriptionElapsedUs_ = subscriptionIntervalUs_;
+      published_.fill(PublishedStatus{});
+      for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+      {
+        motorManager_.markDirty(channel);
+      }
+    }
+
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "SUB:INTERVAL_MS=%lu", static_cast<unsigned long>(subscriptionIntervalUs_ / 1000U));
+  }
+
+  void CommandProcessor::handleEvents(std::string_view payload, Response &out)
+  {
+    if (!payload.empty())
+    {
+      std::array<std::string_view, kMaxTokens> tokens{};
+      std::size_t tokenCount = 0;
+      if (!tokenize(payload, tokens, tokenCount) || tokenCount != 2)
+      {
+        writeResponsePrefix(out, ResponseCode::ParseError);
+        return;
+      }
+      motion::MotorManager::ChannelMask mask{};
+      if (!parseChannelSelector(tokens[0], mask))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidChannel);
+        return;
+      }
+      long enabled = 0;
+      if (!parseInt(tokens[1], enabled) || (enabled != 0 && enabled != 1))
+      {
+        writeResponsePrefix(out, ResponseCode::InvalidArgument);
+        return;
+      }
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        if (HasChannel(mask, i))
+        {
+          motorManager_.setEventsEnabled(i, enabled == 1);
+        }
+      }
+    }
+
+    char maskText[(sizeof(motion::MotorManager::ChannelMask) * 2U) + 1U];
+    FormatChannelMask(motorManager_.eventChannels(), maskText, sizeof(maskText));
+    writeResponsePrefix(out, ResponseCode::Ok);
+    appendFormatted(out, "EVT:MASK=0x%s", maskText);
+  }
+
+  bool CommandProcessor::appendDelta(std::size_t channel, Response &out)
+  {
+    const MotorState &state = motorManager_.state(channel);
+    const ResponseCode code = statusCode(channel);
+    PublishedStatus &last = published_[channel];
+    const bool full = !last.valid;
+    if (!full && last.position == state.position && last.targetPosition == state.targetPosition &&
+        last.phase == state.phase && last.asleep == state.asleep && last.code == code)
+    {
+      return false;
+    }
+
+    auto &line = out.lines[out.count];
+    const std::size_t capacity = kMaxResponseLineLength;
+    std::size_t written = static_cast<std::size_t>(
+        std::snprintf(line.data(), capacity, "DELTA:CH=%u", static_cast<unsigned>(channel)));
+    if (full || last.position != state.position)
+    {
+      written += static_cast<std::size_t>(
+          std::snprintf(line.data() + written, capacity - written, " POS=%ld", static_cast<long>(state.position)));
+    }
+    if (full || last.targetPosition != state.targetPosition)
+    {
+      written += static_cast<std::size_t>(std::snprintf(line.data() + written, capacity - written, " TARGET=%ld",
+                                                        static_cast<long>(state.targetPosition)));
+    }
+    if (full || last.phase != state.phase)
+    {
+      written += static_cast<std::size_t>(
+          std::snprintf(line.data() + written, capacity - written, " STATE=%s", MotionStateLabel(state.phase)));
+    }
+    if (full || last.asleep != state.asleep)
+    {
+      written += static_cast<std::size_t>(
+          std::snprintf(line.data() + written, capacity - written, " SLEEP=%u", state.asleep ? 1U : 0U));
+    }
+    if (full || last.code != code)
+    {
+      std::snprintf(line.data() + written, capacity - written, " ERR=%s", ResponseCodeLabel(code));
+    }
+    ++out.count;
+
+    last.position = state.position;
+    last.targetPosition = state.targetPosition;
+    last.phase = state.phase;
+    last.asleep = state.asleep;
+    last.code = code;
+    last.valid = true;
+    return true;
   }
 
   bool CommandProcessor::parseChannel(std::string_view token, std::size_t &channel)
@@ -612,6 +1851,92 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     return true;
   }
 
+  bool CommandProcessor::parseChannelSelector(std::string_view token, motion::MotorManager::ChannelMask &mask)
+  {
+    mask.fill(0);
+    token = Trim(token);
+    if (token == "*")
+    {
+      for (std::size_t i = 0; i < kMotorCount; ++i)
+      {
+        mask[i / 32U] |= 1UL << (i % 32U);
+      }
+      return true;
+    }
+    if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X'))
+    {
+      return parseChannelMask(token.substr(2), mask);
+    }
+
+    for (std::size_t start = 0;;)
+    {
+      const std::size_t end = token.find_first_of(",+", start);
+      const std::string_view item =
+          Trim(token.substr(start, (end == std::string_view::npos) ? std::string_view::npos : end - start));
+      // Channels are never negative, so a '-' after the first digit is a range.
+      const std::size_t dash = item.find('-', 1);
+      std::size_t first = 0;
+      std::size_t last = 0;
+      if (dash == std::string_view::npos)
+      {
+        if (!parseChannel(item, first))
+        {
+          return false;
+        }
+        last = first;
+      }
+      else if (!parseChannel(Trim(item.substr(0, dash)), first) || !parseChannel(Trim(item.substr(dash + 1U)), last) ||
+               last < first)
+      {
+        return false;
+      }
+      for (std::size_t i = first; i <= last; ++i)
+      {
+        mask[i / 32U] |= 1UL << (i % 32U);
+      }
+      if (end == std::string_view::npos)
+      {
+        return true;
+      }
+      start = end + 1U;
+    }
+  }
+
+  bool CommandProcessor::parseChannelMask(std::string_view hexDigits, motion::MotorManager::ChannelMask &mask)
+  {
+    mask.fill(0);
+    if (hexDigits.empty() || hexDigits.size() > (kMotorCount + 3U) / 4U)
+    {
+      return false;
+    }
+    for (std::size_t i = 0; i < hexDigits.size(); ++i)
+    {
+      const char ch = static_cast<char>(std::tolower(static_cast<unsigned char>(hexDigits[hexDigits.size() - 1U - i])));
+      uint32_t nibble = 0;
+      if (ch >= '0' && ch <= '9')
+      {
+        nibble = static_cast<uint32_t>(ch - '0');
+      }
+      else if (ch >= 'a' && ch <= 'f')
+      {
+        nibble = static_cast<uint32_t>(ch - 'a' + 10);
+      }
+      else
+      {
+        return false;
+      }
+      const std::size_t bit = i * 4U;
+      mask[bit / 32U] |= nibble << (bit % 32U);
+    }
+    bool any = false;
+    for (std::size_t i = 0; i < mask.size(); ++i)
+    {
+      any |= mask[i] != 0U;
+    }
+    const std::size_t spare = (mask.size() * 32U) - kMotorCount;
+    return any && (spare == 0U || (mask.back() >> (32U - spare)) == 0U);
+  }
+
   CommandProcessor::ResponseCode CommandProcessor::mapFault(motion::FaultCode fault) const
   {
     switch (fault)
@@ -623,7 +1948,7 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     case motion::FaultCode::DriverFault:
       return ResponseCode::DriverFault;
     case motion::FaultCode::HomingTimeout:
-      return ResponseCode::NotReady;
+      return ResponseCode::Timeout;
     }
     return ResponseCode::InvalidArgument;
   }
@@ -634,24 +1959,36 @@ bool CommandProcessor::tokenize(std::string_view payload, std::array<std::string
     {
       return;
     }
-    lastResponseCodes_[channel] = code;
+    if (lastResponseCodes_[channel] != code)
+    {
+      lastResponseCodes_[channel] = code;
+      motorManager_.markDirty(channel);
+    }
   }
 
-  void CommandProcessor::writeStatusForMotor(std::size_t channel, Response &out)
+  CommandProcessor::ResponseCode CommandProcessor::statusCode(std::size_t channel) const
+  {
+    const motion::FaultCode fault = motorManager_.state(channel).fault;
+    return (fault != motion::FaultCode::None) ? mapFault(fault) : lastResponseCodes_[channel];
+  }
+
+  void CommandProcessor::writeStatusLine(std::size_t channel, Response &out)
   {
     const auto &state = motorManager_.state(channel);
-    ResponseCode code = lastResponseCodes_[channel];
-    if (state.fault != motion::FaultCode::None)
-    {
-      code = mapFault(state.fault);
-    }
+    const ResponseCode code = statusCode(channel);
     appendFormatted(out, "STATUS:CH=%u POS=%ld TARGET=%ld STATE=%s SLEEP=%u ERR=%s",
                     static_cast<unsigned>(channel),
-                    state.position,
-                    state.targetPosition,
+                    static_cast<long>(state.position),
+                    static_cast<long>(state.targetPosition),
                     MotionStateLabel(state.phase),
                     state.asleep ? 1U : 0U,
                     ResponseCodeLabel(code));
+  }
+
+  void CommandProcessor::writeStatusForMotor(std::size_t channel, Response &out)
+  {
+    const auto &state = motorManager_.state(channel);
+    writeStatusLine(channel, out);
   appendFormatted(out, "STATUS:PROFILE CH=%u SPEED=%ld ACC=%ld PLAN_US=%lu",
                   static_cast<unsigned>(channel),
                   static_cast<long>(state.speedHz),
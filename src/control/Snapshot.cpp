@@ -0,0 +1,149 @@
+#include "control/Snapshot.hpp"
+
+namespace ctrl::snapshot
+{
+
+namespace
+{
+
+void PutU16(uint8_t *out, uint16_t value)
+{
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t *out, uint32_t value)
+{
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    out[i] = static_cast<uint8_t>(value >> (8U * i));
+  }
+}
+
+uint16_t GetU16(const uint8_t *in)
+{
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t *in)
+{
+  uint32_t value = 0;
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    value |= static_cast<uint32_t>(in[i]) << (8U * i);
+  }
+  return value;
+}
+
+int HexDigit(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+} // namespace
+
+void EncodeHeader(const Header &header, uint8_t (&out)[kHeaderBytes])
+{
+  out[0] = header.version;
+  out[1] = header.channelCount;
+  PutU16(out + 2, header.channelBytes);
+  PutU32(out + 4, static_cast<uint32_t>(header.timestampUs));
+  PutU32(out + 8, static_cast<uint32_t>(header.timestampUs >> 32));
+}
+
+void EncodeChannel(const ChannelRecord &record, uint8_t (&out)[kChannelBytes])
+{
+  PutU32(out, static_cast<uint32_t>(record.position));
+  PutU32(out + 4, static_cast<uint32_t>(record.targetPosition));
+  PutU32(out + 8, record.plannedDurationUs);
+  out[12] = record.phase;
+  out[13] = record.flags;
+  out[14] = record.fault;
+  out[15] = record.lastResponse;
+}
+
+uint16_t UpdateChecksum(uint16_t crc, const uint8_t *data, std::size_t length)
+{
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    crc = static_cast<uint16_t>(crc ^ (static_cast<uint16_t>(data[i]) << 8));
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc & 0x8000U) ? static_cast<uint16_t>((crc << 1) ^ 0x1021U) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+DecodeStatus DecodeFrame(const uint8_t *frame, std::size_t length, Header &header)
+{
+  if (length < kHeaderBytes + kTrailerBytes)
+  {
+    return DecodeStatus::Truncated;
+  }
+  header.version = frame[0];
+  header.channelCount = frame[1];
+  header.channelBytes = GetU16(frame + 2);
+  header.timestampUs = static_cast<uint64_t>(GetU32(frame + 4)) | (static_cast<uint64_t>(GetU32(frame + 8)) << 32);
+  if (header.version != kVersion || header.channelBytes < kChannelBytes)
+  {
+    return DecodeStatus::UnsupportedVersion;
+  }
+  const std::size_t body = kHeaderBytes + (static_cast<std::size_t>(header.channelBytes) * header.channelCount);
+  if (length < body + kTrailerBytes)
+  {
+    return DecodeStatus::Truncated;
+  }
+  if (UpdateChecksum(kChecksumSeed, frame, body) != GetU16(frame + body))
+  {
+    return DecodeStatus::BadChecksum;
+  }
+  return DecodeStatus::Ok;
+}
+
+ChannelRecord DecodeChannel(const uint8_t *frame, const Header &header, std::size_t index)
+{
+  const uint8_t *in = frame + kHeaderBytes + (index * header.channelBytes);
+  ChannelRecord record{};
+  record.position = static_cast<int32_t>(GetU32(in));
+  record.targetPosition = static_cast<int32_t>(GetU32(in + 4));
+  record.plannedDurationUs = GetU32(in + 8);
+  record.phase = in[12];
+  record.flags = in[13];
+  record.fault = in[14];
+  record.lastResponse = in[15];
+  return record;
+}
+
+std::size_t DecodeHex(std::string_view hex, uint8_t *out, std::size_t capacity)
+{
+  if ((hex.size() % 2U) != 0U || hex.size() / 2U > capacity)
+  {
+    return 0;
+  }
+  for (std::size_t i = 0; i < hex.size(); i += 2)
+  {
+    const int high = HexDigit(hex[i]);
+    const int low = HexDigit(hex[i + 1]);
+    if (high < 0 || low < 0)
+    {
+      return 0;
+    }
+    out[i / 2U] = static_cast<uint8_t>((high << 4) | low);
+  }
+  return hex.size() / 2U;
+}
+
+} // namespace ctrl::snapshot
@@ -0,0 +1,62 @@
+#include "diag/BootLog.hpp"
+
+#include <array>
+
+namespace diag
+{
+
+namespace
+{
+std::array<uint32_t, kBootPhaseCount> gPhaseMicros{};
+uint32_t gReachedMask = 0;
+} // namespace
+
+void MarkBootPhase(BootPhase phase, uint32_t micros)
+{
+  const auto index = static_cast<std::size_t>(phase);
+  if (index >= kBootPhaseCount || BootPhaseReached(phase))
+  {
+    return;
+  }
+  gPhaseMicros[index] = micros;
+  gReachedMask |= 1U << index;
+}
+
+bool BootPhaseReached(BootPhase phase)
+{
+  const auto index = static_cast<std::size_t>(phase);
+  return index < kBootPhaseCount && ((gReachedMask >> index) & 1U) != 0U;
+}
+
+uint32_t BootPhaseMicros(BootPhase phase)
+{
+  return BootPhaseReached(phase) ? gPhaseMicros[static_cast<std::size_t>(phase)] : 0U;
+}
+
+const char *BootPhaseLabel(BootPhase phase)
+{
+  switch (phase)
+  {
+  case BootPhase::Reset:
+    return "RESET";
+  case BootPhase::MotionReady:
+    return "MOTION";
+  case BootPhase::StoreReady:
+    return "STORE";
+  case BootPhase::Ready:
+    return "READY";
+  case BootPhase::HostConnected:
+    return "HOST";
+  case BootPhase::Count:
+    break;
+  }
+  return "UNKNOWN";
+}
+
+void ResetBootLog()
+{
+  gPhaseMicros.fill(0);
+  gReachedMask = 0;
+}
+
+} // namespace diag
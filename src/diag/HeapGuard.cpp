@@ -0,0 +1,73 @@
+#include "diag/HeapGuard.hpp"
+
+#include <cstddef>
+
+namespace diag
+{
+
+namespace
+{
+volatile uint32_t gScopeDepth = 0;
+volatile uint32_t gViolations = 0;
+} // namespace
+
+NoHeapScope::NoHeapScope()
+{
+  gScopeDepth = gScopeDepth + 1U;
+}
+
+NoHeapScope::~NoHeapScope()
+{
+  gScopeDepth = gScopeDepth - 1U;
+}
+
+bool HeapForbidden()
+{
+  return gScopeDepth != 0U;
+}
+
+uint32_t HeapViolations()
+{
+  return gViolations;
+}
+
+void ResetHeapViolations()
+{
+  gViolations = 0;
+}
+
+void RecordHeapAllocation()
+{
+  if (gScopeDepth == 0U)
+  {
+    return;
+  }
+  gViolations = gViolations + 1U;
+#if defined(ARDUINO)
+  __builtin_trap();
+#endif
+}
+
+} // namespace diag
+
+#if defined(ARDUINO) && !defined(DECK_SIMULATION)
+// Linked with -Wl,--wrap=_Znwj -Wl,--wrap=_Znaj so every operator new in the
+// image funnels through the guard. malloc itself is already wrapped by the
+// Pico SDK; the build-time call graph check in tools/memory_report.py covers
+// direct malloc/calloc/realloc use instead. The simulator build links
+// without the wraps, so it leaves these out.
+extern "C" void *__real__Znwj(std::size_t size);
+extern "C" void *__real__Znaj(std::size_t size);
+
+extern "C" void *__wrap__Znwj(std::size_t size)
+{
+  diag::RecordHeapAllocation();
+  return __real__Znwj(size);
+}
+
+extern "C" void *__wrap__Znaj(std::size_t size)
+{
+  diag::RecordHeapAllocation();
+  return __real__Znaj(size);
+}
+#endif
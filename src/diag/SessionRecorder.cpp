@@ -0,0 +1,101 @@
+#include "diag/SessionRecorder.hpp"
+
+#include <cstring>
+
+namespace diag
+{
+
+bool SessionRecorder::start(uint64_t nowUs, std::size_t channelCount, ChannelSource source, const void *context)
+{
+  length_ = 0;
+  lineCount_ = 0;
+  lastUs_ = nowUs;
+  active_ = false;
+  overflowed_ = false;
+  if (source == nullptr || channelCount == 0 || channelCount > 255)
+  {
+    return false;
+  }
+
+  const uint8_t header[4] = {kVersion, static_cast<uint8_t>(channelCount), static_cast<uint8_t>(kChannelBytes), 0};
+  bool fits = put(header, sizeof(header));
+  for (std::size_t channel = 0; channel < channelCount && fits; ++channel)
+  {
+    const RecordedChannel state = source(context, channel);
+    const int32_t fields[4] = {state.position, state.zeroOffset, state.negativeLimit, state.positiveLimit};
+    for (int32_t field : fields)
+    {
+      const uint32_t value = static_cast<uint32_t>(field);
+      const uint8_t bytes[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                                static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+      fits = fits && put(bytes, sizeof(bytes));
+    }
+  }
+  for (std::size_t base = 0; base < channelCount && fits; base += 8)
+  {
+    uint8_t homed = 0;
+    for (std::size_t bit = 0; bit < 8 && base + bit < channelCount; ++bit)
+    {
+      homed = static_cast<uint8_t>(homed | (source(context, base + bit).homed ? (1U << bit) : 0U));
+    }
+    fits = put(&homed, 1);
+  }
+  if (!fits)
+  {
+    length_ = 0;
+    return false;
+  }
+  active_ = true;
+  return true;
+}
+
+bool SessionRecorder::recordLine(uint64_t nowUs, std::string_view line)
+{
+  if (!active_)
+  {
+    return false;
+  }
+  const std::size_t mark = length_;
+  if (!putVarint(nowUs - lastUs_) || !putVarint(line.size()) || !put(line.data(), line.size()))
+  {
+    // Drop the partial entry so the log ends on a line boundary.
+    length_ = mark;
+    overflowed_ = true;
+    active_ = false;
+    return false;
+  }
+  lastUs_ = nowUs;
+  ++lineCount_;
+  return true;
+}
+
+bool SessionRecorder::put(const void *bytes, std::size_t length)
+{
+  if (length > kCapacity - length_)
+  {
+    return false;
+  }
+  std::memcpy(buffer_.data() + length_, bytes, length);
+  length_ += length;
+  return true;
+}
+
+bool SessionRecorder::putVarint(uint64_t value)
+{
+  do
+  {
+    uint8_t byte = static_cast<uint8_t>(value & 0x7FU);
+    value >>= 7;
+    if (value != 0)
+    {
+      byte |= 0x80U;
+    }
+    if (!put(&byte, 1))
+    {
+      return false;
+    }
+  } while (value != 0);
+  return true;
+}
+
+} // namespace diag
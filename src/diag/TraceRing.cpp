@@ -0,0 +1,165 @@
+#include "diag/TraceRing.hpp"
+
+#include "diag/MemoryBudget.hpp"
+
+#include <array>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+#define TRACE_MASKS_IRQ 1
+#include <hardware/sync.h>
+#else
+#include <atomic>
+#endif
+
+namespace diag
+{
+
+namespace
+{
+std::array<TraceRecord, kTraceCapacity> gRecords{};
+static_assert(sizeof(gRecords) <= kTraceRingBudgetBytes,
+              "Trace ring outgrew its RAM budget (include/diag/MemoryBudget.hpp)");
+#if defined(TRACE_MASKS_IRQ)
+volatile uint32_t gHead = 0;
+volatile bool gEnabled = true;
+
+uint32_t ReserveSequence()
+{
+  const uint32_t saved = save_and_disable_interrupts();
+  const uint32_t sequence = gHead;
+  gHead = sequence + 1U;
+  restore_interrupts(saved);
+  return sequence;
+}
+
+uint32_t LoadHead()
+{
+  return gHead;
+}
+#else
+std::atomic<uint32_t> gHead{0};
+std::atomic<bool> gEnabled{true};
+
+uint32_t ReserveSequence()
+{
+  return gHead.fetch_add(1U, std::memory_order_acq_rel);
+}
+
+uint32_t LoadHead()
+{
+  return gHead.load(std::memory_order_acquire);
+}
+#endif
+} // namespace
+
+uint32_t TraceMicros()
+{
+#if defined(ARDUINO)
+  return static_cast<uint32_t>(micros());
+#else
+  static const auto kStart = std::chrono::steady_clock::now();
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - kStart).count());
+#endif
+}
+
+void Trace(TraceKind kind, uint8_t channel, uint16_t value)
+{
+  if (!gEnabled)
+  {
+    return;
+  }
+  TraceRecord &record = gRecords[ReserveSequence() & (kTraceCapacity - 1U)];
+  record.micros = TraceMicros();
+  record.kind = kind;
+  record.channel = channel;
+  record.value = value;
+}
+
+void SetTraceEnabled(bool enabled)
+{
+  gEnabled = enabled;
+}
+
+bool TraceEnabled()
+{
+  return gEnabled;
+}
+
+uint32_t TraceHead()
+{
+  return LoadHead();
+}
+
+bool ReadTrace(uint32_t sequence, TraceRecord &out)
+{
+  // Sequence numbers wrap, so distances are compared rather than values.
+  if (LoadHead() - sequence - 1U >= kTraceCapacity)
+  {
+    return false;
+  }
+  out = gRecords[sequence & (kTraceCapacity - 1U)];
+  // A writer that reserved sequence + kTraceCapacity may have been filling
+  // the slot during the copy.
+  return LoadHead() - sequence <= kTraceCapacity;
+}
+
+void EncodeTraceRecord(const TraceRecord &record, uint8_t *out)
+{
+  out[0] = static_cast<uint8_t>(record.micros);
+  out[1] = static_cast<uint8_t>(record.micros >> 8);
+  out[2] = static_cast<uint8_t>(record.micros >> 16);
+  out[3] = static_cast<uint8_t>(record.micros >> 24);
+  out[4] = static_cast<uint8_t>(record.kind);
+  out[5] = record.channel;
+  out[6] = static_cast<uint8_t>(record.value);
+  out[7] = static_cast<uint8_t>(record.value >> 8);
+}
+
+TraceRecord DecodeTraceRecord(const uint8_t *in)
+{
+  TraceRecord record{};
+  record.micros = static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                  (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+  record.kind = static_cast<TraceKind>(in[4]);
+  record.channel = in[5];
+  record.value = static_cast<uint16_t>(in[6] | (in[7] << 8));
+  return record;
+}
+
+const char *TraceKindLabel(TraceKind kind)
+{
+  switch (kind)
+  {
+  case TraceKind::CommandAccepted:
+    return "CMD";
+  case TraceKind::SlotLatched:
+    return "LATCH";
+  case TraceKind::SlotRetired:
+    return "RETIRE";
+  case TraceKind::PhaseChange:
+    return "PHASE";
+  case TraceKind::SleepLatch:
+    return "SLEEP";
+  case TraceKind::Overrun:
+    return "OVERRUN";
+  case TraceKind::None:
+  case TraceKind::Count:
+    break;
+  }
+  return "UNKNOWN";
+}
+
+void ResetTrace()
+{
+  gRecords.fill(TraceRecord{});
+  gHead = 0;
+}
+
+} // namespace diag
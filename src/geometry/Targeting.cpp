@@ -0,0 +1,210 @@
+#include "geometry/Targeting.hpp"
+
+#include <cstdlib>
+
+namespace geometry
+{
+
+namespace
+{
+
+// atan(2^-i) in BAM32 units.
+constexpr int32_t kAtanTable[] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245,
+    2670163, 1335087, 667544, 333772, 166886, 83443, 41722, 20861,
+    10430, 5215, 2608, 1304, 652, 326, 163, 81};
+
+constexpr std::size_t kCordicIterations = sizeof(kAtanTable) / sizeof(kAtanTable[0]);
+constexpr BinaryAngle kHalfTurn = static_cast<BinaryAngle>(0x80000000U);
+constexpr BinaryAngle kQuarterTurn = 0x40000000;
+constexpr int32_t kMirrorColumns = 2;
+constexpr int32_t kMirrorPitchMm = 80;
+
+bool InRange(int32_t value)
+{
+  return value >= -kMaxCoordinateMm && value <= kMaxCoordinateMm;
+}
+
+// Shifts (x, y) up so the larger magnitude sits near 2^29; CORDIC growth
+// (x1.647) then stays inside int32_t while keeping full precision.
+void Normalise(int32_t &x, int32_t &y)
+{
+  uint32_t magnitude = static_cast<uint32_t>(std::abs(x)) | static_cast<uint32_t>(std::abs(y));
+  while (magnitude < (1U << 28))
+  {
+    x *= 2;
+    y *= 2;
+    magnitude <<= 1;
+  }
+}
+
+} // namespace
+
+BinaryAngle Atan2(int32_t y, int32_t x)
+{
+  if (x == 0 && y == 0)
+  {
+    return 0;
+  }
+  if (std::abs(x) >= (1 << 29) || std::abs(y) >= (1 << 29))
+  {
+    x /= 4;
+    y /= 4;
+  }
+  Normalise(x, y);
+
+  // Fold the left half-plane onto the right so CORDIC converges.
+  uint32_t angle = 0;
+  if (x < 0)
+  {
+    x = -x;
+    y = -y;
+    angle = static_cast<uint32_t>(kHalfTurn);
+  }
+
+  for (std::size_t i = 0; i < kCordicIterations; ++i)
+  {
+    const int32_t dx = x >> i;
+    const int32_t dy = y >> i;
+    if (y > 0)
+    {
+      x += dy;
+      y -= dx;
+      angle += static_cast<uint32_t>(kAtanTable[i]);
+    }
+    else
+    {
+      x -= dy;
+      y += dx;
+      angle -= static_cast<uint32_t>(kAtanTable[i]);
+    }
+  }
+  return static_cast<BinaryAngle>(angle);
+}
+
+uint32_t ISqrt(uint32_t value)
+{
+  uint32_t result = 0;
+  uint32_t bit = 1U << 30;
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+  while (bit != 0)
+  {
+    if (value >= result + bit)
+    {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    }
+    else
+    {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+int32_t StepsFromAngle(BinaryAngle angle, int32_t stepsPerTurn)
+{
+  const int64_t scaled = static_cast<int64_t>(angle) * stepsPerTurn;
+  const int64_t half = kAngleUnitsPerTurn / 2;
+  return static_cast<int32_t>((scaled >= 0 ? scaled + half : scaled - half) / kAngleUnitsPerTurn);
+}
+
+double DegreesFromAngle(BinaryAngle angle)
+{
+  return static_cast<double>(angle) * 360.0 / static_cast<double>(kAngleUnitsPerTurn);
+}
+
+AxisTargets SolveMirror(const MirrorPose &pose, const WallTarget &target, const StepLimits &limits)
+{
+  return SolveMirror(pose, target, limits, limits);
+}
+
+AxisTargets SolveMirror(const MirrorPose &pose,
+                        const WallTarget &target,
+                        const StepLimits &yawLimits,
+                        const StepLimits &pitchLimits)
+{
+  AxisTargets result{};
+  if (target.distanceMm <= 0 || !InRange(target.distanceMm) || !InRange(target.xMm) || !InRange(target.yMm) ||
+      !InRange(pose.xMm) || !InRange(pose.yMm) || pose.stepsPerTurn <= 0)
+  {
+    return result;
+  }
+
+  const int32_t outX = target.xMm - pose.xMm;
+  const int32_t outY = target.yMm - pose.yMm;
+  const int32_t outZ = target.distanceMm;
+  if (!InRange(outX) || !InRange(outY))
+  {
+    return result;
+  }
+  const uint32_t lengthSquared = static_cast<uint32_t>(outX * outX) + static_cast<uint32_t>(outY * outY) +
+                                 static_cast<uint32_t>(outZ * outZ);
+  const int32_t length = static_cast<int32_t>(ISqrt(lengthSquared));
+
+  // Unit outgoing ray in Q14; the mirror normal bisects it and the reversed
+  // incoming ray, so normal ~ out - in needs no further normalisation.
+  const int32_t normalX = (outX * kUnitQ14) / length - pose.incoming.x;
+  const int32_t normalY = (outY * kUnitQ14) / length - pose.incoming.y;
+  const int32_t normalZ = (outZ * kUnitQ14) / length - pose.incoming.z;
+  if (normalZ <= 0)
+  {
+    return result;
+  }
+
+  const uint32_t horizontalSquared = static_cast<uint32_t>(normalX * normalX) + static_cast<uint32_t>(normalZ * normalZ);
+  const int32_t horizontal = static_cast<int32_t>(ISqrt(horizontalSquared));
+
+  result.yawAngle = Atan2(normalX, normalZ);
+  result.pitchAngle = Atan2(normalY, horizontal);
+  result.yawSteps = pose.yawZeroSteps + StepsFromAngle(result.yawAngle, pose.stepsPerTurn);
+  result.pitchSteps = pose.pitchZeroSteps + StepsFromAngle(result.pitchAngle, pose.stepsPerTurn);
+
+  if (result.yawSteps < yawLimits.negative || result.yawSteps > yawLimits.positive)
+  {
+    result.status = TargetStatus::YawOutOfRange;
+  }
+  else if (result.pitchSteps < pitchLimits.negative || result.pitchSteps > pitchLimits.positive)
+  {
+    result.status = TargetStatus::PitchOutOfRange;
+  }
+  else
+  {
+    result.status = TargetStatus::Reachable;
+  }
+  return result;
+}
+
+MirrorPose DefaultMirrorPose(std::size_t mirrorIndex)
+{
+  MirrorPose pose{};
+  const int32_t column = static_cast<int32_t>(mirrorIndex) % kMirrorColumns;
+  const int32_t row = static_cast<int32_t>(mirrorIndex) / kMirrorColumns;
+  pose.xMm = column * kMirrorPitchMm;
+  pose.yMm = -row * kMirrorPitchMm;
+  pose.yawChannel = static_cast<uint8_t>(mirrorIndex * 2U);
+  pose.pitchChannel = static_cast<uint8_t>((mirrorIndex * 2U) + 1U);
+  return pose;
+}
+
+const char *TargetStatusLabel(TargetStatus status)
+{
+  switch (status)
+  {
+  case TargetStatus::Reachable:
+    return "REACHABLE";
+  case TargetStatus::YawOutOfRange:
+    return "YAW_LIMIT";
+  case TargetStatus::PitchOutOfRange:
+    return "PITCH_LIMIT";
+  case TargetStatus::InvalidTarget:
+    return "INVALID";
+  }
+  return "UNKNOWN";
+}
+
+} // namespace geometry
@@ -1,21 +1,42 @@
 #ifdef ARDUINO
 
 #include <Arduino.h>
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <string_view>
 
 #include "boards/Rp2040Pins.hpp"
 #include "control/CommandProcessor.hpp"
+#include "diag/BootLog.hpp"
+#include "diag/HeapGuard.hpp"
+#include "diag/SessionRecorder.hpp"
+#include "diag/TraceRing.hpp"
+#include "motion/StepperPioDriver.hpp"
+#include "storage/CalibrationStore.hpp"
+#include "storage/Rp2040Flash.hpp"
 
 namespace
 {
 
+// A loop pass longer than this is traced as an overrun: eight steps at the
+// default 4 kHz, long enough for a short slot to retire before its
+// successor is handed over.
+constexpr uint32_t kLoopStallUs = 2000;
+
 ctrl::CommandProcessor gCommandProcessor;
+motion::pio::StepperPioDriver gStepperDriver;
+storage::Rp2040Flash gFlash;
+storage::CalibrationStore gCalibrationStore(gFlash);
+diag::SessionRecorder gRecorder;
+// Static rather than on the loop stack: a full STATUS response is ~1.9 KB.
+ctrl::CommandProcessor::Response gResponse{};
 std::array<char, ctrl::CommandProcessor::kMaxCommandLength + 1> gBuffer{};
 std::size_t gBufferLength = 0;
 bool gBufferOverflow = false;
 uint32_t gLastServiceMicros = 0;
+bool gHostConnected = false;
+bool gResumed = false;
 
 void emitResponse(const ctrl::CommandProcessor::Response &response)
 {
@@ -25,20 +46,63 @@ void emitResponse(const ctrl::CommandProcessor::Response &response)
   }
 }
 
+void dispatchPendingCommands()
+{
+  auto &manager = gCommandProcessor.motorManager();
+  motion::pio::StepperCommand command{};
+  gStepperDriver.service();
+  for (std::size_t channel = 0; channel < gStepperDriver.channelCount(); ++channel)
+  {
+    // Positions follow the steps the PIO confirmed. The driver's IRQ has
+    // already started a queued slot; the manager catches up here and hands
+    // the driver the next one to hold.
+    const motion::pio::StepProgress progress = manager.cancelPending(channel)
+                                                   ? gStepperDriver.abort(channel)
+                                                   : gStepperDriver.takeProgress(channel);
+    manager.reconcileExecuted(channel, progress.retired, progress.executed);
+    if (gStepperDriver.ready(channel) && manager.takePendingCommand(channel, command))
+    {
+      gStepperDriver.submit(channel, command);
+    }
+  }
+}
+
+// Called every loop pass. USB CDC drops output while no host has the port
+// open, so the banner goes out on each connect rather than from setup().
+void announceOnHostConnect()
+{
+  const bool connected = static_cast<bool>(Serial);
+  if (connected == gHostConnected)
+  {
+    return;
+  }
+  gHostConnected = connected;
+  if (!connected)
+  {
+    return;
+  }
+  diag::MarkBootPhase(diag::BootPhase::HostConnected, micros());
+  Serial.println(gResumed ? "BOOT:RESUMED" : "BOOT:HOMING_REQUIRED");
+  Serial.println("CTRL:READY");
+}
+
 void flushCommand()
 {
   if (gBufferOverflow)
   {
     gBufferOverflow = false;
     gBufferLength = 0;
+    diag::Trace(diag::TraceKind::Overrun, static_cast<uint8_t>(diag::TraceOverrun::InputLine), 0);
     Serial.println("CTRL:ERR_PAYLOAD_TOO_LONG");
     return;
   }
 
-  ctrl::CommandProcessor::Response response{};
   std::string_view commandView(gBuffer.data(), gBufferLength);
-  gCommandProcessor.processLine(commandView, response);
-  emitResponse(response);
+  {
+    diag::NoHeapScope noHeap;
+    gCommandProcessor.processLine(commandView, gResponse);
+  }
+  emitResponse(gResponse);
   gBufferLength = 0;
 }
 
@@ -46,16 +110,29 @@ void flushCommand()
 
 void setup()
 {
+  diag::MarkBootPhase(diag::BootPhase::Reset, micros());
+  // Non-blocking: the motion side must not wait on USB enumeration.
   Serial.begin(115200);
-  unsigned long start = millis();
-  while (!Serial && (millis() - start) < 2000)
-  {
-    delay(10);
-  }
   gCommandProcessor.reset();
   gCommandProcessor.configureShiftRegister(board::rp2040::kShiftRegisterPins);
+  gStepperDriver.begin(board::rp2040::kStepPins.data(),
+                       board::rp2040::kDirPins.data(),
+                       board::rp2040::kStepPins.size());
+  for (std::size_t channel = 0; channel < gStepperDriver.channelCount(); ++channel)
+  {
+    gCommandProcessor.motorManager().setExecutionFeedback(channel, true);
+  }
+  diag::MarkBootPhase(diag::BootPhase::MotionReady, micros());
+
+  gCommandProcessor.attachRecorder(&gRecorder);
+  gCommandProcessor.attachStore(&gCalibrationStore);
+  if (gCalibrationStore.begin())
+  {
+    gResumed = gCommandProcessor.restoreFromStore();
+    diag::MarkBootPhase(diag::BootPhase::StoreReady, micros());
+  }
   gLastServiceMicros = micros();
-  Serial.println("CTRL:READY");
+  diag::MarkBootPhase(diag::BootPhase::Ready, gLastServiceMicros);
 }
 
 void loop()
@@ -63,11 +140,37 @@ void loop()
   const uint32_t now = micros();
   const uint32_t elapsed = now - gLastServiceMicros;
   gLastServiceMicros = now;
+  if (elapsed > kLoopStallUs)
+  {
+    diag::Trace(diag::TraceKind::Overrun, static_cast<uint8_t>(diag::TraceOverrun::LoopStall),
+                static_cast<uint16_t>(std::min<uint32_t>(elapsed, UINT16_MAX)));
+  }
   if (elapsed > 0)
   {
+    diag::NoHeapScope noHeap;
     gCommandProcessor.service(elapsed);
   }
 
+  announceOnHostConnect();
+
+  bool pushed = false;
+  {
+    diag::NoHeapScope noHeap;
+    pushed = gCommandProcessor.collectUpdates(gResponse);
+  }
+  if (pushed)
+  {
+    emitResponse(gResponse);
+  }
+  {
+    diag::NoHeapScope noHeap;
+    pushed = gCommandProcessor.collectEvents(gResponse);
+  }
+  if (pushed)
+  {
+    emitResponse(gResponse);
+  }
+
   while (Serial.available() > 0)
   {
     char incoming = static_cast<char>(Serial.read());
@@ -89,6 +192,8 @@ void loop()
 
     gBuffer[gBufferLength++] = incoming;
   }
+
+  dispatchPendingCommands();
 }
 
 #endif // ARDUINO
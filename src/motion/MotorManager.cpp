@@ -1,6 +1,9 @@
 #include "motion/MotorManager.hpp"
 #include "motion/StepperPioProgram.hpp"
 
+#include "diag/MemoryBudget.hpp"
+#include "diag/TraceRing.hpp"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
@@ -22,155 +25,295 @@ namespace
 constexpr uint32_t kMicrosPerSecond = 1'000'000U;
 }
 
-MotorManager::MotorManager()
+template <std::size_t ChannelCount>
+BasicMotorManager<ChannelCount>::BasicMotorManager()
 {
   reset();
 }
 
-void MotorManager::reset()
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::reset()
 {
+  hot_ = HotPlans{};
   for (std::size_t i = 0; i < kMotorCount; ++i)
   {
     motors_[i] = MotorState{};
     motors_[i].speedHz = kDefaultSpeedHz;
     motors_[i].acceleration = kDefaultAcceleration;
-    motors_[i].phase = MotionPhase::Idle;
-    motors_[i].asleep = true;
-    motors_[i].fault = FaultCode::None;
-    motors_[i].limitClipped = false;
-    motors_[i].plannedDurationUs = 0;
 
     commandSlots_[i][0] = CommandSlot{};
     commandSlots_[i][1] = CommandSlot{};
     activeSlot_[i] = 0;
 
-    plans_[i] = ActivePlan{};
+    homing_[i] = HomingPlan{};
+    positiveLimits_[i] = kDefaultLimit;
+    negativeLimits_[i] = -kDefaultLimit;
+    zeroOffsets_[i] = 0;
 
     sleepRegister_.setChannel(i, true);
   }
+  homedMask_.fill(0);
+  dirtyMask_.fill(0);
+  cancelMask_.fill(0);
+  eventMask_.fill(0);
+  faultEventMask_.fill(0);
+  eventHead_ = 0;
+  eventCount_ = 0;
+  droppedEvents_ = 0;
+  commandTag_ = CommandTag{};
+  profileCache_.clear();
+  for (std::size_t i = 0; i < kMotorCount; ++i)
+  {
+    markDirty(i);
+  }
+  homingGroupLimits_.fill(0);
   sleepRegister_.apply();
 }
 
-MoveResult MotorManager::queueMove(std::size_t channel,
-                                   long targetPosition,
-                                   int32_t speedHz,
-                                   int32_t acceleration,
-                                   TimingEstimate &timing)
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::queueMove(std::size_t channel,
+                                                      int32_t targetPosition,
+                                                      int32_t speedHz,
+                                                      int32_t acceleration,
+                                                      TimingEstimate &timing)
 {
-  if (channel >= kMotorCount)
+  const MoveResult readiness = moveReadiness(channel);
+  if (readiness != MoveResult::Scheduled)
   {
-    return MoveResult::Fault;
+    return readiness;
   }
 
   auto &motor = motors_[channel];
-  if (motor.phase == MotionPhase::Homing)
-  {
-    return MoveResult::Busy;
-  }
-
-  if (motor.fault == FaultCode::DriverFault)
+  if (slotRunning(channel))
   {
-    return MoveResult::Fault;
+    // The PIO owns the running slot; queue behind it from where it ends.
+    // A later MOVE replaces a queued one the driver does not hold yet.
+    auto &queued = commandSlots_[channel][(activeSlot_[channel] + 1U) % 2U];
+    const int32_t from = hot_.startPosition[channel] + hot_.travel[channel];
+    const int32_t clamped = std::max(negativeLimits_[channel], std::min(positiveLimits_[channel], targetPosition));
+    const bool clipped = (clamped != targetPosition);
+    const uint32_t steps = static_cast<uint32_t>(std::llabs(static_cast<long long>(clamped) - from));
+    const MotionProfile &profile = planProfile(steps, speedHz, acceleration);
+    timing = profile.timing;
+
+    queued = CommandSlot{};
+    queued.tag = commandTag_;
+    queued.occupied = (steps != 0);
+    queued.stepCount = steps;
+    queued.stepRateHz = static_cast<uint32_t>(std::max<int32_t>(1, speedHz));
+    queued.rate = profile.rate;
+    queued.directionHigh = (clamped >= from);
+
+    motor.targetPosition = clamped;
+    motor.speedHz = speedHz;
+    motor.acceleration = acceleration;
+    motor.limitClipped = clipped;
+    motor.fault = clipped ? FaultCode::LimitClipped : FaultCode::None;
+    markDirty(channel);
+    return clipped ? MoveResult::ClippedToLimit : MoveResult::Scheduled;
   }
 
   // Determine which slot we can use without stalling the double-buffered pipeline.
+  // A fed-back slot the PIO has not taken yet is simply replaced.
   uint8_t slotToUse = activeSlot_[channel];
-  if (commandSlots_[channel][slotToUse].occupied)
+  const auto &current = commandSlots_[channel][slotToUse];
+  if (current.occupied && !(testBit(feedbackMask_, channel) && !current.dispatched))
   {
-    uint8_t alternate = static_cast<uint8_t>((slotToUse + 1U) % 2U);
-    if (commandSlots_[channel][alternate].occupied)
-    {
-      return MoveResult::Busy;
-    }
-    slotToUse = alternate;
+    slotToUse = static_cast<uint8_t>((slotToUse + 1U) % 2U);
   }
   activeSlot_[channel] = slotToUse;
 
-  long clamped = std::max(negativeLimit_, std::min(positiveLimit_, targetPosition));
+  int32_t clamped = std::max(negativeLimits_[channel], std::min(positiveLimits_[channel], targetPosition));
   bool clipped = (clamped != targetPosition);
-  uint32_t steps = static_cast<uint32_t>(std::llabs(clamped - motor.position));
-  timing = ComputeTiming(steps, speedHz, acceleration);
+  uint32_t steps = static_cast<uint32_t>(std::llabs(static_cast<long long>(clamped) - motor.position));
+  const MotionProfile &profile = planProfile(steps, speedHz, acceleration);
+  timing = profile.timing;
+
+  return commitMove(channel, clamped, speedHz, acceleration, steps, profile, clipped);
+}
+
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::moveReadiness(std::size_t channel) const
+{
+  if (channel >= kMotorCount)
+  {
+    return MoveResult::Fault;
+  }
+  const auto &motor = motors_[channel];
+  if (motor.phase == MotionPhase::Homing)
+  {
+    return MoveResult::Busy;
+  }
+  if (motor.fault == FaultCode::DriverFault)
+  {
+    return MoveResult::Fault;
+  }
+  if (cancelPending(channel))
+  {
+    return MoveResult::Busy;
+  }
 
-  return commitMove(channel, clamped, speedHz, acceleration, steps, timing, clipped);
+  const uint8_t active = activeSlot_[channel];
+  const auto &current = commandSlots_[channel][active];
+  const auto &alternate = commandSlots_[channel][(active + 1U) % 2U];
+  if (slotRunning(channel))
+  {
+    return alternate.dispatched ? MoveResult::Busy : MoveResult::Scheduled;
+  }
+  if (current.occupied && !(testBit(feedbackMask_, channel) && !current.dispatched) && alternate.occupied)
+  {
+    return MoveResult::Busy;
+  }
+  return MoveResult::Scheduled;
 }
 
-MoveResult MotorManager::commitMove(std::size_t channel,
-                                    long clampedTarget,
-                                    int32_t speedHz,
-                                    int32_t acceleration,
-                                    uint32_t steps,
-                                    TimingEstimate &timing,
-                                    bool clipped)
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::commitMove(std::size_t channel,
+                                                       int32_t clampedTarget,
+                                                       int32_t speedHz,
+                                                       int32_t acceleration,
+                                                       uint32_t steps,
+                                                       const MotionProfile &profile,
+                                                       bool clipped)
 {
   auto &motor = motors_[channel];
-  auto &plan = plans_[channel];
+  const TimingEstimate &timing = profile.timing;
 
   motor.targetPosition = clampedTarget;
   motor.speedHz = speedHz;
   motor.acceleration = acceleration;
   motor.limitClipped = clipped;
   motor.plannedDurationUs = timing.totalDurationUs;
+  homing_[channel] = HomingPlan{};
 
   if (timing.totalSteps == 0 || timing.totalDurationUs == 0)
   {
     motor.position = clampedTarget;
-    motor.phase = MotionPhase::Idle;
-    motor.asleep = true;
+    setPhase(channel, MotionPhase::Idle, true);
     motor.fault = clipped ? FaultCode::LimitClipped : FaultCode::None;
-    plan = ActivePlan{};
+    deactivatePlan(channel);
     commandSlots_[channel][activeSlot_[channel]].occupied = false;
+    markDirty(channel);
     updateAutosleep(channel);
+    pushEvent(channel, MotionEventKind::Done, commandTag_);
     return clipped ? MoveResult::ClippedToLimit : MoveResult::Scheduled;
   }
 
-  plan.active = true;
-  plan.homingPhase = false;
-  plan.homingStep = 0;
-  plan.elapsedUs = 0;
-  plan.startPosition = motor.position;
-  plan.targetPosition = clampedTarget;
-  plan.timing = timing;
-  plan.homingRange = 0;
-  plan.homingBackoff = 0;
+  const int32_t startPosition = motor.position;
+  activatePlan(channel, startPosition, clampedTarget, timing.totalDurationUs);
 
   auto &slot = commandSlots_[channel][activeSlot_[channel]];
   slot = CommandSlot{};
   slot.occupied = true;
-  slot.timing = timing;
   slot.stepCount = steps;
-  double clampedSpeed = static_cast<double>(std::max<int32_t>(1, speedHz));
-  double stepPeriodUs = static_cast<double>(kMicrosPerSecond) / clampedSpeed;
-  uint32_t periodUs = static_cast<uint32_t>(std::llround(std::max(1.0, stepPeriodUs)));
-  slot.halfPeriodMicros = std::max<uint32_t>(1U, periodUs / 2U);
-  slot.directionHigh = (clampedTarget >= plan.startPosition);
-
-  motor.phase = MotionPhase::Moving;
-  motor.asleep = false;
+  slot.stepRateHz = static_cast<uint32_t>(std::max<int32_t>(1, speedHz));
+  slot.rate = profile.rate;
+  slot.directionHigh = (clampedTarget >= startPosition);
+  slot.tag = commandTag_;
+
+  setPhase(channel, MotionPhase::Moving, false);
   motor.fault = clipped ? FaultCode::LimitClipped : FaultCode::None;
+  markDirty(channel);
   updateAutosleep(channel);
 
   return clipped ? MoveResult::ClippedToLimit : MoveResult::Scheduled;
 }
 
-MoveResult MotorManager::beginHoming(std::size_t channel, const HomingRequest &request)
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::beginHoming(std::size_t channel, const HomingRequest &request)
 {
-  if (channel >= kMotorCount)
+  const MoveResult result = homingReadiness(channel, request);
+  if (result == MoveResult::Scheduled)
+  {
+    prepareHoming(channel, request, kUngrouped);
+    startHoming(channel);
+  }
+  return result;
+}
+
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::beginHomingGroup(const ChannelMask &channels,
+                                                             const HomingRequest &request,
+                                                             std::size_t maxConcurrent)
+{
+  // Every channel is checked before any is touched, so a refusal leaves the
+  // whole group as it was.
+  bool any = false;
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (!testBit(channels, channel))
+    {
+      continue;
+    }
+    any = true;
+    const MoveResult result = homingReadiness(channel, request);
+    if (result != MoveResult::Scheduled)
+    {
+      return result;
+    }
+  }
+  if (!any)
   {
     return MoveResult::Fault;
   }
 
-  auto &motor = motors_[channel];
-  if (motor.phase == MotionPhase::Moving)
+  // A group keeps its own limit while any of its channels homes; take a
+  // slot no other group still holds. Channels re-homed here leave theirs.
+  uint16_t group = 0;
+  for (; group < kMotorCount; ++group)
   {
-    return MoveResult::Busy;
+    bool held = false;
+    for (std::size_t channel = 0; channel < kMotorCount && !held; ++channel)
+    {
+      held = homing_[channel].active && homing_[channel].group == group && !testBit(channels, channel);
+    }
+    if (!held)
+    {
+      break;
+    }
   }
+  homingGroupLimits_[group] = static_cast<uint16_t>((maxConcurrent == 0 || maxConcurrent > kMotorCount) ? kMotorCount
+                                                                                                       : maxConcurrent);
+  holdLatch();
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (testBit(channels, channel))
+    {
+      prepareHoming(channel, request, group);
+    }
+  }
+  startQueuedHoming();
+  releaseLatch();
+  return MoveResult::Scheduled;
+}
 
-  long range = (request.travelRange == 0) ? kDefaultTravelRange : request.travelRange;
-  if (range < 2L)
+template <std::size_t ChannelCount>
+MoveResult BasicMotorManager<ChannelCount>::homingReadiness(std::size_t channel, const HomingRequest &request) const
+{
+  if (channel >= kMotorCount)
   {
     return MoveResult::Fault;
   }
-  long backoff = (request.backoff == 0) ? kDefaultBackoff : request.backoff;
+  if (motors_[channel].phase == MotionPhase::Moving || cancelPending(channel))
+  {
+    return MoveResult::Busy;
+  }
+  if (((request.travelRange == 0) ? kDefaultTravelRange : request.travelRange) < 2)
+  {
+    return MoveResult::Fault;
+  }
+  if (commandSlots_[channel][0].occupied && commandSlots_[channel][1].occupied)
+  {
+    return MoveResult::Busy;
+  }
+  return MoveResult::Scheduled;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::prepareHoming(std::size_t channel, const HomingRequest &request, uint16_t group)
+{
+  const int32_t range = (request.travelRange == 0) ? kDefaultTravelRange : request.travelRange;
+  int32_t backoff = (request.backoff == 0) ? kDefaultBackoff : request.backoff;
   if (backoff < 0)
   {
     backoff = 0;
@@ -180,261 +323,597 @@ MoveResult MotorManager::beginHoming(std::size_t channel, const HomingRequest &r
     backoff = range - 1;
   }
 
-  uint8_t slotToUse = activeSlot_[channel];
-  if (commandSlots_[channel][slotToUse].occupied)
+  // homingReadiness() saw at least one slot free.
+  if (commandSlots_[channel][activeSlot_[channel]].occupied)
   {
-    uint8_t alternate = static_cast<uint8_t>((slotToUse + 1U) % 2U);
-    if (commandSlots_[channel][alternate].occupied)
-    {
-      return MoveResult::Busy;
-    }
-    slotToUse = alternate;
+    activeSlot_[channel] = static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U);
   }
-  activeSlot_[channel] = slotToUse;
 
-  auto &plan = plans_[channel];
-  plan = ActivePlan{};
-  plan.homingPhase = true;
-  plan.homingStep = 0;
-  plan.homingRange = range;
-  plan.homingBackoff = backoff;
-
-  motor.phase = MotionPhase::Homing;
-  motor.asleep = false;
+  auto &homing = homing_[channel];
+  homing = HomingPlan{};
+  homing.active = true;
+  homing.queued = (group != kUngrouped);
+  homing.group = group;
+  homing.range = range;
+  homing.backoff = backoff;
+  homing.stageTimeoutUs = (request.stageTimeoutUs == 0) ? kDefaultHomingStageTimeoutUs : request.stageTimeoutUs;
+  homing.tag = commandTag_;
+
+  homedMask_[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+  auto &motor = motors_[channel];
+  setPhase(channel, MotionPhase::Homing, motor.asleep);
   motor.limitClipped = false;
   motor.fault = FaultCode::None;
+  motor.plannedDurationUs = 0;
+  markDirty(channel);
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::startHoming(std::size_t channel)
+{
+  auto &motor = motors_[channel];
+  homing_[channel].queued = false;
+  setPhase(channel, motor.phase, false);
 
-  configureHomingStage(channel, plan);
-  if (!plan.active)
+  configureHomingStage(channel);
+  if (!isActive(channel))
   {
-    motor.position = 0;
-    motor.targetPosition = 0;
-    motor.phase = MotionPhase::Idle;
-    motor.asleep = true;
-    motor.plannedDurationUs = 0;
-    updateAutosleep(channel);
-    return MoveResult::Scheduled;
+    finishHoming(channel, homing_[channel].timedOut ? FaultCode::HomingTimeout : FaultCode::None);
+    return;
   }
 
-  motor.plannedDurationUs = plan.timing.totalDurationUs;
+  motor.plannedDurationUs = hot_.durationUs[channel];
+  markDirty(channel);
   updateAutosleep(channel);
-  return MoveResult::Scheduled;
 }
 
-void MotorManager::service(uint32_t elapsedMicros)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::finishHoming(std::size_t channel, FaultCode fault)
 {
-  if (elapsedMicros == 0)
+  auto &motor = motors_[channel];
+  const CommandTag tag = homing_[channel].tag;
+  homing_[channel] = HomingPlan{};
+  if (fault == FaultCode::None)
   {
-    return;
+    // The homed centre sits zeroOffset steps from logical zero.
+    motor.position = -zeroOffsets_[channel];
+    motor.targetPosition = motor.position;
+    homedMask_[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
   }
+  else
+  {
+    motor.targetPosition = motor.position;
+    homedMask_[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+  }
+  setPhase(channel, MotionPhase::Idle, true);
+  motor.limitClipped = false;
+  motor.fault = fault;
+  motor.plannedDurationUs = 0;
+  markDirty(channel);
+  updateAutosleep(channel);
+  pushEvent(channel, fault == FaultCode::None ? MotionEventKind::Homed : MotionEventKind::Fault, tag, fault);
+}
 
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::startQueuedHoming()
+{
+  // Each group answers to the limit it was started with.
   for (std::size_t channel = 0; channel < kMotorCount; ++channel)
   {
-    auto &plan = plans_[channel];
-    auto &motor = motors_[channel];
-
-    if (!plan.active)
+    if (!homing_[channel].active || !homing_[channel].queued)
     {
       continue;
     }
-
-    uint64_t elapsed = static_cast<uint64_t>(plan.elapsedUs) + elapsedMicros;
-    if (elapsed > plan.timing.totalDurationUs)
+    const uint16_t group = homing_[channel].group;
+    std::size_t running = 0;
+    for (std::size_t other = 0; other < kMotorCount; ++other)
     {
-      elapsed = plan.timing.totalDurationUs;
+      running += (homing_[other].active && !homing_[other].queued && homing_[other].group == group) ? 1U : 0U;
     }
-    plan.elapsedUs = static_cast<uint32_t>(elapsed);
-
-    if (plan.timing.totalDurationUs > 0)
+    if (running < homingGroupLimits_[group])
     {
-      double progress = static_cast<double>(plan.elapsedUs) / static_cast<double>(plan.timing.totalDurationUs);
-      long delta = plan.targetPosition - plan.startPosition;
-      long updated = plan.startPosition + static_cast<long>(std::llround(progress * static_cast<double>(delta)));
-      motor.position = updated;
+      startHoming(channel);
     }
+  }
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::service(uint32_t elapsedMicros)
+{
+  if (elapsedMicros == 0)
+  {
+    return;
+  }
 
-    if (plan.elapsedUs >= plan.timing.totalDurationUs)
+  for (std::size_t word = 0; word < kMaskWords; ++word)
+  {
+    uint32_t pending = hot_.activeMask[word];
+    // Every active channel either advances or completes this tick; fed-back
+    // channels do so in reconcileExecuted() instead.
+    dirtyMask_[word] |= pending;
+    pending &= ~feedbackMask_[word];
+    while (pending != 0U)
     {
-      motor.position = plan.targetPosition;
-      commandSlots_[channel][activeSlot_[channel]].occupied = false;
+      const std::size_t channel = (word * 32U) + static_cast<std::size_t>(__builtin_ctz(pending));
+      pending &= pending - 1U;
 
-      if (plan.homingPhase)
+      const uint32_t duration = hot_.durationUs[channel];
+      const uint32_t remaining = duration - hot_.elapsedUs[channel];
+      if (elapsedMicros >= remaining)
       {
-        if (plan.homingStep == 0)
-        {
-          plan.limitRecorded = true;
-          plan.homingLimitPosition = motor.position;
-        }
-        else if (plan.homingStep == 1)
-        {
-          plan.backoffRecorded = true;
-          plan.homingBackoffPosition = motor.position;
-        }
-
-        ++plan.homingStep;
-        if (plan.homingStep <= 2)
-        {
-          uint8_t nextSlot = static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U);
-          activeSlot_[channel] = nextSlot;
-          configureHomingStage(channel, plan);
-          if (plan.active)
-          {
-            motor.phase = MotionPhase::Homing;
-            motor.asleep = false;
-            motor.plannedDurationUs = plan.timing.totalDurationUs;
-            updateAutosleep(channel);
-            continue;
-          }
-        }
-
-        plan = ActivePlan{};
-        motor.position = 0;
-        motor.targetPosition = 0;
-        motor.phase = MotionPhase::Idle;
-        motor.asleep = true;
-        motor.limitClipped = false;
-        motor.fault = FaultCode::None;
-        motor.plannedDurationUs = 0;
-        updateAutosleep(channel);
+        hot_.elapsedUs[channel] = duration;
+        completePlan(channel);
         continue;
       }
 
-      plan = ActivePlan{};
-      motor.phase = MotionPhase::Idle;
-      motor.position = motor.targetPosition;
-      motor.asleep = true;
-      motor.plannedDurationUs = 0;
-      updateAutosleep(channel);
+      const uint32_t elapsed = hot_.elapsedUs[channel] + elapsedMicros;
+      hot_.elapsedUs[channel] = elapsed;
+
+      // Round-half-away-from-zero interpolation along the planned travel.
+      const int64_t scaled = static_cast<int64_t>(hot_.travel[channel]) * elapsed;
+      const int64_t half = static_cast<int64_t>(duration / 2U);
+      const int64_t offset = (scaled >= 0 ? scaled + half : scaled - half) / static_cast<int64_t>(duration);
+      motors_[channel].position = hot_.startPosition[channel] + static_cast<int32_t>(offset);
+    }
+
+    // Fed-back channels wait for the PIO's count, but a homing stage still
+    // answers to its deadline: a stalled or starved state machine would
+    // otherwise hold the channel in HOMING forever. elapsedUs, unused for
+    // them otherwise, restarts with each stage.
+    uint32_t watched = hot_.activeMask[word] & feedbackMask_[word];
+    while (watched != 0U)
+    {
+      const std::size_t channel = (word * 32U) + static_cast<std::size_t>(__builtin_ctz(watched));
+      watched &= watched - 1U;
+      if (!homing_[channel].active)
+      {
+        continue;
+      }
+      const uint32_t elapsed = hot_.elapsedUs[channel] + std::min(elapsedMicros, UINT32_MAX - hot_.elapsedUs[channel]);
+      hot_.elapsedUs[channel] = elapsed;
+      if (elapsed >= homing_[channel].stageTimeoutUs)
+      {
+        injectFault(channel, FaultCode::HomingTimeout);
+      }
     }
   }
 }
 
-void MotorManager::configureHomingStage(std::size_t channel, ActivePlan &plan)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::assignBit(ChannelMask &mask, std::size_t channel, bool value)
+{
+  const uint32_t bit = static_cast<uint32_t>(1UL << (channel % 32U));
+  mask[channel / 32U] = value ? (mask[channel / 32U] | bit) : (mask[channel / 32U] & ~bit);
+}
+
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::slotRunning(std::size_t channel) const
+{
+  const auto &slot = commandSlots_[channel][activeSlot_[channel]];
+  return testBit(feedbackMask_, channel) && isActive(channel) && slot.occupied && slot.dispatched;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::cancelRunningSlot(std::size_t channel)
+{
+  if (slotRunning(channel))
+  {
+    // hot_ keeps the start and travel until the final count arrives.
+    assignBit(cancelMask_, channel, true);
+  }
+}
+
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::isActive(std::size_t channel) const
+{
+  return (hot_.activeMask[channel / 32U] & (1UL << (channel % 32U))) != 0U;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::activatePlan(std::size_t channel,
+                                                   int32_t startPosition,
+                                                   int32_t targetPosition,
+                                                   uint32_t durationUs)
+{
+  hot_.elapsedUs[channel] = 0;
+  hot_.durationUs[channel] = durationUs;
+  hot_.startPosition[channel] = startPosition;
+  hot_.travel[channel] = targetPosition - startPosition;
+  hot_.activeMask[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::deactivatePlan(std::size_t channel)
+{
+  hot_.activeMask[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+  hot_.elapsedUs[channel] = 0;
+  hot_.durationUs[channel] = 0;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::completePlan(std::size_t channel)
 {
   auto &motor = motors_[channel];
+  auto &homing = homing_[channel];
+
+  motor.position = hot_.startPosition[channel] + hot_.travel[channel];
+  commandSlots_[channel][activeSlot_[channel]].occupied = false;
+  const CommandTag tag = commandSlots_[channel][activeSlot_[channel]].tag;
+  deactivatePlan(channel);
 
-  if (plan.homingStep > 2)
+  if (homing.active)
   {
-    plan.active = false;
+    if (homing.timedOut)
+    {
+      finishHoming(channel, FaultCode::HomingTimeout);
+      startQueuedHoming();
+      return;
+    }
+    // The carriage sits on the stop after either approach; the slow one wins.
+    if (homing.stage == 0 || homing.stage == 2)
+    {
+      homing.limitRecorded = true;
+      homing.limitPosition = motor.position;
+    }
+
+    ++homing.stage;
+    if (homing.stage < kHomingStageCount)
+    {
+      activeSlot_[channel] = static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U);
+      configureHomingStage(channel);
+      if (isActive(channel))
+      {
+        setPhase(channel, MotionPhase::Homing, false);
+        motor.plannedDurationUs = hot_.durationUs[channel];
+        markDirty(channel);
+        updateAutosleep(channel);
+        return;
+      }
+    }
+
+    finishHoming(channel, homing.timedOut ? FaultCode::HomingTimeout : FaultCode::None);
+    startQueuedHoming();
     return;
   }
 
-  plan.startPosition = motor.position;
-  switch (plan.homingStep)
-  {
-  case 0:
-    plan.targetPosition = plan.startPosition - plan.homingRange;
-    break;
-  case 1:
-    plan.targetPosition = plan.startPosition + plan.homingBackoff;
-    break;
-  case 2:
+  auto &queued = commandSlots_[channel][(activeSlot_[channel] + 1U) % 2U];
+  if (testBit(feedbackMask_, channel) && queued.occupied)
   {
-    long limitBase = plan.limitRecorded ? plan.homingLimitPosition : (plan.startPosition - plan.homingBackoff);
-    long centerOffset = plan.homingRange / 2L;
-    plan.targetPosition = limitBase + centerOffset;
-    break;
-  }
-  default:
-    plan.active = false;
+    // The chained move starts where this one ended; both report.
+    pushEvent(channel, MotionEventKind::Done, tag);
+    activeSlot_[channel] = static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U);
+    const int32_t travel = queued.directionHigh ? static_cast<int32_t>(queued.stepCount)
+                                                : -static_cast<int32_t>(queued.stepCount);
+    const TimingEstimate timing =
+        planProfile(queued.stepCount, static_cast<int32_t>(queued.stepRateHz), motor.acceleration).timing;
+    activatePlan(channel, motor.position, motor.position + travel, timing.totalDurationUs);
+    motor.plannedDurationUs = timing.totalDurationUs;
+    markDirty(channel);
     return;
   }
 
-  uint32_t steps = static_cast<uint32_t>(std::llabs(plan.targetPosition - plan.startPosition));
-  plan.timing = ComputeTiming(steps, motor.speedHz, motor.acceleration);
-  plan.elapsedUs = 0;
+  motor.position = motor.targetPosition;
+  setPhase(channel, MotionPhase::Idle, true);
+  motor.plannedDurationUs = 0;
+  markDirty(channel);
+  updateAutosleep(channel);
+  pushEvent(channel, MotionEventKind::Done, tag);
+}
 
-  auto &slot = commandSlots_[channel][activeSlot_[channel]];
-  slot = CommandSlot{};
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::configureHomingStage(std::size_t channel)
+{
+  auto &motor = motors_[channel];
+  auto &homing = homing_[channel];
 
-  if (steps == 0 || plan.timing.totalDurationUs == 0)
+  // Stages that need no travel are settled in place and skipped.
+  for (; homing.stage < kHomingStageCount; ++homing.stage)
   {
-    motor.position = plan.targetPosition;
-    motor.targetPosition = plan.targetPosition;
-    plan.active = false;
-    if (plan.homingStep < 2)
+    const int32_t startPosition = motor.position;
+    int32_t targetPosition = startPosition;
+    int32_t speedHz = motor.speedHz;
+    switch (homing.stage)
+    {
+    case 0:
+      targetPosition = startPosition - homing.range;
+      break;
+    case 1:
+      targetPosition = startPosition + homing.backoff;
+      break;
+    case 2:
+      // Overshoot the stop so the slow pass is sure to seat against it.
+      targetPosition = startPosition - (2 * homing.backoff);
+      speedHz = std::max<int32_t>(1, motor.speedHz / kHomingSlowDivisor);
+      break;
+    default:
     {
-      ++plan.homingStep;
-      configureHomingStage(channel, plan);
+      int32_t limitBase = homing.limitRecorded ? homing.limitPosition : startPosition;
+      targetPosition = limitBase + (homing.range / 2);
+      break;
+    }
     }
-    return;
-  }
 
-  double clampedSpeed = static_cast<double>(std::max<int32_t>(1, motor.speedHz));
-  double stepPeriodUs = static_cast<double>(kMicrosPerSecond) / clampedSpeed;
-  uint32_t periodUs = static_cast<uint32_t>(std::llround(std::max(1.0, stepPeriodUs)));
+    uint32_t steps = static_cast<uint32_t>(std::llabs(static_cast<long long>(targetPosition) - startPosition));
+    const MotionProfile &profile = planProfile(steps, speedHz, motor.acceleration);
+    TimingEstimate timing = profile.timing;
 
-  slot.occupied = true;
-  slot.timing = plan.timing;
-  slot.stepCount = steps;
-  slot.halfPeriodMicros = std::max<uint32_t>(1U, periodUs / 2U);
-  slot.directionHigh = (plan.targetPosition >= plan.startPosition);
+    auto &slot = commandSlots_[channel][activeSlot_[channel]];
+    slot = CommandSlot{};
+
+    if (steps == 0 || timing.totalDurationUs == 0)
+    {
+      motor.position = targetPosition;
+      motor.targetPosition = targetPosition;
+      continue;
+    }
+
+    // A stage never drives past its deadline: cut it short there and fault
+    // the channel when it completes.
+    if (timing.totalDurationUs > homing.stageTimeoutUs)
+    {
+      const int64_t travel = static_cast<int64_t>(targetPosition) - startPosition;
+      targetPosition = startPosition + static_cast<int32_t>((travel * homing.stageTimeoutUs) / timing.totalDurationUs);
+      steps = static_cast<uint32_t>(std::llabs(static_cast<long long>(targetPosition) - startPosition));
+      timing.totalDurationUs = homing.stageTimeoutUs;
+      homing.timedOut = true;
+      if (steps == 0)
+      {
+        break;
+      }
+    }
+
+    slot.occupied = true;
+    slot.stepCount = steps;
+    slot.stepRateHz = static_cast<uint32_t>(std::max<int32_t>(1, speedHz));
+    slot.rate = profile.rate;
+    slot.directionHigh = (targetPosition >= startPosition);
+    slot.tag = homing.tag;
+
+    activatePlan(channel, startPosition, targetPosition, timing.totalDurationUs);
+    motor.targetPosition = targetPosition;
+    motor.plannedDurationUs = timing.totalDurationUs;
+    return;
+  }
 
-  plan.active = true;
-  motor.targetPosition = plan.targetPosition;
-  motor.plannedDurationUs = plan.timing.totalDurationUs;
+  deactivatePlan(channel);
 }
 
-void MotorManager::forceSleep(std::size_t channel)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::forceSleep(std::size_t channel)
 {
   if (channel >= kMotorCount)
   {
     return;
   }
 
-  motors_[channel].phase = MotionPhase::Idle;
-  motors_[channel].asleep = true;
+  cancelRunningSlot(channel);
+  setPhase(channel, MotionPhase::Idle, true);
   motors_[channel].plannedDurationUs = 0;
-  plans_[channel] = ActivePlan{};
-  commandSlots_[channel][0] = CommandSlot{};
-  commandSlots_[channel][1] = CommandSlot{};
-  activeSlot_[channel] = 0;
+  deactivatePlan(channel);
+  const bool wasHoming = homing_[channel].active;
+  homing_[channel] = HomingPlan{};
+  if (!cancelPending(channel))
+  {
+    // A cancelled channel keeps its slots until reconcileExecuted() knows
+    // which of them the PIO got to.
+    commandSlots_[channel][0] = CommandSlot{};
+    commandSlots_[channel][1] = CommandSlot{};
+    activeSlot_[channel] = 0;
+  }
+  markDirty(channel);
   updateAutosleep(channel);
+  if (wasHoming)
+  {
+    startQueuedHoming();
+  }
 }
 
-void MotorManager::forceWake(std::size_t channel)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::forceWake(std::size_t channel)
 {
   if (channel >= kMotorCount)
   {
     return;
   }
-  motors_[channel].asleep = false;
+  setPhase(channel, motors_[channel].phase, false);
+  markDirty(channel);
   updateAutosleep(channel);
 }
 
-void MotorManager::injectFault(std::size_t channel, FaultCode fault)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::queueMoveGroup(const ChannelMask &channels,
+                                                     int32_t targetPosition,
+                                                     int32_t speedHz,
+                                                     int32_t acceleration,
+                                                     GroupMoveResult &result)
+{
+  result = GroupMoveResult{};
+  holdLatch();
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (!testBit(channels, channel))
+    {
+      continue;
+    }
+    TimingEstimate timing{};
+    switch (queueMove(channel, targetPosition, speedHz, acceleration, timing))
+    {
+    case MoveResult::ClippedToLimit:
+      assignBit(result.clipped, channel, true);
+      [[fallthrough]];
+    case MoveResult::Scheduled:
+      assignBit(result.scheduled, channel, true);
+      result.longestDurationUs = std::max(result.longestDurationUs, timing.totalDurationUs);
+      break;
+    case MoveResult::Busy:
+      assignBit(result.busy, channel, true);
+      break;
+    case MoveResult::Fault:
+      assignBit(result.fault, channel, true);
+      break;
+    }
+  }
+  releaseLatch();
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::forceSleepGroup(const ChannelMask &channels)
+{
+  holdLatch();
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (testBit(channels, channel))
+    {
+      forceSleep(channel);
+    }
+  }
+  releaseLatch();
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::forceWakeGroup(const ChannelMask &channels)
+{
+  holdLatch();
+  for (std::size_t channel = 0; channel < kMotorCount; ++channel)
+  {
+    if (testBit(channels, channel))
+    {
+      forceWake(channel);
+    }
+  }
+  releaseLatch();
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::injectFault(std::size_t channel, FaultCode fault)
 {
   if (channel >= kMotorCount)
   {
     return;
   }
 
+  cancelRunningSlot(channel);
+  const auto &running = commandSlots_[channel][activeSlot_[channel]];
+  const CommandTag tag = homing_[channel].active ? homing_[channel].tag
+                         : running.occupied      ? running.tag
+                                                 : CommandTag{};
   motors_[channel].fault = fault;
-  motors_[channel].phase = MotionPhase::Idle;
+  if (fault == FaultCode::DriverFault || fault == FaultCode::HomingTimeout)
+  {
+    // Steps may have been lost; the position needs re-establishing.
+    homedMask_[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+  }
+  setPhase(channel, MotionPhase::Idle, true);
   motors_[channel].plannedDurationUs = 0;
-  motors_[channel].asleep = true;
-  plans_[channel] = ActivePlan{};
-  commandSlots_[channel][0] = CommandSlot{};
-  commandSlots_[channel][1] = CommandSlot{};
-  activeSlot_[channel] = 0;
+  deactivatePlan(channel);
+  const bool wasHoming = homing_[channel].active;
+  homing_[channel] = HomingPlan{};
+  if (!cancelPending(channel))
+  {
+    // A cancelled channel keeps its slots until reconcileExecuted() knows
+    // which of them the PIO got to.
+    commandSlots_[channel][0] = CommandSlot{};
+    commandSlots_[channel][1] = CommandSlot{};
+    activeSlot_[channel] = 0;
+    if (fault != FaultCode::None)
+    {
+      pushEvent(channel, MotionEventKind::Fault, tag, fault);
+    }
+  }
+  else
+  {
+    // Reported once the aborted count has settled the position.
+    assignBit(faultEventMask_, channel, fault != FaultCode::None);
+  }
+  markDirty(channel);
   updateAutosleep(channel);
+  if (wasHoming)
+  {
+    startQueuedHoming();
+  }
+}
+
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::setCalibration(std::size_t channel,
+                                                     int32_t zeroOffset,
+                                                     int32_t negativeLimit,
+                                                     int32_t positiveLimit)
+{
+  if (channel >= kMotorCount || negativeLimit > positiveLimit || motors_[channel].phase != MotionPhase::Idle)
+  {
+    return false;
+  }
+  // Re-express the current position against the new zero so a homed channel
+  // stays homed.
+  motors_[channel].position += zeroOffsets_[channel] - zeroOffset;
+  motors_[channel].targetPosition = motors_[channel].position;
+  zeroOffsets_[channel] = zeroOffset;
+  negativeLimits_[channel] = negativeLimit;
+  positiveLimits_[channel] = positiveLimit;
+  markDirty(channel);
+  return true;
 }
 
-void MotorManager::clearFault(std::size_t channel)
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::restorePosition(std::size_t channel, int32_t position, bool homed)
+{
+  if (channel >= kMotorCount || motors_[channel].phase != MotionPhase::Idle)
+  {
+    return false;
+  }
+  motors_[channel].position = position;
+  motors_[channel].targetPosition = position;
+  if (homed)
+  {
+    homedMask_[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
+  }
+  else
+  {
+    homedMask_[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+  }
+  markDirty(channel);
+  return true;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::markDirty(std::size_t channel)
+{
+  if (channel >= kMotorCount)
+  {
+    return;
+  }
+  dirtyMask_[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::clearDirty(std::size_t channel)
+{
+  if (channel >= kMotorCount)
+  {
+    return;
+  }
+  dirtyMask_[channel / 32U] &= ~static_cast<uint32_t>(1UL << (channel % 32U));
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::clearFault(std::size_t channel)
 {
   if (channel >= kMotorCount)
   {
     return;
   }
   motors_[channel].fault = FaultCode::None;
+  markDirty(channel);
 }
 
-const MotorState &MotorManager::state(std::size_t channel) const
+template <std::size_t ChannelCount>
+const MotorState &BasicMotorManager<ChannelCount>::state(std::size_t channel) const
 {
   return motors_[channel];
 }
 
-TimingEstimate MotorManager::ComputeTiming(uint32_t steps, int32_t speedHz, int32_t acceleration)
+template <std::size_t ChannelCount>
+TimingEstimate BasicMotorManager<ChannelCount>::ComputeTiming(uint32_t steps, int32_t speedHz, int32_t acceleration)
 {
   TimingEstimate timing{};
   timing.totalSteps = steps;
@@ -472,7 +951,8 @@ TimingEstimate MotorManager::ComputeTiming(uint32_t steps, int32_t speedHz, int3
   return timing;
 }
 
-void MotorManager::markCommandExecuted(std::size_t channel)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::markCommandExecuted(std::size_t channel)
 {
   if (channel >= kMotorCount)
   {
@@ -481,7 +961,8 @@ void MotorManager::markCommandExecuted(std::size_t channel)
   commandSlots_[channel][activeSlot_[channel]] = CommandSlot{};
 }
 
-void MotorManager::configureShiftRegister(const ShiftRegisterPins &pins)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::configureShiftRegister(const ShiftRegisterPins &pins)
 {
   sleepRegister_.configure(pins);
   for (std::size_t i = 0; i < kMotorCount; ++i)
@@ -491,13 +972,45 @@ void MotorManager::configureShiftRegister(const ShiftRegisterPins &pins)
   sleepRegister_.apply();
 }
 
-void MotorManager::updateAutosleep(std::size_t channel)
+// Every phase and sleep edge goes through here so the trace ring sees it.
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::setPhase(std::size_t channel, MotionPhase phase, bool asleep)
+{
+  auto &motor = motors_[channel];
+  if (motor.phase != phase || motor.asleep != asleep)
+  {
+    diag::Trace(diag::TraceKind::PhaseChange, static_cast<uint8_t>(channel),
+                static_cast<uint16_t>(static_cast<uint16_t>(phase) | (asleep ? 0x100U : 0U)));
+  }
+  motor.phase = phase;
+  motor.asleep = asleep;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::updateAutosleep(std::size_t channel)
 {
   sleepRegister_.setChannel(channel, motors_[channel].asleep);
+  if (latchHeld_)
+  {
+    latchPending_ = true;
+    return;
+  }
   sleepRegister_.apply();
 }
 
-void MotorManager::exportCommandBuffer(std::size_t channel, pio::CommandBuffer &out) const
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::releaseLatch()
+{
+  latchHeld_ = false;
+  if (latchPending_)
+  {
+    latchPending_ = false;
+    sleepRegister_.apply();
+  }
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::exportCommandBuffer(std::size_t channel, pio::CommandBuffer &out) const
 {
   if (channel >= kMotorCount)
   {
@@ -506,14 +1019,205 @@ void MotorManager::exportCommandBuffer(std::size_t channel, pio::CommandBuffer &
   for (std::size_t index = 0; index < 2; ++index)
   {
     const auto &source = commandSlots_[channel][index];
-    out.slots[index].stepCount = source.stepCount;
-    out.slots[index].delayTicks = source.halfPeriodMicros;
-    out.slots[index].directionHigh = source.directionHigh;
+    out.slots[index] = ToStepperCommand(source);
+    out.words[index] = source.occupied ? pio::PackCommandWord(out.slots[index]) : 0U;
     out.occupied[index] = source.occupied;
   }
 }
 
-void MotorManager::SleepRegister::configure(const ShiftRegisterPins &pins)
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::takePendingCommand(std::size_t channel, pio::StepperCommand &out)
+{
+  if (channel >= kMotorCount)
+  {
+    return false;
+  }
+  if (cancelPending(channel))
+  {
+    return false;
+  }
+  const uint8_t index =
+      slotRunning(channel) ? static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U) : activeSlot_[channel];
+  auto &slot = commandSlots_[channel][index];
+  if (!slot.occupied || slot.dispatched)
+  {
+    return false;
+  }
+  slot.dispatched = true;
+  out = ToStepperCommand(slot);
+  diag::Trace(diag::TraceKind::SlotLatched, static_cast<uint8_t>(channel),
+              static_cast<uint16_t>(std::min<uint32_t>(slot.stepCount, UINT16_MAX)));
+  return true;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::setExecutionFeedback(std::size_t channel, bool enabled)
+{
+  if (channel < kMotorCount)
+  {
+    assignBit(feedbackMask_, channel, enabled);
+  }
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::reconcileExecuted(std::size_t channel,
+                                                        uint32_t retiredCommands,
+                                                        uint32_t executedSteps)
+{
+  if (channel >= kMotorCount)
+  {
+    return;
+  }
+  const bool cancelled = cancelPending(channel);
+  auto &motor = motors_[channel];
+  for (uint32_t retired = 0; retired < retiredCommands; ++retired)
+  {
+    if (!cancelled)
+    {
+      if (!slotRunning(channel))
+      {
+        break;
+      }
+      completePlan(channel);
+      continue;
+    }
+    // Finished before the abort landed; the queued slot, if the driver had
+    // it, is the one the abort interrupted.
+    hot_.startPosition[channel] += hot_.travel[channel];
+    hot_.travel[channel] = 0;
+    commandSlots_[channel][activeSlot_[channel]] = CommandSlot{};
+    const uint8_t next = static_cast<uint8_t>((activeSlot_[channel] + 1U) % 2U);
+    const auto &queued = commandSlots_[channel][next];
+    if (queued.occupied && queued.dispatched)
+    {
+      activeSlot_[channel] = next;
+      hot_.travel[channel] =
+          queued.directionHigh ? static_cast<int32_t>(queued.stepCount) : -static_cast<int32_t>(queued.stepCount);
+    }
+  }
+  if (!cancelled && !slotRunning(channel))
+  {
+    return;
+  }
+
+  const int32_t travel = hot_.travel[channel];
+  const uint32_t total = static_cast<uint32_t>(std::llabs(static_cast<long long>(travel)));
+  const int32_t done = static_cast<int32_t>(std::min(executedSteps, total));
+  const int32_t position = hot_.startPosition[channel] + (travel < 0 ? -done : done);
+  if (cancelled)
+  {
+    const CommandTag tag = commandSlots_[channel][activeSlot_[channel]].tag;
+    assignBit(cancelMask_, channel, false);
+    commandSlots_[channel][0] = CommandSlot{};
+    commandSlots_[channel][1] = CommandSlot{};
+    activeSlot_[channel] = 0;
+    motor.position = position;
+    motor.targetPosition = position;
+    markDirty(channel);
+    if (testBit(faultEventMask_, channel))
+    {
+      assignBit(faultEventMask_, channel, false);
+      pushEvent(channel, MotionEventKind::Fault, tag, motor.fault);
+    }
+    return;
+  }
+  if (position != motor.position)
+  {
+    motor.position = position;
+    markDirty(channel);
+  }
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::setEventsEnabled(std::size_t channel, bool enabled)
+{
+  if (channel < kMotorCount)
+  {
+    assignBit(eventMask_, channel, enabled);
+  }
+}
+
+template <std::size_t ChannelCount>
+bool BasicMotorManager<ChannelCount>::popEvent(MotionEvent &out)
+{
+  if (eventCount_ == 0)
+  {
+    return false;
+  }
+  out = events_[eventHead_];
+  eventHead_ = static_cast<uint16_t>((eventHead_ + 1U) % kEventQueueCapacity);
+  --eventCount_;
+  return true;
+}
+
+template <std::size_t ChannelCount>
+uint32_t BasicMotorManager<ChannelCount>::takeDroppedEvents()
+{
+  const uint32_t dropped = droppedEvents_;
+  droppedEvents_ = 0;
+  return dropped;
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::pushEvent(std::size_t channel,
+                                                MotionEventKind kind,
+                                                const CommandTag &tag,
+                                                FaultCode fault)
+{
+  if (!testBit(eventMask_, channel))
+  {
+    return;
+  }
+  if (eventCount_ == kEventQueueCapacity)
+  {
+    if (droppedEvents_ != UINT32_MAX)
+    {
+      ++droppedEvents_;
+    }
+    diag::Trace(diag::TraceKind::Overrun, static_cast<uint8_t>(diag::TraceOverrun::EventQueue),
+                static_cast<uint16_t>(channel));
+    return;
+  }
+  MotionEvent &event = events_[(eventHead_ + eventCount_) % kEventQueueCapacity];
+  event.position = motors_[channel].position;
+  event.tag = tag;
+  event.channel = static_cast<uint16_t>(channel);
+  event.kind = kind;
+  event.fault = fault;
+  ++eventCount_;
+}
+
+template <std::size_t ChannelCount>
+pio::StepperCommand BasicMotorManager<ChannelCount>::ToStepperCommand(const CommandSlot &slot)
+{
+  // The rate timing came with the plan that filled the slot.
+  pio::StepperCommand command{};
+  command.stepCount = slot.stepCount;
+  command.delayTicks = slot.rate.delayTicks;
+  command.clockDivider = slot.rate.clockDivider;
+  command.delayFraction = slot.rate.delayFraction;
+  command.directionHigh = slot.directionHigh;
+  return command;
+}
+
+template <std::size_t ChannelCount>
+const MotionProfile &BasicMotorManager<ChannelCount>::planProfile(uint32_t steps, int32_t speedHz, int32_t acceleration)
+{
+  if (const MotionProfile *cached = profileCache_.find(steps, speedHz, acceleration))
+  {
+    return *cached;
+  }
+  MotionProfile profile{};
+  profile.timing = ComputeTiming(steps, speedHz, acceleration);
+  const pio::StepperCommand command = pio::StepTimingForRate(static_cast<uint32_t>(std::max<int32_t>(1, speedHz)));
+  profile.rate.delayTicks = command.delayTicks;
+  profile.rate.clockDivider = command.clockDivider;
+  profile.rate.delayFraction = command.delayFraction;
+  return profileCache_.insert(steps, speedHz, acceleration, profile);
+}
+
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::SleepRegister::configure(const ShiftRegisterPins &pins)
 {
   pins_ = pins;
   configured_ = (pins.data != 0 || pins.clock != 0 || pins.latch != 0);
@@ -526,40 +1230,63 @@ void MotorManager::SleepRegister::configure(const ShiftRegisterPins &pins)
     pinMode(pins_.latch, OUTPUT);
   }
 #endif
-  states_.fill(true);
+  awakeBits_.fill(0);
 }
 
-void MotorManager::SleepRegister::setChannel(std::size_t channel, bool asleep)
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::SleepRegister::setChannel(std::size_t channel, bool asleep)
 {
-  if (channel >= MotorManager::kMotorCount)
+  if (channel >= ChannelCount)
   {
     return;
   }
-  states_[channel] = asleep;
+  uint8_t &bits = awakeBits_[channel / 8U];
+  const uint8_t mask = static_cast<uint8_t>(1U << (channel % 8U));
+  if (asleep)
+  {
+    bits = static_cast<uint8_t>(bits & ~mask);
+  }
+  else
+  {
+    bits = static_cast<uint8_t>(bits | mask);
+  }
 }
 
-void MotorManager::SleepRegister::apply()
+template <std::size_t ChannelCount>
+void BasicMotorManager<ChannelCount>::SleepRegister::apply()
 {
   if (!configured_)
   {
     return;
   }
-
-#if defined(ARDUINO)
-  uint8_t pattern = 0;
-  for (std::size_t channel = 0; channel < MotorManager::kMotorCount; ++channel)
+  uint16_t lowChannels = awakeBits_[0];
+  if constexpr (kRegisterCount > 1)
   {
-    bool awake = !states_[channel];
-    if (awake)
-    {
-      pattern |= static_cast<uint8_t>(1U << channel);
-    }
+    lowChannels = static_cast<uint16_t>(lowChannels | (awakeBits_[1] << 8));
   }
+  diag::Trace(diag::TraceKind::SleepLatch, diag::kTraceNoChannel, lowChannels);
 
+#if defined(ARDUINO)
+  // The register furthest down the chain is shifted first so register 0 ends
+  // up nearest the MCU; one latch pulse then updates every SLEEP line at once.
   digitalWrite(pins_.latch, LOW);
-  shiftOut(pins_.data, pins_.clock, LSBFIRST, pattern);
+  for (std::size_t index = kRegisterCount; index-- > 0;)
+  {
+    shiftOut(pins_.data, pins_.clock, LSBFIRST, awakeBits_[index]);
+  }
   digitalWrite(pins_.latch, HIGH);
 #endif
 }
 
+template class BasicMotorManager<8>;
+template class BasicMotorManager<16>;
+template class BasicMotorManager<32>;
+template class BasicMotorManager<64>;
+#if MOTION_CHANNEL_COUNT != 8 && MOTION_CHANNEL_COUNT != 16 && MOTION_CHANNEL_COUNT != 32 && MOTION_CHANNEL_COUNT != 64
+template class BasicMotorManager<kChannelCount>;
+#endif
+
+static_assert(sizeof(MotorManager) <= diag::kMotorManagerBudgetBytes,
+              "MotorManager outgrew its RAM budget (include/diag/MemoryBudget.hpp)");
+
 } // namespace motion
@@ -0,0 +1,67 @@
+#include "motion/ProfileCache.hpp"
+
+#include "diag/MemoryBudget.hpp"
+
+namespace motion
+{
+
+static_assert(sizeof(ProfileCache) <= diag::kProfileCacheBudgetBytes,
+              "ProfileCache outgrew its RAM budget (include/diag/MemoryBudget.hpp)");
+
+const MotionProfile *ProfileCache::find(uint32_t steps, int32_t speedHz, int32_t acceleration)
+{
+  for (std::size_t index = 0; index < stats_.entries; ++index)
+  {
+    Entry &entry = entries_[index];
+    if (entry.steps == steps && entry.speedHz == speedHz && entry.acceleration == acceleration)
+    {
+      entry.lastUse = ++useClock_;
+      ++stats_.hits;
+      return &entry.profile;
+    }
+  }
+  ++stats_.misses;
+  return nullptr;
+}
+
+const MotionProfile &ProfileCache::insert(uint32_t steps,
+                                          int32_t speedHz,
+                                          int32_t acceleration,
+                                          const MotionProfile &profile)
+{
+  std::size_t slot = stats_.entries;
+  if (slot == kCapacity)
+  {
+    // Unsigned distances from the clock keep the order across wraparound.
+    slot = 0;
+    for (std::size_t index = 1; index < kCapacity; ++index)
+    {
+      if (useClock_ - entries_[index].lastUse > useClock_ - entries_[slot].lastUse)
+      {
+        slot = index;
+      }
+    }
+    ++stats_.evictions;
+  }
+  else
+  {
+    ++stats_.entries;
+  }
+
+  Entry &entry = entries_[slot];
+  entry.steps = steps;
+  entry.speedHz = speedHz;
+  entry.acceleration = acceleration;
+  entry.lastUse = ++useClock_;
+  entry.profile = profile;
+  return entry.profile;
+}
+
+void ProfileCache::clear()
+{
+  entries_.fill(Entry{});
+  useClock_ = 0;
+  stats_ = Stats{};
+}
+
+} // namespace motion
@@ -0,0 +1,171 @@
+#include "motion/StepGroupDriver.hpp"
+
+#include <algorithm>
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+#define MOTION_HAS_PIO 1
+#include <hardware/dma.h>
+#endif
+
+namespace motion::pio
+{
+
+namespace
+{
+#if defined(MOTION_HAS_PIO)
+PIO BlockInstance(uint8_t block)
+{
+  return (block == 0) ? pio0 : pio1;
+}
+#endif
+} // namespace
+
+bool StepGroupDriver::begin(const StepGroupPins *groups, std::size_t groupCount)
+{
+  groupCount_ = 0;
+  if (groups == nullptr)
+  {
+    return false;
+  }
+  for (std::size_t g = 0; g < std::min(groupCount, kMaxGroups); ++g)
+  {
+    const StepGroupPins &pins = groups[g];
+    if (pins.axisCount == 0 || pins.axisCount > kMaxGroupAxes)
+    {
+      return false;
+    }
+    Group &group = groups_[g];
+    group = Group{};
+    group.axisCount = pins.axisCount;
+
+#if defined(MOTION_HAS_PIO)
+    const pio_program &program = StepGroupProgram();
+    int sm = -1;
+    for (uint8_t block = 0; block < kPioBlockCount && sm < 0; ++block)
+    {
+      PIO instance = BlockInstance(block);
+      if (programOffsets_[block] < 0)
+      {
+        if (!pio_can_add_program(instance, &program))
+        {
+          continue;
+        }
+        programOffsets_[block] = static_cast<int8_t>(pio_add_program(instance, &program));
+      }
+      sm = pio_claim_unused_sm(instance, false);
+      group.block = block;
+    }
+    if (sm < 0)
+    {
+      return false;
+    }
+    const int dma = dma_claim_unused_channel(false);
+    if (dma < 0)
+    {
+      // Hand the state machine back so a later begin() can claim it.
+      pio_sm_unclaim(BlockInstance(group.block), static_cast<uint>(sm));
+      return false;
+    }
+    group.index = static_cast<uint8_t>(sm);
+    group.dmaChannel = static_cast<int8_t>(dma);
+
+    PIO instance = BlockInstance(group.block);
+    const uint offset = static_cast<uint>(programOffsets_[group.block]);
+    const uint pinCount = 2U * pins.axisCount;
+    for (uint pin = 0; pin < pinCount; ++pin)
+    {
+      pio_gpio_init(instance, pins.base + pin);
+    }
+    pio_sm_set_consecutive_pindirs(instance, group.index, pins.base, pinCount, true);
+
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, offset, offset + program.length - 1);
+    sm_config_set_out_pins(&config, pins.base, pinCount);
+    sm_config_set_out_shift(&config, true, true, 32);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv_int_frac(&config, kStepGroupClockDivider, 0);
+    pio_sm_init(instance, group.index, offset, &config);
+    pio_sm_set_enabled(instance, group.index, true);
+
+    dma_channel_config dmaConfig = dma_channel_get_default_config(static_cast<uint>(dma));
+    channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&dmaConfig, true);
+    channel_config_set_write_increment(&dmaConfig, false);
+    channel_config_set_dreq(&dmaConfig, pio_get_dreq(instance, group.index, true));
+    dma_channel_configure(static_cast<uint>(dma), &dmaConfig, &instance->txf[group.index], group.buffers[0].data(), 0,
+                          false);
+#endif
+    groupCount_ = g + 1;
+  }
+  return groupCount_ == groupCount;
+}
+
+bool StepGroupDriver::move(std::size_t group, const int32_t *deltas, std::size_t axisCount, uint32_t periodTicks)
+{
+  if (group >= groupCount_ || deltas == nullptr || busy(group))
+  {
+    return false;
+  }
+  Group &state = groups_[group];
+  state.interpolator.start(deltas, std::min<std::size_t>(axisCount, state.axisCount), periodTicks);
+  for (uint8_t buffer = 0; buffer < 2; ++buffer)
+  {
+    state.lengths[buffer] = state.interpolator.fill(state.buffers[buffer].data(), kBufferWords);
+  }
+  startBuffer(state, 0);
+  return true;
+}
+
+bool StepGroupDriver::busy(std::size_t group) const
+{
+  if (group >= groupCount_)
+  {
+    return false;
+  }
+  const Group &state = groups_[group];
+  if (!state.interpolator.done() || state.lengths[0] != 0 || state.lengths[1] != 0)
+  {
+    return true;
+  }
+#if defined(MOTION_HAS_PIO)
+  return dma_channel_is_busy(static_cast<uint>(state.dmaChannel)) ||
+         !pio_sm_is_tx_fifo_empty(BlockInstance(state.block), state.index);
+#else
+  return false;
+#endif
+}
+
+void StepGroupDriver::service()
+{
+  for (std::size_t g = 0; g < groupCount_; ++g)
+  {
+    Group &state = groups_[g];
+#if defined(MOTION_HAS_PIO)
+    if (dma_channel_is_busy(static_cast<uint>(state.dmaChannel)))
+    {
+      continue;
+    }
+#endif
+    const uint8_t drained = state.streaming;
+    state.lengths[drained] = 0;
+    if (state.lengths[drained ^ 1U] != 0)
+    {
+      startBuffer(state, static_cast<uint8_t>(drained ^ 1U));
+    }
+    state.lengths[drained] = state.interpolator.fill(state.buffers[drained].data(), kBufferWords);
+  }
+}
+
+void StepGroupDriver::startBuffer(Group &group, uint8_t buffer)
+{
+  group.streaming = buffer;
+#if defined(MOTION_HAS_PIO)
+  dma_channel_transfer_from_buffer_now(static_cast<uint>(group.dmaChannel), group.buffers[buffer].data(),
+                                       static_cast<uint32_t>(group.lengths[buffer]));
+#else
+  // No DMA on host builds: the buffer counts as sent.
+  group.lengths[buffer] = 0;
+#endif
+}
+
+} // namespace motion::pio
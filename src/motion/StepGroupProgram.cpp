@@ -0,0 +1,140 @@
+#include "motion/StepGroupProgram.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+#include <hardware/pio_instructions.h>
+#endif
+
+namespace motion::pio
+{
+
+namespace
+{
+
+constexpr std::size_t kStepGroupLength = 4;
+constexpr uint32_t kDwellLoop = 3;
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+std::array<uint16_t, kStepGroupLength> BuildStepGroupInstructions()
+{
+  std::array<uint16_t, kStepGroupLength> instructions{};
+  instructions[0] = static_cast<uint16_t>(pio_encode_out(pio_pins, 8) | pio_encode_delay(7)); // STEP high, 8 ticks
+  instructions[1] = static_cast<uint16_t>(pio_encode_out(pio_pins, 8));                       // STEP low
+  instructions[2] = static_cast<uint16_t>(pio_encode_out(pio_y, 16));                         // dwell
+  instructions[3] = static_cast<uint16_t>(pio_encode_jmp_y_dec(kDwellLoop));
+  return instructions;
+}
+#else
+// pioasm output for kProgramSource.
+constexpr uint16_t kStepGroupProgramInstructions[kStepGroupLength] = {0x6708, 0x6008, 0x6050, 0x0083};
+
+const pio_program kStepGroupProgram{kStepGroupProgramInstructions, static_cast<uint8_t>(kStepGroupLength), -1};
+#endif
+
+constexpr char kProgramSource[] =
+    R"PIO(
+.program step_group
+; One word per tick, autopulled; see StepGroupProgram.hpp for the layout.
+.wrap_target
+    out pins, 8 [7]         ; DIR + this tick's STEP bits
+    out pins, 8             ; DIR, STEP low
+    out y, 16               ; dwell
+dwell:
+    jmp y-- dwell
+.wrap
+)PIO";
+
+} // namespace
+
+const pio_program &StepGroupProgram()
+{
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+  static std::array<uint16_t, kStepGroupLength> instructions = BuildStepGroupInstructions();
+  static const ::pio_program program{instructions.data(), static_cast<uint8_t>(instructions.size()), -1};
+  return program;
+#else
+  return kStepGroupProgram;
+#endif
+}
+
+std::string_view StepGroupProgramSource()
+{
+  return std::string_view(kProgramSource, sizeof(kProgramSource) - 1);
+}
+
+uint32_t PackGroupWord(std::size_t axisCount, uint8_t stepMask, uint8_t dirMask, uint32_t ticks)
+{
+  const uint32_t axisMask = (1U << axisCount) - 1U;
+  const uint32_t idle = dirMask & axisMask;
+  const uint32_t stepping = idle | ((stepMask & axisMask) << axisCount);
+  const uint32_t dwell =
+      std::min(kMaxGroupDwell, std::max(kMinGroupWordTicks, ticks) - kGroupWordOverheadTicks);
+  return stepping | (idle << 8) | (dwell << 16);
+}
+
+void StepInterpolator::start(const int32_t *deltas, std::size_t axisCount, uint32_t periodTicks)
+{
+  *this = StepInterpolator{};
+  axisCount_ = std::min(axisCount, kMaxGroupAxes);
+  for (std::size_t axis = 0; axis < axisCount_; ++axis)
+  {
+    counts_[axis] = static_cast<uint32_t>(std::llabs(static_cast<long long>(deltas[axis])));
+    if (deltas[axis] >= 0)
+    {
+      dirMask_ = static_cast<uint8_t>(dirMask_ | (1U << axis));
+    }
+    majorSteps_ = std::max(majorSteps_, counts_[axis]);
+  }
+  for (std::size_t axis = 0; axis < axisCount_; ++axis)
+  {
+    errors_[axis] = majorSteps_ / 2U;
+  }
+  directionPending_ = majorSteps_ != 0;
+
+  const uint32_t period = std::max(kMinGroupWordTicks, periodTicks);
+  wordsPerTick_ = (period + kMaxGroupWordTicks - 1U) / kMaxGroupWordTicks;
+  idleWordTicks_ = period / wordsPerTick_;
+  firstWordTicks_ = idleWordTicks_ + (period % wordsPerTick_);
+}
+
+std::size_t StepInterpolator::fill(uint32_t *words, std::size_t capacity)
+{
+  std::size_t written = 0;
+  if (directionPending_ && written < capacity)
+  {
+    // DIR settles a full word before the first STEP edge.
+    words[written++] = PackGroupWord(axisCount_, 0, dirMask_, kMinGroupWordTicks);
+    directionPending_ = false;
+  }
+  while (written < capacity)
+  {
+    if (idleWordsPending_ > 0)
+    {
+      words[written++] = PackGroupWord(axisCount_, 0, dirMask_, idleWordTicks_);
+      --idleWordsPending_;
+      continue;
+    }
+    if (tick_ >= majorSteps_)
+    {
+      break;
+    }
+    uint8_t stepMask = 0;
+    for (std::size_t axis = 0; axis < axisCount_; ++axis)
+    {
+      errors_[axis] += counts_[axis];
+      if (errors_[axis] >= majorSteps_)
+      {
+        errors_[axis] -= majorSteps_;
+        stepMask = static_cast<uint8_t>(stepMask | (1U << axis));
+      }
+    }
+    words[written++] = PackGroupWord(axisCount_, stepMask, dirMask_, firstWordTicks_);
+    idleWordsPending_ = wordsPerTick_ - 1U;
+    ++tick_;
+  }
+  return written;
+}
+
+} // namespace motion::pio
@@ -0,0 +1,418 @@
+#include "motion/StepperPioDriver.hpp"
+
+#include <algorithm>
+
+#include "diag/TraceRing.hpp"
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+#define MOTION_HAS_PIO 1
+#include <hardware/irq.h>
+#include <hardware/pio_instructions.h>
+#include <hardware/sync.h>
+#endif
+
+namespace motion::pio
+{
+
+namespace
+{
+#if defined(MOTION_HAS_PIO)
+PIO BlockInstance(uint8_t block)
+{
+  return (block == 0) ? pio0 : pio1;
+}
+
+// The IRQ handlers take no argument; begin() points them at the driver.
+StepperPioDriver *gIrqDriver = nullptr;
+
+void Pio0IrqHandler()
+{
+  if (gIrqDriver != nullptr)
+  {
+    gIrqDriver->handleIrq(0);
+  }
+}
+
+void Pio1IrqHandler()
+{
+  if (gIrqDriver != nullptr)
+  {
+    gIrqDriver->handleIrq(1);
+  }
+}
+#endif
+
+// Holds off the word IRQ while the main thread touches channel state.
+class IrqMask
+{
+public:
+#if defined(MOTION_HAS_PIO)
+  IrqMask() : saved_(save_and_disable_interrupts()) {}
+  ~IrqMask() { restore_interrupts(saved_); }
+#else
+  IrqMask() : saved_(0) {}
+  ~IrqMask() { (void)saved_; }
+#endif
+
+private:
+  uint32_t saved_;
+};
+} // namespace
+
+bool StepperPioDriver::begin(const uint8_t *stepPins, const uint8_t *dirPins, std::size_t channelCount)
+{
+  channelCount_ = std::min(channelCount, kMaxStepDirChannels);
+  channels_.fill(ChannelState{});
+  if (stepPins == nullptr || dirPins == nullptr)
+  {
+    channelCount_ = 0;
+    return false;
+  }
+
+#if defined(MOTION_HAS_PIO)
+  const pio_program &program = StepDirProgram();
+  const std::size_t blocksNeeded = (channelCount_ + kStateMachinesPerBlock - 1) / kStateMachinesPerBlock;
+  for (std::size_t block = 0; block < blocksNeeded; ++block)
+  {
+    PIO instance = BlockInstance(static_cast<uint8_t>(block));
+    if (!pio_can_add_program(instance, &program))
+    {
+      channelCount_ = block * kStateMachinesPerBlock;
+      return false;
+    }
+    programOffsets_[block] = static_cast<uint8_t>(pio_add_program(instance, &program));
+  }
+
+  gIrqDriver = this;
+  for (std::size_t channel = 0; channel < channelCount_; ++channel)
+  {
+    const StateMachineSlot slot = StateMachineForChannel(channel);
+    PIO instance = BlockInstance(slot.block);
+    const uint offset = programOffsets_[slot.block];
+    pio_sm_claim(instance, slot.index);
+
+    pio_gpio_init(instance, stepPins[channel]);
+    pio_gpio_init(instance, dirPins[channel]);
+    pio_sm_set_consecutive_pindirs(instance, slot.index, stepPins[channel], 1, true);
+    pio_sm_set_consecutive_pindirs(instance, slot.index, dirPins[channel], 1, true);
+
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, offset, offset + program.length - 1);
+    sm_config_set_set_pins(&config, stepPins[channel], 1);
+    sm_config_set_out_pins(&config, dirPins[channel], 1);
+    sm_config_set_out_shift(&config, true, false, 32);
+    pio_sm_init(instance, slot.index, offset, &config);
+    // `irq set 0 rel` raises flag <sm>; route it to the block's IRQ0.
+    pio_interrupt_clear(instance, slot.index);
+    pio_set_irq0_source_enabled(instance, static_cast<pio_interrupt_source>(pis_interrupt0 + slot.index), true);
+    pio_sm_set_enabled(instance, slot.index, true);
+  }
+  for (std::size_t block = 0; block < blocksNeeded; ++block)
+  {
+    const uint irq = (block == 0) ? PIO0_IRQ_0 : PIO1_IRQ_0;
+    irq_set_exclusive_handler(irq, (block == 0) ? &Pio0IrqHandler : &Pio1IrqHandler);
+    irq_set_enabled(irq, true);
+  }
+  return true;
+#else
+  return channelCount_ == channelCount;
+#endif
+}
+
+bool StepperPioDriver::ready(std::size_t channel) const
+{
+  return channel < channelCount_ && channels_[channel].commands < 2;
+}
+
+bool StepperPioDriver::submit(std::size_t channel, const StepperCommand &command)
+{
+  if (!ready(channel))
+  {
+    return false;
+  }
+  IrqMask mask;
+  ChannelState &state = channels_[channel];
+  if (state.commands == 0)
+  {
+    state.unfed = command;
+    state.currentSteps = command.stepCount;
+    state.executed = 0;
+    state.delayError = 0;
+  }
+  else
+  {
+    state.next = command;
+    state.nextSteps = command.stepCount;
+    state.nextFed = false;
+  }
+  ++state.commands;
+  feed(channel);
+  retireFinished(channel);
+  return true;
+}
+
+void StepperPioDriver::service()
+{
+  IrqMask mask;
+  for (std::size_t channel = 0; channel < channelCount_; ++channel)
+  {
+    drain(channel);
+    feed(channel);
+  }
+}
+
+uint32_t StepperPioDriver::executedSteps(std::size_t channel) const
+{
+  return channel < channelCount_ ? channels_[channel].executed : 0U;
+}
+
+uint32_t StepperPioDriver::remainingSteps(std::size_t channel) const
+{
+  if (channel >= channelCount_)
+  {
+    return 0;
+  }
+  IrqMask mask;
+  const ChannelState &state = channels_[channel];
+  return state.currentSteps - state.executed + state.nextSteps;
+}
+
+StepProgress StepperPioDriver::takeProgress(std::size_t channel)
+{
+  if (channel >= channelCount_)
+  {
+    return StepProgress{};
+  }
+  IrqMask mask;
+  ChannelState &state = channels_[channel];
+  const StepProgress progress{state.retired, state.executed};
+  state.retired = 0;
+  return progress;
+}
+
+StepProgress StepperPioDriver::abort(std::size_t channel)
+{
+  if (channel >= channelCount_)
+  {
+    return StepProgress{};
+  }
+  IrqMask mask;
+  ChannelState &state = channels_[channel];
+#if defined(MOTION_HAS_PIO)
+  const StateMachineSlot slot = StateMachineForChannel(channel);
+  PIO instance = BlockInstance(slot.block);
+  const uint offset = programOffsets_[slot.block];
+  pio_sm_set_enabled(instance, slot.index, false);
+  drain(channel);
+  state.executed += interruptedWordSteps(channel);
+
+  // Back to the pull with STEP low and nothing queued.
+  pio_sm_clear_fifos(instance, slot.index);
+  pio_sm_restart(instance, slot.index);
+  pio_sm_exec(instance, slot.index, pio_encode_set(pio_pins, 0));
+  pio_sm_exec(instance, slot.index, pio_encode_jmp(offset));
+  pio_interrupt_clear(instance, slot.index);
+  pio_sm_set_enabled(instance, slot.index, true);
+#endif
+  const StepProgress progress{state.retired, state.executed};
+  const uint16_t divider = state.divider;
+  state = ChannelState{};
+  state.divider = divider;
+  return progress;
+}
+
+void StepperPioDriver::handleIrq(uint8_t block)
+{
+#if defined(MOTION_HAS_PIO)
+  PIO instance = BlockInstance(block);
+  for (uint8_t sm = 0; sm < kStateMachinesPerBlock; ++sm)
+  {
+    const std::size_t channel = block * kStateMachinesPerBlock + sm;
+    if (channel >= channelCount_)
+    {
+      break;
+    }
+    if (pio_interrupt_get(instance, sm))
+    {
+      pio_interrupt_clear(instance, sm);
+      drain(channel);
+      feed(channel);
+    }
+  }
+#else
+  (void)block;
+#endif
+}
+
+void StepperPioDriver::drain(std::size_t channel)
+{
+#if defined(MOTION_HAS_PIO)
+  const StateMachineSlot slot = StateMachineForChannel(channel);
+  PIO instance = BlockInstance(slot.block);
+  ChannelState &state = channels_[channel];
+  InFlightWords &words = state.inFlight;
+  while (!pio_sm_is_rx_fifo_empty(instance, slot.index))
+  {
+    if (pio_sm_get(instance, slot.index) == kWordDoneToken && words.size != 0)
+    {
+      state.executed += words.steps[words.head];
+      words.head = static_cast<uint8_t>((words.head + 1U) % kInFlightWordCapacity);
+      --words.size;
+      retireFinished(channel);
+    }
+  }
+#else
+  (void)channel;
+#endif
+}
+
+void StepperPioDriver::feed(std::size_t channel)
+{
+  ChannelState &state = channels_[channel];
+#if defined(MOTION_HAS_PIO)
+  const StateMachineSlot slot = StateMachineForChannel(channel);
+  PIO instance = BlockInstance(slot.block);
+  InFlightWords &words = state.inFlight;
+  for (;;)
+  {
+    StepperCommand &command = state.unfed;
+    if (command.stepCount == 0)
+    {
+      // The running command is all in the FIFO: start on the queued one so
+      // its first word is waiting when the last one finishes.
+      if (state.commands < 2 || state.nextFed)
+      {
+        return;
+      }
+      command = state.next;
+      state.next = StepperCommand{};
+      state.nextFed = true;
+      state.delayError = 0;
+      continue;
+    }
+    if (command.clockDivider != state.divider)
+    {
+      if (!parked(channel))
+      {
+        return;
+      }
+      pio_sm_set_clkdiv_int_frac(instance, slot.index, command.clockDivider, 0);
+      pio_sm_clkdiv_restart(instance, slot.index);
+      state.divider = command.clockDivider;
+    }
+    const uint64_t period = StepPeriodCycles(command.delayTicks, command.clockDivider);
+    const uint32_t windowSteps =
+        static_cast<uint32_t>(std::max<uint64_t>(1U, kReadbackWindowCycles / std::max<uint64_t>(1U, period)));
+    const uint32_t wordSteps = std::min(windowSteps, command.delayFraction != 0 ? kDiffusionRunSteps : kMaxStepsPerWord);
+    while (command.stepCount != 0 && !pio_sm_is_tx_fifo_full(instance, slot.index) &&
+           words.size < kInFlightWordCapacity)
+    {
+      StepperCommand segment = command;
+      segment.stepCount = std::min(command.stepCount, wordSteps);
+      if (command.delayFraction != 0)
+      {
+        // Error diffusion: a run takes M + 1 once the owed fraction reaches
+        // half a tick per step, and pays the overshoot back afterwards.
+        const int64_t run = segment.stepCount;
+        state.delayError += static_cast<int64_t>(command.delayFraction) * run;
+        if (state.delayError * 2 >= run * 65536)
+        {
+          ++segment.delayTicks;
+          state.delayError -= run * 65536;
+        }
+      }
+      pio_sm_put(instance, slot.index, PackCommandWord(segment));
+      words.steps[(words.head + words.size) % kInFlightWordCapacity] = static_cast<uint16_t>(segment.stepCount);
+      ++words.size;
+      command.stepCount -= segment.stepCount;
+    }
+    if (command.stepCount != 0)
+    {
+      return;
+    }
+  }
+#else
+  // No state machine to wait for: the command counts as run once fed.
+  state.executed += state.unfed.stepCount;
+  state.unfed.stepCount = 0;
+#endif
+}
+
+// Retires the running command once its last word is confirmed and promotes
+// the queued one; a zero-step command retires as soon as it runs.
+void StepperPioDriver::retireFinished(std::size_t channel)
+{
+  ChannelState &state = channels_[channel];
+  while (state.commands != 0 && state.executed == state.currentSteps)
+  {
+    ++state.retired;
+    diag::Trace(diag::TraceKind::SlotRetired, static_cast<uint8_t>(channel), static_cast<uint16_t>(state.retired));
+    --state.commands;
+    state.executed = 0;
+    state.currentSteps = 0;
+    if (state.commands != 0)
+    {
+      state.currentSteps = state.nextSteps;
+      if (!state.nextFed)
+      {
+        state.unfed = state.next;
+        state.delayError = 0;
+      }
+      state.next = StepperCommand{};
+      state.nextSteps = 0;
+      state.nextFed = false;
+    }
+  }
+}
+
+// Steps the front in-flight word emitted before the state machine stopped,
+// read from its PC and, mid-word, from X via a forced `mov isr, x; push`.
+// During step k of an n-step word X holds n - 1 - k; at the `step` label the
+// jmp x-- (or the out) has already moved on to the next, unstarted step.
+uint32_t StepperPioDriver::interruptedWordSteps(std::size_t channel)
+{
+#if defined(MOTION_HAS_PIO)
+  const InFlightWords &words = channels_[channel].inFlight;
+  if (words.size == 0)
+  {
+    return 0;
+  }
+  const StateMachineSlot slot = StateMachineForChannel(channel);
+  PIO instance = BlockInstance(slot.block);
+  const uint8_t pc = static_cast<uint8_t>(pio_sm_get_pc(instance, slot.index) - programOffsets_[slot.block]);
+  const uint32_t wordSteps = words.steps[words.head];
+  if (pc >= kStepDirDonePc && pc < kStepDirIrqPc)
+  {
+    return wordSteps;
+  }
+  if (pc < kStepDirStepPc || pc >= kStepDirDonePc)
+  {
+    return 0;
+  }
+  pio_sm_exec(instance, slot.index, pio_encode_mov(pio_isr, pio_x));
+  pio_sm_exec(instance, slot.index, pio_encode_push(false, false));
+  const uint32_t x = pio_sm_get(instance, slot.index);
+  const uint32_t started = (pc == kStepDirStepPc) ? wordSteps - 1U - x : wordSteps - x;
+  return std::min(started, wordSteps);
+#else
+  (void)channel;
+  return 0;
+#endif
+}
+
+// True when the state machine sits on its `pull` with nothing queued, so
+// its clock can change without stretching a step in flight.
+bool StepperPioDriver::parked(std::size_t channel) const
+{
+#if defined(MOTION_HAS_PIO)
+  const StateMachineSlot slot = StateMachineForChannel(channel);
+  PIO instance = BlockInstance(slot.block);
+  return pio_sm_is_tx_fifo_empty(instance, slot.index) &&
+         pio_sm_get_pc(instance, slot.index) == programOffsets_[slot.block];
+#else
+  (void)channel;
+  return true;
+#endif
+}
+
+} // namespace motion::pio
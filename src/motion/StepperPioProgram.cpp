@@ -1,5 +1,6 @@
 #include "motion/StepperPioProgram.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
@@ -14,64 +15,61 @@ namespace motion::pio
 namespace
 {
 
+// Offsets of the branch targets below; pio_add_program relocates them.
+constexpr uint32_t kStepLoop = 3;
+constexpr uint32_t kHighLoop = 5;
+constexpr uint32_t kLowLoop = 8;
+constexpr std::size_t kStepDirLength = 13;
+
 #if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
-std::array<uint16_t, 12> BuildStepDirInstructions()
+std::array<uint16_t, kStepDirLength> BuildStepDirInstructions()
 {
-  std::array<uint16_t, 12> instructions{};
-  instructions[0] = static_cast<uint16_t>(pio_encode_pull(true, false));           // pull block
-  instructions[1] = static_cast<uint16_t>(pio_encode_mov(pio_y, pio_osr));         // move delay into Y
-  instructions[2] = static_cast<uint16_t>(pio_encode_pull(true, false));           // pull block
-  instructions[3] = static_cast<uint16_t>(pio_encode_mov(pio_x, pio_osr));         // move step count into X
-  instructions[4] = static_cast<uint16_t>(pio_encode_pull(true, false));           // pull block
-  instructions[5] = static_cast<uint16_t>(pio_encode_out(pio_pins, 1));            // update direction pin
-  instructions[6] = static_cast<uint16_t>(pio_encode_irq_set(false, 0));           // mark command latched
-  instructions[7] = static_cast<uint16_t>(pio_encode_set(pio_pins, 1) | (1u << 5)); // set step high, min hold
-  instructions[8] = static_cast<uint16_t>(pio_encode_nop() | (31u << 5));          // delay via sideset
-  instructions[9] = static_cast<uint16_t>(pio_encode_set(pio_pins, 0) | (1u << 5)); // set step low, min hold
-  instructions[10] = static_cast<uint16_t>(pio_encode_nop() | (31u << 5));         // delay
-  instructions[11] = static_cast<uint16_t>(pio_encode_jmp_x_dec(7));               // loop while X > 0
+  std::array<uint16_t, kStepDirLength> instructions{};
+  instructions[0] = static_cast<uint16_t>(pio_encode_pull(false, true));     // pull block
+  instructions[1] = static_cast<uint16_t>(pio_encode_out(pio_pins, 1));      // DIR
+  instructions[2] = static_cast<uint16_t>(pio_encode_out(pio_x, 15));        // steps - 1
+  instructions[3] = static_cast<uint16_t>(pio_encode_set(pio_pins, 1));      // STEP high
+  instructions[4] = static_cast<uint16_t>(pio_encode_mov(pio_y, pio_osr));   // reload delay
+  instructions[5] = static_cast<uint16_t>(pio_encode_jmp_y_dec(kHighLoop));  // M + 1 ticks
+  instructions[6] = static_cast<uint16_t>(pio_encode_set(pio_pins, 0));      // STEP low
+  instructions[7] = static_cast<uint16_t>(pio_encode_mov(pio_y, pio_osr));   // reload delay
+  instructions[8] = static_cast<uint16_t>(pio_encode_jmp_y_dec(kLowLoop));   // M + 1 ticks
+  instructions[9] = static_cast<uint16_t>(pio_encode_jmp_x_dec(kStepLoop));  // next step
+  instructions[10] = static_cast<uint16_t>(pio_encode_mov(pio_isr, pio_x));  // X wrapped: kWordDoneToken
+  instructions[11] = static_cast<uint16_t>(pio_encode_push(false, true));    // completion token
+  instructions[12] = static_cast<uint16_t>(pio_encode_irq_set(true, 0));     // IRQ flag = SM index
   return instructions;
 }
 #else
-constexpr uint16_t kStepDirProgramInstructions[] = {
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000,
-    0x0000};
-
-const pio_program kStepDirProgram{
-    kStepDirProgramInstructions,
-    static_cast<uint8_t>(sizeof(kStepDirProgramInstructions) / sizeof(kStepDirProgramInstructions[0])),
-    -1};
+// pioasm output for kProgramSource, so host builds can inspect the image.
+constexpr uint16_t kStepDirProgramInstructions[kStepDirLength] = {
+    0x80a0, 0x6001, 0x602f, 0xe001, 0xa047, 0x0085, 0xe000, 0xa047, 0x0088, 0x0043, 0xa0c1, 0x8020, 0xc010};
+
+const pio_program kStepDirProgram{kStepDirProgramInstructions, static_cast<uint8_t>(kStepDirLength), -1};
 #endif
 
 constexpr char kProgramSource[] =
     R"PIO(
 .program step_dir
-.side_set 1 opt
+; One packed word per segment; see StepperPioProgram.hpp for the layout.
 .wrap_target
-pull block            ; delay (Y)
-mov y, osr
-pull block            ; step count (X)
-mov x, osr
-pull block            ; direction bit
-out pins, 1
-set pins, 1           ; STEP high
-nop [31]
-set pins, 0           ; STEP low
-nop [31]
-jmp x--, step_dir_loop
+    pull block
+    out pins, 1             ; DIR
+    out x, 15               ; steps - 1; the delay mantissa stays in OSR
+step:
+    set pins, 1             ; STEP high
+    mov y, osr
+high:
+    jmp y-- high
+    set pins, 0             ; STEP low
+    mov y, osr
+low:
+    jmp y-- low
+    jmp x-- step
+    mov isr, x              ; X wrapped to 0xFFFFFFFF
+    push block              ; one completion token per finished segment
+    irq set 0 rel           ; and the state machine's own IRQ flag
 .wrap
-step_dir_loop:
-jmp y--, step_dir_loop
 )PIO";
 
 } // namespace
@@ -79,7 +77,7 @@ jmp y--, step_dir_loop
 const pio_program &StepDirProgram()
 {
 #if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
-  static std::array<uint16_t, 12> instructions = BuildStepDirInstructions();
+  static std::array<uint16_t, kStepDirLength> instructions = BuildStepDirInstructions();
   static const ::pio_program program{
       instructions.data(),
       static_cast<uint8_t>(instructions.size()),
@@ -95,22 +93,51 @@ std::string_view StepDirProgramSource()
   return std::string_view(kProgramSource, sizeof(kProgramSource) - 1);
 }
 
-uint32_t DelayTicksFromMicros(uint32_t halfPeriodMicros, uint32_t clockHz)
+StepperCommand StepTimingForRate(uint32_t stepRateHz, uint32_t clockHz)
 {
-  if (halfPeriodMicros == 0 || clockHz == 0)
+  StepperCommand timing{};
+  const uint64_t rate = std::max<uint32_t>(1U, stepRateHz);
+  const uint64_t maxTicks = 2ULL * kMaxDelayMantissa + kStepOverheadTicks;
+  const uint64_t divider = std::min<uint64_t>(0xFFFFU, std::max<uint64_t>(1U, (clockHz + rate * maxTicks - 1U) / (rate * maxTicks)));
+  timing.clockDivider = static_cast<uint16_t>(divider);
+
+  // Ideal M = (clockHz / (rate * divider) - 7) / 2, kept as a fraction.
+  const uint64_t denominator = 2U * rate * divider;
+  const uint64_t overhead = kStepOverheadTicks * rate * divider;
+  const uint64_t minHighTicks = (kMinStepHighCycles + divider - 1U) / divider;
+  uint64_t mantissa = 0;
+  uint64_t fraction = 0;
+  if (clockHz > overhead)
   {
-    return 0;
+    mantissa = (clockHz - overhead) / denominator;
+    fraction = (((clockHz - overhead) % denominator) << 16) / denominator;
   }
-  uint64_t ticks = (static_cast<uint64_t>(clockHz) * static_cast<uint64_t>(halfPeriodMicros)) / 1'000'000ULL;
-  if (ticks == 0)
+  if (mantissa + 3U < minHighTicks)
   {
-    return 1;
+    mantissa = minHighTicks - 3U;
+    fraction = 0;
   }
-  if (ticks > 0xFFFFFFu)
+  if (2U * mantissa + kStepOverheadTicks >= kDiffusionThresholdTicks)
   {
-    ticks = 0xFFFFFFu;
+    // Rounding is already finer than the diffusion would buy.
+    mantissa += fraction >> 15;
+    fraction = 0;
   }
-  return static_cast<uint32_t>(ticks);
+  timing.delayTicks = static_cast<uint32_t>(std::min<uint64_t>(kMaxDelayMantissa, mantissa));
+  timing.delayFraction = static_cast<uint16_t>(fraction);
+  return timing;
+}
+
+uint64_t StepPeriodCycles(uint32_t delayTicks, uint16_t clockDivider)
+{
+  return (2ULL * delayTicks + kStepOverheadTicks) * std::max<uint16_t>(1U, clockDivider);
+}
+
+uint32_t PackCommandWord(const StepperCommand &command)
+{
+  const uint32_t steps = std::min(std::max<uint32_t>(1U, command.stepCount), kMaxStepsPerWord);
+  return ((command.delayTicks & kMaxDelayMantissa) << kCommandDelayShift) | ((steps - 1U) << kCommandCountShift) |
+         (command.directionHigh ? 1U : 0U);
 }
 
 } // namespace motion::pio
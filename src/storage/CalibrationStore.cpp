@@ -0,0 +1,160 @@
+#include "storage/CalibrationStore.hpp"
+
+#include <cstring>
+
+namespace storage
+{
+
+static_assert(sizeof(uint32_t) + sizeof(CalibrationStore::ChannelMask) + (sizeof(int32_t) * CalibrationStore::kChannelCount) <=
+                  FlashLog::kMaxPayloadBytes,
+              "Shutdown journal no longer fits one log record");
+
+CalibrationStore::CalibrationStore(FlashDevice &device) : log_(device)
+{
+  log_.setCompactor(&CalibrationStore::Compact, this);
+}
+
+bool CalibrationStore::begin()
+{
+  ready_ = false;
+  calibration_.fill(ChannelCalibration{});
+  calibrated_.fill(0);
+  restored_ = Journal{};
+  if (!log_.mount())
+  {
+    return false;
+  }
+  log_.replay(&CalibrationStore::Visit, this);
+  current_ = restored_;
+  current_.clean = false;
+  ++current_.bootCount;
+  ready_ = writeBoot(log_);
+  return ready_;
+}
+
+bool CalibrationStore::saveCalibration(std::size_t channel, const ChannelCalibration &calibration)
+{
+  if (!ready_ || channel >= kChannelCount || calibration.negativeLimit > calibration.positiveLimit)
+  {
+    return false;
+  }
+  calibration_[channel] = calibration;
+  calibrated_[channel / 32U] |= static_cast<uint32_t>(1UL << (channel % 32U));
+  return writeCalibration(log_, channel);
+}
+
+bool CalibrationStore::recordShutdown(const std::array<int32_t, kChannelCount> &positions, const ChannelMask &homed)
+{
+  if (!ready_)
+  {
+    return false;
+  }
+  current_.positions = positions;
+  current_.homed = homed;
+  current_.clean = true;
+  return writeShutdown(log_);
+}
+
+bool CalibrationStore::invalidateShutdown()
+{
+  if (!ready_ || !current_.clean)
+  {
+    return true;
+  }
+  // Still clean until the marker lands: a failed write leaves the journal
+  // live in flash, and the next call tries again.
+  if (!writeBoot(log_))
+  {
+    return false;
+  }
+  current_.clean = false;
+  return true;
+}
+
+void CalibrationStore::Visit(void *context, uint8_t type, const uint8_t *payload, std::size_t length)
+{
+  auto &self = *static_cast<CalibrationStore *>(context);
+  Journal &journal = self.restored_;
+  switch (type)
+  {
+  case kCalibrationRecord:
+  {
+    CalibrationPayload record{};
+    if (length != sizeof(record))
+    {
+      return;
+    }
+    std::memcpy(&record, payload, sizeof(record));
+    if (record.channel < kChannelCount)
+    {
+      self.calibration_[record.channel] = record.calibration;
+      self.calibrated_[record.channel / 32U] |= static_cast<uint32_t>(1UL << (record.channel % 32U));
+    }
+    return;
+  }
+  case kShutdownRecord:
+    if (length != self.scratch_.size())
+    {
+      return;
+    }
+    std::memcpy(&journal.bootCount, payload, sizeof(journal.bootCount));
+    std::memcpy(journal.homed.data(), payload + sizeof(uint32_t), sizeof(ChannelMask));
+    std::memcpy(journal.positions.data(), payload + sizeof(uint32_t) + sizeof(ChannelMask), sizeof(journal.positions));
+    journal.clean = true;
+    return;
+  case kBootRecord:
+    if (length != sizeof(uint32_t))
+    {
+      return;
+    }
+    std::memcpy(&journal.bootCount, payload, sizeof(journal.bootCount));
+    journal.clean = false;
+    return;
+  default:
+    return; // Unknown records from newer firmware are skipped.
+  }
+}
+
+void CalibrationStore::Compact(void *context, FlashLog &log)
+{
+  auto &self = *static_cast<CalibrationStore *>(context);
+  for (std::size_t channel = 0; channel < kChannelCount; ++channel)
+  {
+    if (self.hasCalibration(channel))
+    {
+      self.writeCalibration(log, channel);
+    }
+  }
+  if (self.current_.clean)
+  {
+    self.writeShutdown(log);
+  }
+  else
+  {
+    self.writeBoot(log);
+  }
+}
+
+bool CalibrationStore::writeCalibration(FlashLog &log, std::size_t channel)
+{
+  CalibrationPayload record{};
+  record.channel = static_cast<uint8_t>(channel);
+  std::memset(record.reserved, 0xFF, sizeof(record.reserved));
+  record.calibration = calibration_[channel];
+  return log.append(kCalibrationRecord, &record, sizeof(record));
+}
+
+bool CalibrationStore::writeShutdown(FlashLog &log)
+{
+  std::memcpy(scratch_.data(), &current_.bootCount, sizeof(uint32_t));
+  std::memcpy(scratch_.data() + sizeof(uint32_t), current_.homed.data(), sizeof(ChannelMask));
+  std::memcpy(scratch_.data() + sizeof(uint32_t) + sizeof(ChannelMask), current_.positions.data(), sizeof(current_.positions));
+  return log.append(kShutdownRecord, scratch_.data(), scratch_.size());
+}
+
+bool CalibrationStore::writeBoot(FlashLog &log)
+{
+  return log.append(kBootRecord, &current_.bootCount, sizeof(current_.bootCount));
+}
+
+} // namespace storage
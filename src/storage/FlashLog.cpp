@@ -0,0 +1,233 @@
+#include "storage/FlashLog.hpp"
+
+#include <array>
+
+namespace storage
+{
+
+namespace
+{
+
+uint32_t Crc32Update(uint32_t crc, const uint8_t *data, std::size_t length)
+{
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+    }
+  }
+  return crc;
+}
+
+} // namespace
+
+FlashLog::FlashLog(FlashDevice &device) : device_(device) {}
+
+void FlashLog::setCompactor(Compactor compactor, void *context)
+{
+  compactor_ = compactor;
+  compactorContext_ = context;
+}
+
+std::size_t FlashLog::RecordSpan(std::size_t payloadLength)
+{
+  return sizeof(RecordHeader) + ((payloadLength + 3U) & ~static_cast<std::size_t>(3U));
+}
+
+uint32_t FlashLog::Checksum(uint8_t type, const uint8_t *payload, std::size_t length)
+{
+  const uint8_t prefix[3] = {type, static_cast<uint8_t>(length & 0xFFU), static_cast<uint8_t>(length >> 8)};
+  uint32_t crc = Crc32Update(0xFFFFFFFFU, prefix, sizeof(prefix));
+  return ~Crc32Update(crc, payload, length);
+}
+
+std::size_t FlashLog::freeBytes() const
+{
+  return device_.sectorSize() - head_;
+}
+
+bool FlashLog::readHeader(std::size_t sector, SectorHeader &header) const
+{
+  device_.read(sector * device_.sectorSize(), &header, sizeof(header));
+  return header.magic == kSectorMagic && header.sequence != 0xFFFFFFFFU;
+}
+
+bool FlashLog::mount()
+{
+  mounted_ = false;
+  if (device_.sectorCount() < 2 || device_.sectorSize() <= sizeof(SectorHeader) + RecordSpan(kMaxPayloadBytes))
+  {
+    return false;
+  }
+
+  bool found = false;
+  for (std::size_t sector = 0; sector < device_.sectorCount(); ++sector)
+  {
+    SectorHeader header{};
+    if (readHeader(sector, header) && (!found || header.sequence > sequence_))
+    {
+      found = true;
+      sequence_ = header.sequence;
+      activeSector_ = sector;
+    }
+  }
+
+  if (!found)
+  {
+    // Blank or foreign flash: start a fresh log in sector 0.
+    if (!device_.erase(0))
+    {
+      return false;
+    }
+    const SectorHeader header{kSectorMagic, 1U};
+    if (!device_.program(0, &header, sizeof(header)))
+    {
+      return false;
+    }
+    activeSector_ = 0;
+    sequence_ = header.sequence;
+    head_ = sizeof(SectorHeader);
+    mounted_ = true;
+    return true;
+  }
+
+  scan();
+  mounted_ = true;
+  return true;
+}
+
+bool FlashLog::scan()
+{
+  const std::size_t base = activeSector_ * device_.sectorSize();
+  head_ = sizeof(SectorHeader);
+  std::array<uint8_t, kMaxPayloadBytes> payload{};
+  while (head_ + sizeof(RecordHeader) <= device_.sectorSize())
+  {
+    RecordHeader header{};
+    device_.read(base + head_, &header, sizeof(header));
+    if (header.type == kErasedType && header.length == 0xFFFFU && header.crc == 0xFFFFFFFFU)
+    {
+      return true;
+    }
+    const std::size_t span = RecordSpan(header.length);
+    if (header.type == kErasedType || header.length > kMaxPayloadBytes || head_ + span > device_.sectorSize())
+    {
+      break;
+    }
+    device_.read(base + head_ + sizeof(RecordHeader), payload.data(), header.length);
+    if (Checksum(header.type, payload.data(), header.length) != header.crc)
+    {
+      break;
+    }
+    head_ += span;
+  }
+  // A torn record: nothing after it can be trusted or overwritten, so the
+  // next append rotates.
+  head_ = device_.sectorSize();
+  return false;
+}
+
+void FlashLog::replay(Visitor visitor, void *context) const
+{
+  if (!mounted_)
+  {
+    return;
+  }
+  const std::size_t base = activeSector_ * device_.sectorSize();
+  std::size_t offset = sizeof(SectorHeader);
+  std::array<uint8_t, kMaxPayloadBytes> payload{};
+  while (offset + sizeof(RecordHeader) <= head_)
+  {
+    RecordHeader header{};
+    device_.read(base + offset, &header, sizeof(header));
+    if (header.type == kErasedType || header.length > kMaxPayloadBytes)
+    {
+      return;
+    }
+    device_.read(base + offset + sizeof(RecordHeader), payload.data(), header.length);
+    if (Checksum(header.type, payload.data(), header.length) != header.crc)
+    {
+      return;
+    }
+    visitor(context, header.type, payload.data(), header.length);
+    offset += RecordSpan(header.length);
+  }
+}
+
+bool FlashLog::append(uint8_t type, const void *payload, std::size_t length)
+{
+  if (!mounted_ || type == kErasedType || length > kMaxPayloadBytes)
+  {
+    return false;
+  }
+  if (RecordSpan(length) > freeBytes())
+  {
+    if (rotating_ || !rotate())
+    {
+      return false;
+    }
+    if (RecordSpan(length) > freeBytes())
+    {
+      return false;
+    }
+  }
+  return writeRecord(type, payload, length);
+}
+
+bool FlashLog::writeRecord(uint8_t type, const void *payload, std::size_t length)
+{
+  const std::size_t offset = (activeSector_ * device_.sectorSize()) + head_;
+  const auto *bytes = static_cast<const uint8_t *>(payload);
+  const RecordHeader header{type, 0xFFU, static_cast<uint16_t>(length), Checksum(type, bytes, length)};
+
+  // Header first: a torn payload then fails its checksum instead of looking
+  // like erased space.
+  head_ += RecordSpan(length);
+  if (!device_.program(offset, &header, sizeof(header)) ||
+      (length > 0 && !device_.program(offset + sizeof(header), bytes, length)))
+  {
+    head_ = device_.sectorSize();
+    writeFailed_ = true;
+    return false;
+  }
+  ++stats_.appends;
+  stats_.bytesProgrammed += static_cast<uint32_t>(sizeof(header) + length);
+  return true;
+}
+
+bool FlashLog::rotate()
+{
+  const std::size_t next = (activeSector_ + 1U) % device_.sectorCount();
+  if (!device_.erase(next))
+  {
+    return false;
+  }
+
+  const std::size_t previousSector = activeSector_;
+  activeSector_ = next;
+  head_ = sizeof(SectorHeader);
+  rotating_ = true;
+  writeFailed_ = false;
+  if (compactor_ != nullptr)
+  {
+    compactor_(compactorContext_, *this);
+  }
+  rotating_ = false;
+
+  // The header goes last: until it lands, mount() still picks the old sector.
+  const SectorHeader header{kSectorMagic, sequence_ + 1U};
+  if (writeFailed_ || !device_.program(next * device_.sectorSize(), &header, sizeof(header)))
+  {
+    activeSector_ = previousSector;
+    head_ = device_.sectorSize();
+    return false;
+  }
+  sequence_ = header.sequence;
+  ++stats_.rotations;
+  stats_.bytesProgrammed += sizeof(header);
+  return true;
+}
+
+} // namespace storage
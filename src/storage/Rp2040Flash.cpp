@@ -0,0 +1,99 @@
+#include "storage/Rp2040Flash.hpp"
+
+#include <cstring>
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_PLATFORM)
+#define STORAGE_HAS_FLASH 1
+#include <hardware/flash.h>
+#include <hardware/sync.h>
+#endif
+
+namespace storage
+{
+
+#if defined(STORAGE_HAS_FLASH)
+namespace
+{
+
+constexpr std::size_t kReservedTopBytes = FLASH_SECTOR_SIZE; // EEPROM emulation
+constexpr std::size_t kRegionOffset =
+    PICO_FLASH_SIZE_BYTES - kReservedTopBytes - (Rp2040Flash::kSectorSize * Rp2040Flash::kSectorCount);
+
+static_assert(Rp2040Flash::kSectorSize == FLASH_SECTOR_SIZE, "Log sectors must match the erase granule");
+
+// Programming runs from a full page: bytes outside the request stay 0xFF,
+// which NOR programming leaves untouched.
+uint8_t gPageBuffer[FLASH_PAGE_SIZE];
+
+} // namespace
+#endif
+
+std::size_t Rp2040Flash::sectorCount() const
+{
+#if defined(STORAGE_HAS_FLASH)
+  return kSectorCount;
+#else
+  return 0;
+#endif
+}
+
+void Rp2040Flash::read(std::size_t offset, void *out, std::size_t length) const
+{
+#if defined(STORAGE_HAS_FLASH)
+  std::memcpy(out, reinterpret_cast<const uint8_t *>(XIP_BASE + kRegionOffset + offset), length);
+#else
+  std::memset(out, 0xFF, length);
+  (void)offset;
+#endif
+}
+
+bool Rp2040Flash::program(std::size_t offset, const void *data, std::size_t length)
+{
+#if defined(STORAGE_HAS_FLASH)
+  if (offset + length > kSectorSize * kSectorCount)
+  {
+    return false;
+  }
+  const auto *source = static_cast<const uint8_t *>(data);
+  while (length > 0)
+  {
+    const std::size_t pageStart = offset & ~static_cast<std::size_t>(FLASH_PAGE_SIZE - 1U);
+    const std::size_t within = offset - pageStart;
+    const std::size_t chunk = (length < FLASH_PAGE_SIZE - within) ? length : FLASH_PAGE_SIZE - within;
+    std::memset(gPageBuffer, 0xFF, sizeof(gPageBuffer));
+    std::memcpy(gPageBuffer + within, source, chunk);
+    // XIP is unavailable while the flash is busy, so nothing may run from it.
+    const uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_program(kRegionOffset + pageStart, gPageBuffer, FLASH_PAGE_SIZE);
+    restore_interrupts(interrupts);
+    offset += chunk;
+    source += chunk;
+    length -= chunk;
+  }
+  return true;
+#else
+  (void)offset;
+  (void)data;
+  (void)length;
+  return false;
+#endif
+}
+
+bool Rp2040Flash::erase(std::size_t sector)
+{
+#if defined(STORAGE_HAS_FLASH)
+  if (sector >= kSectorCount)
+  {
+    return false;
+  }
+  const uint32_t interrupts = save_and_disable_interrupts();
+  flash_range_erase(kRegionOffset + (sector * kSectorSize), kSectorSize);
+  restore_interrupts(interrupts);
+  return true;
+#else
+  (void)sector;
+  return false;
+#endif
+}
+
+} // namespace storage
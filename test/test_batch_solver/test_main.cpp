@@ -0,0 +1,131 @@
+#include <cstdlib>
+
+#include <unity.h>
+
+#include "geometry/BatchSolver.hpp"
+
+namespace
+{
+
+constexpr std::size_t kDecks = 3;
+constexpr std::size_t kMirrorsPerDeck = motion::kChannelCount / 2;
+
+void BuildWall(geometry::MirrorBatch &mirrors, geometry::TargetBatch &targets, std::size_t count)
+{
+  mirrors.resize(count);
+  targets.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    geometry::MirrorPose pose = geometry::DefaultMirrorPose(i % kMirrorsPerDeck);
+    pose.xMm += static_cast<int32_t>((i / kMirrorsPerDeck) * 200);
+    pose.incoming = {0, 2896, -16126};
+    mirrors.assign(i, static_cast<uint16_t>(i / kMirrorsPerDeck), pose);
+    targets.xMm[i] = static_cast<float>((static_cast<int>(i * 37) % 4000) - 2000);
+    targets.yMm[i] = static_cast<float>((static_cast<int>(i * 53) % 3000) - 1500);
+    targets.distanceMm[i] = static_cast<float>(1500 + (i % 7) * 400);
+  }
+}
+
+const geometry::StepLimits kLimits{-1200, 1200};
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_batch_matches_fixed_point_solver()
+{
+  geometry::MirrorBatch mirrors;
+  geometry::TargetBatch targets;
+  BuildWall(mirrors, targets, 1003); // odd size exercises the SIMD tail
+
+  geometry::BatchSolver solver(3);
+  geometry::BatchTargets results;
+  solver.solve(mirrors, targets, kLimits, results);
+
+  for (std::size_t i = 0; i < mirrors.size(); ++i)
+  {
+    geometry::MirrorPose pose = geometry::DefaultMirrorPose(i % kMirrorsPerDeck);
+    pose.xMm += static_cast<int32_t>((i / kMirrorsPerDeck) * 200);
+    pose.incoming = {0, 2896, -16126};
+    const geometry::WallTarget target{static_cast<int32_t>(targets.xMm[i]), static_cast<int32_t>(targets.yMm[i]),
+                                      static_cast<int32_t>(targets.distanceMm[i])};
+    const geometry::AxisTargets scalar = geometry::SolveMirror(pose, target, kLimits);
+    TEST_ASSERT_EQUAL(scalar.status, results.status[i]);
+    if (scalar.status == geometry::TargetStatus::InvalidTarget)
+    {
+      continue;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_INT32(1, std::abs(scalar.yawSteps - results.yawSteps[i]));
+    TEST_ASSERT_LESS_OR_EQUAL_INT32(1, std::abs(scalar.pitchSteps - results.pitchSteps[i]));
+  }
+}
+
+void test_thread_count_does_not_change_results()
+{
+  geometry::MirrorBatch mirrors;
+  geometry::TargetBatch targets;
+  BuildWall(mirrors, targets, 2048);
+
+  geometry::BatchSolver single(1);
+  geometry::BatchSolver pooled(4);
+  geometry::BatchTargets a;
+  geometry::BatchTargets b;
+  single.solve(mirrors, targets, kLimits, a);
+  pooled.solve(mirrors, targets, kLimits, b);
+  pooled.solve(mirrors, targets, kLimits, b); // pool is reusable across frames
+
+  TEST_ASSERT_EQUAL_UINT32(1, single.threads());
+  TEST_ASSERT_EQUAL_UINT32(4, pooled.threads());
+  TEST_ASSERT_TRUE(a.yawSteps == b.yawSteps);
+  TEST_ASSERT_TRUE(a.pitchSteps == b.pitchSteps);
+}
+
+void test_invalid_and_unreachable_targets_are_flagged()
+{
+  geometry::MirrorBatch mirrors;
+  geometry::TargetBatch targets;
+  BuildWall(mirrors, targets, 3);
+  targets.distanceMm[0] = 0.0f;
+  targets.xMm[1] = 25000.0f;
+  targets.distanceMm[1] = 100.0f;
+  mirrors.stepsPerTurn[1] = 51200.0f;
+
+  geometry::BatchTargets results;
+  geometry::BatchSolver(1).solve(mirrors, targets, kLimits, results);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::InvalidTarget, results.status[0]);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::YawOutOfRange, results.status[1]);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::Reachable, results.status[2]);
+}
+
+void test_scatter_builds_per_deck_channel_targets()
+{
+  geometry::MirrorBatch mirrors;
+  geometry::TargetBatch targets;
+  BuildWall(mirrors, targets, kDecks * kMirrorsPerDeck);
+  targets.distanceMm[1] = -5.0f; // deck 0, mirror 1 -> channels 2/3 left unassigned
+
+  geometry::BatchTargets results;
+  geometry::BatchSolver(2).solve(mirrors, targets, kLimits, results);
+  std::vector<geometry::DeckFrame> decks;
+  geometry::ScatterToDecks(mirrors, results, decks);
+
+  TEST_ASSERT_EQUAL_UINT32(kDecks, decks.size());
+  TEST_ASSERT_TRUE(decks[0].hasTarget(0));
+  TEST_ASSERT_FALSE(decks[0].hasTarget(2));
+  TEST_ASSERT_FALSE(decks[0].hasTarget(3));
+  const std::size_t last = (kDecks * kMirrorsPerDeck) - 1;
+  TEST_ASSERT_TRUE(decks[kDecks - 1].hasTarget(motion::kChannelCount - 1));
+  TEST_ASSERT_EQUAL_INT32(results.pitchSteps[last], decks[kDecks - 1].target[motion::kChannelCount - 1]);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_batch_matches_fixed_point_solver);
+  RUN_TEST(test_thread_count_does_not_change_results);
+  RUN_TEST(test_invalid_and_unreachable_targets_are_flagged);
+  RUN_TEST(test_scatter_builds_per_deck_channel_targets);
+  return UNITY_END();
+}
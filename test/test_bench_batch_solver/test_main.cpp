@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <unity.h>
+
+#include "geometry/BatchSolver.hpp"
+
+// Native benchmark: mirrors solved per second by the fixed-point firmware
+// solver, the SIMD batch kernel on one thread, and the pooled batch solver,
+// plus the batch solver's step error against a double-precision reference.
+namespace
+{
+
+constexpr std::size_t kMirrors = 16384;
+constexpr int kFrames = 20;
+constexpr double kTwoPi = 6.283185307179586;
+const geometry::StepLimits kLimits{-100000, 100000};
+
+geometry::MirrorBatch gMirrors;
+geometry::TargetBatch gTargets;
+
+void BuildWall()
+{
+  gMirrors.resize(kMirrors);
+  gTargets.resize(kMirrors);
+  for (std::size_t i = 0; i < kMirrors; ++i)
+  {
+    geometry::MirrorPose pose{};
+    pose.xMm = static_cast<int32_t>((i % 128) * 40) - 2560;
+    pose.yMm = static_cast<int32_t>((i / 128) * 40) - 2560;
+    pose.incoming = {1420, 2896, -16064};
+    pose.yawChannel = static_cast<uint8_t>((i * 2) % motion::kChannelCount);
+    pose.pitchChannel = static_cast<uint8_t>(pose.yawChannel + 1);
+    gMirrors.assign(i, static_cast<uint16_t>(i / (motion::kChannelCount / 2)), pose);
+    gTargets.xMm[i] = static_cast<float>((static_cast<int>(i * 7919) % 12000) - 6000);
+    gTargets.yMm[i] = static_cast<float>((static_cast<int>(i * 104729) % 8000) - 4000);
+    gTargets.distanceMm[i] = static_cast<float>(2000 + (i % 97) * 60);
+  }
+}
+
+geometry::MirrorPose PoseAt(std::size_t i)
+{
+  geometry::MirrorPose pose{};
+  pose.xMm = static_cast<int32_t>(gMirrors.xMm[i]);
+  pose.yMm = static_cast<int32_t>(gMirrors.yMm[i]);
+  pose.incoming = {1420, 2896, -16064};
+  return pose;
+}
+
+template <typename Fn>
+double MirrorsPerSecond(Fn &&solveFrame)
+{
+  solveFrame(); // warm caches and the pool
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; ++frame)
+  {
+    solveFrame();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return (static_cast<double>(kMirrors) * kFrames) / std::chrono::duration<double>(stop - start).count();
+}
+
+void Report(const char *label, double rate)
+{
+  char line[96];
+  std::snprintf(line, sizeof(line), "%-24s %12.0f mirrors/s", label, rate);
+  TEST_MESSAGE(line);
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_batch_solver_throughput_and_accuracy()
+{
+  BuildWall();
+  geometry::BatchTargets results;
+  results.resize(kMirrors);
+
+  volatile int32_t sink = 0;
+  const double scalarRate = MirrorsPerSecond([&]()
+                                             {
+    for (std::size_t i = 0; i < kMirrors; ++i)
+    {
+      const geometry::WallTarget target{static_cast<int32_t>(gTargets.xMm[i]), static_cast<int32_t>(gTargets.yMm[i]),
+                                        static_cast<int32_t>(gTargets.distanceMm[i])};
+      sink = sink + geometry::SolveMirror(PoseAt(i), target, kLimits).yawSteps;
+    } });
+  const double simdRate = MirrorsPerSecond([&]()
+                                           { geometry::BatchSolver::SolveRange(gMirrors, gTargets, kLimits, results, 0, kMirrors); });
+  geometry::BatchSolver pooled;
+  const double pooledRate = MirrorsPerSecond([&]()
+                                             { pooled.solve(gMirrors, gTargets, kLimits, results); });
+
+  int32_t worst = 0;
+  std::size_t exact = 0;
+  for (std::size_t i = 0; i < kMirrors; ++i)
+  {
+    const double ox = gTargets.xMm[i] - gMirrors.xMm[i];
+    const double oy = gTargets.yMm[i] - gMirrors.yMm[i];
+    const double oz = gTargets.distanceMm[i];
+    const double length = std::sqrt((ox * ox) + (oy * oy) + (oz * oz));
+    const double nx = (ox / length) - gMirrors.incomingX[i];
+    const double ny = (oy / length) - gMirrors.incomingY[i];
+    const double nz = (oz / length) - gMirrors.incomingZ[i];
+    const double spr = gMirrors.stepsPerTurn[i] / kTwoPi;
+    const int32_t yaw = static_cast<int32_t>(std::lround(std::atan2(nx, nz) * spr));
+    const int32_t pitch = static_cast<int32_t>(std::lround(std::atan2(ny, std::sqrt((nx * nx) + (nz * nz))) * spr));
+    const int32_t error = std::max(std::abs(yaw - results.yawSteps[i]), std::abs(pitch - results.pitchSteps[i]));
+    worst = std::max(worst, error);
+    exact += (error == 0) ? 1U : 0U;
+  }
+
+  char line[96];
+  Report("fixed-point scalar", scalarRate);
+  Report("SIMD batch, 1 thread", simdRate);
+  std::snprintf(line, sizeof(line), "SIMD batch, %zu threads", pooled.threads());
+  Report(line, pooledRate);
+  std::snprintf(line, sizeof(line), "accuracy vs double: worst=%ld steps exact=%.2f%%",
+                static_cast<long>(worst), 100.0 * static_cast<double>(exact) / kMirrors);
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(1, worst);
+  TEST_ASSERT_TRUE_MESSAGE(simdRate > scalarRate, "SIMD kernel should beat the fixed-point scalar path");
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_batch_solver_throughput_and_accuracy);
+  return UNITY_END();
+}
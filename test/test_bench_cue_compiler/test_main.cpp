@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <unity.h>
+
+#include "cue/CueCompiler.hpp"
+
+// Native benchmark: parse + plan + encode a two-hour show with an aim cue for
+// every mirror every 250 ms.
+namespace
+{
+
+constexpr uint32_t kShowMs = 2U * 60U * 60U * 1000U;
+constexpr uint32_t kCueSpacingMs = 250;
+
+std::string BuildTimeline()
+{
+  std::string timeline;
+  char line[64];
+  for (uint32_t atMs = 0, frame = 0; atMs < kShowMs; atMs += kCueSpacingMs, ++frame)
+  {
+    for (std::size_t mirror = 0; mirror < cue::CueCompiler::kMirrorCount; ++mirror)
+    {
+      const long x = static_cast<long>((frame * 131U + mirror * 17U) % 1200U) - 600;
+      const long y = static_cast<long>((frame * 71U + mirror * 29U) % 800U) - 400;
+      std::snprintf(line, sizeof(line), "at %lu aim %zu %ld %ld 3000\n", static_cast<unsigned long>(atMs), mirror, x, y);
+      timeline += line;
+    }
+  }
+  return timeline;
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_long_show_compiles_well_under_a_second()
+{
+  const std::string timeline = BuildTimeline();
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<cue::Cue> cues;
+  std::vector<cue::Diagnostic> diagnostics;
+  TEST_ASSERT_TRUE(cue::ParseTimeline(timeline, cues, diagnostics));
+  const std::size_t cueCount = cues.size();
+  const cue::CompiledShow show = cue::CueCompiler().compile(std::move(cues));
+  const std::vector<uint8_t> program = cue::EncodeProgram(show);
+  const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "cues=%zu moves=%zu program=%zu B (%.2f B/move) compile=%.1f ms", cueCount,
+                show.moveCount(), program.size(), static_cast<double>(program.size()) / show.moveCount(), elapsedMs);
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_TRUE(show.ok());
+  TEST_ASSERT_TRUE(elapsedMs < 1000.0);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_long_show_compiles_well_under_a_second);
+  return UNITY_END();
+}
@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include <unity.h>
+
+#include "geometry/Targeting.hpp"
+#include "motion/MotorManager.hpp"
+
+// Native benchmark: solving every mirror of the deck (both channels of each)
+// for a new wall point, as a cue that re-aims the whole panel does, against
+// one loop pass. The host is far faster than the M0+, so the measured time is
+// scaled by a deliberately pessimistic slowdown before it meets the budget.
+namespace
+{
+
+constexpr std::size_t kMirrors = motion::kChannelCount / 2;
+constexpr int kRounds = 20000;
+// main.cpp traces a loop pass longer than this as an overrun.
+constexpr double kTickBudgetUs = 2000.0;
+// A 133 MHz single-issue core with 64-bit multiplies and shifts done in
+// software, against a multi-GHz host core.
+constexpr double kM0PlusSlowdown = 100.0;
+
+volatile int32_t gSink = 0;
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_all_mirrors_solve_within_one_tick()
+{
+  geometry::MirrorPose poses[kMirrors];
+  for (std::size_t mirror = 0; mirror < kMirrors; ++mirror)
+  {
+    poses[mirror] = geometry::DefaultMirrorPose(mirror);
+  }
+  const geometry::StepLimits limits{-motion::MotorManager::kDefaultLimit, motion::MotorManager::kDefaultLimit};
+
+  std::size_t reachable = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round)
+  {
+    // A different point each round so nothing is hoisted out of the loop.
+    const geometry::WallTarget target{(round % 801) - 400, (round % 401) - 200, 2000 + (round % 64)};
+    for (std::size_t mirror = 0; mirror < kMirrors; ++mirror)
+    {
+      const geometry::AxisTargets axes = geometry::SolveMirror(poses[mirror], target, limits);
+      reachable += axes.status == geometry::TargetStatus::Reachable ? 1U : 0U;
+      gSink = gSink + axes.yawSteps + axes.pitchSteps;
+    }
+  }
+  const double hostUs =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kRounds;
+  const double deviceUs = hostUs * kM0PlusSlowdown;
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "%zu mirrors: host=%.3f us/panel M0+ estimate=%.1f us (budget %.0f us)", kMirrors,
+                hostUs, deviceUs, kTickBudgetUs);
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL_UINT32(kRounds * kMirrors, reachable);
+  TEST_ASSERT_TRUE_MESSAGE(deviceUs < kTickBudgetUs, "solving every mirror no longer fits one loop pass");
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_all_mirrors_solve_within_one_tick);
+  return UNITY_END();
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+
+#include <unity.h>
+
+#include "motion/MotorManager.hpp"
+#include "motion/StepperPioProgram.hpp"
+
+// Native benchmark: planning a cue's worth of repeated moves with the profile
+// cache against recomputing every plan. The host has hardware floating point,
+// so the gap here understates the one on the M0+.
+namespace
+{
+
+constexpr int kRounds = 20000;
+constexpr int32_t kPositions[] = {0, 400, -250, 900};
+constexpr std::size_t kPositionCount = sizeof(kPositions) / sizeof(kPositions[0]);
+
+motion::MotorManager gManager;
+volatile uint32_t gSink = 0;
+
+uint32_t LegSteps(std::size_t index)
+{
+  const int32_t from = kPositions[index];
+  const int32_t to = kPositions[(index + 1U) % kPositionCount];
+  return static_cast<uint32_t>(to > from ? to - from : from - to);
+}
+
+double TimeUncached()
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round)
+  {
+    for (std::size_t index = 0; index < kPositionCount; ++index)
+    {
+      const motion::TimingEstimate timing = motion::MotorManager::ComputeTiming(LegSteps(index), 4000, 16000);
+      const motion::pio::StepperCommand rate = motion::pio::StepTimingForRate(4000);
+      gSink = gSink + timing.totalDurationUs + rate.delayTicks;
+    }
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         (kRounds * kPositionCount);
+}
+
+double TimeCached(motion::ProfileCache &cache)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round)
+  {
+    for (std::size_t index = 0; index < kPositionCount; ++index)
+    {
+      const uint32_t steps = LegSteps(index);
+      const motion::MotionProfile *profile = cache.find(steps, 4000, 16000);
+      if (profile == nullptr)
+      {
+        motion::MotionProfile fresh{};
+        fresh.timing = motion::MotorManager::ComputeTiming(steps, 4000, 16000);
+        const motion::pio::StepperCommand rate = motion::pio::StepTimingForRate(4000);
+        fresh.rate.delayTicks = rate.delayTicks;
+        profile = &cache.insert(steps, 4000, 16000, fresh);
+      }
+      gSink = gSink + profile->timing.totalDurationUs + profile->rate.delayTicks;
+    }
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         (kRounds * kPositionCount);
+}
+
+void RunManager()
+{
+  gManager.reset();
+  motion::TimingEstimate timing{};
+  motion::pio::StepperCommand command{};
+  for (int round = 0; round < kRounds; ++round)
+  {
+    for (std::size_t index = 0; index < kPositionCount; ++index)
+    {
+      gManager.queueMove(0, kPositions[(index + 1U) % kPositionCount], 4000, 16000, timing);
+      gManager.takePendingCommand(0, command);
+      gManager.service(gManager.state(0).plannedDurationUs + 10U);
+    }
+  }
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_repeated_moves_plan_from_the_cache()
+{
+  motion::ProfileCache cache;
+  const double uncachedNs = TimeUncached();
+  const double cachedNs = TimeCached(cache);
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "plan=%.1f ns/move cached=%.1f ns/move (%.0f%%)", uncachedNs, cachedNs,
+                100.0 * cachedNs / uncachedNs);
+  TEST_MESSAGE(line);
+
+  // Four distinct legs: every plan after the first lap is a hit, and each
+  // move is looked up once; takePendingCommand reuses the plan's rate.
+  RunManager();
+  const auto stats = gManager.profileCache().stats();
+  TEST_ASSERT_EQUAL_UINT32(kPositionCount, stats.misses);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.evictions);
+  TEST_ASSERT_EQUAL_UINT32(kRounds * kPositionCount - kPositionCount, stats.hits);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_repeated_moves_plan_from_the_cache);
+  return UNITY_END();
+}
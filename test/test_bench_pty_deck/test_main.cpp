@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unity.h>
+
+#include "host/DeckClient.hpp"
+#include "host/PtyDeck.hpp"
+
+// Native benchmark: end-to-end protocol cost through a pty to the deck's
+// command loop. Latency is first-byte round trip of one tagged STATUS:0;
+// throughput is replies per second at several pipelining windows.
+namespace
+{
+
+constexpr int kLatencySamples = 500;
+constexpr std::size_t kThroughputCommands = 4000;
+
+double Percentile(std::vector<double> samples, double fraction)
+{
+  std::sort(samples.begin(), samples.end());
+  return samples[static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1))];
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_round_trip_latency()
+{
+  host::PtyDeck deck;
+  TEST_ASSERT_TRUE(deck.open());
+  deck.start();
+  // With no settle gap a reply ends on the read that brings its CTRL line,
+  // so this times the round trip rather than the client's quiet period.
+  host::DeckClient::Options options{};
+  options.window = 1;
+  options.settleUs = 0;
+  host::DeckClient client(options);
+  TEST_ASSERT_TRUE(client.open(deck.path()));
+
+  std::vector<double> micros;
+  micros.reserve(kLatencySamples);
+  for (int i = 0; i < kLatencySamples; ++i)
+  {
+    const auto sent = std::chrono::steady_clock::now();
+    const host::Reply reply = client.call("STATUS:0", 1000);
+    micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+    TEST_ASSERT_TRUE(reply.ok());
+  }
+  char line[96];
+  std::snprintf(line, sizeof(line), "pty round trip: p50=%.0f us p99=%.0f us", Percentile(micros, 0.5),
+                Percentile(micros, 0.99));
+  TEST_MESSAGE(line);
+}
+
+void test_throughput_by_window()
+{
+  host::PtyDeck deck;
+  TEST_ASSERT_TRUE(deck.open());
+  deck.start();
+  for (std::size_t window : {std::size_t{4}, std::size_t{16}, std::size_t{64}})
+  {
+    host::DeckClient::Options options{};
+    options.window = window;
+    host::DeckClient client(options);
+    TEST_ASSERT_TRUE(client.open(deck.path()));
+    const auto started = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kThroughputCommands; ++i)
+    {
+      client.submit("STATUS:0");
+    }
+    TEST_ASSERT_TRUE(client.drain(20'000));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const double rate = static_cast<double>(kThroughputCommands) / seconds;
+    char line[96];
+    std::snprintf(line, sizeof(line), "window %zu: %.0f commands/s", window, rate);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(rate > 0.0);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_latency);
+  RUN_TEST(test_throughput_by_window);
+  return UNITY_END();
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include <unity.h>
+
+#include "motion/MotorManager.hpp"
+
+// Native benchmark: cost of one MotorManager::service() tick with every
+// channel mid-move, for the channel counts the firmware can be built with.
+namespace
+{
+
+constexpr uint32_t kTickMicros = 100;
+constexpr int kTicks = 20000;
+
+struct ScalingSample
+{
+  std::size_t channels = 0;
+  double nanosPerTick = 0.0;
+};
+
+template <std::size_t ChannelCount>
+ScalingSample MeasureServiceCost()
+{
+  static motion::BasicMotorManager<ChannelCount> manager;
+  manager.reset();
+
+  auto rearm = []()
+  {
+    for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+    {
+      motion::TimingEstimate timing{};
+      long target = (manager.state(channel).position > 0) ? -1000 : 1000;
+      manager.queueMove(channel, target, 4000, 16000, timing);
+    }
+  };
+  rearm();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int tick = 0; tick < kTicks; ++tick)
+  {
+    manager.service(kTickMicros);
+    if (manager.state(0).phase == motion::MotionPhase::Idle)
+    {
+      rearm();
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  ScalingSample sample{};
+  sample.channels = ChannelCount;
+  sample.nanosPerTick = std::chrono::duration<double, std::nano>(stop - start).count() / kTicks;
+  return sample;
+}
+
+void Report(const ScalingSample &sample)
+{
+  char line[96];
+  std::snprintf(line, sizeof(line), "service(): channels=%zu ns/tick=%.1f ns/channel=%.2f",
+                sample.channels, sample.nanosPerTick, sample.nanosPerTick / static_cast<double>(sample.channels));
+  TEST_MESSAGE(line);
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_service_cost_scales_linearly_with_channel_count()
+{
+  const ScalingSample samples[] = {
+      MeasureServiceCost<8>(),
+      MeasureServiceCost<16>(),
+      MeasureServiceCost<32>(),
+      MeasureServiceCost<64>()};
+
+  for (const auto &sample : samples)
+  {
+    Report(sample);
+  }
+
+  // Per-channel cost must stay flat; a superlinear term would show up here.
+  double perChannel8 = samples[0].nanosPerTick / 8.0;
+  double perChannel64 = samples[3].nanosPerTick / 64.0;
+  TEST_ASSERT_TRUE_MESSAGE(perChannel64 < perChannel8 * 3.0, "service() cost grows faster than channel count");
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_service_cost_scales_linearly_with_channel_count);
+  return UNITY_END();
+}
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <string_view>
+
+#include <unity.h>
+
+#include "control/CommandProcessor.hpp"
+#include "storage/CalibrationStore.hpp"
+#include "storage/RamFlash.hpp"
+
+namespace
+{
+
+using Flash = storage::RamFlash<4096, 4>;
+
+Flash flash;
+ctrl::CommandProcessor processor;
+ctrl::CommandProcessor::Response response{};
+
+std::string_view Line(std::size_t index)
+{
+  return index < response.count ? std::string_view(response.lines[index].data()) : std::string_view{};
+}
+
+// One power cycle: a fresh store and processor over the same flash.
+bool Boot(storage::CalibrationStore &store)
+{
+  processor.reset();
+  processor.attachStore(&store);
+  if (!store.begin())
+  {
+    return false;
+  }
+  return processor.restoreFromStore();
+}
+
+} // namespace
+
+void setUp()
+{
+  flash = Flash{};
+}
+
+void tearDown()
+{
+  processor.attachStore(nullptr);
+}
+
+void test_blank_flash_requires_homing()
+{
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_FALSE(Boot(store));
+  TEST_ASSERT_TRUE(store.ready());
+  TEST_ASSERT_FALSE(store.lastShutdown().clean);
+  TEST_ASSERT_EQUAL_UINT32(1, store.bootCount());
+  TEST_ASSERT_FALSE(processor.motorManager().isHomed(0));
+}
+
+void test_clean_shutdown_resumes_without_homing()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    processor.processLine("CAL:1,100,-500,900", response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    TEST_ASSERT_TRUE(Line(1).find("SAVED=1") != std::string_view::npos);
+    TEST_ASSERT_TRUE(processor.motorManager().restorePosition(1, 321));
+    TEST_ASSERT_TRUE(processor.motorManager().restorePosition(3, -42));
+    processor.processLine("SHUTDOWN", response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    TEST_ASSERT_EQUAL_STRING("SHUTDOWN:HOMED=0xa BOOT=1", response.lines[1].data());
+  }
+
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_TRUE(Boot(store));
+  const auto &manager = processor.motorManager();
+  TEST_ASSERT_TRUE(manager.isHomed(1));
+  TEST_ASSERT_TRUE(manager.isHomed(3));
+  TEST_ASSERT_FALSE(manager.isHomed(0));
+  TEST_ASSERT_EQUAL_INT32(321, manager.state(1).position);
+  TEST_ASSERT_EQUAL_INT32(-42, manager.state(3).position);
+  TEST_ASSERT_EQUAL_INT32(100, manager.zeroOffset(1));
+  TEST_ASSERT_EQUAL_INT32(-500, manager.negativeLimit(1));
+  TEST_ASSERT_EQUAL_INT32(900, manager.positiveLimit(1));
+}
+
+void test_power_loss_after_boot_requires_homing()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    processor.motorManager().restorePosition(0, 10);
+    processor.processLine("SHUTDOWN", response);
+  }
+  {
+    // Boots cleanly, then loses power without a SHUTDOWN.
+    storage::CalibrationStore store(flash);
+    TEST_ASSERT_TRUE(Boot(store));
+  }
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_FALSE(Boot(store));
+  TEST_ASSERT_FALSE(processor.motorManager().isHomed(0));
+  TEST_ASSERT_EQUAL_UINT32(3, store.bootCount());
+}
+
+void test_motion_after_shutdown_requires_homing()
+{
+  const char *commands[] = {"MOVE:0,800", "HOME:0", "WAKE:0"};
+  for (const char *command : commands)
+  {
+    flash = Flash{};
+    {
+      storage::CalibrationStore store(flash);
+      Boot(store);
+      TEST_ASSERT_TRUE(processor.motorManager().restorePosition(0, 0));
+      processor.processLine("SHUTDOWN", response);
+      TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+      processor.processLine(command, response);
+      TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+      TEST_ASSERT_FALSE(store.shutdownClean());
+      for (int tick = 0; tick < 200; ++tick)
+      {
+        processor.service(50000);
+      }
+    }
+
+    // main.cpp prints BOOT:HOMING_REQUIRED for this.
+    storage::CalibrationStore store(flash);
+    TEST_ASSERT_FALSE(Boot(store));
+    TEST_ASSERT_FALSE(store.lastShutdown().clean);
+    TEST_ASSERT_FALSE(processor.motorManager().isHomed(0));
+  }
+}
+
+void test_motion_waits_for_the_journal_to_be_invalidated()
+{
+  storage::CalibrationStore store(flash);
+  Boot(store);
+  TEST_ASSERT_TRUE(processor.motorManager().restorePosition(0, 0));
+  processor.processLine("SHUTDOWN", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+
+  // The boot marker cannot be written: moving would leave a clean journal
+  // behind positions that are no longer true.
+  flash.cutPowerAfter(0);
+  processor.processLine("MOVE:0,800", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_DRIVER_FAULT", response.lines[0].data());
+  TEST_ASSERT_EQUAL_STRING("MOVE:ERR=FLASH", response.lines[1].data());
+  TEST_ASSERT_TRUE(store.shutdownClean());
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorManager().state(0).phase);
+  processor.processLine("AIM:0,0,0,1000", response);
+  TEST_ASSERT_EQUAL_STRING("AIM:ERR=FLASH", response.lines[1].data());
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorManager().state(1).phase);
+
+  flash.restorePower();
+  processor.processLine("MOVE:0,800", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+  TEST_ASSERT_FALSE(store.shutdownClean());
+}
+
+void test_recalibration_after_shutdown_requires_homing()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    TEST_ASSERT_TRUE(processor.motorManager().restorePosition(0, 300));
+    processor.processLine("SHUTDOWN", response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    processor.processLine("CAL:0,100,-1000,1000", response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    TEST_ASSERT_EQUAL_INT32(200, processor.motorManager().state(0).position);
+    TEST_ASSERT_FALSE(store.shutdownClean());
+  }
+
+  // The journal holds 300 against the old zero; resuming from it would be
+  // off by the offset shift.
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_FALSE(Boot(store));
+  TEST_ASSERT_FALSE(processor.motorManager().isHomed(0));
+  TEST_ASSERT_EQUAL_INT32(100, processor.motorManager().zeroOffset(0));
+}
+
+void test_compaction_keeps_a_stale_journal_stale()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    TEST_ASSERT_TRUE(processor.motorManager().restorePosition(0, 0));
+    processor.processLine("SHUTDOWN", response);
+    processor.processLine("MOVE:0,800", response);
+    for (int tick = 0; tick < 200; ++tick)
+    {
+      processor.service(50000);
+    }
+    // Enough calibration records to wrap every sector at least once.
+    const uint32_t erases = flash.eraseCounts[0] + flash.eraseCounts[1] + flash.eraseCounts[2] + flash.eraseCounts[3];
+    for (int save = 0; save < 2000; ++save)
+    {
+      processor.processLine(save % 2 == 0 ? "CAL:1,5,-600,600" : "CAL:1,6,-600,600", response);
+      TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(
+        erases + 4U, flash.eraseCounts[0] + flash.eraseCounts[1] + flash.eraseCounts[2] + flash.eraseCounts[3]);
+  }
+
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_FALSE(Boot(store));
+  TEST_ASSERT_EQUAL_INT32(6, processor.motorManager().zeroOffset(1));
+}
+
+void test_shutdown_is_one_small_record()
+{
+  storage::CalibrationStore store(flash);
+  Boot(store);
+  const uint32_t calls = flash.programCalls;
+  const std::size_t bytes = flash.bytesProgrammed;
+  processor.processLine("SHUTDOWN", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+  // Record header plus payload, in two program operations.
+  TEST_ASSERT_EQUAL_UINT32(2, flash.programCalls - calls);
+  TEST_ASSERT_LESS_OR_EQUAL(8 + 4 + sizeof(motion::MotorManager::ChannelMask) + (4 * motion::kChannelCount),
+                            flash.bytesProgrammed - bytes);
+}
+
+void test_shutdown_requires_idle_channels_and_a_store()
+{
+  processor.reset();
+  processor.processLine("SHUTDOWN", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_NOT_READY", response.lines[0].data());
+
+  storage::CalibrationStore store(flash);
+  Boot(store);
+  processor.processLine("MOVE:2,400", response);
+  processor.processLine("SHUTDOWN", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_BUSY", response.lines[0].data());
+  TEST_ASSERT_EQUAL_STRING("SHUTDOWN:ERR=BUSY CH=2", response.lines[1].data());
+
+  // CAL writes flash too, so it waits for the whole array, not just its channel.
+  processor.processLine("CAL:0,5,-600,600", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_BUSY", response.lines[0].data());
+  TEST_ASSERT_EQUAL_STRING("CAL:ERR=BUSY CH=2", response.lines[1].data());
+  TEST_ASSERT_FALSE(store.hasCalibration(0));
+
+  processor.processLine("CAL:0,0,10,-10", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_ARGUMENT", response.lines[0].data());
+}
+
+void test_power_cycles_spread_erases_evenly()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    processor.processLine("CAL:0,-7,-800,800", response);
+  }
+  for (int cycle = 0; cycle < 2000; ++cycle)
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    processor.motorManager().restorePosition(0, cycle);
+    processor.processLine("SHUTDOWN", response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+  }
+
+  const auto [least, most] = std::minmax_element(flash.eraseCounts.begin(), flash.eraseCounts.end());
+  TEST_ASSERT_GREATER_THAN_UINT32(4, *least);
+  TEST_ASSERT_LESS_OR_EQUAL(1U, *most - *least);
+
+  storage::CalibrationStore store(flash);
+  TEST_ASSERT_TRUE(Boot(store));
+  TEST_ASSERT_EQUAL_INT32(1999, processor.motorManager().state(0).position);
+  TEST_ASSERT_EQUAL_INT32(-7, processor.motorManager().zeroOffset(0));
+  TEST_ASSERT_EQUAL_UINT32(2002, store.bootCount());
+}
+
+void test_torn_writes_never_lose_calibration()
+{
+  {
+    storage::CalibrationStore store(flash);
+    Boot(store);
+    processor.processLine("CAL:5,12,-300,300", response);
+  }
+
+  // Cut power at every byte offset across enough cycles to tear records,
+  // sector headers, and compaction alike.
+  for (std::size_t budget = 0; budget < 400; ++budget)
+  {
+    {
+      storage::CalibrationStore store(flash);
+      Boot(store);
+      processor.motorManager().restorePosition(5, static_cast<int32_t>(budget));
+      flash.cutPowerAfter(budget % 80);
+      processor.processLine("SHUTDOWN", response);
+      flash.restorePower();
+    }
+
+    storage::CalibrationStore store(flash);
+    const bool resumed = Boot(store);
+    TEST_ASSERT_TRUE(store.ready());
+    TEST_ASSERT_EQUAL_INT32(12, processor.motorManager().zeroOffset(5));
+    TEST_ASSERT_EQUAL_INT32(300, processor.motorManager().positiveLimit(5));
+    if (resumed)
+    {
+      // Only a complete journal may resume, and then with the right position.
+      TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(budget), processor.motorManager().state(5).position);
+    }
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_blank_flash_requires_homing);
+  RUN_TEST(test_clean_shutdown_resumes_without_homing);
+  RUN_TEST(test_power_loss_after_boot_requires_homing);
+  RUN_TEST(test_motion_after_shutdown_requires_homing);
+  RUN_TEST(test_motion_waits_for_the_journal_to_be_invalidated);
+  RUN_TEST(test_recalibration_after_shutdown_requires_homing);
+  RUN_TEST(test_compaction_keeps_a_stale_journal_stale);
+  RUN_TEST(test_shutdown_is_one_small_record);
+  RUN_TEST(test_shutdown_requires_idle_channels_and_a_store);
+  RUN_TEST(test_power_cycles_spread_erases_evenly);
+  RUN_TEST(test_torn_writes_never_lose_calibration);
+  return UNITY_END();
+}
@@ -1,8 +1,11 @@
+#include <string>
 #include <string_view>
 
 #include <unity.h>
 
 #include "control/CommandProcessor.hpp"
+#include "control/Snapshot.hpp"
+#include "diag/BootLog.hpp"
 
 namespace
 {
@@ -135,6 +138,117 @@ void test_status_reports_structured_channel_data()
   TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_CHANNEL", GetLine(response, 0).data());
 }
 
+void test_aim_queues_both_mirror_axes()
+{
+  ctrl::CommandProcessor::Response response{};
+  processor.processLine("AIM:1,400,250,2000", response);
+
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(GetLine(response, 1).find("AIM:MIRROR=1 YAW_CH=2") != std::string_view::npos);
+
+  const auto &yaw = processor.motorState(2);
+  const auto &pitch = processor.motorState(3);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, yaw.phase);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, pitch.phase);
+  TEST_ASSERT_GREATER_THAN_INT32(0, yaw.targetPosition);
+  TEST_ASSERT_GREATER_THAN_INT32(0, pitch.targetPosition);
+
+  // Geared mirror: 45 degrees of yaw is well past the default step limit.
+  processor.mirrorPose(0).stepsPerTurn = 8 * geometry::kDefaultStepsPerTurn;
+  processor.processLine("AIM:0,25000,0,100", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_LIMIT", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(GetLine(response, 1).find("AIM:UNREACHABLE MIRROR=0 REASON=YAW_LIMIT") != std::string_view::npos);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorState(0).phase);
+}
+
+void test_aim_leaves_yaw_alone_when_pitch_refuses()
+{
+  ctrl::CommandProcessor::Response response{};
+  processor.motorManager().injectFault(3, motion::FaultCode::DriverFault);
+  processor.processLine("AIM:1,400,250,2000", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_DRIVER_FAULT", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("AIM:ERR=DRIVER_FAULT", GetLine(response, 1).data());
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorState(2).phase);
+  TEST_ASSERT_EQUAL_INT32(0, processor.motorState(2).position);
+  TEST_ASSERT_EQUAL_INT32(0, processor.motorState(2).targetPosition);
+
+  processor.reset();
+  processor.processLine("HOME:3", response);
+  processor.processLine("AIM:1,400,250,2000", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_BUSY", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorState(2).phase);
+  TEST_ASSERT_EQUAL_INT32(0, processor.motorState(2).targetPosition);
+  processor.processLine("STATUS:2", response);
+  TEST_ASSERT_TRUE(GetLine(response, 1).find("ERR=ERR_BUSY") != std::string_view::npos);
+}
+
+void test_boot_reports_phase_timestamps()
+{
+  diag::ResetBootLog();
+  diag::MarkBootPhase(diag::BootPhase::Reset, 0);
+  diag::MarkBootPhase(diag::BootPhase::MotionReady, 850);
+  diag::MarkBootPhase(diag::BootPhase::StoreReady, 4100);
+  diag::MarkBootPhase(diag::BootPhase::Ready, 4200);
+  diag::MarkBootPhase(diag::BootPhase::MotionReady, 9999);
+
+  ctrl::CommandProcessor::Response response{};
+  processor.processLine("BOOT", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("BOOT:RESET=0 MOTION=850 STORE=4100 READY=4200 HOST=-", GetLine(response, 1).data());
+  diag::ResetBootLog();
+}
+
+void test_snapshot_frame_decodes_every_channel()
+{
+  ctrl::CommandProcessor::Response response{};
+  processor.processLine("MOVE:4,-300", response);
+  processor.service(25'000);
+  processor.processLine("SNAP", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+
+  std::string hex;
+  for (std::size_t i = 1; i < response.count; ++i)
+  {
+    const std::string_view line = GetLine(response, i);
+    TEST_ASSERT_TRUE(line.substr(0, 5) == "SNAP:");
+    hex += line.substr(5);
+  }
+
+  uint8_t frame[ctrl::snapshot::FrameBytes(ctrl::CommandProcessor::kMotorCount)];
+  TEST_ASSERT_EQUAL_UINT32(sizeof(frame), ctrl::snapshot::DecodeHex(hex, frame, sizeof(frame)));
+  ctrl::snapshot::Header header{};
+  TEST_ASSERT_EQUAL(ctrl::snapshot::DecodeStatus::Ok, ctrl::snapshot::DecodeFrame(frame, sizeof(frame), header));
+  TEST_ASSERT_EQUAL_UINT8(ctrl::CommandProcessor::kMotorCount, header.channelCount);
+  TEST_ASSERT_EQUAL_UINT32(25'000, static_cast<uint32_t>(header.timestampUs));
+
+  const auto &state = processor.motorState(4);
+  const ctrl::snapshot::ChannelRecord moving = ctrl::snapshot::DecodeChannel(frame, header, 4);
+  TEST_ASSERT_EQUAL_INT32(state.position, moving.position);
+  TEST_ASSERT_EQUAL_INT32(-300, moving.targetPosition);
+  TEST_ASSERT_EQUAL_UINT32(state.plannedDurationUs, moving.plannedDurationUs);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(motion::MotionPhase::Moving), moving.phase);
+  TEST_ASSERT_EQUAL_UINT8(0, moving.flags & ctrl::snapshot::kFlagAsleep);
+  const ctrl::snapshot::ChannelRecord idle = ctrl::snapshot::DecodeChannel(frame, header, 0);
+  TEST_ASSERT_EQUAL_UINT8(ctrl::snapshot::kFlagAsleep, idle.flags);
+
+  // Even hex-encoded, well under half the text STATUS it replaces.
+  std::size_t snapBytes = 0;
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    snapBytes += GetLine(response, i).size() + 2;
+  }
+  processor.processLine("STATUS", response);
+  std::size_t statusBytes = 0;
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    statusBytes += GetLine(response, i).size() + 2;
+  }
+  TEST_ASSERT_LESS_THAN_UINT32(statusBytes / 2, snapBytes);
+
+  frame[20] ^= 0x01;
+  TEST_ASSERT_EQUAL(ctrl::snapshot::DecodeStatus::BadChecksum, ctrl::snapshot::DecodeFrame(frame, sizeof(frame), header));
+}
+
 int main()
 {
   UNITY_BEGIN();
@@ -142,5 +256,9 @@ int main()
   RUN_TEST(test_move_applies_speed_and_accel_overrides);
   RUN_TEST(test_sleep_wake_toggle_persists_state);
   RUN_TEST(test_status_reports_structured_channel_data);
+  RUN_TEST(test_aim_queues_both_mirror_axes);
+  RUN_TEST(test_aim_leaves_yaw_alone_when_pitch_refuses);
+  RUN_TEST(test_boot_reports_phase_timestamps);
+  RUN_TEST(test_snapshot_frame_decodes_every_channel);
   return UNITY_END();
 }
@@ -0,0 +1,132 @@
+#include <string_view>
+
+#include <unity.h>
+
+#include "cue/CueCompiler.hpp"
+
+namespace
+{
+
+cue::CompiledShow Compile(std::string_view timeline, const cue::CompileOptions &options = cue::CompileOptions{})
+{
+  std::vector<cue::Cue> cues;
+  std::vector<cue::Diagnostic> diagnostics;
+  TEST_ASSERT_TRUE(cue::ParseTimeline(timeline, cues, diagnostics));
+  return cue::CueCompiler(options).compile(std::move(cues));
+}
+
+bool HasDiagnostic(const cue::CompiledShow &show, cue::DiagnosticCode code)
+{
+  for (const auto &diagnostic : show.diagnostics)
+  {
+    if (diagnostic.code == code)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_parse_reports_line_numbers()
+{
+  std::vector<cue::Cue> cues;
+  std::vector<cue::Diagnostic> diagnostics;
+  TEST_ASSERT_FALSE(cue::ParseTimeline("# intro\nat 0 move 1 100\nat x move 1 5\nat 10 aim 0 1 2 3 4\n", cues, diagnostics));
+  TEST_ASSERT_EQUAL_UINT32(1, cues.size());
+  TEST_ASSERT_EQUAL_UINT32(2, diagnostics.size());
+  TEST_ASSERT_EQUAL_UINT32(3, diagnostics[0].line);
+  TEST_ASSERT_EQUAL_UINT32(4, diagnostics[1].line);
+}
+
+void test_group_moves_finish_together()
+{
+  cue::CompiledShow show = Compile("at 0 move 0 1000\nat 0 move 1 100\nat 0 angle 1 -5.5 2.25\n");
+  TEST_ASSERT_TRUE(show.ok());
+  const auto longest = motion::MotorManager::ComputeTiming(1000, motion::MotorManager::kDefaultSpeedHz,
+                                                           motion::MotorManager::kDefaultAcceleration);
+  for (std::size_t channel : {0U, 1U, 2U, 3U})
+  {
+    TEST_ASSERT_EQUAL_UINT32(1, show.channels[channel].size());
+    const cue::ChannelStep &step = show.channels[channel][0];
+    TEST_ASSERT_TRUE(step.durationUs <= longest.totalDurationUs);
+    // Speeds are whole Hz, so slow axes land within 1% of the longest move.
+    TEST_ASSERT_TRUE(step.durationUs + (longest.totalDurationUs / 100U) >= longest.totalDurationUs);
+  }
+  TEST_ASSERT_TRUE(show.channels[1][0].speedHz < motion::MotorManager::kDefaultSpeedHz);
+  TEST_ASSERT_EQUAL_INT32(-98, show.channels[2][0].target); // -5.5 deg at 6400 steps/turn
+  TEST_ASSERT_EQUAL_INT32(40, show.channels[3][0].target);
+}
+
+void test_validation_catches_unreachable_and_over_budget_cues()
+{
+  cue::CompileOptions options{};
+  options.maxMovingChannels = 1;
+  options.maxCueDurationMs = 200;
+  cue::CompiledShow show = Compile("at 0 move 0 5000\n"
+                                   "at 0 move 1 1100\n"
+                                   "at 10 move 1 0\n"
+                                   "at 20 move 2 10\n"
+                                   "at 30 aim 9 0 0 1000\n",
+                                   options);
+  TEST_ASSERT_FALSE(show.ok());
+  TEST_ASSERT_TRUE(HasDiagnostic(show, cue::DiagnosticCode::Unreachable));
+  TEST_ASSERT_TRUE(HasDiagnostic(show, cue::DiagnosticCode::DurationExceeded));
+  TEST_ASSERT_TRUE(HasDiagnostic(show, cue::DiagnosticCode::ChannelBusy));
+  TEST_ASSERT_TRUE(HasDiagnostic(show, cue::DiagnosticCode::OverPowerBudget));
+  TEST_ASSERT_TRUE(HasDiagnostic(show, cue::DiagnosticCode::InvalidIndex));
+}
+
+void test_program_round_trips_and_stays_compact()
+{
+  std::string timeline;
+  for (int i = 0; i < 200; ++i)
+  {
+    timeline += "at " + std::to_string(i * 500) + " aim " + std::to_string(i % 4) + " " + std::to_string((i * 37) % 2000 - 1000) +
+                " " + std::to_string((i * 11) % 800 - 400) + " 2500\n";
+  }
+  cue::CompiledShow show = Compile(timeline);
+  TEST_ASSERT_TRUE(show.ok());
+
+  const std::vector<uint8_t> program = cue::EncodeProgram(show);
+  TEST_ASSERT_TRUE(program.size() < show.moveCount() * 6U);
+
+  cue::CompiledShow decoded{};
+  TEST_ASSERT_TRUE(cue::DecodeProgram(program.data(), program.size(), decoded));
+  TEST_ASSERT_EQUAL_UINT32(show.moveCount(), decoded.moveCount());
+  TEST_ASSERT_EQUAL_UINT32(show.endMs, decoded.endMs);
+  for (std::size_t channel = 0; channel < show.channels.size(); ++channel)
+  {
+    for (std::size_t i = 0; i < show.channels[channel].size(); ++i)
+    {
+      TEST_ASSERT_EQUAL_UINT32(show.channels[channel][i].startMs, decoded.channels[channel][i].startMs);
+      TEST_ASSERT_EQUAL_INT32(show.channels[channel][i].target, decoded.channels[channel][i].target);
+      TEST_ASSERT_EQUAL_INT32(show.channels[channel][i].speedHz, decoded.channels[channel][i].speedHz);
+      TEST_ASSERT_EQUAL_UINT32(show.channels[channel][i].durationUs, decoded.channels[channel][i].durationUs);
+    }
+  }
+
+  TEST_ASSERT_FALSE(cue::DecodeProgram(program.data(), program.size() - 1, decoded));
+}
+
+void test_move_script_is_time_ordered()
+{
+  cue::CompiledShow show = Compile("at 50 move 3 -20\nat 0 move 5 30\n");
+  TEST_ASSERT_EQUAL_STRING("0 MOVE:5,30,4000,16000\n50 MOVE:3,-20,4000,16000\n", cue::FormatMoveScript(show).c_str());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_reports_line_numbers);
+  RUN_TEST(test_group_moves_finish_together);
+  RUN_TEST(test_validation_catches_unreachable_and_over_budget_cues);
+  RUN_TEST(test_program_round_trips_and_stays_compact);
+  RUN_TEST(test_move_script_is_time_ordered);
+  return UNITY_END();
+}
@@ -0,0 +1,222 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unity.h>
+
+#include "control/CommandProcessor.hpp"
+#include "host/DeckClient.hpp"
+#include "host/PtyDeck.hpp"
+
+namespace
+{
+
+// A deck on a pty, served from a background thread.
+class NativeDeck
+{
+public:
+  explicit NativeDeck(double clockScale = 1.0) : deck_(Options(clockScale))
+  {
+    TEST_ASSERT_TRUE(deck_.open());
+    deck_.start();
+  }
+
+  const std::string &path() const { return deck_.path(); }
+
+private:
+  static host::PtyDeckOptions Options(double clockScale)
+  {
+    host::PtyDeckOptions options{};
+    options.clockScale = clockScale;
+    return options;
+  }
+
+  host::PtyDeck deck_;
+};
+
+double MeasureCommandsPerSecond(const std::string &path, std::size_t window, std::size_t count)
+{
+  host::DeckClient::Options options{};
+  options.window = window;
+  host::DeckClient client(options);
+  TEST_ASSERT_TRUE(client.open(path));
+  std::size_t ok = 0;
+  const auto started = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    client.submit("STATUS:0", [&ok](const host::Reply &reply) { ok += reply.ok() && reply.lines.size() == 2; });
+  }
+  TEST_ASSERT_TRUE(client.drain(20'000));
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  TEST_ASSERT_EQUAL_UINT32(count, ok);
+  return static_cast<double>(count) / seconds;
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_protocol_lines_parse_into_structs()
+{
+  const host::TaggedLine tagged = host::SplitTag("#42 EVT:FAULT CH=3 POS=-17 ERR=ERR_DRIVER_FAULT");
+  TEST_ASSERT_TRUE(tagged.tagged);
+  TEST_ASSERT_EQUAL_UINT16(42, tagged.sequence);
+  host::Event event{};
+  TEST_ASSERT_TRUE(host::ParseEvent(tagged.body, event));
+  TEST_ASSERT_EQUAL(host::EventKind::Fault, event.kind);
+  TEST_ASSERT_EQUAL_UINT32(3, event.channel);
+  TEST_ASSERT_EQUAL_INT32(-17, event.position);
+  TEST_ASSERT_EQUAL_STRING("ERR_DRIVER_FAULT", event.error.c_str());
+  TEST_ASSERT_TRUE(host::ParseEvent("EVT:OVERFLOW DROPPED=5", event));
+  TEST_ASSERT_EQUAL_UINT32(5, event.dropped);
+  TEST_ASSERT_FALSE(host::ParseEvent("EVT:MASK=0xff", event));
+  TEST_ASSERT_FALSE(host::SplitTag("#x CTRL:OK").tagged);
+
+  host::ChannelStatus status{};
+  TEST_ASSERT_TRUE(host::ParseStatus("STATUS:CH=2 POS=120 TARGET=400 STATE=MOVING SLEEP=0 ERR=OK", status));
+  TEST_ASSERT_EQUAL_UINT32(2, status.channel);
+  TEST_ASSERT_EQUAL_INT32(120, status.position);
+  TEST_ASSERT_EQUAL_INT32(400, status.target);
+  TEST_ASSERT_EQUAL_STRING("MOVING", status.state.c_str());
+  TEST_ASSERT_FALSE(status.asleep);
+  TEST_ASSERT_FALSE(host::ParseStatus("STATUS:PROFILE CH=2 SPEED=1 ACC=1 PLAN_US=1", status));
+}
+
+void test_pipelined_replies_match_their_commands()
+{
+  NativeDeck deck;
+  host::DeckClient client;
+  TEST_ASSERT_TRUE(client.open(deck.path()));
+  std::vector<std::string> unsolicited;
+  client.setLineHandler([&](std::string_view line) { unsolicited.emplace_back(line); });
+
+  std::vector<host::Reply> replies;
+  const auto keep = [&](const host::Reply &reply) { replies.push_back(reply); };
+  for (int channel = 0; channel < 4; ++channel)
+  {
+    client.submit("MOVE:" + std::to_string(channel) + ",100", keep);
+    client.submit("STATUS:" + std::to_string(channel), keep);
+  }
+  client.submit("MOVE:9,0", keep);
+  client.submit("BOGUS", keep);
+  TEST_ASSERT_EQUAL_UINT32(10, client.pending());
+  TEST_ASSERT_TRUE(client.drain(2000));
+
+  TEST_ASSERT_EQUAL_UINT32(10, replies.size());
+  for (std::size_t i = 0; i < 8; i += 2)
+  {
+    TEST_ASSERT_EQUAL_UINT16(replies[0].sequence + i, replies[i].sequence);
+    TEST_ASSERT_TRUE(replies[i].ok());
+    host::ChannelStatus status{};
+    TEST_ASSERT_TRUE(host::ParseStatus(replies[i + 1].lines[0], status));
+    TEST_ASSERT_EQUAL_UINT32(i / 2, status.channel);
+    TEST_ASSERT_EQUAL_INT32(100, status.target);
+  }
+  TEST_ASSERT_EQUAL_STRING("ERR_INVALID_CHANNEL", replies[8].code.c_str());
+  TEST_ASSERT_EQUAL_STRING("ERR_UNKNOWN_VERB", replies[9].code.c_str());
+  TEST_ASSERT_EQUAL_STRING("BOGUS", replies[9].command.c_str());
+  TEST_ASSERT_EQUAL_UINT32(2, unsolicited.size());
+  TEST_ASSERT_EQUAL_STRING("BOOT:HOMING_REQUIRED", unsolicited[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("CTRL:READY", unsolicited[1].c_str());
+
+  // Too long once tagged: refused locally instead of an untagged error.
+  host::Reply refused = client.call(std::string(ctrl::CommandProcessor::kMaxCommandLength, 'A'), 100);
+  TEST_ASSERT_EQUAL_STRING("ERR_PAYLOAD_TOO_LONG", refused.code.c_str());
+}
+
+void test_events_carry_the_tag_of_their_command()
+{
+  NativeDeck deck;
+  host::DeckClient client;
+  TEST_ASSERT_TRUE(client.open(deck.path()));
+  std::vector<host::Event> events;
+  client.setEventHandler([&](const host::Event &event) { events.push_back(event); });
+
+  TEST_ASSERT_TRUE(client.call("EVT:*,1", 1000).ok());
+  const uint16_t move = client.submit("MOVE:1,40,4000,1000000");
+  TEST_ASSERT_TRUE(client.drain(1000));
+  for (int i = 0; i < 100 && events.empty(); ++i)
+  {
+    client.poll(10);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, events.size());
+  TEST_ASSERT_EQUAL(host::EventKind::Done, events[0].kind);
+  TEST_ASSERT_TRUE(events[0].tagged);
+  TEST_ASSERT_EQUAL_UINT16(move, events[0].sequence);
+  TEST_ASSERT_EQUAL_INT32(40, events[0].position);
+}
+
+void test_group_fans_out_to_every_deck()
+{
+  NativeDeck first;
+  NativeDeck second;
+  host::DeckClient a;
+  host::DeckClient b;
+  TEST_ASSERT_TRUE(a.open(first.path()));
+  TEST_ASSERT_TRUE(b.open(second.path()));
+  host::DeckGroup group;
+  group.add(a);
+  group.add(b);
+
+  std::vector<std::size_t> answered(2, 0);
+  group.broadcast("MOVE:0,25", [&](std::size_t index, const host::Reply &reply) { answered[index] += reply.ok(); });
+  group.broadcast("STATUS", [&](std::size_t index, const host::Reply &reply)
+                  { answered[index] += reply.ok() && reply.lines.size() == 2 * ctrl::CommandProcessor::kMotorCount; });
+  TEST_ASSERT_EQUAL_UINT32(4, group.pending());
+  TEST_ASSERT_TRUE(group.drain(2000));
+  TEST_ASSERT_EQUAL_UINT32(2, answered[0]);
+  TEST_ASSERT_EQUAL_UINT32(2, answered[1]);
+}
+
+void test_accelerated_clock_finishes_moves_sooner()
+{
+  // 2000 steps at 1 kHz: over two seconds of deck time.
+  NativeDeck deck(20.0);
+  host::DeckClient client;
+  TEST_ASSERT_TRUE(client.open(deck.path()));
+  bool done = false;
+  client.setEventHandler([&](const host::Event &event) { done = done || event.kind == host::EventKind::Done; });
+  TEST_ASSERT_TRUE(client.call("EVT:0,1", 1000).ok());
+  TEST_ASSERT_TRUE(client.call("CAL:0,0,-5000,5000", 1000).ok());
+  const auto started = std::chrono::steady_clock::now();
+  TEST_ASSERT_TRUE(client.call("MOVE:0,2000,1000,1000000", 1000).ok());
+  while (!done && std::chrono::steady_clock::now() - started < std::chrono::seconds(2))
+  {
+    client.poll(10);
+  }
+  const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  TEST_ASSERT_TRUE(done);
+  TEST_ASSERT_TRUE(wallSeconds < 0.5);
+  host::ChannelStatus status{};
+  const host::Reply reply = client.call("STATUS:0", 1000);
+  TEST_ASSERT_TRUE(host::ParseStatus(reply.lines[0], status));
+  TEST_ASSERT_EQUAL_INT32(2000, status.position);
+  TEST_ASSERT_EQUAL_STRING("IDLE", status.state.c_str());
+}
+
+void test_pipelining_outruns_lockstep()
+{
+  NativeDeck deck;
+  const double lockstep = MeasureCommandsPerSecond(deck.path(), 1, 200);
+  const double pipelined = MeasureCommandsPerSecond(deck.path(), 16, 2000);
+  char line[96];
+  std::snprintf(line, sizeof(line), "STATUS:0 over a pty: lockstep %.0f commands/s, window 16 %.0f commands/s",
+                lockstep, pipelined);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(pipelined > 2.0 * lockstep);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_protocol_lines_parse_into_structs);
+  RUN_TEST(test_pipelined_replies_match_their_commands);
+  RUN_TEST(test_events_carry_the_tag_of_their_command);
+  RUN_TEST(test_group_fans_out_to_every_deck);
+  RUN_TEST(test_accelerated_clock_finishes_moves_sooner);
+  RUN_TEST(test_pipelining_outruns_lockstep);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <unity.h>
+
+#include "geometry/Targeting.hpp"
+
+namespace
+{
+
+constexpr double kTwoPi = 6.283185307179586;
+
+struct ReferenceSteps
+{
+  int32_t yaw = 0;
+  int32_t pitch = 0;
+};
+
+// Double-precision model of SolveMirror, used as the accuracy oracle.
+ReferenceSteps Reference(const geometry::MirrorPose &pose, const geometry::WallTarget &target)
+{
+  const double ox = target.xMm - pose.xMm;
+  const double oy = target.yMm - pose.yMm;
+  const double oz = target.distanceMm;
+  const double length = std::sqrt((ox * ox) + (oy * oy) + (oz * oz));
+  const double nx = (ox / length) - (pose.incoming.x / 16384.0);
+  const double ny = (oy / length) - (pose.incoming.y / 16384.0);
+  const double nz = (oz / length) - (pose.incoming.z / 16384.0);
+  const double yaw = std::atan2(nx, nz);
+  const double pitch = std::atan2(ny, std::sqrt((nx * nx) + (nz * nz)));
+
+  ReferenceSteps steps{};
+  steps.yaw = pose.yawZeroSteps + static_cast<int32_t>(std::lround(yaw / kTwoPi * pose.stepsPerTurn));
+  steps.pitch = pose.pitchZeroSteps + static_cast<int32_t>(std::lround(pitch / kTwoPi * pose.stepsPerTurn));
+  return steps;
+}
+
+const geometry::StepLimits kWideLimits{-100000, 100000};
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_atan2_matches_libm()
+{
+  const int32_t samples[][2] = {{0, 1000}, {1000, 0}, {-1000, 0}, {1, -1}, {-3, -4}, {16384, 16384}, {5, 29999}, {-29999, 7}};
+  for (const auto &sample : samples)
+  {
+    const double expected = std::atan2(sample[0], sample[1]) / kTwoPi * 4294967296.0;
+    const double actual = static_cast<double>(geometry::Atan2(sample[0], sample[1]));
+    double error = std::fabs(expected - actual);
+    if (error > 2147483648.0)
+    {
+      error = 4294967296.0 - error; // +/- half turn are the same angle
+    }
+    TEST_ASSERT_TRUE_MESSAGE(error < 4096.0, "CORDIC atan2 drifted more than 1e-6 turn");
+  }
+}
+
+void test_isqrt_floors()
+{
+  TEST_ASSERT_EQUAL_UINT32(0, geometry::ISqrt(0));
+  TEST_ASSERT_EQUAL_UINT32(3, geometry::ISqrt(15));
+  TEST_ASSERT_EQUAL_UINT32(4, geometry::ISqrt(16));
+  TEST_ASSERT_EQUAL_UINT32(65535, geometry::ISqrt(0xFFFFFFFFU));
+}
+
+void test_straight_ahead_target_needs_no_rotation()
+{
+  geometry::MirrorPose pose{};
+  pose.yawZeroSteps = 12;
+  pose.pitchZeroSteps = -7;
+  geometry::WallTarget target{0, 0, 2500};
+  auto axes = geometry::SolveMirror(pose, target, kWideLimits);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::Reachable, axes.status);
+  TEST_ASSERT_EQUAL_INT32(12, axes.yawSteps);
+  TEST_ASSERT_EQUAL_INT32(-7, axes.pitchSteps);
+}
+
+void test_solver_tracks_double_reference_within_one_step()
+{
+  geometry::MirrorPose pose = geometry::DefaultMirrorPose(3);
+  pose.incoming = {0, 2896, -16126}; // light arriving from ~10 degrees above
+  int32_t worst = 0;
+  for (int32_t distance = 300; distance <= 9000; distance += 1450)
+  {
+    for (int32_t x = -6000; x <= 6000; x += 750)
+    {
+      for (int32_t y = -4000; y <= 4000; y += 500)
+      {
+        geometry::WallTarget target{x, y, distance};
+        auto axes = geometry::SolveMirror(pose, target, kWideLimits);
+        TEST_ASSERT_EQUAL(geometry::TargetStatus::Reachable, axes.status);
+        ReferenceSteps expected = Reference(pose, target);
+        worst = std::max(worst, std::abs(axes.yawSteps - expected.yaw));
+        worst = std::max(worst, std::abs(axes.pitchSteps - expected.pitch));
+      }
+    }
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(1, worst);
+}
+
+void test_limits_flag_unreachable_axis()
+{
+  geometry::MirrorPose pose{};
+  geometry::StepLimits narrow{-100, 100};
+
+  auto axes = geometry::SolveMirror(pose, geometry::WallTarget{3000, 0, 1000}, narrow);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::YawOutOfRange, axes.status);
+  TEST_ASSERT_GREATER_THAN_INT32(100, axes.yawSteps);
+
+  axes = geometry::SolveMirror(pose, geometry::WallTarget{0, -3000, 1000}, narrow);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::PitchOutOfRange, axes.status);
+  TEST_ASSERT_LESS_THAN_INT32(-100, axes.pitchSteps);
+}
+
+void test_invalid_targets_are_rejected()
+{
+  geometry::MirrorPose pose{};
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::InvalidTarget,
+                    geometry::SolveMirror(pose, geometry::WallTarget{0, 0, 0}, kWideLimits).status);
+  TEST_ASSERT_EQUAL(geometry::TargetStatus::InvalidTarget,
+                    geometry::SolveMirror(pose, geometry::WallTarget{40000, 0, 1000}, kWideLimits).status);
+}
+
+void test_default_poses_pair_channels()
+{
+  geometry::MirrorPose pose = geometry::DefaultMirrorPose(2);
+  TEST_ASSERT_EQUAL_UINT8(4, pose.yawChannel);
+  TEST_ASSERT_EQUAL_UINT8(5, pose.pitchChannel);
+  TEST_ASSERT_EQUAL_INT32(0, pose.xMm);
+  TEST_ASSERT_LESS_THAN_INT32(0, pose.yMm);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_atan2_matches_libm);
+  RUN_TEST(test_isqrt_floors);
+  RUN_TEST(test_straight_ahead_target_needs_no_rotation);
+  RUN_TEST(test_solver_tracks_double_reference_within_one_step);
+  RUN_TEST(test_limits_flag_unreachable_axis);
+  RUN_TEST(test_invalid_targets_are_rejected);
+  RUN_TEST(test_default_poses_pair_channels);
+  return UNITY_END();
+}
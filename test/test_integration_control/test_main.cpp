@@ -4,7 +4,9 @@
 #include <unity.h>
 
 #include "control/CommandProcessor.hpp"
+#include "diag/TraceRing.hpp"
 #include "motion/MotorManager.hpp"
+#include "motion/StepperPioProgram.hpp"
 
 namespace
 {
@@ -188,6 +190,370 @@ void test_move_beyond_limits_reports_clipping()
   TEST_ASSERT_EQUAL(ctrl::CommandProcessor::ResponseCode::LimitViolation, processor.lastResponse(4));
 }
 
+void test_home_all_channels_in_parallel()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("HOME:1", response);
+  uint32_t singleUs = 0;
+  while (processor.motorState(1).phase == motion::MotionPhase::Homing)
+  {
+    processor.service(5000);
+    singleUs += 5000;
+  }
+
+  ProcessLine("HOME:*", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), "HOME:MASK=0xff"));
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), "CONCURRENCY=8"));
+
+  uint32_t arrayUs = 0;
+  bool homing = true;
+  while (homing && arrayUs < 60000000U)
+  {
+    processor.service(5000);
+    arrayUs += 5000;
+    homing = false;
+    for (std::size_t channel = 0; channel < ctrl::CommandProcessor::kMotorCount; ++channel)
+    {
+      homing |= processor.motorState(channel).phase == motion::MotionPhase::Homing;
+    }
+  }
+  // The whole array takes as long as one channel, not eight in sequence.
+  TEST_ASSERT_TRUE(arrayUs <= singleUs + 5000U);
+
+  ProcessLine("HOME:0x1ff", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_CHANNEL", GetLine(response, 0).data());
+  ProcessLine("HOME:2,,,3", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_ARGUMENT", GetLine(response, 0).data());
+}
+
+std::size_t ResponseBytes(const ctrl::CommandProcessor::Response &response)
+{
+  std::size_t bytes = 0;
+  for (std::size_t index = 0; index < response.count; ++index)
+  {
+    bytes += GetLine(response, index).size() + 2; // CRLF on the wire
+  }
+  return bytes;
+}
+
+void test_subscription_pushes_only_changed_fields()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("SUB:50", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("SUB:INTERVAL_MS=50", GetLine(response, 1).data());
+
+  // First push is a full snapshot of every channel.
+  TEST_ASSERT_TRUE(processor.collectUpdates(response));
+  TEST_ASSERT_EQUAL_UINT32(ctrl::CommandProcessor::kMotorCount, response.count);
+  TEST_ASSERT_EQUAL_STRING("DELTA:CH=0 POS=0 TARGET=0 STATE=IDLE SLEEP=1 ERR=OK", GetLine(response, 0).data());
+  TEST_ASSERT_FALSE(processor.collectUpdates(response));
+
+  ProcessLine("MOVE:2,400", response);
+  processor.service(10'000);
+  TEST_ASSERT_FALSE(processor.collectUpdates(response)); // rate limited
+  processor.service(40'000);
+  TEST_ASSERT_TRUE(processor.collectUpdates(response));
+  TEST_ASSERT_EQUAL_UINT32(1, response.count);
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 0), "DELTA:CH=2 POS="));
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 0), "TARGET=400 STATE=MOVING SLEEP=0"));
+  TEST_ASSERT_FALSE(Contains(GetLine(response, 0), "ERR="));
+
+  // Run to completion: the last push reports arrival and sleep.
+  for (int tick = 0; tick < 100; ++tick)
+  {
+    processor.service(10'000);
+    if (processor.collectUpdates(response) && Contains(GetLine(response, 0), "STATE=IDLE"))
+    {
+      break;
+    }
+  }
+  TEST_ASSERT_EQUAL_STRING("DELTA:CH=2 POS=400 STATE=IDLE SLEEP=1", GetLine(response, 0).data());
+
+  ProcessLine("SUB:0", response);
+  TEST_ASSERT_EQUAL_STRING("SUB:INTERVAL_MS=0", GetLine(response, 1).data());
+  ProcessLine("MOVE:3,100", response);
+  processor.service(100'000);
+  TEST_ASSERT_FALSE(processor.collectUpdates(response));
+
+  ProcessLine("SUB:5", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_ARGUMENT", GetLine(response, 0).data());
+}
+
+void test_subscription_cuts_link_traffic_tenfold()
+{
+  ctrl::CommandProcessor::Response response{};
+  std::size_t polledBytes = 0;
+  std::size_t pushedBytes = 0;
+
+  // One channel sweeping for two seconds, dashboard refreshing at 20 Hz.
+  ProcessLine("MOVE:1,1200", response);
+  for (int tick = 0; tick < 200; ++tick)
+  {
+    processor.service(10'000);
+    if (tick % 5 == 0)
+    {
+      ProcessLine("STATUS", response);
+      polledBytes += ResponseBytes(response);
+    }
+  }
+
+  processor.reset();
+  ProcessLine("SUB:50", response);
+  pushedBytes += ResponseBytes(response);
+  ProcessLine("MOVE:1,1200", response);
+  pushedBytes += ResponseBytes(response);
+  for (int tick = 0; tick < 200; ++tick)
+  {
+    processor.service(10'000);
+    if (processor.collectUpdates(response))
+    {
+      pushedBytes += ResponseBytes(response);
+    }
+  }
+
+  TEST_ASSERT_GREATER_THAN_UINT32(0, pushedBytes);
+  TEST_ASSERT_LESS_OR_EQUAL(polledBytes / 10, pushedBytes);
+}
+
+void test_events_report_transitions_without_polling()
+{
+  ctrl::CommandProcessor::Response response{};
+  TEST_ASSERT_FALSE(processor.collectEvents(response));
+  ProcessLine("EVT:2,1", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("EVT:MASK=0x4", GetLine(response, 1).data());
+
+  // Only the enabled channel reports, once, when it arrives.
+  ProcessLine("MOVE:2,400", response);
+  ProcessLine("MOVE:3,100", response);
+  processor.service(10'000);
+  TEST_ASSERT_FALSE(processor.collectEvents(response));
+  processor.service(2'000'000);
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_UINT32(1, response.count);
+  TEST_ASSERT_EQUAL_STRING("EVT:DONE CH=2 POS=400", GetLine(response, 0).data());
+  TEST_ASSERT_FALSE(processor.collectEvents(response));
+
+  // Homing stages complete one per service() pass; only the last reports.
+  ProcessLine("HOME:2", response);
+  for (int stage = 0; stage < 4; ++stage)
+  {
+    TEST_ASSERT_FALSE(processor.collectEvents(response));
+    processor.service(5'000'000);
+  }
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_UINT32(1, response.count);
+  TEST_ASSERT_EQUAL_STRING("EVT:HOMED CH=2 POS=0", GetLine(response, 0).data());
+
+  processor.motorManager().injectFault(2, motion::FaultCode::DriverFault);
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_STRING("EVT:FAULT CH=2 POS=0 ERR=ERR_DRIVER_FAULT", GetLine(response, 0).data());
+
+  ProcessLine("EVT:2,0", response);
+  TEST_ASSERT_EQUAL_STRING("EVT:MASK=0x0", GetLine(response, 1).data());
+  ProcessLine("EVT:9,1", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_CHANNEL", GetLine(response, 0).data());
+  ProcessLine("EVT:1,2", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_ARGUMENT", GetLine(response, 0).data());
+}
+
+void test_event_queue_overflow_is_signalled()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("EVT:*,1", response);
+  TEST_ASSERT_EQUAL_STRING("EVT:MASK=0xff", GetLine(response, 1).data());
+
+  // A MOVE to where the channel already is completes on the spot.
+  const std::size_t capacity = motion::MotorManager::kEventQueueCapacity;
+  for (std::size_t i = 0; i < capacity + 3U; ++i)
+  {
+    ProcessLine("MOVE:0,0", response);
+  }
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_UINT32(capacity + 1U, response.count);
+  TEST_ASSERT_EQUAL_STRING("EVT:DONE CH=0 POS=0", GetLine(response, capacity - 1U).data());
+  TEST_ASSERT_EQUAL_STRING("EVT:OVERFLOW DROPPED=3", GetLine(response, capacity).data());
+  TEST_ASSERT_FALSE(processor.collectEvents(response));
+}
+
+void test_sequence_tags_follow_commands_into_events()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("#7 EVT:*,1", response);
+  TEST_ASSERT_EQUAL_UINT32(2, response.count);
+  TEST_ASSERT_EQUAL_STRING("#7 CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("#7 EVT:MASK=0xff", GetLine(response, 1).data());
+
+  // Tagged and untagged moves in flight together; each DONE carries its own.
+  ProcessLine("#12 MOVE:1,300", response);
+  TEST_ASSERT_EQUAL_STRING("#12 CTRL:OK", GetLine(response, 0).data());
+  ProcessLine("MOVE:2,100", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  processor.service(2'000'000);
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_UINT32(2, response.count);
+  const std::string_view first = GetLine(response, 0);
+  const std::string_view second = GetLine(response, 1);
+  TEST_ASSERT_TRUE((first == "#12 EVT:DONE CH=1 POS=300" && second == "EVT:DONE CH=2 POS=100") ||
+                   (first == "EVT:DONE CH=2 POS=100" && second == "#12 EVT:DONE CH=1 POS=300"));
+
+  ProcessLine("#65535 HOME:2", response);
+  TEST_ASSERT_EQUAL_STRING("#65535 CTRL:OK", GetLine(response, 0).data());
+  for (int stage = 0; stage < 4; ++stage)
+  {
+    processor.service(5'000'000);
+  }
+  TEST_ASSERT_TRUE(processor.collectEvents(response));
+  TEST_ASSERT_EQUAL_STRING("#65535 EVT:HOMED CH=2 POS=0", GetLine(response, 0).data());
+
+  // Multi-line responses are tagged on every line.
+  ProcessLine("#3 STATUS:1", response);
+  TEST_ASSERT_GREATER_THAN_UINT32(1, response.count);
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    TEST_ASSERT_TRUE(GetLine(response, i).substr(0, 3) == "#3 ");
+  }
+
+  ProcessLine("#4", response);
+  TEST_ASSERT_EQUAL_STRING("#4 CTRL:ERR_EMPTY", GetLine(response, 0).data());
+  ProcessLine("#5 BOGUS", response);
+  TEST_ASSERT_EQUAL_STRING("#5 CTRL:ERR_UNKNOWN_VERB", GetLine(response, 0).data());
+  ProcessLine("#65536 STATUS", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_PARSE", GetLine(response, 0).data());
+  ProcessLine("#12STATUS", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_PARSE", GetLine(response, 0).data());
+  ProcessLine("# STATUS", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_PARSE", GetLine(response, 0).data());
+}
+
+void test_trace_ring_records_the_hot_path()
+{
+  processor.configureShiftRegister(motion::ShiftRegisterPins{2, 3, 4});
+  diag::ResetTrace();
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("#7 MOVE:0,50", response);
+  TEST_ASSERT_EQUAL_STRING("#7 CTRL:OK", GetLine(response, 0).data());
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(processor.motorManager().takePendingCommand(0, command));
+  processor.service(1'000'000);
+  TEST_ASSERT_EQUAL(ctrl::CommandProcessor::MotionState::Idle, processor.motorState(0).phase);
+
+  const diag::TraceKind expected[] = {diag::TraceKind::CommandAccepted, diag::TraceKind::PhaseChange,
+                                      diag::TraceKind::SleepLatch,      diag::TraceKind::SlotLatched,
+                                      diag::TraceKind::PhaseChange,     diag::TraceKind::SleepLatch};
+  TEST_ASSERT_EQUAL_UINT32(6, diag::TraceHead());
+  diag::TraceRecord records[6];
+  for (uint32_t sequence = 0; sequence < 6; ++sequence)
+  {
+    TEST_ASSERT_TRUE(diag::ReadTrace(sequence, records[sequence]));
+    TEST_ASSERT_EQUAL(expected[sequence], records[sequence].kind);
+  }
+  TEST_ASSERT_EQUAL_STRING("MOVE", ctrl::CommandProcessor::verbName(records[0].channel & ~diag::kTraceTagged));
+  TEST_ASSERT_TRUE((records[0].channel & diag::kTraceTagged) != 0);
+  TEST_ASSERT_EQUAL_UINT16(7, records[0].value);
+  TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(motion::MotionPhase::Moving), records[1].value);
+  TEST_ASSERT_EQUAL_UINT16(0x0001, records[2].value);
+  TEST_ASSERT_EQUAL_UINT16(50, records[3].value);
+  TEST_ASSERT_EQUAL_UINT16(0x100, records[4].value);
+  TEST_ASSERT_EQUAL_UINT16(0x0000, records[5].value);
+  TEST_ASSERT_FALSE(diag::ReadTrace(6, records[0]));
+
+  // The dump's own command is the seventh record; five per data line.
+  ProcessLine("TRACE:DUMP", response);
+  TEST_ASSERT_EQUAL_UINT32(4, response.count);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(GetLine(response, 1).substr(0, 48) == "TRACE:DUMP FROM=0 COUNT=7 NEXT=7 HEAD=7 LOST=0 N");
+  TEST_ASSERT_EQUAL_UINT32(11 + 80, GetLine(response, 2).size());
+  TEST_ASSERT_EQUAL_UINT32(11 + 32, GetLine(response, 3).size());
+
+  // Off: nothing after the TRACE:OFF itself is recorded.
+  ProcessLine("TRACE:OFF", response);
+  ProcessLine("MOVE:0,0", response);
+  TEST_ASSERT_EQUAL_UINT32(8, diag::TraceHead());
+  ProcessLine("TRACE", response);
+  TEST_ASSERT_TRUE(GetLine(response, 1).substr(0, 34) == "TRACE:STATE=OFF HEAD=8 HELD=8 NOW=");
+  ProcessLine("TRACE:ON", response);
+
+  // A lapped reader loses the oldest records and is told how many.
+  for (std::size_t i = 0; i < diag::kTraceCapacity; ++i)
+  {
+    ProcessLine("STATUS:0", response);
+  }
+  ProcessLine("TRACE:DUMP,2", response);
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), " FROM=9 COUNT=80 NEXT=89 HEAD=137 LOST=7 "));
+  ProcessLine("TRACE:DUMP,140", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_ARGUMENT", GetLine(response, 0).data());
+  processor.configureShiftRegister(motion::ShiftRegisterPins{});
+}
+
+void test_cache_verb_reports_profile_reuse()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("MOVE:0,300", response);
+  processor.service(processor.motorState(0).plannedDurationUs + 50);
+  ProcessLine("MOVE:0,0", response);
+  processor.service(processor.motorState(0).plannedDurationUs + 50);
+
+  ProcessLine("CACHE", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("CACHE:ENTRIES=1/8 HITS=1 MISSES=1 EVICTIONS=0", GetLine(response, 1).data());
+
+  ProcessLine("CACHE:CLEAR", response);
+  TEST_ASSERT_EQUAL_STRING("CACHE:ENTRIES=0/8 HITS=0 MISSES=0 EVICTIONS=0", GetLine(response, 1).data());
+
+  ProcessLine("CACHE:FLUSH", response);
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 0), "ERR_INVALID_ARGUMENT"));
+}
+
+void test_channel_selectors_address_many_channels_at_once()
+{
+  ctrl::CommandProcessor::Response response{};
+  ProcessLine("WAKE:0-7", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("WAKE:MASK=0xff STATE=AWAKE", GetLine(response, 1).data());
+  TEST_ASSERT_EQUAL_UINT32(2, response.count);
+
+  ProcessLine("SLEEP:1,3 , 4", response);
+  TEST_ASSERT_EQUAL_STRING("SLEEP:MASK=0x1a STATE=SLEEP", GetLine(response, 1).data());
+
+  ProcessLine("MOVE:0-2+6,1500", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), "MOVE:MASK=0x47 TARGET=1500 SPEED=4000 ACC=16000 PLAN_US="));
+  TEST_ASSERT_EQUAL_STRING("MOVE:LIMIT_CLIPPED=0x47", GetLine(response, 2).data());
+  TEST_ASSERT_EQUAL_UINT32(3, response.count);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, processor.motorState(6).phase);
+  TEST_ASSERT_EQUAL_INT32(motion::MotorManager::kDefaultLimit, processor.motorState(6).targetPosition);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, processor.motorState(3).phase);
+
+  ProcessLine("STATUS:*", response);
+  TEST_ASSERT_EQUAL_STRING("STATUS:MOVING=0x47 HOMING=0x0 SLEEP=0x18 ERR=0x47", GetLine(response, 1).data());
+  TEST_ASSERT_EQUAL_UINT32(2 + motion::MotorManager::kMotorCount, response.count);
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 8), "STATUS:CH=6 "));
+
+  ProcessLine("HOME:4-5", response);
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), "HOME:MASK=0x30 "));
+  ProcessLine("MOVE:4+6,0", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", GetLine(response, 0).data());
+  TEST_ASSERT_TRUE(Contains(GetLine(response, 1), "MOVE:MASK=0x40 "));
+  TEST_ASSERT_EQUAL_STRING("MOVE:BUSY=0x10 DRIVER_FAULT=0x0", GetLine(response, 2).data());
+  ProcessLine("MOVE:4-5,0", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_BUSY", GetLine(response, 0).data());
+  TEST_ASSERT_EQUAL_STRING("MOVE:MASK=0x0 TARGET=0 SPEED=4000 ACC=16000 PLAN_US=0", GetLine(response, 1).data());
+  TEST_ASSERT_EQUAL_STRING("MOVE:BUSY=0x30 DRIVER_FAULT=0x0", GetLine(response, 2).data());
+
+  ProcessLine("EVT:0+7,1", response);
+  TEST_ASSERT_EQUAL_STRING("EVT:MASK=0x81", GetLine(response, 1).data());
+
+  const char *rejected[] = {"SLEEP:3-1", "WAKE:0,8", "STATUS:1-", "MOVE:2+,10", "HOME:0x100"};
+  for (const char *line : rejected)
+  {
+    ProcessLine(line, response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:ERR_INVALID_CHANNEL", GetLine(response, 0).data());
+  }
+}
+
 int main()
 {
   UNITY_BEGIN();
@@ -195,6 +561,15 @@ int main()
   RUN_TEST(test_move_status_cycle_reaches_target);
   RUN_TEST(test_sleep_wake_flow_reflected_in_status);
   RUN_TEST(test_home_sequence_completes_and_resets_origin);
+  RUN_TEST(test_home_all_channels_in_parallel);
   RUN_TEST(test_move_beyond_limits_reports_clipping);
+  RUN_TEST(test_subscription_pushes_only_changed_fields);
+  RUN_TEST(test_subscription_cuts_link_traffic_tenfold);
+  RUN_TEST(test_events_report_transitions_without_polling);
+  RUN_TEST(test_event_queue_overflow_is_signalled);
+  RUN_TEST(test_sequence_tags_follow_commands_into_events);
+  RUN_TEST(test_trace_ring_records_the_hot_path);
+  RUN_TEST(test_cache_verb_reports_profile_reuse);
+  RUN_TEST(test_channel_selectors_address_many_channels_at_once);
   return UNITY_END();
 }
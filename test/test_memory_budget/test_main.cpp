@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <unity.h>
+
+#include "control/CommandProcessor.hpp"
+#include "diag/HeapGuard.hpp"
+#include "diag/MemoryBudget.hpp"
+
+// Route every native operator new through the same hook the firmware wraps,
+// so the control path is held to the heap-free contract on the host too.
+void *operator new(std::size_t size)
+{
+  diag::RecordHeapAllocation();
+  void *block = std::malloc(size == 0 ? 1 : size);
+  if (block == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void *operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *block) noexcept
+{
+  std::free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+  std::free(block);
+}
+
+void operator delete(void *block, std::size_t) noexcept
+{
+  std::free(block);
+}
+
+void operator delete[](void *block, std::size_t) noexcept
+{
+  std::free(block);
+}
+
+namespace
+{
+
+ctrl::CommandProcessor processor;
+ctrl::CommandProcessor::Response response{};
+int *volatile gProbe = nullptr;
+
+void AllocateProbe()
+{
+  gProbe = new int(7);
+  delete gProbe;
+  gProbe = nullptr;
+}
+
+void Run(const char *line)
+{
+  diag::NoHeapScope noHeap;
+  processor.processLine(line, response);
+}
+
+void Service(uint32_t elapsedMicros)
+{
+  diag::NoHeapScope noHeap;
+  processor.service(elapsedMicros);
+}
+
+} // namespace
+
+void setUp()
+{
+  processor.reset();
+  diag::ResetHeapViolations();
+}
+
+void tearDown() {}
+
+void test_control_path_never_allocates()
+{
+  const char *session[] = {
+      "HELP", "STATUS", "MOVE:0,300", "MOVE:1,-2000,5000,20000", "HOME:2,400,20",
+      "WAKE:3", "SLEEP:3", "STATUS:1", "MOVE:9,1", "BOGUS", "", "MOVE:0,abc"};
+  for (const char *line : session)
+  {
+    Run(line);
+    Service(5000);
+  }
+  for (int tick = 0; tick < 2000; ++tick)
+  {
+    Service(1000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, diag::HeapViolations());
+}
+
+void test_guard_detects_allocation_inside_scope()
+{
+  {
+    diag::NoHeapScope noHeap;
+    AllocateProbe();
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, diag::HeapViolations());
+
+  AllocateProbe();
+  TEST_ASSERT_EQUAL_UINT32(1, diag::HeapViolations());
+  TEST_ASSERT_FALSE(diag::HeapForbidden());
+}
+
+void test_static_footprint_within_budget()
+{
+  char line[96];
+  std::snprintf(line, sizeof(line), "MotorManager=%zu/%zu CommandProcessor=%zu/%zu Response=%zu/%zu",
+                sizeof(motion::MotorManager), diag::kMotorManagerBudgetBytes,
+                sizeof(ctrl::CommandProcessor), diag::kCommandProcessorBudgetBytes,
+                sizeof(ctrl::CommandProcessor::Response), diag::kResponseBudgetBytes);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(sizeof(ctrl::CommandProcessor) <= diag::kCommandProcessorBudgetBytes);
+  TEST_ASSERT_TRUE(sizeof(ctrl::CommandProcessor::Response) <= diag::kResponseBudgetBytes);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_control_path_never_allocates);
+  RUN_TEST(test_guard_detects_allocation_inside_scope);
+  RUN_TEST(test_static_footprint_within_budget);
+  return UNITY_END();
+}
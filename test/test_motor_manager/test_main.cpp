@@ -1,6 +1,9 @@
 #include <unity.h>
 
+#include "diag/TraceRing.hpp"
 #include "motion/MotorManager.hpp"
+#include "motion/StepGroupProgram.hpp"
+#include "motion/StepperPioDriver.hpp"
 #include "motion/StepperPioProgram.hpp"
 
 namespace
@@ -17,6 +20,20 @@ void fastForwardChannel(std::size_t channel)
   }
 }
 
+std::size_t countSleepLatches()
+{
+  std::size_t latches = 0;
+  diag::TraceRecord record{};
+  for (uint32_t sequence = 0; sequence < diag::TraceHead(); ++sequence)
+  {
+    if (diag::ReadTrace(sequence, record) && record.kind == diag::TraceKind::SleepLatch)
+    {
+      ++latches;
+    }
+  }
+  return latches;
+}
+
 } // namespace
 
 void setUp()
@@ -48,11 +65,13 @@ void test_homing_resets_zero_position()
   auto result = manager.beginHoming(1, request);
   TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, result);
 
-  // First phase (approach)
+  // First phase (fast approach)
   fastForwardChannel(1);
   // Second phase (backoff)
   fastForwardChannel(1);
-  // Third phase (establish midpoint zero)
+  // Third phase (slow re-approach)
+  fastForwardChannel(1);
+  // Fourth phase (establish midpoint zero)
   fastForwardChannel(1);
 
   const auto &state = manager.state(1);
@@ -90,9 +109,18 @@ void test_homing_moves_relative_distance()
   buffer = motion::pio::CommandBuffer{};
   manager.exportCommandBuffer(4, buffer);
   TEST_ASSERT_TRUE_MESSAGE(buffer.occupied[0] || buffer.occupied[1], "Third homing stage should occupy a slot");
-  uint32_t expectedCenterSteps = static_cast<uint32_t>((request.travelRange / 2) - request.backoff);
   uint32_t stage2Steps = buffer.occupied[0] ? buffer.slots[0].stepCount : buffer.slots[1].stepCount;
-  TEST_ASSERT_EQUAL_UINT32(expectedCenterSteps, stage2Steps);
+  TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(2 * request.backoff), stage2Steps);
+  const uint32_t fastStageDuration = motion::MotorManager::ComputeTiming(stage2Steps, 4000, 16000).totalDurationUs;
+  TEST_ASSERT_GREATER_THAN_UINT32(fastStageDuration, manager.state(4).plannedDurationUs);
+
+  fastForwardChannel(4);
+  buffer = motion::pio::CommandBuffer{};
+  manager.exportCommandBuffer(4, buffer);
+  TEST_ASSERT_TRUE_MESSAGE(buffer.occupied[0] || buffer.occupied[1], "Fourth homing stage should occupy a slot");
+  uint32_t expectedCenterSteps = static_cast<uint32_t>(request.travelRange / 2);
+  uint32_t stage3Steps = buffer.occupied[0] ? buffer.slots[0].stepCount : buffer.slots[1].stepCount;
+  TEST_ASSERT_EQUAL_UINT32(expectedCenterSteps, stage3Steps);
 
   fastForwardChannel(4);
   const auto &state = manager.state(4);
@@ -141,6 +169,438 @@ void test_fault_blocks_motion_until_cleared()
   TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, result);
 }
 
+void test_wide_manager_drives_channels_beyond_eight()
+{
+  motion::BasicMotorManager<16> wide;
+  motion::TimingEstimate timing{};
+  auto result = wide.queueMove(12, 400, 4000, 16000, timing);
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, result);
+  TEST_ASSERT_FALSE(wide.state(12).asleep);
+
+  wide.service(wide.state(12).plannedDurationUs + 10);
+  TEST_ASSERT_EQUAL_INT32(400, static_cast<int32_t>(wide.state(12).position));
+  TEST_ASSERT_TRUE(wide.state(12).asleep);
+  TEST_ASSERT_EQUAL(motion::MoveResult::Fault, wide.queueMove(16, 10, 4000, 16000, timing));
+}
+
+void test_state_machines_fill_both_pio_blocks()
+{
+  auto first = motion::pio::StateMachineForChannel(0);
+  auto lastOfBlock0 = motion::pio::StateMachineForChannel(3);
+  auto firstOfBlock1 = motion::pio::StateMachineForChannel(4);
+  auto last = motion::pio::StateMachineForChannel(motion::pio::kMaxStepDirChannels - 1);
+  TEST_ASSERT_EQUAL_UINT(0, first.block);
+  TEST_ASSERT_EQUAL_UINT(0, first.index);
+  TEST_ASSERT_EQUAL_UINT(0, lastOfBlock0.block);
+  TEST_ASSERT_EQUAL_UINT(3, lastOfBlock0.index);
+  TEST_ASSERT_EQUAL_UINT(1, firstOfBlock1.block);
+  TEST_ASSERT_EQUAL_UINT(0, firstOfBlock1.index);
+  TEST_ASSERT_EQUAL_UINT(1, last.block);
+  TEST_ASSERT_EQUAL_UINT(3, last.index);
+}
+
+void test_pending_command_is_handed_out_once()
+{
+  motion::TimingEstimate timing{};
+  manager.queueMove(5, -300, 4000, 16000, timing);
+
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(manager.takePendingCommand(5, command));
+  TEST_ASSERT_EQUAL_UINT32(300, command.stepCount);
+  TEST_ASSERT_FALSE(command.directionHigh);
+  TEST_ASSERT_FALSE(manager.takePendingCommand(5, command));
+}
+
+void test_command_word_packs_count_direction_and_delay()
+{
+  motion::TimingEstimate timing{};
+  manager.queueMove(6, 250, 4000, 16000, timing);
+
+  motion::pio::CommandBuffer buffer{};
+  manager.exportCommandBuffer(6, buffer);
+  const std::size_t index = buffer.occupied[0] ? 0 : 1;
+  TEST_ASSERT_TRUE(buffer.occupied[index]);
+  const uint32_t word = buffer.words[index];
+  TEST_ASSERT_EQUAL_UINT32(1, word & 1U);
+  TEST_ASSERT_EQUAL_UINT32(249, (word >> motion::pio::kCommandCountShift) & (motion::pio::kMaxStepsPerWord - 1U));
+  // 4 kHz is 31250 cycles: divider 1, M = 15621 leaves 31249, rounded up.
+  const motion::pio::StepperCommand &command = buffer.slots[index];
+  TEST_ASSERT_EQUAL_UINT16(1, command.clockDivider);
+  TEST_ASSERT_EQUAL_UINT32(command.delayTicks, word >> motion::pio::kCommandDelayShift);
+  TEST_ASSERT_UINT32_WITHIN(1, 31250, static_cast<uint32_t>(motion::pio::StepPeriodCycles(command.delayTicks, 1)));
+
+  // Counts past one word are truncated here; the driver sends the rest.
+  motion::pio::StepperCommand longCommand{};
+  longCommand.stepCount = motion::pio::kMaxStepsPerWord + 10;
+  longCommand.directionHigh = false;
+  const uint32_t first = motion::pio::PackCommandWord(longCommand);
+  TEST_ASSERT_EQUAL_UINT32(motion::pio::kMaxStepsPerWord - 1, (first >> motion::pio::kCommandCountShift) & 0x7FFFU);
+  TEST_ASSERT_EQUAL_UINT32(0, first & 1U);
+}
+
+void test_step_timing_tunes_divider_and_keeps_the_fraction()
+{
+  // Every rate within 0.1% once the fraction is averaged in; slow rates
+  // raise the divider instead of losing resolution.
+  const uint32_t rates[] = {1, 3, 700, 953, 4000, 33'333, 150'000, 240'000};
+  for (uint32_t rate : rates)
+  {
+    const motion::pio::StepperCommand timing = motion::pio::StepTimingForRate(rate);
+    const double ticks = 2.0 * (timing.delayTicks + timing.delayFraction / 65536.0) + 7.0;
+    const double actualHz = 125e6 / (ticks * timing.clockDivider);
+    TEST_ASSERT_DOUBLE_WITHIN(rate * 0.001, static_cast<double>(rate), actualHz);
+    TEST_ASSERT_TRUE(timing.delayTicks + 3U >= (250U + timing.clockDivider - 1U) / timing.clockDivider);
+  }
+  TEST_ASSERT_EQUAL_UINT16(954, motion::pio::StepTimingForRate(1).clockDivider);
+  TEST_ASSERT_EQUAL_UINT16(1, motion::pio::StepTimingForRate(954).clockDivider);
+  TEST_ASSERT_EQUAL_UINT16(0, motion::pio::StepTimingForRate(4000).delayFraction);
+  TEST_ASSERT_NOT_EQUAL(0, motion::pio::StepTimingForRate(150'000).delayFraction);
+}
+
+void test_interpolator_spreads_minor_axes_over_major_ticks()
+{
+  motion::pio::StepInterpolator interpolator;
+  const int32_t deltas[] = {7, -3, 0};
+  interpolator.start(deltas, 3, 1000);
+
+  std::array<uint32_t, 4> words{};
+  std::array<uint32_t, 3> pulses{};
+  std::size_t total = 0;
+  uint8_t lastDir = 0;
+  while (!interpolator.done())
+  {
+    const std::size_t count = interpolator.fill(words.data(), words.size());
+    TEST_ASSERT_GREATER_THAN_UINT32(0, count);
+    for (std::size_t i = 0; i < count; ++i, ++total)
+    {
+      const uint32_t stepping = words[i] & 0xFFU;
+      lastDir = static_cast<uint8_t>(stepping & 0x7U);
+      for (std::size_t axis = 0; axis < 3; ++axis)
+      {
+        pulses[axis] += (stepping >> (3 + axis)) & 1U;
+      }
+      // STEP clears in the second image; DIR carries over unchanged.
+      TEST_ASSERT_EQUAL_UINT32(stepping & 0x7U, (words[i] >> 8) & 0xFFU);
+    }
+  }
+  // One direction word, then one word per major tick.
+  TEST_ASSERT_EQUAL_UINT32(8, total);
+  TEST_ASSERT_EQUAL_UINT32(7, pulses[0]);
+  TEST_ASSERT_EQUAL_UINT32(3, pulses[1]);
+  TEST_ASSERT_EQUAL_UINT32(0, pulses[2]);
+  TEST_ASSERT_EQUAL_UINT8(0x5, lastDir);
+  TEST_ASSERT_EQUAL_UINT32(1000 - motion::pio::kGroupWordOverheadTicks, words[0] >> 16);
+}
+
+void test_fed_back_position_follows_confirmed_steps()
+{
+  motion::MotorManager fed;
+  fed.setExecutionFeedback(2, true);
+  motion::TimingEstimate timing{};
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, fed.queueMove(2, 300, 4000, 16000, timing));
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(fed.takePendingCommand(2, command));
+
+  // A stalled FIFO: time passes, nothing is confirmed, nothing moves.
+  fed.service(timing.totalDurationUs * 4U);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, fed.state(2).phase);
+  TEST_ASSERT_EQUAL_INT32(0, fed.state(2).position);
+  fed.reconcileExecuted(2, 0, 120);
+  TEST_ASSERT_EQUAL_INT32(120, fed.state(2).position);
+
+  // A MOVE mid-slot queues behind it, starts from its end and goes to the
+  // driver at once; with the driver holding it, another MOVE is refused.
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, fed.queueMove(2, 100, 4000, 16000, timing));
+  TEST_ASSERT_EQUAL_UINT32(200, timing.totalSteps);
+  TEST_ASSERT_TRUE(fed.takePendingCommand(2, command));
+  TEST_ASSERT_EQUAL_UINT32(200, command.stepCount);
+  TEST_ASSERT_FALSE(command.directionHigh);
+  TEST_ASSERT_EQUAL(motion::MoveResult::Busy, fed.queueMove(2, 0, 4000, 16000, timing));
+
+  // The first command retires and the queued one is already 50 steps in.
+  fed.reconcileExecuted(2, 1, 50);
+  TEST_ASSERT_EQUAL_INT32(250, fed.state(2).position);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, fed.state(2).phase);
+
+  // SLEEP mid-slot: the position waits for the aborted command's count.
+  fed.forceSleep(2);
+  TEST_ASSERT_TRUE(fed.cancelPending(2));
+  TEST_ASSERT_EQUAL(motion::MoveResult::Busy, fed.queueMove(2, 0, 4000, 16000, timing));
+  fed.reconcileExecuted(2, 0, 73);
+  TEST_ASSERT_FALSE(fed.cancelPending(2));
+  TEST_ASSERT_EQUAL_INT32(227, fed.state(2).position);
+  TEST_ASSERT_EQUAL_INT32(227, fed.state(2).targetPosition);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, fed.state(2).phase);
+
+  // A slot that finished just before the abort counts in full and the
+  // interrupted one it chained to continues from its end.
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, fed.queueMove(2, 400, 4000, 16000, timing));
+  TEST_ASSERT_TRUE(fed.takePendingCommand(2, command));
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, fed.queueMove(2, 500, 4000, 16000, timing));
+  TEST_ASSERT_TRUE(fed.takePendingCommand(2, command));
+  fed.injectFault(2, motion::FaultCode::DriverFault);
+  fed.reconcileExecuted(2, 1, 30);
+  TEST_ASSERT_EQUAL_INT32(430, fed.state(2).position);
+  TEST_ASSERT_FALSE(fed.takePendingCommand(2, command));
+}
+
+void test_homing_group_respects_concurrency_limit()
+{
+  motion::MotorManager::ChannelMask channels{};
+  channels[0] = 0xFFU;
+  motion::HomingRequest request{};
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, manager.beginHomingGroup(channels, request, 3));
+
+  std::size_t running = 0;
+  for (std::size_t channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+  {
+    TEST_ASSERT_EQUAL(motion::MotionPhase::Homing, manager.state(channel).phase);
+    running += manager.state(channel).plannedDurationUs > 0 ? 1U : 0U;
+  }
+  TEST_ASSERT_EQUAL_UINT32(3, running);
+
+  uint32_t totalUs = 0;
+  for (int guard = 0; guard < 1000; ++guard)
+  {
+    bool homing = false;
+    for (std::size_t channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+    {
+      homing |= manager.state(channel).phase == motion::MotionPhase::Homing;
+    }
+    if (!homing)
+    {
+      break;
+    }
+    manager.service(10000);
+    totalUs += 10000;
+  }
+
+  motion::HomingRequest single{};
+  manager.beginHoming(0, single);
+  uint32_t singleUs = 0;
+  while (manager.state(0).phase == motion::MotionPhase::Homing)
+  {
+    manager.service(10000);
+    singleUs += 10000;
+  }
+
+  for (std::size_t channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+  {
+    TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, manager.state(channel).phase);
+    TEST_ASSERT_EQUAL_INT32(0, manager.state(channel).position);
+    TEST_ASSERT_EQUAL(motion::FaultCode::None, manager.state(channel).fault);
+  }
+  // Eight channels three at a time: three waves, not eight.
+  TEST_ASSERT_TRUE(totalUs <= 3U * singleUs);
+}
+
+void test_homing_groups_keep_their_own_limits()
+{
+  motion::MotorManager::ChannelMask first{};
+  first[0] = 0x0FU;
+  motion::MotorManager::ChannelMask second{};
+  second[0] = 0xF0U;
+  motion::HomingRequest request{};
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, manager.beginHomingGroup(first, request, 1));
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, manager.beginHomingGroup(second, request, 4));
+
+  for (int guard = 0; guard < 1000; ++guard)
+  {
+    std::size_t firstRunning = 0;
+    std::size_t secondRunning = 0;
+    bool homing = false;
+    for (std::size_t channel = 0; channel < 8; ++channel)
+    {
+      const auto &state = manager.state(channel);
+      homing |= state.phase == motion::MotionPhase::Homing;
+      const std::size_t running = state.plannedDurationUs > 0 ? 1U : 0U;
+      (channel < 4 ? firstRunning : secondRunning) += running;
+    }
+    if (!homing)
+    {
+      break;
+    }
+    // The second call does not widen the first group.
+    TEST_ASSERT_TRUE(firstRunning <= 1U);
+    if (guard == 0)
+    {
+      TEST_ASSERT_EQUAL_UINT32(1, firstRunning);
+      TEST_ASSERT_EQUAL_UINT32(4, secondRunning);
+    }
+    manager.service(10000);
+  }
+
+  for (std::size_t channel = 0; channel < 8; ++channel)
+  {
+    TEST_ASSERT_TRUE(manager.isHomed(channel));
+  }
+}
+
+void test_refused_homing_group_leaves_every_channel_alone()
+{
+  TEST_ASSERT_TRUE(manager.restorePosition(0, 100));
+  TEST_ASSERT_TRUE(manager.restorePosition(1, -40));
+  motion::TimingEstimate timing{};
+  manager.queueMove(2, 300, 4000, 16000, timing);
+
+  motion::MotorManager::ChannelMask channels{};
+  channels[0] = 0x7U;
+  motion::HomingRequest request{};
+  TEST_ASSERT_EQUAL(motion::MoveResult::Busy, manager.beginHomingGroup(channels, request, 0));
+  request.travelRange = 1;
+  channels[0] = 0x3U;
+  TEST_ASSERT_EQUAL(motion::MoveResult::Fault, manager.beginHomingGroup(channels, request, 0));
+
+  for (std::size_t channel = 0; channel < 2; ++channel)
+  {
+    TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, manager.state(channel).phase);
+    TEST_ASSERT_TRUE(manager.isHomed(channel));
+  }
+  TEST_ASSERT_EQUAL_INT32(100, manager.state(0).position);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, manager.state(2).phase);
+}
+
+void test_homing_stage_deadline_raises_timeout()
+{
+  motion::HomingRequest request{};
+  request.travelRange = motion::MotorManager::kDefaultTravelRange;
+  request.stageTimeoutUs = 200000; // the fast approach needs ~850 ms
+
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, manager.beginHoming(6, request));
+  TEST_ASSERT_EQUAL_UINT32(request.stageTimeoutUs, manager.state(6).plannedDurationUs);
+
+  manager.service(request.stageTimeoutUs);
+  const auto &state = manager.state(6);
+  TEST_ASSERT_EQUAL(motion::FaultCode::HomingTimeout, state.fault);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, state.phase);
+  TEST_ASSERT_TRUE(state.position < 0);
+  TEST_ASSERT_TRUE(state.position > -request.travelRange);
+}
+
+void test_unconfirmed_homing_stage_times_out()
+{
+  motion::MotorManager fed;
+  fed.setExecutionFeedback(4, true);
+  motion::HomingRequest request{};
+  request.stageTimeoutUs = 200000;
+  TEST_ASSERT_EQUAL(motion::MoveResult::Scheduled, fed.beginHoming(4, request));
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(fed.takePendingCommand(4, command));
+
+  // The state machine never confirms a step.
+  fed.service(150000);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Homing, fed.state(4).phase);
+  fed.service(50000);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, fed.state(4).phase);
+  TEST_ASSERT_EQUAL(motion::FaultCode::HomingTimeout, fed.state(4).fault);
+  TEST_ASSERT_FALSE(fed.isHomed(4));
+
+  // The aborted stage's count settles the position.
+  TEST_ASSERT_TRUE(fed.cancelPending(4));
+  fed.reconcileExecuted(4, 0, 12);
+  TEST_ASSERT_FALSE(fed.cancelPending(4));
+  TEST_ASSERT_EQUAL_INT32(-12, fed.state(4).position);
+}
+
+void test_repeated_moves_reuse_cached_profiles()
+{
+  motion::TimingEstimate timing{};
+  manager.queueMove(2, 400, 4000, 16000, timing);
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(manager.takePendingCommand(2, command));
+  fastForwardChannel(2);
+
+  // Back and forth over the same distance: one plan, then a hit. Handing
+  // a slot to the driver reuses its plan's rate timing without a lookup.
+  manager.queueMove(2, 0, 4000, 16000, timing);
+  TEST_ASSERT_TRUE(manager.takePendingCommand(2, command));
+
+  const auto stats = manager.profileCache().stats();
+  TEST_ASSERT_EQUAL_UINT32(1, stats.entries);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.misses);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.hits);
+
+  const auto direct = motion::MotorManager::ComputeTiming(400, 4000, 16000);
+  TEST_ASSERT_EQUAL_UINT32(direct.totalDurationUs, timing.totalDurationUs);
+  TEST_ASSERT_EQUAL_UINT32(direct.accelSteps, timing.accelSteps);
+  const auto rate = motion::pio::StepTimingForRate(4000);
+  TEST_ASSERT_EQUAL_UINT32(rate.delayTicks, command.delayTicks);
+  TEST_ASSERT_EQUAL_UINT16(rate.clockDivider, command.clockDivider);
+  TEST_ASSERT_EQUAL_UINT16(rate.delayFraction, command.delayFraction);
+  TEST_ASSERT_EQUAL_UINT32(400, command.stepCount);
+  TEST_ASSERT_FALSE(command.directionHigh);
+
+  manager.reset();
+  TEST_ASSERT_EQUAL_UINT32(0, manager.profileCache().stats().entries);
+}
+
+void test_profile_cache_evicts_least_recently_used()
+{
+  motion::ProfileCache cache;
+  motion::MotionProfile profile{};
+  for (uint32_t steps = 1; steps <= motion::ProfileCache::kCapacity; ++steps)
+  {
+    profile.timing.totalSteps = steps;
+    cache.insert(steps, 1000, 2000, profile);
+  }
+  TEST_ASSERT_NOT_NULL(cache.find(1, 1000, 2000));
+  TEST_ASSERT_NULL(cache.find(1, 1000, 3000));
+
+  // Entry 2 is now the oldest.
+  profile.timing.totalSteps = 99;
+  cache.insert(99, 1000, 2000, profile);
+  TEST_ASSERT_NULL(cache.find(2, 1000, 2000));
+  TEST_ASSERT_NOT_NULL(cache.find(1, 1000, 2000));
+  const motion::MotionProfile *found = cache.find(99, 1000, 2000);
+  TEST_ASSERT_NOT_NULL(found);
+  TEST_ASSERT_EQUAL_UINT32(99, found->timing.totalSteps);
+
+  const auto stats = cache.stats();
+  TEST_ASSERT_EQUAL_UINT32(motion::ProfileCache::kCapacity, stats.entries);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.evictions);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.hits);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.misses);
+}
+
+void test_group_operations_latch_sleep_lines_once()
+{
+  manager.configureShiftRegister(motion::ShiftRegisterPins{2, 3, 4});
+  motion::MotorManager::ChannelMask all{};
+  all[0] = 0xFFU;
+
+  diag::ResetTrace();
+  manager.forceWakeGroup(all);
+  TEST_ASSERT_EQUAL_UINT32(1, countSleepLatches());
+  for (std::size_t channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+  {
+    TEST_ASSERT_FALSE(manager.state(channel).asleep);
+  }
+
+  // Channel 7 is homing and refuses the move; the rest start together.
+  motion::HomingRequest request{};
+  manager.beginHoming(7, request);
+  diag::ResetTrace();
+  motion::MotorManager::GroupMoveResult result{};
+  manager.queueMoveGroup(all, motion::MotorManager::kDefaultLimit + 100, 4000, 16000, result);
+  TEST_ASSERT_EQUAL_UINT32(1, countSleepLatches());
+  TEST_ASSERT_EQUAL_HEX32(0x7FU, result.scheduled[0]);
+  TEST_ASSERT_EQUAL_HEX32(0x7FU, result.clipped[0]);
+  TEST_ASSERT_EQUAL_HEX32(0x80U, result.busy[0]);
+  TEST_ASSERT_EQUAL_HEX32(0x00U, result.fault[0]);
+  TEST_ASSERT_EQUAL_UINT32(manager.state(0).plannedDurationUs, result.longestDurationUs);
+  TEST_ASSERT_EQUAL(motion::MotionPhase::Moving, manager.state(3).phase);
+
+  diag::ResetTrace();
+  manager.forceSleepGroup(all);
+  TEST_ASSERT_EQUAL_UINT32(1, countSleepLatches());
+  for (std::size_t channel = 0; channel < motion::MotorManager::kMotorCount; ++channel)
+  {
+    TEST_ASSERT_TRUE(manager.state(channel).asleep);
+    TEST_ASSERT_EQUAL(motion::MotionPhase::Idle, manager.state(channel).phase);
+  }
+  manager.configureShiftRegister(motion::ShiftRegisterPins{});
+}
+
 int main()
 {
   UNITY_BEGIN();
@@ -150,5 +610,20 @@ int main()
   RUN_TEST(test_autosleep_transitions_after_motion);
   RUN_TEST(test_step_timing_calculation_matches_trapezoid_profile);
   RUN_TEST(test_fault_blocks_motion_until_cleared);
+  RUN_TEST(test_wide_manager_drives_channels_beyond_eight);
+  RUN_TEST(test_state_machines_fill_both_pio_blocks);
+  RUN_TEST(test_pending_command_is_handed_out_once);
+  RUN_TEST(test_command_word_packs_count_direction_and_delay);
+  RUN_TEST(test_step_timing_tunes_divider_and_keeps_the_fraction);
+  RUN_TEST(test_interpolator_spreads_minor_axes_over_major_ticks);
+  RUN_TEST(test_fed_back_position_follows_confirmed_steps);
+  RUN_TEST(test_homing_group_respects_concurrency_limit);
+  RUN_TEST(test_homing_groups_keep_their_own_limits);
+  RUN_TEST(test_refused_homing_group_leaves_every_channel_alone);
+  RUN_TEST(test_homing_stage_deadline_raises_timeout);
+  RUN_TEST(test_unconfirmed_homing_stage_times_out);
+  RUN_TEST(test_repeated_moves_reuse_cached_profiles);
+  RUN_TEST(test_profile_cache_evicts_least_recently_used);
+  RUN_TEST(test_group_operations_latch_sleep_lines_once);
   return UNITY_END();
 }
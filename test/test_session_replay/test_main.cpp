@@ -0,0 +1,220 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unity.h>
+
+#include "control/CommandProcessor.hpp"
+#include "diag/SessionRecorder.hpp"
+#include "replay/SessionReplay.hpp"
+
+namespace
+{
+
+ctrl::CommandProcessor processor;
+ctrl::CommandProcessor::Response response{};
+diag::SessionRecorder recorder;
+
+struct Step
+{
+  uint32_t serviceUs;
+  const char *line;
+};
+
+// A short session as the deck would see it: service ticks between lines.
+const Step kSession[] = {
+    {0, "MOVE:2,400"},
+    {20'000, "#17 STATUS:2"},
+    {250'000, "MOVE:2,-150,2000,8000"},
+    {5'000, "SLEEP:5"},
+    {10'000, "AIM:1,400,250,2000"},
+    {400'000, "STATUS"},
+    {1'000, "MOVE:9,1"},
+    {2'000, "#18 MOVE:4,90"},
+};
+
+// Runs kSession live with the recorder on; returns the "<us> > cmd" and
+// "<us> < response" lines the replayer is expected to reproduce.
+std::vector<std::string> RecordLiveSession()
+{
+  std::vector<std::string> live;
+  processor.reset();
+  processor.attachRecorder(&recorder);
+  processor.service(123'456); // uptime before recording starts
+  processor.processLine("REC:START", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+  const uint64_t startUs = processor.uptimeMicros();
+
+  for (const Step &step : kSession)
+  {
+    for (uint32_t elapsed = 0; elapsed < step.serviceUs; elapsed += 1000)
+    {
+      processor.service(1000);
+    }
+    const std::string stamp = std::to_string(processor.uptimeMicros() - startUs);
+    live.push_back(stamp + " > " + step.line);
+    processor.processLine(step.line, response);
+    for (std::size_t i = 0; i < response.count; ++i)
+    {
+      live.push_back(stamp + " < " + response.lines[i].data());
+    }
+  }
+  processor.processLine("REC:STOP", response);
+  return live;
+}
+
+std::vector<uint8_t> DumpOverSerial()
+{
+  std::ostringstream capture;
+  std::size_t offset = 0;
+  std::size_t total = 0;
+  do
+  {
+    const std::string command = "REC:DUMP," + std::to_string(offset);
+    processor.processLine(command, response);
+    TEST_ASSERT_EQUAL_STRING("CTRL:OK", response.lines[0].data());
+    unsigned long start = 0;
+    unsigned long bytes = 0;
+    unsigned long size = 0;
+    TEST_ASSERT_EQUAL_INT(3, std::sscanf(response.lines[1].data(), "REC:DUMP OFFSET=%lu BYTES=%lu TOTAL=%lu", &start,
+                                         &bytes, &size));
+    for (std::size_t i = 0; i < response.count; ++i)
+    {
+      capture << response.lines[i].data() << "\r\n";
+    }
+    offset += bytes;
+    total = size;
+  } while (offset < total);
+  std::istringstream in(capture.str());
+  return replay::ReadDump(in);
+}
+
+std::vector<std::string> InputAndResponses(const replay::Transcript &transcript)
+{
+  std::vector<std::string> lines;
+  for (const std::string &line : transcript.lines)
+  {
+    if (line.find(" M ") == std::string::npos)
+    {
+      lines.push_back(line);
+    }
+  }
+  return lines;
+}
+
+} // namespace
+
+void setUp()
+{
+  processor.reset();
+}
+
+void tearDown()
+{
+  processor.attachRecorder(nullptr);
+}
+
+void test_recording_round_trips_through_dump()
+{
+  RecordLiveSession();
+  const std::vector<uint8_t> bytes = DumpOverSerial();
+  TEST_ASSERT_EQUAL_UINT32(recorder.size(), bytes.size());
+
+  replay::Session session{};
+  TEST_ASSERT_EQUAL(replay::ParseStatus::Ok, replay::ParseSession(bytes.data(), bytes.size(), session));
+  TEST_ASSERT_EQUAL_UINT32(ctrl::CommandProcessor::kMotorCount, session.channels.size());
+  TEST_ASSERT_EQUAL_UINT32(sizeof(kSession) / sizeof(kSession[0]), session.lines.size());
+  TEST_ASSERT_EQUAL_STRING("MOVE:2,400", session.lines[0].text.c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, session.lines[0].atUs);
+  TEST_ASSERT_EQUAL_UINT32(270'000, session.lines[2].atUs);
+  // Tags are kept as the host sent them.
+  TEST_ASSERT_EQUAL_STRING("#17 STATUS:2", session.lines[1].text.c_str());
+  TEST_ASSERT_EQUAL_STRING("#18 MOVE:4,90", session.lines.back().text.c_str());
+  // About a dozen bytes per line on top of the command text.
+  TEST_ASSERT_LESS_THAN_UINT32(4 + (17 * ctrl::CommandProcessor::kMotorCount) + 160, bytes.size());
+}
+
+void test_replay_reproduces_live_responses()
+{
+  const std::vector<std::string> live = RecordLiveSession();
+  replay::Session session{};
+  replay::ParseSession(recorder.data(), recorder.size(), session);
+
+  const replay::Transcript first = replay::Replay(session, replay::ReplayOptions{});
+  const replay::TranscriptDiff diff = replay::Diff(live, InputAndResponses(first));
+  if (!diff.equal)
+  {
+    TEST_FAIL_MESSAGE((diff.expected + " != " + diff.actual).c_str());
+  }
+
+  // Deterministic down to the motion trace.
+  const replay::Transcript second = replay::Replay(session, replay::ReplayOptions{});
+  TEST_ASSERT_TRUE(replay::Diff(first.lines, second.lines).equal);
+  bool sawArrival = false;
+  for (const std::string &line : first.lines)
+  {
+    sawArrival |= line.find(" M CH=2 STATE=IDLE POS=-150 TARGET=-150 SLEEP=1") != std::string::npos;
+  }
+  TEST_ASSERT_TRUE(sawArrival);
+
+  // A changed command shows up as a diff at the right line.
+  session.lines[0].text = "MOVE:2,401";
+  const replay::TranscriptDiff changed = replay::Diff(first.lines, replay::Replay(session, replay::ReplayOptions{}).lines);
+  TEST_ASSERT_FALSE(changed.equal);
+  TEST_ASSERT_EQUAL_STRING("0 > MOVE:2,400", changed.expected.c_str());
+}
+
+void test_replay_runs_faster_than_real_time()
+{
+  replay::Session session{};
+  session.channels.resize(ctrl::CommandProcessor::kMotorCount);
+  for (auto &channel : session.channels)
+  {
+    channel.negativeLimit = -1200;
+    channel.positiveLimit = 1200;
+  }
+  // Ten minutes of a channel sweeping back and forth every two seconds.
+  for (uint64_t second = 0; second < 600; second += 2)
+  {
+    session.lines.push_back({second * 1'000'000ULL, (second % 4 == 0) ? "MOVE:0,1000" : "MOVE:0,-1000"});
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const replay::Transcript transcript = replay::Replay(session, replay::ReplayOptions{});
+  const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  const double virtualSeconds = static_cast<double>(transcript.virtualUs) / 1e6;
+  TEST_ASSERT_TRUE(virtualSeconds > 600.0);
+  TEST_ASSERT_TRUE(wallSeconds * 20.0 < virtualSeconds);
+}
+
+void test_recorder_stops_cleanly_when_full()
+{
+  processor.attachRecorder(&recorder);
+  processor.processLine("REC:START", response);
+  for (int i = 0; i < 200; ++i)
+  {
+    processor.processLine("STATUS:1", response);
+  }
+  processor.processLine("REC", response);
+  TEST_ASSERT_TRUE(std::string(response.lines[1].data()).find("STATE=OFF") != std::string::npos);
+  TEST_ASSERT_TRUE(std::string(response.lines[1].data()).find("OVERFLOW=1") != std::string::npos);
+
+  replay::Session session{};
+  TEST_ASSERT_EQUAL(replay::ParseStatus::Ok, replay::ParseSession(recorder.data(), recorder.size(), session));
+  TEST_ASSERT_EQUAL_UINT32(recorder.lineCount(), session.lines.size());
+
+  processor.processLine("MOVE:1,50", response);
+  processor.processLine("REC:START", response);
+  TEST_ASSERT_EQUAL_STRING("CTRL:ERR_BUSY", response.lines[0].data());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_recording_round_trips_through_dump);
+  RUN_TEST(test_replay_reproduces_live_responses);
+  RUN_TEST(test_replay_runs_faster_than_real_time);
+  RUN_TEST(test_recorder_stops_cleanly_when_full);
+  return UNITY_END();
+}
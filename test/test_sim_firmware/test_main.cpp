@@ -0,0 +1,352 @@
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include <unity.h>
+
+#include "boards/Rp2040Pins.hpp"
+#include "sim/Simulation.hpp"
+#include "trace/TraceDecode.hpp"
+
+namespace
+{
+
+namespace pins = board::rp2040;
+
+sim::Simulation simulation(&setup, &loop);
+
+bool SawLine(std::string_view prefix)
+{
+  for (const sim::OutputLine &line : sim::board().serial().lines())
+  {
+    if (std::string_view(line.text).substr(0, prefix.size()) == prefix)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string LastLine(std::string_view prefix)
+{
+  std::string found;
+  for (const sim::OutputLine &line : sim::board().serial().lines())
+  {
+    if (std::string_view(line.text).substr(0, prefix.size()) == prefix)
+    {
+      found = line.text;
+    }
+  }
+  return found;
+}
+
+} // namespace
+
+void setUp()
+{
+  sim::Board &board = sim::board();
+  board.flash().erase(0, sim::FlashChip::kSizeBytes);
+  for (std::size_t ch = 0; ch < pins::kChannelCount; ++ch)
+  {
+    board.watchAxis(ch, pins::kStepPins[ch], pins::kDirPins[ch]);
+  }
+  board.attachShiftRegisters(pins::kShiftRegisterPins.data, pins::kShiftRegisterPins.clock,
+                             pins::kShiftRegisterPins.latch, (pins::kChannelCount + 7U) / 8U);
+  simulation.boot();
+}
+
+void tearDown() {}
+
+void test_boot_announces_and_claims_pins_cleanly()
+{
+  TEST_ASSERT_TRUE(simulation.runUntilLine("CTRL:READY", 10'000));
+  TEST_ASSERT_TRUE(SawLine("BOOT:HOMING_REQUIRED"));
+  // Every STEP/DIR pad belongs to a PIO block and nothing else writes them.
+  TEST_ASSERT_EQUAL_HEX32(0, sim::board().gpio().conflictMask());
+  TEST_ASSERT_TRUE(sim::board().gpio().function(pins::kStepPins[5]) == sim::PinFunction::Pio1);
+}
+
+void test_move_pulses_step_and_wakes_only_its_channel()
+{
+  simulation.send("MOVE:0,200");
+  simulation.run(1'000'000);
+
+  const sim::AxisStats &axis = sim::board().axis(0);
+  TEST_ASSERT_EQUAL_UINT64(200, axis.pulses);
+  TEST_ASSERT_EQUAL_INT64(200, axis.position);
+  TEST_ASSERT_TRUE(sim::board().readPin(pins::kDirPins[0]));
+  TEST_ASSERT_EQUAL_UINT64(0, sim::board().axis(1).pulses);
+
+  const sim::SleepStats &sleep = sim::board().sleepLine(0);
+  TEST_ASSERT_EQUAL_UINT64(1, sleep.wakes);
+  TEST_ASSERT_FALSE(sleep.awake);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, static_cast<uint32_t>(sleep.awakeCycles));
+  TEST_ASSERT_EQUAL_UINT64(0, sim::board().sleepLine(1).wakes);
+}
+
+void test_reverse_move_drives_dir_low()
+{
+  simulation.send("MOVE:3,-150");
+  simulation.run(1'000'000);
+
+  const sim::AxisStats &axis = sim::board().axis(3);
+  TEST_ASSERT_LESS_THAN_INT32(0, static_cast<int32_t>(axis.position));
+  TEST_ASSERT_FALSE(sim::board().readPin(pins::kDirPins[3]));
+
+  simulation.send("STATUS:3");
+  simulation.run(1'000);
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=3").find("POS=-150 ") != std::string::npos);
+}
+
+void test_long_move_splits_words_and_holds_the_step_rate()
+{
+  simulation.send("CAL:1,0,-50000,50000");
+  simulation.send("MOVE:1,40000,8000");
+  simulation.run(6'000'000);
+
+  // 40000 steps go out as 1 ms words; every completion token is collected.
+  const sim::AxisStats &axis = sim::board().axis(1);
+  TEST_ASSERT_EQUAL_UINT64(40'000, axis.pulses);
+  // One IRQ per word, each handled: flag cleared, token collected.
+  TEST_ASSERT_EQUAL_UINT(0, pio_sm_get_rx_fifo_level(pio0, 1));
+  TEST_ASSERT_FALSE(pio_interrupt_get(pio0, 1));
+  TEST_ASSERT_EQUAL_UINT64(5'000, sim::board().interrupts().delivered(PIO0_IRQ_0));
+  simulation.send("STATUS:1");
+  simulation.run(1'000);
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=1").find("POS=40000 ") != std::string::npos);
+
+  // 8 kHz is 125 us per step; the delay loop must hold it to 0.1%.
+  const double periodCycles =
+      static_cast<double>(axis.lastPulseCycle - axis.firstPulseCycle) / static_cast<double>(axis.pulses - 1);
+  TEST_ASSERT_DOUBLE_WITHIN(125.0 * 125.0 * 0.001, 125.0 * 125.0, periodCycles);
+}
+
+void test_position_tracks_emitted_steps_through_stall_and_sleep()
+{
+  simulation.send("MOVE:4,1000,1000");
+  simulation.run(300'000);
+  // Stall the state machine well past the planned end of the move.
+  pio_sm_set_enabled(pio1, 0, false);
+  simulation.run(2'000'000);
+
+  // The report never runs ahead of the pulses and trails them by at most
+  // the unconfirmed word (1 ms, one step at 1 kHz).
+  const sim::AxisStats &axis = sim::board().axis(4);
+  simulation.send("STATUS:4");
+  simulation.run(1'000);
+  const std::string status = LastLine("STATUS:CH=4");
+  const long reported = std::strtol(status.c_str() + status.find("POS=") + 4, nullptr, 10);
+  TEST_ASSERT_TRUE(status.find("STATE=MOVING") != std::string::npos);
+  TEST_ASSERT_LESS_THAN_INT32(1000, static_cast<int32_t>(axis.position));
+  TEST_ASSERT_TRUE(reported <= axis.position);
+  TEST_ASSERT_TRUE(reported + 1 >= axis.position);
+
+  // Resumed, then put to sleep mid-word: the count includes the partial word.
+  pio_sm_set_enabled(pio1, 0, true);
+  simulation.run(200'000);
+  simulation.send("SLEEP:4");
+  simulation.run(1'000);
+  const int64_t stoppedAt = axis.position;
+  simulation.run(100'000);
+  TEST_ASSERT_EQUAL_INT64(stoppedAt, axis.position);
+  TEST_ASSERT_GREATER_THAN_INT32(0, static_cast<int32_t>(stoppedAt));
+  TEST_ASSERT_LESS_THAN_INT32(1000, static_cast<int32_t>(stoppedAt));
+  simulation.send("STATUS:4");
+  simulation.run(1'000);
+  const std::string slept = "POS=" + std::to_string(stoppedAt) + " ";
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=4").find(slept) != std::string::npos);
+}
+
+void test_chained_moves_run_gap_free_under_a_slow_loop()
+{
+  // loop() only every 5 ms: refills and the hand-over between the two moves
+  // have to come from the word IRQ, or the step train stalls for a loop.
+  sim::SimulationOptions options{};
+  options.loopPeriodUs = 5'000;
+  sim::Simulation slow(&setup, &loop, options);
+  slow.boot();
+  slow.send("CAL:5,0,-50000,50000");
+  slow.send("MOVE:5,2000,20000,10000000");
+  slow.run(20'000);
+  slow.send("MOVE:5,4000,20000,10000000");
+  slow.run(400'000);
+
+  // 20 kHz is 6250 cycles per step, across the boundary too; a word
+  // boundary adds only the few cycles of the pull.
+  const sim::AxisStats &axis = sim::board().axis(5);
+  TEST_ASSERT_EQUAL_UINT64(4'000, axis.pulses);
+  TEST_ASSERT_EQUAL_UINT64(0, axis.reversals);
+  TEST_ASSERT_UINT32_WITHIN(63, 6'250, static_cast<uint32_t>(axis.longestPeriodCycles));
+  slow.send("STATUS:5");
+  slow.run(10'000);
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=5").find("POS=4000 ") != std::string::npos);
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=5").find("STATE=IDLE") != std::string::npos);
+}
+
+void test_done_event_follows_the_last_confirmed_step()
+{
+  simulation.send("EVT:6,1");
+  simulation.send("MOVE:6,300,3000");
+  TEST_ASSERT_TRUE(simulation.runUntilLine("EVT:DONE CH=6 POS=300", 1'000'000));
+  TEST_ASSERT_EQUAL_UINT64(300, sim::board().axis(6).pulses);
+  // The event goes out within a loop pass of the last token, not a poll.
+  const uint64_t lastStepUs = sim::board().axis(6).lastPulseCycle / sim::kCyclesPerMicro;
+  TEST_ASSERT_TRUE(sim::board().serial().lines().back().micros <= lastStepUs + 2'000);
+}
+
+void test_pipelined_moves_report_under_their_own_tags()
+{
+  simulation.send("#1 EVT:5,1");
+  simulation.send("#2 MOVE:5,200,3000");
+  // Once the PIO holds #2, #3 chains behind it instead of replacing it.
+  simulation.run(5'000);
+  simulation.send("#3 MOVE:5,400,3000");
+  TEST_ASSERT_TRUE(simulation.runUntilLine("#3 EVT:DONE", 1'000'000));
+  std::vector<std::string> tagged;
+  for (const sim::OutputLine &line : sim::board().serial().lines())
+  {
+    if (line.text[0] == '#')
+    {
+      tagged.push_back(line.text);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(10, tagged.size());
+  TEST_ASSERT_EQUAL_STRING("#1 CTRL:OK", tagged[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("#2 CTRL:OK", tagged[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("#3 CTRL:OK", tagged[5].c_str());
+  TEST_ASSERT_EQUAL_STRING("#2 EVT:DONE CH=5 POS=200", tagged[8].c_str());
+  TEST_ASSERT_EQUAL_STRING("#3 EVT:DONE CH=5 POS=400", tagged[9].c_str());
+  TEST_ASSERT_EQUAL_UINT64(400, sim::board().axis(5).pulses);
+}
+
+void test_trace_times_the_retire_from_the_word_irq()
+{
+  TEST_ASSERT_TRUE(simulation.runUntilLine("CTRL:READY", 10'000));
+  simulation.send("TRACE:CLEAR");
+  simulation.send("MOVE:3,100,5000");
+  simulation.run(200'000);
+  const std::size_t before = sim::board().serial().lines().size();
+  simulation.send("TRACE:DUMP");
+  simulation.run(10'000);
+  std::vector<std::string> page;
+  for (std::size_t i = before; i < sim::board().serial().lines().size(); ++i)
+  {
+    page.push_back(sim::board().serial().lines()[i].text);
+  }
+  trace::Capture capture{};
+  TEST_ASSERT_TRUE(trace::AddPage(page, capture) >= 7);
+
+  const char *expected[] = {"CMD", "PHASE", "SLEEP", "LATCH", "RETIRE", "PHASE", "SLEEP"};
+  std::size_t matched = 0;
+  uint32_t retiredUs = 0;
+  for (const auto &[sequence, record] : capture.records)
+  {
+    if (record.kind == diag::TraceKind::CommandAccepted && matched != 0)
+    {
+      continue; // the TRACE:DUMP itself
+    }
+    if (matched < 7 && std::string_view(diag::TraceKindLabel(record.kind)) == expected[matched])
+    {
+      retiredUs = record.kind == diag::TraceKind::SlotRetired ? record.micros : retiredUs;
+      ++matched;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(7, matched);
+  // Stamped in the IRQ one step period (200 us) after the last rising edge,
+  // not at the next loop pass.
+  const uint64_t lastStepUs = sim::board().axis(3).lastPulseCycle / sim::kCyclesPerMicro;
+  TEST_ASSERT_TRUE(retiredUs >= lastStepUs);
+  TEST_ASSERT_TRUE(retiredUs <= lastStepUs + 500);
+}
+
+void test_step_rates_hold_within_a_tenth_of_a_percent()
+{
+  struct Case
+  {
+    const char *move;
+    uint32_t rateHz;
+    uint32_t steps;
+  };
+  // From a divider of 954 at 3 Hz down to diffused fractions at 150 kHz.
+  // The high acceleration keeps the planned duration close to steps/rate.
+  const Case cases[] = {{"MOVE:2,6,3,1000000", 3, 6},
+                        {"MOVE:2,-694,700,1000000", 700, 700},
+                        {"MOVE:2,306,4000,1000000", 4000, 1000},
+                        {"MOVE:2,-694,33333,1000000", 33'333, 1000},
+                        {"MOVE:2,1000,150000,10000000", 150'000, 1694}};
+  uint64_t pulsesBefore = 0;
+  for (const Case &step : cases)
+  {
+    sim::board().watchAxis(2, pins::kStepPins[2], pins::kDirPins[2]);
+    simulation.send(step.move);
+    simulation.run(static_cast<uint64_t>(step.steps) * 1'000'000ULL / step.rateHz + 300'000ULL);
+
+    const sim::AxisStats &axis = sim::board().axis(2);
+    TEST_ASSERT_EQUAL_UINT64(step.steps, axis.pulses);
+    const double rateHz = static_cast<double>(sim::kSystemClockHz) * static_cast<double>(axis.pulses - 1) /
+                          static_cast<double>(axis.lastPulseCycle - axis.firstPulseCycle);
+    TEST_ASSERT_DOUBLE_WITHIN(step.rateHz * 0.001, static_cast<double>(step.rateHz), rateHz);
+    pulsesBefore += axis.pulses;
+  }
+  TEST_ASSERT_EQUAL_UINT64(6 + 700 + 1000 + 1000 + 1694, pulsesBefore);
+}
+
+void test_shutdown_journal_resumes_after_reboot()
+{
+  simulation.send("HOME:2");
+  simulation.run(10'000'000);
+  simulation.send("MOVE:2,120");
+  simulation.run(500'000);
+  simulation.send("SHUTDOWN");
+  TEST_ASSERT_TRUE(simulation.runUntilLine("SHUTDOWN:", 10'000));
+
+  simulation.boot();
+  TEST_ASSERT_TRUE(simulation.runUntilLine("CTRL:READY", 10'000));
+  TEST_ASSERT_TRUE(SawLine("BOOT:RESUMED"));
+  simulation.send("STATUS:2");
+  simulation.run(1'000);
+  TEST_ASSERT_TRUE(LastLine("STATUS:CH=2").find("POS=120 ") != std::string::npos);
+}
+
+void test_hour_of_operation_runs_in_virtual_time()
+{
+  sim::SimulationOptions options{};
+  options.loopPeriodUs = 1'000;
+  sim::Simulation coarse(&setup, &loop, options);
+  coarse.boot();
+
+  const uint64_t start = coarse.micros();
+  for (int minute = 0; minute < 60; ++minute)
+  {
+    coarse.send((minute % 2 == 0) ? "MOVE:7,400" : "MOVE:7,-400");
+    coarse.run(60'000'000);
+  }
+
+  TEST_ASSERT_EQUAL_UINT64(3'600'000'000ULL, coarse.micros() - start);
+  const sim::AxisStats &axis = sim::board().axis(7);
+  TEST_ASSERT_EQUAL_UINT64(59, axis.reversals);
+  TEST_ASSERT_EQUAL_UINT64(60, sim::board().sleepLine(7).wakes);
+  TEST_ASSERT_FALSE(sim::board().sleepLine(7).awake);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_announces_and_claims_pins_cleanly);
+  RUN_TEST(test_move_pulses_step_and_wakes_only_its_channel);
+  RUN_TEST(test_reverse_move_drives_dir_low);
+  RUN_TEST(test_long_move_splits_words_and_holds_the_step_rate);
+  RUN_TEST(test_position_tracks_emitted_steps_through_stall_and_sleep);
+  RUN_TEST(test_chained_moves_run_gap_free_under_a_slow_loop);
+  RUN_TEST(test_done_event_follows_the_last_confirmed_step);
+  RUN_TEST(test_pipelined_moves_report_under_their_own_tags);
+  RUN_TEST(test_trace_times_the_retire_from_the_word_irq);
+  RUN_TEST(test_step_rates_hold_within_a_tenth_of_a_percent);
+  RUN_TEST(test_shutdown_journal_resumes_after_reboot);
+  RUN_TEST(test_hour_of_operation_runs_in_virtual_time);
+  return UNITY_END();
+}
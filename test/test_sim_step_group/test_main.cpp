@@ -0,0 +1,175 @@
+#include <cstdint>
+#include <vector>
+
+#include <Arduino.h>
+#include <hardware/dma.h>
+#include <hardware/pio.h>
+#include <unity.h>
+
+#include "motion/StepGroupDriver.hpp"
+#include "sim/Board.hpp"
+
+namespace
+{
+
+// DIR 0/1 on GPIO 0/1, STEP 0/1 on GPIO 2/3.
+constexpr motion::pio::StepGroupPins kPair{0, 2};
+
+struct RisingEdges
+{
+  std::vector<uint64_t> step0;
+  std::vector<uint64_t> step1;
+};
+
+RisingEdges edges;
+
+void RecordEdge(void *context, const sim::TraceEvent &event)
+{
+  RisingEdges &record = *static_cast<RisingEdges *>(context);
+  if (event.signal != sim::TraceSignal::Gpio || !event.level)
+  {
+    return;
+  }
+  if (event.index == 2)
+  {
+    record.step0.push_back(event.cycle);
+  }
+  else if (event.index == 3)
+  {
+    record.step1.push_back(event.cycle);
+  }
+}
+
+void RunServiced(motion::pio::StepGroupDriver &driver, uint64_t micros)
+{
+  for (uint64_t elapsed = 0; elapsed < micros; elapsed += 100)
+  {
+    sim::board().advance(sim::MicrosToCycles(100));
+    driver.service();
+  }
+}
+
+} // namespace
+
+void setUp()
+{
+  sim::Board &board = sim::board();
+  board.reset();
+  board.watchAxis(0, 2, 0);
+  board.watchAxis(1, 3, 1);
+  edges = RisingEdges{};
+  board.setTraceSink(&RecordEdge, &edges);
+}
+
+void tearDown()
+{
+  sim::board().setTraceSink(nullptr, nullptr);
+}
+
+void test_group_axes_step_on_the_same_cycle()
+{
+  motion::pio::StepGroupDriver driver;
+  TEST_ASSERT_TRUE(driver.begin(&kPair, 1));
+
+  const int32_t deltas[] = {300, -120};
+  TEST_ASSERT_TRUE(driver.move(0, deltas, 2, 977));
+  TEST_ASSERT_FALSE(driver.move(0, deltas, 2, 977));
+  RunServiced(driver, 200'000);
+  TEST_ASSERT_FALSE(driver.busy(0));
+
+  TEST_ASSERT_EQUAL_INT64(300, sim::board().axis(0).position);
+  TEST_ASSERT_EQUAL_INT64(-120, sim::board().axis(1).position);
+  TEST_ASSERT_EQUAL_UINT32(300, edges.step0.size());
+  TEST_ASSERT_EQUAL_UINT32(120, edges.step1.size());
+  std::size_t major = 0;
+  for (uint64_t cycle : edges.step1)
+  {
+    while (major < edges.step0.size() && edges.step0[major] < cycle)
+    {
+      ++major;
+    }
+    TEST_ASSERT_TRUE(major < edges.step0.size());
+    TEST_ASSERT_EQUAL_UINT64(edges.step0[major], cycle);
+  }
+  // DMA kept the FIFO fed across ping-pong swaps: no tick ran long.
+  for (std::size_t i = 1; i < edges.step0.size(); ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT64(977ULL * motion::pio::kStepGroupClockDivider, edges.step0[i] - edges.step0[i - 1]);
+  }
+  TEST_ASSERT_EQUAL_HEX32(0, sim::board().gpio().conflictMask());
+}
+
+void test_slow_ticks_pad_with_idle_words()
+{
+  motion::pio::StepGroupDriver driver;
+  TEST_ASSERT_TRUE(driver.begin(&kPair, 1));
+
+  // 2 Hz needs 30 words per tick; only the first one carries STEP.
+  const uint32_t periodTicks = motion::pio::kStepGroupTickHz / 2U;
+  const int32_t deltas[] = {-4, 2};
+  TEST_ASSERT_TRUE(driver.move(0, deltas, 2, periodTicks));
+  RunServiced(driver, 2'500'000);
+
+  TEST_ASSERT_EQUAL_INT64(-4, sim::board().axis(0).position);
+  TEST_ASSERT_EQUAL_INT64(2, sim::board().axis(1).position);
+  const uint64_t expected = static_cast<uint64_t>(periodTicks) * motion::pio::kStepGroupClockDivider;
+  TEST_ASSERT_EQUAL_UINT64(expected, edges.step0[1] - edges.step0[0]);
+}
+
+void test_failed_begin_releases_its_state_machine()
+{
+  // No DMA channel left: begin() fails after claiming a state machine.
+  while (dma_claim_unused_channel(false) >= 0)
+  {
+  }
+  motion::pio::StepGroupDriver driver;
+  TEST_ASSERT_FALSE(driver.begin(&kPair, 1));
+  for (uint sm = 0; sm < 4; ++sm)
+  {
+    TEST_ASSERT_FALSE(pio_sm_is_claimed(pio0, sm));
+    TEST_ASSERT_FALSE(pio_sm_is_claimed(pio1, sm));
+  }
+
+  dma_channel_unclaim(0);
+  TEST_ASSERT_TRUE(driver.begin(&kPair, 1));
+  TEST_ASSERT_TRUE(pio_sm_is_claimed(pio0, 0));
+  TEST_ASSERT_FALSE(pio_sm_is_claimed(pio0, 1));
+}
+
+void test_fourteen_channels_share_one_block()
+{
+  // Three four-axis groups and a pair: 14 channels on PIO0 alone.
+  const motion::pio::StepGroupPins groups[] = {{0, 4}, {8, 4}, {16, 4}, {24, 2}};
+  motion::pio::StepGroupDriver driver;
+  TEST_ASSERT_TRUE(driver.begin(groups, 4));
+  for (uint sm = 0; sm < 4; ++sm)
+  {
+    TEST_ASSERT_TRUE(pio_sm_is_claimed(pio0, sm));
+    TEST_ASSERT_FALSE(pio_sm_is_claimed(pio1, sm));
+  }
+
+  sim::board().watchAxis(0, 4, 0);   // group 0, axis 0
+  sim::board().watchAxis(1, 23, 19); // group 2, axis 3
+  sim::board().watchAxis(2, 27, 25); // group 3, axis 1
+  const int32_t deltas[] = {40, 30, 20, -10};
+  for (std::size_t g = 0; g < 4; ++g)
+  {
+    TEST_ASSERT_TRUE(driver.move(g, deltas, 4, 977));
+  }
+  RunServiced(driver, 50'000);
+
+  TEST_ASSERT_EQUAL_INT64(40, sim::board().axis(0).position);
+  TEST_ASSERT_EQUAL_INT64(-10, sim::board().axis(1).position);
+  TEST_ASSERT_EQUAL_INT64(30, sim::board().axis(2).position);
+  TEST_ASSERT_EQUAL_HEX32(0, sim::board().gpio().conflictMask());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_group_axes_step_on_the_same_cycle);
+  RUN_TEST(test_slow_ticks_pad_with_idle_words);
+  RUN_TEST(test_failed_begin_releases_its_state_machine);
+  RUN_TEST(test_fourteen_channels_share_one_block);
+  return UNITY_END();
+}
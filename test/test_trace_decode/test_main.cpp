@@ -0,0 +1,163 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unity.h>
+
+#include "control/CommandProcessor.hpp"
+#include "diag/TraceRing.hpp"
+#include "motion/StepperPioProgram.hpp"
+#include "trace/TraceDecode.hpp"
+
+namespace
+{
+
+std::vector<std::string> Dump(ctrl::CommandProcessor &processor, const char *command)
+{
+  ctrl::CommandProcessor::Response response{};
+  processor.processLine(command, response);
+  std::vector<std::string> lines;
+  for (std::size_t i = 0; i < response.count; ++i)
+  {
+    lines.emplace_back(response.lines[i].data());
+  }
+  return lines;
+}
+
+bool HasLineEndingWith(const std::vector<std::string> &lines, const std::string &suffix)
+{
+  for (const std::string &line : lines)
+  {
+    if (line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+diag::TraceRecord Record(uint32_t micros, diag::TraceKind kind, uint8_t channel, uint16_t value)
+{
+  diag::TraceRecord record{};
+  record.micros = micros;
+  record.kind = kind;
+  record.channel = channel;
+  record.value = value;
+  return record;
+}
+
+} // namespace
+
+void setUp()
+{
+  diag::ResetTrace();
+  diag::SetTraceEnabled(true);
+}
+
+void tearDown() {}
+
+void test_deck_dump_decodes_into_a_timeline()
+{
+  ctrl::CommandProcessor processor;
+  Dump(processor, "#3 MOVE:0,50");
+  motion::pio::StepperCommand command{};
+  TEST_ASSERT_TRUE(processor.motorManager().takePendingCommand(0, command));
+  processor.service(1'000'000);
+
+  // Tagged dump lines decode the same as bare ones.
+  const std::vector<std::string> page = Dump(processor, "#9 TRACE:DUMP");
+  trace::Capture capture{};
+  TEST_ASSERT_EQUAL_UINT32(5, trace::AddPage(page, capture));
+  const std::vector<std::string> timeline = trace::Timeline(capture);
+  TEST_ASSERT_EQUAL_UINT32(5, timeline.size());
+  TEST_ASSERT_TRUE(HasLineEndingWith(timeline, "CMD     MOVE #3"));
+  TEST_ASSERT_TRUE(HasLineEndingWith(timeline, "PHASE   CH=0 MOVING AWAKE"));
+  TEST_ASSERT_TRUE(HasLineEndingWith(timeline, "LATCH   CH=0 STEPS=50"));
+  TEST_ASSERT_TRUE(HasLineEndingWith(timeline, "PHASE   CH=0 IDLE ASLEEP"));
+  TEST_ASSERT_TRUE(HasLineEndingWith(timeline, "CMD     TRACE #9"));
+  TEST_ASSERT_EQUAL_STRING("         0 +      0 CMD     MOVE #3", timeline[0].c_str());
+}
+
+void test_overlapping_pages_merge_and_gaps_show()
+{
+  ctrl::CommandProcessor processor;
+  for (int i = 0; i < 3; ++i)
+  {
+    Dump(processor, "STATUS:0");
+  }
+  // A host streaming the ring re-reads from its last NEXT; the overlap is
+  // the same records and collapses.
+  std::ostringstream transcript;
+  for (const char *command : {"TRACE:DUMP", "TRACE:DUMP,1"})
+  {
+    for (const std::string &line : Dump(processor, command))
+    {
+      transcript << line << "\r\n";
+    }
+  }
+  std::istringstream in(transcript.str());
+  trace::Capture capture{};
+  TEST_ASSERT_EQUAL_UINT32(4 + 4, trace::ReadDump(in, capture));
+  TEST_ASSERT_EQUAL_UINT32(5, capture.records.size());
+  TEST_ASSERT_EQUAL_STRING("TRACE", ctrl::CommandProcessor::verbName(capture.records.at(4).channel));
+
+  capture.records.erase(2);
+  const std::vector<std::string> timeline = trace::Timeline(capture);
+  TEST_ASSERT_EQUAL_UINT32(5, timeline.size());
+  TEST_ASSERT_EQUAL_STRING("-- 1 records missing --", timeline[2].c_str());
+}
+
+void test_timestamps_unwrap_and_records_describe_themselves()
+{
+  trace::Capture capture{};
+  capture.records[10] = Record(0xFFFFFFF0U, diag::TraceKind::SlotRetired, 2, 7);
+  capture.records[11] = Record(0x00000010U, diag::TraceKind::Overrun,
+                               static_cast<uint8_t>(diag::TraceOverrun::LoopStall), 2500);
+  capture.records[12] = Record(0x00000020U, diag::TraceKind::Overrun,
+                               static_cast<uint8_t>(diag::TraceOverrun::EventQueue), 5);
+  capture.records[13] = Record(0x00000030U, diag::TraceKind::SleepLatch, diag::kTraceNoChannel, 0x0081);
+  const std::vector<std::string> timeline = trace::Timeline(capture);
+  TEST_ASSERT_EQUAL_UINT32(4, timeline.size());
+  TEST_ASSERT_EQUAL_STRING("         0 +      0 RETIRE  CH=2 RETIRED=7", timeline[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("        32 +     32 OVERRUN LOOP_STALL US=2500", timeline[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("        48 +     16 OVERRUN EVENT_QUEUE CH=5", timeline[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("        64 +     16 SLEEP   AWAKE=0x0081", timeline[3].c_str());
+
+  uint8_t bytes[sizeof(diag::TraceRecord)];
+  diag::EncodeTraceRecord(capture.records[11], bytes);
+  TEST_ASSERT_EQUAL_HEX8(0x10, bytes[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xC4, bytes[6]);
+  TEST_ASSERT_EQUAL_HEX8(0x09, bytes[7]);
+  const diag::TraceRecord decoded = diag::DecodeTraceRecord(bytes);
+  TEST_ASSERT_EQUAL_UINT32(0x10, decoded.micros);
+  TEST_ASSERT_EQUAL_UINT16(2500, decoded.value);
+}
+
+void test_ring_keeps_the_newest_records()
+{
+  for (uint16_t i = 0; i < diag::kTraceCapacity + 3; ++i)
+  {
+    diag::Trace(diag::TraceKind::SlotLatched, 0, i);
+  }
+  diag::TraceRecord record{};
+  TEST_ASSERT_FALSE(diag::ReadTrace(2, record));
+  TEST_ASSERT_TRUE(diag::ReadTrace(3, record));
+  TEST_ASSERT_EQUAL_UINT16(3, record.value);
+  TEST_ASSERT_TRUE(diag::ReadTrace(diag::kTraceCapacity + 2, record));
+  TEST_ASSERT_EQUAL_UINT16(diag::kTraceCapacity + 2, record.value);
+  TEST_ASSERT_FALSE(diag::ReadTrace(diag::kTraceCapacity + 3, record));
+
+  diag::SetTraceEnabled(false);
+  diag::Trace(diag::TraceKind::SlotLatched, 0, 0);
+  TEST_ASSERT_EQUAL_UINT32(diag::kTraceCapacity + 3, diag::TraceHead());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_deck_dump_decodes_into_a_timeline);
+  RUN_TEST(test_overlapping_pages_merge_and_gaps_show);
+  RUN_TEST(test_timestamps_unwrap_and_records_describe_themselves);
+  RUN_TEST(test_ring_keeps_the_newest_records);
+  return UNITY_END();
+}
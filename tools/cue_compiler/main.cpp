@@ -0,0 +1,106 @@
+// Offline show compiler.
+//
+//   cue_compiler <timeline.txt> [-o program.bin] [--moves] [--cap <channels>] [--max-cue-ms <ms>]
+//
+// Plans every cue with the firmware's timing model, prints diagnostics and
+// writes the delta-encoded program (-o) or the streaming MOVE script
+// (--moves). Exits non-zero when any cue is unreachable or over budget.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "cue/CueCompiler.hpp"
+
+namespace
+{
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr, "usage: %s <timeline> [-o program.bin] [--moves] [--cap <channels>] [--max-cue-ms <ms>]\n", program);
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    return Usage(argv[0]);
+  }
+
+  const char *outputPath = nullptr;
+  bool printMoves = false;
+  cue::CompileOptions options{};
+  for (int i = 2; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+    {
+      outputPath = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--moves") == 0)
+    {
+      printMoves = true;
+    }
+    else if (std::strcmp(argv[i], "--cap") == 0 && i + 1 < argc)
+    {
+      options.maxMovingChannels = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--max-cue-ms") == 0 && i + 1 < argc)
+    {
+      options.maxCueDurationMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else
+    {
+      return Usage(argv[0]);
+    }
+  }
+
+  std::ifstream input(argv[1]);
+  if (!input)
+  {
+    std::fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 2;
+  }
+  std::stringstream text;
+  text << input.rdbuf();
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<cue::Cue> cues;
+  std::vector<cue::Diagnostic> parseErrors;
+  cue::ParseTimeline(text.str(), cues, parseErrors);
+  const std::size_t cueCount = cues.size();
+  cue::CompiledShow show = cue::CueCompiler(options).compile(std::move(cues));
+  show.diagnostics.insert(show.diagnostics.begin(), parseErrors.begin(), parseErrors.end());
+  const std::vector<uint8_t> program = cue::EncodeProgram(show);
+  const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  for (const auto &diagnostic : show.diagnostics)
+  {
+    std::fprintf(stderr, "%s:%lu: %s at %lu ms: %s\n", argv[1], static_cast<unsigned long>(diagnostic.line),
+                 cue::DiagnosticLabel(diagnostic.code), static_cast<unsigned long>(diagnostic.atMs), diagnostic.detail.c_str());
+  }
+  std::fprintf(stderr, "%zu cues -> %zu moves, show %lu ms, program %zu bytes, compiled in %.2f ms\n", cueCount,
+               show.moveCount(), static_cast<unsigned long>(show.endMs), program.size(), elapsedMs);
+
+  if (printMoves)
+  {
+    std::fputs(cue::FormatMoveScript(show).c_str(), stdout);
+  }
+  if (outputPath != nullptr)
+  {
+    std::ofstream output(outputPath, std::ios::binary);
+    output.write(reinterpret_cast<const char *>(program.data()), static_cast<std::streamsize>(program.size()));
+    if (!output)
+    {
+      std::fprintf(stderr, "cannot write %s\n", outputPath);
+      return 2;
+    }
+  }
+  return show.ok() ? 0 : 1;
+}
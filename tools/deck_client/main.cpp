@@ -0,0 +1,190 @@
+// Host client for one or more decks.
+//
+//   deck_client --port <tty> [--port <tty> ...] [--window <n>] [--timeout-ms <ms>] [--events]
+//               [--bench <count> [--bench-command <cmd>]] [command ...]
+//
+// Commands come from the arguments, or one per stdin line when there are
+// none. Every command goes to every port, pipelined up to --window deep per
+// deck. Replies print as "<port> #<seq> > command" followed by
+// "<port> < line", in completion order. --events keeps printing EVT and
+// other unsolicited lines after the last reply until --timeout-ms passes
+// without one. --bench sends <count> copies of --bench-command (default
+// STATUS:0) to every deck and reports commands per second on stderr.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "host/DeckClient.hpp"
+
+namespace
+{
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr,
+               "usage: %s --port <tty> [--port <tty> ...] [--window <n>] [--timeout-ms <ms>] [--events] "
+               "[--bench <count> [--bench-command <cmd>]] [command ...]\n",
+               program);
+  return 2;
+}
+
+void PrintReply(const host::DeckClient &deck, const host::Reply &reply)
+{
+  std::printf("%s #%u > %s\n", deck.name().c_str(), static_cast<unsigned>(reply.sequence), reply.command.c_str());
+  std::printf("%s < CTRL:%s\n", deck.name().c_str(), reply.code.empty() ? "<no reply>" : reply.code.c_str());
+  for (const std::string &line : reply.lines)
+  {
+    std::printf("%s < %s\n", deck.name().c_str(), line.c_str());
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> ports;
+  std::vector<std::string> commands;
+  host::DeckClient::Options options{};
+  int timeoutMs = 2000;
+  bool events = false;
+  unsigned long benchCount = 0;
+  std::string benchCommand = "STATUS:0";
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+    {
+      ports.emplace_back(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+    {
+      options.window = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--timeout-ms") == 0 && i + 1 < argc)
+    {
+      timeoutMs = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--events") == 0)
+    {
+      events = true;
+    }
+    else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+    {
+      benchCount = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--bench-command") == 0 && i + 1 < argc)
+    {
+      benchCommand = argv[++i];
+    }
+    else if (argv[i][0] == '-')
+    {
+      return Usage(argv[0]);
+    }
+    else
+    {
+      commands.emplace_back(argv[i]);
+    }
+  }
+  if (ports.empty())
+  {
+    return Usage(argv[0]);
+  }
+
+  std::vector<std::unique_ptr<host::DeckClient>> decks;
+  host::DeckGroup group;
+  for (const std::string &port : ports)
+  {
+    decks.push_back(std::make_unique<host::DeckClient>(options));
+    host::DeckClient &deck = *decks.back();
+    if (!deck.open(port))
+    {
+      std::fprintf(stderr, "%s: cannot open\n", port.c_str());
+      return 1;
+    }
+    group.add(deck);
+  }
+
+  if (benchCount > 0)
+  {
+    const auto started = std::chrono::steady_clock::now();
+    uint64_t failed = 0;
+    for (unsigned long i = 0; i < benchCount; ++i)
+    {
+      group.broadcast(benchCommand, [&failed](std::size_t, const host::Reply &reply) { failed += !reply.ok(); });
+    }
+    const bool drained = group.drain(timeoutMs + static_cast<int>(benchCount));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const double total = static_cast<double>(benchCount * decks.size());
+    std::fprintf(stderr, "%.0f commands in %.3f s: %.0f commands/s (%zu decks, window %zu), %llu not OK%s\n", total,
+                 seconds, seconds > 0.0 ? total / seconds : 0.0, decks.size(), options.window,
+                 static_cast<unsigned long long>(failed), drained ? "" : ", timed out");
+    return drained && failed == 0 ? 0 : 1;
+  }
+
+  auto lastActivity = std::chrono::steady_clock::now();
+  for (auto &deck : decks)
+  {
+    host::DeckClient *client = deck.get();
+    client->setLineHandler(
+        [client, &lastActivity](std::string_view line)
+        {
+          lastActivity = std::chrono::steady_clock::now();
+          std::printf("%s < %.*s\n", client->name().c_str(), static_cast<int>(line.size()), line.data());
+        });
+    client->setEventHandler(
+        [client, &lastActivity](const host::Event &event)
+        {
+          static const char *const kKinds[] = {"DONE", "HOMED", "FAULT", "OVERFLOW"};
+          lastActivity = std::chrono::steady_clock::now();
+          std::printf("%s < ", client->name().c_str());
+          if (event.tagged)
+          {
+            std::printf("#%u ", static_cast<unsigned>(event.sequence));
+          }
+          if (event.kind == host::EventKind::Overflow)
+          {
+            std::printf("EVT:OVERFLOW DROPPED=%lu\n", static_cast<unsigned long>(event.dropped));
+            return;
+          }
+          std::printf("EVT:%s CH=%lu POS=%ld%s%s\n", kKinds[static_cast<int>(event.kind)],
+                      static_cast<unsigned long>(event.channel), static_cast<long>(event.position),
+                      event.error.empty() ? "" : " ERR=", event.error.c_str());
+        });
+  }
+
+  if (commands.empty())
+  {
+    for (std::string line; std::getline(std::cin, line);)
+    {
+      if (!line.empty())
+      {
+        commands.push_back(line);
+      }
+    }
+  }
+  for (const std::string &command : commands)
+  {
+    group.broadcast(command, [&decks](std::size_t index, const host::Reply &reply) { PrintReply(*decks[index], reply); });
+  }
+  const bool drained = group.drain(timeoutMs);
+  if (!drained)
+  {
+    std::fprintf(stderr, "timed out with %zu commands pending\n", group.pending());
+  }
+  if (events)
+  {
+    // Events arrive unprompted; stop after a quiet --timeout-ms.
+    lastActivity = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - lastActivity < std::chrono::milliseconds(timeoutMs) &&
+           group.poll(timeoutMs))
+    {
+    }
+  }
+  std::fflush(stdout);
+  return drained ? 0 : 1;
+}
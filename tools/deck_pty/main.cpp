@@ -0,0 +1,93 @@
+// The deck's command loop on a pseudo-terminal, for host tools without a board.
+//
+//   deck_pty [--clock-scale <x>] [--loop-us <us>] [--link <path>]
+//
+// Prints the pty path on stdout, then serves until SIGINT or SIGTERM. Point
+// smoke_test.py or deck_client at the path (or at --link, a symlink with a
+// fixed name). --clock-scale 10 runs the deck's clock ten times faster than
+// the wall clock, so moves and homing finish sooner.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "host/PtyDeck.hpp"
+
+namespace
+{
+
+host::PtyDeck *gDeck = nullptr;
+
+void Stop(int)
+{
+  gDeck->stop();
+}
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr, "usage: %s [--clock-scale <x>] [--loop-us <us>] [--link <path>]\n", program);
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  host::PtyDeckOptions options{};
+  const char *linkPath = nullptr;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--clock-scale") == 0 && i + 1 < argc)
+    {
+      options.clockScale = std::strtod(argv[++i], nullptr);
+    }
+    else if (std::strcmp(argv[i], "--loop-us") == 0 && i + 1 < argc)
+    {
+      options.loopPeriodUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (std::strcmp(argv[i], "--link") == 0 && i + 1 < argc)
+    {
+      linkPath = argv[++i];
+    }
+    else
+    {
+      return Usage(argv[0]);
+    }
+  }
+  if (options.clockScale <= 0.0)
+  {
+    return Usage(argv[0]);
+  }
+
+  host::PtyDeck deck(options);
+  if (!deck.open())
+  {
+    std::perror("pty");
+    return 1;
+  }
+  if (linkPath != nullptr)
+  {
+    ::unlink(linkPath);
+    if (::symlink(deck.path().c_str(), linkPath) != 0)
+    {
+      std::perror(linkPath);
+      return 1;
+    }
+  }
+  std::printf("%s\n", deck.path().c_str());
+  std::fflush(stdout);
+
+  gDeck = &deck;
+  std::signal(SIGINT, Stop);
+  std::signal(SIGTERM, Stop);
+  deck.run();
+
+  if (linkPath != nullptr)
+  {
+    ::unlink(linkPath);
+  }
+  std::fprintf(stderr, "%.3f s of deck time\n", static_cast<double>(deck.virtualMicros()) / 1e6);
+  return 0;
+}
@@ -0,0 +1,281 @@
+// Whole-firmware simulator: the deck's own setup()/loop() on a virtual RP2040.
+//
+//   firmware_sim [--script cues.txt] [--duration-s <s>] [--repeat-ms <ms>] [--loop-us <us>]
+//                [--vcd trace.vcd] [--flash image.bin] [--quiet]
+//
+// Script lines are "<ms> <command>", sent when the virtual clock reaches
+// <ms>; with --repeat-ms the script restarts every period until the duration
+// ends. Host traffic is printed as "<us> > cmd" / "<us> < line" unless
+// --quiet. --vcd writes every STEP, DIR and SLEEP edge for a waveform viewer.
+// --flash loads the flash image if the file exists and saves it on exit, so
+// consecutive runs see the previous run's calibration and journal.
+// A per-channel summary and the speed relative to real time go to stderr.
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boards/Rp2040Pins.hpp"
+#include "sim/Simulation.hpp"
+
+#if !defined(PLATFORMIO_UNIT_TESTING) && !defined(UNIT_TEST)
+
+namespace
+{
+
+namespace pins = board::rp2040;
+
+struct Cue
+{
+  uint64_t ms = 0;
+  std::string command;
+};
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr,
+               "usage: %s [--script cues.txt] [--duration-s <s>] [--repeat-ms <ms>] [--loop-us <us>] "
+               "[--vcd trace.vcd] [--flash image.bin] [--quiet]\n",
+               program);
+  return 2;
+}
+
+std::vector<Cue> LoadScript(const char *path)
+{
+  std::vector<Cue> cues;
+  std::ifstream file(path);
+  for (std::string line; std::getline(file, line);)
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    char *end = nullptr;
+    const uint64_t ms = std::strtoull(line.c_str(), &end, 10);
+    while (*end == ' ' || *end == '\t')
+    {
+      ++end;
+    }
+    if (*end != '\0')
+    {
+      cues.push_back(Cue{ms, end});
+    }
+  }
+  return cues;
+}
+
+// Value Change Dump with one wire per STEP, DIR and SLEEP line, 1 ns units.
+class VcdWriter
+{
+public:
+  explicit VcdWriter(const char *path) : file_(std::fopen(path, "w")) {}
+  ~VcdWriter()
+  {
+    if (file_ != nullptr)
+    {
+      std::fclose(file_);
+    }
+  }
+
+  bool open() const { return file_ != nullptr; }
+
+  void writeHeader()
+  {
+    std::fprintf(file_, "$timescale 1ns $end\n$scope module deck $end\n");
+    for (std::size_t ch = 0; ch < pins::kChannelCount; ++ch)
+    {
+      std::fprintf(file_, "$var wire 1 %s STEP%zu $end\n", gpioId(pins::kStepPins[ch]).c_str(), ch);
+      std::fprintf(file_, "$var wire 1 %s DIR%zu $end\n", gpioId(pins::kDirPins[ch]).c_str(), ch);
+      std::fprintf(file_, "$var wire 1 %s SLEEP%zu $end\n", sleepId(ch).c_str(), ch);
+    }
+    std::fprintf(file_, "$upscope $end\n$enddefinitions $end\n#0\n");
+  }
+
+  static void Sink(void *context, const sim::TraceEvent &event)
+  {
+    static_cast<VcdWriter *>(context)->write(event);
+  }
+
+private:
+  static std::string gpioId(std::size_t pin) { return "g" + std::to_string(pin); }
+  static std::string sleepId(std::size_t line) { return "s" + std::to_string(line); }
+
+  void write(const sim::TraceEvent &event)
+  {
+    const uint64_t ns = event.cycle * (1'000'000'000ULL / sim::kSystemClockHz);
+    if (ns != lastNs_)
+    {
+      std::fprintf(file_, "#%llu\n", static_cast<unsigned long long>(ns));
+      lastNs_ = ns;
+    }
+    const std::string id = event.signal == sim::TraceSignal::Gpio ? gpioId(event.index)
+                                                                  : sleepId(sim::Board::ChainBitForLine(event.index));
+    std::fprintf(file_, "%c%s\n", event.level ? '1' : '0', id.c_str());
+  }
+
+  std::FILE *file_ = nullptr;
+  uint64_t lastNs_ = 0;
+};
+
+void PrintOutput(bool quiet)
+{
+  std::deque<sim::OutputLine> &lines = sim::board().serial().lines();
+  if (!quiet)
+  {
+    for (const sim::OutputLine &line : lines)
+    {
+      std::printf("%llu < %s\n", static_cast<unsigned long long>(line.micros), line.text.c_str());
+    }
+  }
+  lines.clear();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  const char *scriptPath = nullptr;
+  const char *vcdPath = nullptr;
+  const char *flashPath = nullptr;
+  uint64_t durationUs = 60ULL * 1'000'000ULL;
+  uint64_t repeatMs = 0;
+  bool quiet = false;
+  sim::SimulationOptions options{};
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+    {
+      scriptPath = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc)
+    {
+      durationUs = static_cast<uint64_t>(std::strtod(argv[++i], nullptr) * 1e6);
+    }
+    else if (std::strcmp(argv[i], "--repeat-ms") == 0 && i + 1 < argc)
+    {
+      repeatMs = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--loop-us") == 0 && i + 1 < argc)
+    {
+      options.loopPeriodUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (std::strcmp(argv[i], "--vcd") == 0 && i + 1 < argc)
+    {
+      vcdPath = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--flash") == 0 && i + 1 < argc)
+    {
+      flashPath = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--quiet") == 0)
+    {
+      quiet = true;
+    }
+    else
+    {
+      return Usage(argv[0]);
+    }
+  }
+
+  sim::Board &board = sim::board();
+  for (std::size_t ch = 0; ch < pins::kChannelCount; ++ch)
+  {
+    board.watchAxis(ch, pins::kStepPins[ch], pins::kDirPins[ch]);
+  }
+  board.attachShiftRegisters(pins::kShiftRegisterPins.data, pins::kShiftRegisterPins.clock,
+                             pins::kShiftRegisterPins.latch, (pins::kChannelCount + 7U) / 8U);
+  if (flashPath != nullptr)
+  {
+    std::ifstream image(flashPath, std::ios::binary);
+    image.read(reinterpret_cast<char *>(board.flash().data()), sim::FlashChip::kSizeBytes);
+  }
+
+  std::unique_ptr<VcdWriter> vcd;
+  if (vcdPath != nullptr)
+  {
+    vcd = std::make_unique<VcdWriter>(vcdPath);
+    if (!vcd->open())
+    {
+      std::fprintf(stderr, "%s: cannot open\n", vcdPath);
+      return 1;
+    }
+    vcd->writeHeader();
+    board.setTraceSink(&VcdWriter::Sink, vcd.get());
+  }
+
+  const std::vector<Cue> cues = scriptPath != nullptr ? LoadScript(scriptPath) : std::vector<Cue>{};
+  sim::Simulation simulation(&setup, &loop, options);
+  const auto started = std::chrono::steady_clock::now();
+  simulation.boot();
+  PrintOutput(quiet);
+
+  uint64_t passStartUs = 0;
+  do
+  {
+    for (const Cue &cue : cues)
+    {
+      const uint64_t atUs = passStartUs + cue.ms * 1000ULL;
+      if (atUs >= durationUs)
+      {
+        break;
+      }
+      if (atUs > simulation.micros())
+      {
+        simulation.run(atUs - simulation.micros());
+      }
+      PrintOutput(quiet);
+      if (!quiet)
+      {
+        std::printf("%llu > %s\n", static_cast<unsigned long long>(simulation.micros()), cue.command.c_str());
+      }
+      simulation.send(cue.command);
+    }
+    passStartUs += repeatMs * 1000ULL;
+  } while (repeatMs > 0 && passStartUs < durationUs);
+  if (durationUs > simulation.micros())
+  {
+    simulation.run(durationUs - simulation.micros());
+  }
+  PrintOutput(quiet);
+
+  const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  const double virtualSeconds = static_cast<double>(simulation.micros()) / 1e6;
+  for (std::size_t ch = 0; ch < pins::kChannelCount; ++ch)
+  {
+    const sim::AxisStats &axis = board.axis(ch);
+    const sim::SleepStats &sleep = board.sleepLine(ch);
+    std::fprintf(stderr, "CH=%zu PULSES=%llu POS=%lld REVERSALS=%llu WAKES=%llu AWAKE_S=%.3f\n", ch,
+                 static_cast<unsigned long long>(axis.pulses), static_cast<long long>(axis.position),
+                 static_cast<unsigned long long>(axis.reversals), static_cast<unsigned long long>(sleep.wakes),
+                 static_cast<double>(sleep.awakeCycles) / sim::kSystemClockHz);
+  }
+  for (uint8_t pin = 0; pin < sim::Gpio::kPinCount; ++pin)
+  {
+    if ((board.gpio().conflictMask() >> pin) & 1U)
+    {
+      std::fprintf(stderr, "GPIO%u: write dropped, pin owned by another function\n", pin);
+    }
+  }
+  std::fprintf(stderr, "%.3f s virtual in %.3f s (%.0fx real time), %llu loops\n", virtualSeconds, wallSeconds,
+               wallSeconds > 0.0 ? virtualSeconds / wallSeconds : 0.0,
+               static_cast<unsigned long long>(simulation.loops()));
+
+  board.setTraceSink(nullptr, nullptr);
+  vcd.reset();
+  if (flashPath != nullptr)
+  {
+    std::ofstream image(flashPath, std::ios::binary);
+    image.write(reinterpret_cast<const char *>(board.flash().data()), sim::FlashChip::kSizeBytes);
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Host front end for the firmware's targeting solver.
+//
+//   geometry_cli <mirror> <x_mm> <y_mm> <distance_mm> [steps_per_turn]
+//   geometry_cli -            (reads "<mirror> <x> <y> <distance>" lines from stdin)
+//
+// Prints the same step targets the AIM verb would queue, so cue sheets can be
+// checked off-device.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "geometry/Targeting.hpp"
+#include "motion/MotorManager.hpp"
+
+namespace
+{
+
+constexpr std::size_t kMirrorCount = motion::kChannelCount / 2;
+
+int Solve(long mirror, long x, long y, long distance, long stepsPerTurn)
+{
+  if (mirror < 0 || static_cast<std::size_t>(mirror) >= kMirrorCount)
+  {
+    std::fprintf(stderr, "mirror %ld out of range (0-%zu)\n", mirror, kMirrorCount - 1);
+    return 2;
+  }
+
+  geometry::MirrorPose pose = geometry::DefaultMirrorPose(static_cast<std::size_t>(mirror));
+  pose.stepsPerTurn = static_cast<int32_t>(stepsPerTurn);
+  const geometry::StepLimits limits{-motion::MotorManager::kDefaultLimit, motion::MotorManager::kDefaultLimit};
+  const geometry::WallTarget target{static_cast<int32_t>(x), static_cast<int32_t>(y), static_cast<int32_t>(distance)};
+  const geometry::AxisTargets axes = geometry::SolveMirror(pose, target, limits);
+
+  std::printf("mirror=%ld status=%s yaw_ch=%u yaw=%ld (%.3f deg) pitch_ch=%u pitch=%ld (%.3f deg)\n",
+              mirror,
+              geometry::TargetStatusLabel(axes.status),
+              static_cast<unsigned>(pose.yawChannel),
+              static_cast<long>(axes.yawSteps),
+              geometry::DegreesFromAngle(axes.yawAngle),
+              static_cast<unsigned>(pose.pitchChannel),
+              static_cast<long>(axes.pitchSteps),
+              geometry::DegreesFromAngle(axes.pitchAngle));
+  return (axes.status == geometry::TargetStatus::Reachable) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc == 2 && std::strcmp(argv[1], "-") == 0)
+  {
+    int worst = 0;
+    long mirror = 0;
+    long x = 0;
+    long y = 0;
+    long distance = 0;
+    while (std::scanf("%ld %ld %ld %ld", &mirror, &x, &y, &distance) == 4)
+    {
+      const int rc = Solve(mirror, x, y, distance, geometry::kDefaultStepsPerTurn);
+      worst = (rc > worst) ? rc : worst;
+    }
+    return worst;
+  }
+
+  if (argc != 5 && argc != 6)
+  {
+    std::fprintf(stderr, "usage: %s <mirror> <x_mm> <y_mm> <distance_mm> [steps_per_turn] | -\n", argv[0]);
+    return 2;
+  }
+
+  const long stepsPerTurn = (argc == 6) ? std::strtol(argv[5], nullptr, 10) : geometry::kDefaultStepsPerTurn;
+  return Solve(std::strtol(argv[1], nullptr, 10),
+               std::strtol(argv[2], nullptr, 10),
+               std::strtol(argv[3], nullptr, 10),
+               std::strtol(argv[4], nullptr, 10),
+               stepsPerTurn);
+}
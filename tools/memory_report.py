@@ -0,0 +1,209 @@
+"""
+PlatformIO post-build memory report for the control deck firmware.
+
+Runs after the ELF links and prints:
+  * per-object static RAM for the project's globals (from `nm`),
+  * worst-case stack depth of the control path roots (from GCC's
+    -fcallgraph-info=su call graphs),
+  * every heap entry point reachable from those roots.
+
+The build fails when a root can reach the heap, when a root's stack depth
+exceeds `custom_stack_budget_bytes`, or when project statics exceed
+`custom_static_ram_budget_bytes`. Both budgets live in platformio.ini.
+"""
+
+from __future__ import annotations
+
+import pathlib
+import re
+import subprocess
+import sys
+from typing import Dict, Iterable, List, Optional, Set, Tuple
+
+Import("env")  # type: ignore  # noqa: F821  (provided by PlatformIO/SCons)
+
+CONTROL_ROOTS = (
+    "ctrl::CommandProcessor::processLine",
+    "ctrl::CommandProcessor::service",
+    "ctrl::CommandProcessor::collectEvents",
+    "ctrl::CommandProcessor::collectUpdates",
+)
+
+HEAP_SYMBOLS = {
+    "malloc",
+    "calloc",
+    "realloc",
+    "_malloc_r",
+    "_calloc_r",
+    "_realloc_r",
+    "_sbrk",
+    "_sbrk_r",
+    "strdup",
+    "_Znwj",
+    "_Znaj",
+    "_ZnwjRKSt9nothrow_t",
+    "_ZnajRKSt9nothrow_t",
+    "__wrap_malloc",
+    "__wrap_calloc",
+    "__wrap_realloc",
+}
+
+PROJECT_SYMBOL = re.compile(r"^(ctrl::|motion::|diag::|board::|storage::|geometry::|\(anonymous namespace\)::g)")
+
+NODE_RE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+EDGE_RE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+STACK_RE = re.compile(r"(\d+) bytes \(([^)]*)\)")
+
+
+def canonical(title: str) -> str:
+    """Drops the `path:` prefix GCC puts on some titles so cross-TU edges meet
+    their definitions. Anonymous-namespace symbols keep it to stay unique."""
+    if ":" in title and "_GLOBAL__N_" not in title:
+        return title.rsplit(":", 1)[1]
+    return title
+
+
+class CallGraph:
+    def __init__(self) -> None:
+        self.labels: Dict[str, str] = {}
+        self.frames: Dict[str, Tuple[int, str]] = {}
+        self.edges: Dict[str, Set[str]] = {}
+
+    def load(self, path: pathlib.Path) -> None:
+        text = path.read_text(encoding="utf-8", errors="replace")
+        for raw_title, label in NODE_RE.findall(text):
+            title = canonical(raw_title)
+            name = label.split("\\n", 1)[0]
+            self.labels.setdefault(title, name)
+            match = STACK_RE.search(label)
+            if match:
+                self.frames[title] = (int(match.group(1)), match.group(2))
+        for source, target in EDGE_RE.findall(text):
+            self.edges.setdefault(canonical(source), set()).add(canonical(target))
+
+    def find(self, qualified_name: str) -> List[str]:
+        pattern = re.compile(r"(?:^|\s)" + re.escape(qualified_name) + r"\(")
+        return [title for title, name in self.labels.items() if pattern.search(name) and title in self.frames]
+
+    def worst_path(self, root: str) -> Tuple[int, List[str], Set[str], bool]:
+        """Returns (depth, path, unknown callees, unbounded)."""
+        memo: Dict[str, Tuple[int, List[str]]] = {}
+        unknown: Set[str] = set()
+        unbounded = False
+        visiting: Set[str] = set()
+
+        def walk(node: str) -> Tuple[int, List[str]]:
+            nonlocal unbounded
+            if node in memo:
+                return memo[node]
+            if node in visiting:
+                unbounded = True
+                return 0, [node + " (recursion)"]
+            visiting.add(node)
+            frame, kind = self.frames.get(node, (0, "unknown"))
+            if node not in self.frames:
+                unknown.add(self.labels.get(node, node))
+            if "dynamic" in kind and "bounded" not in kind:
+                unbounded = True
+            best, best_path = 0, []
+            for callee in self.edges.get(node, ()):
+                depth, path = walk(callee)
+                if depth > best:
+                    best, best_path = depth, path
+            visiting.discard(node)
+            memo[node] = (frame + best, [self.labels.get(node, node)] + best_path)
+            return memo[node]
+
+        depth, path = walk(root)
+        return depth, path, unknown, unbounded
+
+    def reachable(self, root: str) -> Set[str]:
+        seen: Set[str] = set()
+        stack = [root]
+        while stack:
+            node = stack.pop()
+            if node in seen:
+                continue
+            seen.add(node)
+            stack.extend(self.edges.get(node, ()))
+        return seen
+
+
+def tool_path(env, name: str) -> str:  # type: ignore[no-untyped-def]
+    compiler = env.subst("$CC")
+    if compiler.endswith("gcc"):
+        return compiler[: -len("gcc")] + name
+    return name
+
+
+def static_objects(env, elf: str) -> List[Tuple[int, str]]:  # type: ignore[no-untyped-def]
+    output = subprocess.check_output([tool_path(env, "nm"), "-S", "-C", "--size-sort", elf], text=True)
+    objects = []
+    for line in output.splitlines():
+        parts = line.split(" ", 3)
+        if len(parts) != 4 or parts[2].lower() not in ("b", "d"):
+            continue
+        name = parts[3]
+        if PROJECT_SYMBOL.match(name):
+            objects.append((int(parts[1], 16), name))
+    return sorted(objects, reverse=True)
+
+
+def option_int(env, name: str) -> Optional[int]:  # type: ignore[no-untyped-def]
+    value = env.GetProjectOption(name, "")
+    return int(value) if str(value).strip() else None
+
+
+def report(source, target, env) -> None:  # type: ignore[no-untyped-def]
+    elf = str(target[0])
+    build_dir = pathlib.Path(env.subst("$BUILD_DIR"))
+    failures: List[str] = []
+
+    print("\n== Memory report ==")
+    objects = static_objects(env, elf)
+    total = 0
+    for size, name in objects:
+        total += size
+        print(f"  {size:6d} B  {name}")
+    print(f"  {total:6d} B  total project statics")
+    ram_budget = option_int(env, "custom_static_ram_budget_bytes")
+    if ram_budget is not None and total > ram_budget:
+        failures.append(f"project statics {total} B exceed budget {ram_budget} B")
+
+    graph = CallGraph()
+    graph_files = list(build_dir.rglob("*.ci"))
+    for path in graph_files:
+        graph.load(path)
+    if not graph_files:
+        failures.append("no .ci call graphs found; is -fcallgraph-info=su in build_src_flags?")
+
+    stack_budget = option_int(env, "custom_stack_budget_bytes")
+    heap_titles = {title for title, name in graph.labels.items() if title in HEAP_SYMBOLS or name in HEAP_SYMBOLS}
+    for root_name in CONTROL_ROOTS:
+        roots = graph.find(root_name)
+        if not roots:
+            failures.append(f"control root {root_name} not found in call graphs")
+            continue
+        for root in roots:
+            depth, path, unknown, unbounded = graph.worst_path(root)
+            print(f"\n  stack {root_name}: {depth} B worst case{' (UNBOUNDED)' if unbounded else ''}")
+            for frame in path:
+                print(f"    -> {frame}")
+            if unknown:
+                print(f"    external callees without stack info: {', '.join(sorted(unknown))}")
+            if stack_budget is not None and depth > stack_budget:
+                failures.append(f"{root_name} needs {depth} B of stack, budget is {stack_budget} B")
+            if unbounded:
+                failures.append(f"{root_name} has recursion or dynamic stack allocation")
+            heap_hits = graph.reachable(root) & heap_titles
+            if heap_hits:
+                failures.append(f"{root_name} can reach the heap via {', '.join(sorted(heap_hits))}")
+
+    if failures:
+        for failure in failures:
+            print(f"  FAIL: {failure}", file=sys.stderr)
+        env.Exit(1)
+    print("== Memory report OK ==\n")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)  # type: ignore  # noqa: F821
@@ -0,0 +1,119 @@
+// Native replay of a recorded deck session.
+//
+//   session_replay <log> [--expect transcript.txt] [--tick-us <us>] [--settle-ms <ms>] [--no-motion]
+//
+// <log> is either a serial capture containing REC:DUMP output (REC:DATA=
+// lines) or the raw binary log. Prints the transcript, or with --expect
+// diffs against a previous transcript and exits 1 on the first mismatch.
+// Replay speed relative to real time goes to stderr.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "replay/SessionReplay.hpp"
+
+namespace
+{
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr, "usage: %s <log> [--expect transcript.txt] [--tick-us <us>] [--settle-ms <ms>] [--no-motion]\n",
+               program);
+  return 2;
+}
+
+std::vector<uint8_t> LoadLog(const char *path)
+{
+  std::ifstream file(path, std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (contents.find("REC:DATA=") != std::string::npos)
+  {
+    std::istringstream text(contents);
+    return replay::ReadDump(text);
+  }
+  return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    return Usage(argv[0]);
+  }
+
+  const char *expectPath = nullptr;
+  replay::ReplayOptions options{};
+  for (int i = 2; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--expect") == 0 && i + 1 < argc)
+    {
+      expectPath = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--tick-us") == 0 && i + 1 < argc)
+    {
+      options.tickUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (std::strcmp(argv[i], "--settle-ms") == 0 && i + 1 < argc)
+    {
+      options.settleUs = std::strtoull(argv[++i], nullptr, 10) * 1000ULL;
+    }
+    else if (std::strcmp(argv[i], "--no-motion") == 0)
+    {
+      options.traceMotion = false;
+    }
+    else
+    {
+      return Usage(argv[0]);
+    }
+  }
+
+  const std::vector<uint8_t> bytes = LoadLog(argv[1]);
+  replay::Session session{};
+  const replay::ParseStatus status = replay::ParseSession(bytes.data(), bytes.size(), session);
+  if (status != replay::ParseStatus::Ok)
+  {
+    std::fprintf(stderr, "%s: %s log (%zu bytes)\n", argv[1], replay::ParseStatusLabel(status), bytes.size());
+    return 1;
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const replay::Transcript transcript = replay::Replay(session, options);
+  const double wallSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  std::fprintf(stderr, "%zu lines, %.3f s virtual in %.3f s (%.0fx real time), %llu service calls\n",
+               session.lines.size(), static_cast<double>(transcript.virtualUs) / 1e6, wallSeconds,
+               wallSeconds > 0.0 ? (static_cast<double>(transcript.virtualUs) / 1e6) / wallSeconds : 0.0,
+               static_cast<unsigned long long>(transcript.serviceCalls));
+
+  if (expectPath == nullptr)
+  {
+    for (const std::string &line : transcript.lines)
+    {
+      std::printf("%s\n", line.c_str());
+    }
+    return 0;
+  }
+
+  std::ifstream expectFile(expectPath);
+  std::vector<std::string> expected;
+  for (std::string line; std::getline(expectFile, line);)
+  {
+    expected.push_back(line);
+  }
+  const replay::TranscriptDiff diff = replay::Diff(expected, transcript.lines);
+  if (diff.equal)
+  {
+    std::fprintf(stderr, "transcript matches (%zu lines)\n", expected.size());
+    return 0;
+  }
+  std::printf("line %zu:\n- %s\n+ %s\n", diff.line + 1, diff.expected.c_str(), diff.actual.c_str());
+  return 1;
+}
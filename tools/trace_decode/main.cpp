@@ -0,0 +1,140 @@
+// Turns the deck's hot-path trace into a timeline.
+//
+//   trace_decode <capture>
+//   trace_decode --port <tty> [--freeze]
+//
+// <capture> is a serial transcript containing TRACE:DUMP output ("-" reads
+// stdin). With --port the tool pages the ring out itself, issuing
+// TRACE:DUMP at each NEXT until it reaches HEAD. --freeze sends TRACE:OFF
+// first so the records being chased are not overwritten while they are
+// read, and TRACE:ON afterwards.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "host/DeckClient.hpp"
+#include "trace/TraceDecode.hpp"
+
+namespace
+{
+
+constexpr int kReplyTimeoutMs = 1000;
+
+int Usage(const char *program)
+{
+  std::fprintf(stderr, "usage: %s <capture> | --port <tty> [--freeze]\n", program);
+  return 2;
+}
+
+unsigned long Field(const std::string &line, const char *key)
+{
+  const std::size_t at = line.find(key);
+  return at == std::string::npos ? 0UL : std::strtoul(line.c_str() + at + std::strlen(key), nullptr, 10);
+}
+
+bool PageFromDeck(const char *port, bool freeze, trace::Capture &capture)
+{
+  host::DeckClient client;
+  if (!client.open(port))
+  {
+    std::perror(port);
+    return false;
+  }
+  if (freeze && !client.call("TRACE:OFF", kReplyTimeoutMs).ok())
+  {
+    std::fprintf(stderr, "%s: TRACE:OFF not acknowledged\n", port);
+    return false;
+  }
+  // Each DUMP is itself traced, so with tracing on HEAD stays ahead of
+  // NEXT; paging stops at the HEAD the first page reported.
+  unsigned long end = 0;
+  bool complete = false;
+  for (unsigned long next = 0; !complete;)
+  {
+    const host::Reply reply = client.call("TRACE:DUMP," + std::to_string(next), kReplyTimeoutMs);
+    if (!reply.ok() || reply.lines.empty())
+    {
+      std::fprintf(stderr, "%s: TRACE:DUMP,%lu failed (%s)\n", port, next, reply.code.c_str());
+      return false;
+    }
+    trace::AddPage(reply.lines, capture);
+    if (end == 0)
+    {
+      end = Field(reply.lines.front(), "HEAD=");
+    }
+    next = Field(reply.lines.front(), "NEXT=");
+    complete = Field(reply.lines.front(), "COUNT=") == 0 || next >= end;
+  }
+  if (freeze)
+  {
+    client.call("TRACE:ON", kReplyTimeoutMs);
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  const char *capturePath = nullptr;
+  const char *port = nullptr;
+  bool freeze = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+    {
+      port = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--freeze") == 0)
+    {
+      freeze = true;
+    }
+    else if (capturePath == nullptr && (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0))
+    {
+      capturePath = argv[i];
+    }
+    else
+    {
+      return Usage(argv[0]);
+    }
+  }
+  if ((capturePath == nullptr) == (port == nullptr))
+  {
+    return Usage(argv[0]);
+  }
+
+  trace::Capture capture{};
+  if (port != nullptr)
+  {
+    if (!PageFromDeck(port, freeze, capture))
+    {
+      return 1;
+    }
+  }
+  else if (std::strcmp(capturePath, "-") == 0)
+  {
+    trace::ReadDump(std::cin, capture);
+  }
+  else
+  {
+    std::ifstream file(capturePath);
+    if (!file)
+    {
+      std::perror(capturePath);
+      return 1;
+    }
+    trace::ReadDump(file, capture);
+  }
+
+  for (const std::string &line : trace::Timeline(capture))
+  {
+    std::printf("%s\n", line.c_str());
+  }
+  std::fprintf(stderr, "%zu records, %llu lost before they were dumped\n", capture.records.size(),
+               static_cast<unsigned long long>(capture.lost));
+  return 0;
+}